@@ -12,6 +12,10 @@
  *
  * Internal design notes:
  * - Rendering path prefers DBE when available; falls back to single buffer.
+ * - Created with a compositor, the button has no window: render() paints
+ *   into the shared back buffer at the node's offset from the paint
+ *   callback, and button_win holds the node's input id so routed events
+ *   match as before. Redraws only damage the node.
  * - Colors are cached as pixels to avoid repeated XAllocColor calls.
  * - Theme updates simply refresh cached pixels/fonts without recreating windows.
  */
@@ -66,8 +70,14 @@ struct ButtonContext {
 	
 	// Label text (dynamically allocated)
 	char *label;
+
+	// Compositor node when drawn into a shared back buffer
+	Compositor *comp;
+	int node;
 };
 
+static void button_paint(Drawable target, int x, int y, void *user_data);
+
 /* ========== RENDERING HELPERS ========== */
 /* Color conversion and font loading now centralized in config.c */
 
@@ -115,7 +125,7 @@ static void draw_rounded_rect(Display *dpy, Drawable d, GC gc, int x, int y, int
  * Initializes DBE support if available, creates button window, caches colors,
  * loads font, and sets up event handling for all button interactions.
  */
-ButtonContext *button_create(Display *dpy, Window parent_window, const ButtonBlock *button_style, int width, int height, int padding, int border_width, int hover_border_width, int active_border_width, int border_radius) {
+ButtonContext *button_create(Display *dpy, Window parent_window, const ButtonBlock *button_style, int width, int height, int padding, int border_width, int hover_border_width, int active_border_width, int border_radius, Compositor *comp) {
 	ButtonContext *ctx = calloc(1, sizeof(ButtonContext));
 	if (!ctx) {
 		return NULL;
@@ -154,21 +164,33 @@ ButtonContext *button_create(Display *dpy, Window parent_window, const ButtonBlo
 
 	attr.event_mask = ExposureMask | ButtonPressMask | ButtonReleaseMask | EnterWindowMask | LeaveWindowMask | PointerMotionMask;
 
-	ctx->button_win = XCreateWindow(dpy, parent_window, 0, 0, (unsigned int)ctx->width, (unsigned int)ctx->height, 0, CopyFromParent, InputOutput, CopyFromParent, CWBorderPixel | CWEventMask, &attr);
+	if (comp) {
+		ctx->node = compositor_add_node(comp, button_paint, ctx);
+		if (ctx->node >= 0) {
+			ctx->comp = comp;
+			ctx->button_win = compositor_node_window(comp, ctx->node);
+			compositor_set_node_bounds(comp, ctx->node, 0, 0, ctx->width, ctx->height);
+		}
+	}
+	if (!ctx->comp) {
+		ctx->button_win = XCreateWindow(dpy, parent_window, 0, 0, (unsigned int)ctx->width, (unsigned int)ctx->height, 0, CopyFromParent, InputOutput, CopyFromParent, CWBorderPixel | CWEventMask, &attr);
+	}
 
 	// Initialize DBE buffers after window creation
-	if (ctx->dbe_ctx && dbe_is_supported(ctx->dbe_ctx)) {
+	if (!ctx->comp && ctx->dbe_ctx && dbe_is_supported(ctx->dbe_ctx)) {
 		ctx->dbe_back_buffer = dbe_allocate_back_buffer(ctx->dbe_ctx, ctx->button_win, XdbeUndefined);
 		ctx->use_dbe = (ctx->dbe_back_buffer != None);
 	} else {
 		ctx->use_dbe = 0;
 	}
 
-	ctx->gc = XCreateGC(dpy, ctx->button_win, 0, NULL);
+	ctx->gc = XCreateGC(dpy, ctx->comp ? parent_window : ctx->button_win, 0, NULL);
 
-	// Use appropriate drawable for XftDraw
-	Drawable draw_target = ctx->use_dbe ? ctx->dbe_back_buffer : ctx->button_win;
-	ctx->draw = XftDrawCreate(dpy, draw_target, DefaultVisual(dpy, ctx->screen), DefaultColormap(dpy, ctx->screen));
+	// Use appropriate drawable for XftDraw (a node uses the compositor's)
+	if (!ctx->comp) {
+		Drawable draw_target = ctx->use_dbe ? ctx->dbe_back_buffer : ctx->button_win;
+		ctx->draw = XftDrawCreate(dpy, draw_target, DefaultVisual(dpy, ctx->screen), DefaultColormap(dpy, ctx->screen));
+	}
 
 	XRenderColor xr;
 	#define CLAMP_COMP(c) ((c) < 0.0 ? 0 : (c) > 1.0 ? 65535 : (unsigned short)((c) * 65535.0 + 0.5))
@@ -179,7 +201,9 @@ ButtonContext *button_create(Display *dpy, Window parent_window, const ButtonBlo
 	#undef CLAMP_COMP
 	XftColorAllocValue(dpy, DefaultVisual(dpy, ctx->screen), DefaultColormap(dpy, ctx->screen), &xr, &ctx->xft_fg);
 
-	XMapWindow(dpy, ctx->button_win);
+	if (!ctx->comp) {
+		XMapWindow(dpy, ctx->button_win);
+	}
 	button_draw(ctx);
 
 	return ctx;
@@ -213,7 +237,10 @@ void button_destroy(ButtonContext *button_context) {
 	if (button_context->gc) {
 		XFreeGC(button_context->display, button_context->gc);
 	}
-	if (button_context->button_win) {
+	if (button_context->comp) {
+		compositor_remove_node(button_context->comp, button_context->node);
+	}
+	else if (button_context->button_win) {
 		XDestroyWindow(button_context->display, button_context->button_win);
 	}
 	if (button_context->label) {
@@ -257,23 +284,10 @@ Window button_get_window(ButtonContext *button_context) {
 	return button_context ? button_context->button_win : None;
 }
 
-/**
- * @brief Redraw button widget
- *
- * See button.h for full documentation.
- * Renders background, border (with state-dependent colors/width), and label text.
- * Uses DBE double-buffering if available for smooth updates.
- */
-void button_draw(ButtonContext *button_context) {
-	if (!button_context) {
-		return;
-	}
-	
-	// Determine drawing target
-	Drawable draw_target = button_context->use_dbe ? button_context->dbe_back_buffer : button_context->button_win;
-	
+/* Paint background, border and label with the button's origin at (ox, oy) */
+static void render(ButtonContext *button_context, Drawable draw_target, XftDraw *draw, int ox, int oy) {
 	XSetForeground(button_context->display, button_context->gc, button_context->px_bg);
-	XFillRectangle(button_context->display, draw_target, button_context->gc, 0, 0, (unsigned int)button_context->width, (unsigned int)button_context->height);
+	XFillRectangle(button_context->display, draw_target, button_context->gc, ox, oy, (unsigned int)button_context->width, (unsigned int)button_context->height);
 
 	ConfigColor border_color = button_context->style.border;
 	int border_width = button_context->border_width;
@@ -296,9 +310,9 @@ void button_draw(ButtonContext *button_context) {
 	XSetLineAttributes(button_context->display, button_context->gc, (unsigned int)border_width, LineSolid, CapButt, JoinMiter);
 
 	int inset = border_width / 2;
-	draw_rounded_rect(button_context->display, draw_target, button_context->gc, inset, inset, button_context->width - border_width, button_context->height - border_width, button_context->border_radius);
+	draw_rounded_rect(button_context->display, draw_target, button_context->gc, ox + inset, oy + inset, button_context->width - border_width, button_context->height - border_width, button_context->border_radius);
 	// Draw label text centered if Xft draw is available and label is set
-	if (button_context->draw && button_context->font && button_context->label) {
+	if (draw && button_context->font && button_context->label) {
 		const char *label = button_context->label;
 		int label_len = (int)strlen(label);
 		
@@ -310,8 +324,36 @@ void button_draw(ButtonContext *button_context) {
 		int text_x = (button_context->width - extents.width) / 2;
 		int text_y = (button_context->height + button_context->font->ascent - button_context->font->descent) / 2;
 		
-		XftDrawStringUtf8(button_context->draw, &button_context->xft_fg, button_context->font, text_x, text_y, (const FcChar8 *)label, label_len);
+		XftDrawStringUtf8(draw, &button_context->xft_fg, button_context->font, ox + text_x, oy + text_y, (const FcChar8 *)label, label_len);
 	}
+}
+
+/* Compositor paint callback */
+static void button_paint(Drawable target, int x, int y, void *user_data) {
+	ButtonContext *button_context = user_data;
+	render(button_context, target, compositor_get_draw(button_context->comp), x, y);
+}
+
+/**
+ * @brief Redraw button widget
+ *
+ * See button.h for full documentation.
+ * Renders background, border (with state-dependent colors/width), and label text.
+ * Uses DBE double-buffering if available for smooth updates.
+ */
+void button_draw(ButtonContext *button_context) {
+	if (!button_context) {
+		return;
+	}
+	if (button_context->comp) {
+		// Painted by the compositor's next frame
+		compositor_damage_node(button_context->comp, button_context->node);
+		return;
+	}
+	
+	// Determine drawing target
+	Drawable draw_target = button_context->use_dbe ? button_context->dbe_back_buffer : button_context->button_win;
+	render(button_context, draw_target, button_context->draw, 0, 0);
 	
 	// If using DBE, swap buffers to present
 	if (button_context->use_dbe) {
@@ -407,11 +449,15 @@ void button_set_pressed(ButtonContext *button_context, int pressed) {
  * See button.h for full documentation.
  */
 void button_set_position(ButtonContext *button_context, int x_pos, int y_pos) {
-	if (!button_context) {
+	if (!button_context || (button_context->x == x_pos && button_context->y == y_pos)) {
 		return;
 	}
 	button_context->x = x_pos;
 	button_context->y = y_pos;
+	if (button_context->comp) {
+		compositor_set_node_bounds(button_context->comp, button_context->node, x_pos, y_pos, button_context->width, button_context->height);
+		return;
+	}
 	XMoveWindow(button_context->display, button_context->button_win, x_pos, y_pos);
 }
 
@@ -448,6 +494,10 @@ void button_set_theme(ButtonContext *button_context, const ButtonBlock *button_s
 	button_context->px_border = config_color_to_pixel(button_context->display, button_context->screen, button_style->border);
 	button_context->px_hover_border = config_color_to_pixel(button_context->display, button_context->screen, button_style->hover_border);
 	button_context->px_active_border = config_color_to_pixel(button_context->display, button_context->screen, button_style->active_border);
+	if (button_context->comp) {
+		button_draw(button_context);
+		return;
+	}
 	XSetWindowBackground(button_context->display, button_context->button_win, button_context->px_bg);
 	// Resize window to new dimensions
 	XResizeWindow(button_context->display, button_context->button_win, (unsigned int)button_context->width, (unsigned int)button_context->height);
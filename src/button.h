@@ -23,6 +23,7 @@
  * - X11 (Xlib, Xft)
  * - config.h (ButtonBlock styling)
  * - dbe.h (optional double-buffering)
+ * - compositor.h (optional single-window rendering)
  *
  * Usage:
  *   1. Create button: button_create(display, parent_window, &style, ...)
@@ -39,6 +40,7 @@
 
 #include <X11/Xlib.h>
 #include "config.h"
+#include "compositor.h"
 
 /* ========== BUTTON CONTEXT TYPE ========== */
 
@@ -64,9 +66,13 @@ typedef struct ButtonContext ButtonContext;
  * @param hover_border_width Hover border width in pixels
  * @param active_border_width Active border width in pixels
  * @param border_radius Border radius in pixels
+ * @param comp Compositor of parent_window, or NULL for a window of its own.
+ *             With a compositor the button is a node drawn into the shared
+ *             back buffer and gets its events through
+ *             compositor_route_event(); destroy it before the compositor.
  * @return Pointer to new button context, or NULL on failure
  */
-ButtonContext *button_create(Display *dpy, Window parent_window, const ButtonBlock *button_style, int width, int height, int padding, int border_width, int hover_border_width, int active_border_width, int border_radius);
+ButtonContext *button_create(Display *dpy, Window parent_window, const ButtonBlock *button_style, int width, int height, int padding, int border_width, int hover_border_width, int active_border_width, int border_radius, Compositor *comp);
 
 /**
  * @brief Destroy a button widget and free its resources
@@ -79,7 +85,8 @@ void button_destroy(ButtonContext *button_context);
 /**
  * @brief Get the X11 window handle for a button
  * @param button_context Button context
- * @return X11 Window ID of the button widget
+ * @return X11 Window ID of the button widget (the node's input id for a
+ *         compositor node, which is not a server window)
  */
 Window button_get_window(ButtonContext *button_context);
 
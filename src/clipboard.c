@@ -13,28 +13,91 @@
  *
  * Internal design notes:
  * - Context tracks owned data separately for CLIPBOARD and PRIMARY.
- * - Pending paste requests are queued and matched via property atom + window.
+ * - Pending paste requests live in a growable open-addressed hash table
+ *   keyed by (requestor window, property). Each request gets its own
+ *   property so overlapping pastes into one window never collide, and
+ *   carries a deadline; clipboard_process_timeouts() fails the ones whose
+ *   owner never answers so their slots are reclaimed.
  * - UTF8_STRING targets are preferred; legacy TEXT falls back when required.
+ * - Colours copied with clipboard_set_color() are offered in several
+ *   formats (hex, CSS rgb()/hsl(), JSON, PNG swatch, application/x-color).
+ *   Each is generated the first time a requestor asks for it and cached
+ *   until ownership changes.
+ * - Every colour copy is also recorded in a most-recent-first history,
+ *   de-duplicated by RGB. History strings are packed into one arena that is
+ *   compacted in place when full, and the whole history stays within a byte
+ *   budget (oldest entries fall off). Owned selection text reuses one buffer
+ *   per selection, so repeated copies do not churn the heap.
+ * - Payloads larger than one X request use the ICCCM INCR protocol in both
+ *   directions. Chunks are moved one PropertyNotify at a time, so a large
+ *   transfer never blocks the event loop.
  */
 
 #include "clipboard.h"
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
+#include <limits.h>
+#include <time.h>
 #include <X11/Xatom.h>
 
-/* Maximum number of simultaneous paste requests */
-#define MAX_PENDING_REQUESTS 8
+/* Initial size of the pending request table (power of two) */
+#define INITIAL_REQUEST_SLOTS 16
+
+/* How long a paste (or an INCR transfer) may go without progress */
+#define REQUEST_TIMEOUT_MS 2000
+
+/* Largest chunk moved per PropertyNotify during an INCR transfer */
+#define INCR_CHUNK_MAX (256 * 1024)
+
+/* Default byte budget for the copy history (text + bookkeeping) */
+#define HISTORY_DEFAULT_BUDGET (16 * 1024)
+
+/* Edge length of the image/png swatch offered for colours */
+#define SWATCH_PNG_SIZE 32
 
 /* Property name for data transfer */
 #define CLIPBOARD_PROPERTY_ATOM_NAME "GENERIC_CLIPBOARD"
 
+/* Extra formats offered for a copied colour, generated on demand */
+typedef enum {
+	COLOR_TARGET_HEX, // text/x-color-hex: #RRGGBB
+	COLOR_TARGET_CSS_RGB, // text/css: rgb(r, g, b)
+	COLOR_TARGET_CSS_HSL, // text/x-css-hsl: hsl(h, s%, l%)
+	COLOR_TARGET_JSON, // application/json
+	COLOR_TARGET_PNG, // image/png swatch
+	COLOR_TARGET_XCOLOR, // application/x-color: 4 x CARD16 RGBA (GTK/Qt)
+	COLOR_TARGET_COUNT
+} ColorTarget;
+
+static const char *const color_target_names[COLOR_TARGET_COUNT] = {
+	"text/x-color-hex",
+	"text/css",
+	"text/x-css-hsl",
+	"application/json",
+	"image/png",
+	"application/x-color"
+};
+
 /* Data for one owned selection (CLIPBOARD or PRIMARY) */
 typedef struct {
-	char *text; // Owned text data (malloc'd)
-	Window owner_window; // Window that owns this selection
+	char *text; // Owned text data (malloc'd, reused across copies)
+	size_t text_cap; // Allocated size of text
+	Window owner_window; // Window that owns this selection (None if not owned)
+	int has_color; // 1 if set through clipboard_set_color()
+	RGB8 color;
+	unsigned char *cache[COLOR_TARGET_COUNT]; // Lazily generated payloads (malloc'd)
+	size_t cache_len[COLOR_TARGET_COUNT];
 } ClipboardData;
 
+/* One copied colour in the history. The text lives in the history arena. */
+typedef struct {
+	RGB8 color;
+	size_t text_offset; // Offset of the NUL-terminated text in the arena
+	size_t text_size; // Bytes used in the arena, including the NUL
+} HistoryEntry;
+
 /* Pending paste request */
 typedef struct {
 	Window window;
@@ -42,9 +105,26 @@ typedef struct {
 	void *user_data;
 	SelectionType type;
 	Atom property; // Property for data transfer
-	int active; // 1 if waiting for response
+	int active; // 1 if this table slot is in use
+	long long deadline; // Monotonic ms after which the request fails
+	int incr; // 1 while receiving INCR chunks
+	char *incr_buf; // Accumulated INCR payload (malloc'd)
+	size_t incr_len;
+	size_t incr_cap;
 } PendingRequest;
 
+/* Outgoing INCR transfer to one requestor */
+typedef struct {
+	Window requestor;
+	Atom property;
+	Atom target;
+	Atom type; // Property type written with each chunk
+	char *data; // Private copy of the payload (malloc'd)
+	size_t size;
+	size_t offset; // Bytes already sent
+	long long deadline; // Dropped if the requestor stalls past this
+} IncrTransfer;
+
 /* Clipboard context */
 struct ClipboardContext {
 	Display *dpy;
@@ -56,13 +136,35 @@ struct ClipboardContext {
 	Atom targets_atom; // TARGETS
 	Atom incr_atom; // INCR
 	Atom property_atom; // Property for transfers
+	Atom *extra_properties; // GENERIC_CLIPBOARD_<n> for overlapping requests
+	int extra_property_count;
+	Atom plain_atom; // text/plain
+	Atom plain_utf8_atom; // text/plain;charset=utf-8
+	Atom color_atoms[COLOR_TARGET_COUNT]; // Colour format targets
 
 	// Data we own
 	ClipboardData clipboard_data;
 	ClipboardData primary_data;
 
-	// Pending paste requests
-	PendingRequest requests[MAX_PENDING_REQUESTS];
+	// Pending paste requests (hash table, capacity is a power of two)
+	PendingRequest *requests;
+	size_t request_capacity;
+	size_t request_count;
+
+	// Outgoing INCR transfers
+	IncrTransfer *transfers;
+	int transfer_count;
+	int transfer_capacity;
+	size_t max_chunk; // Largest payload sent in a single property
+
+	// Copy history, most recent first
+	HistoryEntry *history;
+	size_t history_count;
+	size_t history_capacity;
+	char *arena; // Packed history strings
+	size_t arena_used; // High-water mark (includes holes left by removals)
+	size_t arena_live; // Bytes referenced by current entries
+	size_t history_budget; // Byte budget for text plus entries
 };
 
 /* Forward declarations */
@@ -71,7 +173,17 @@ static void handle_selection_notify(ClipboardContext *ctx, XSelectionEvent *sev)
 static void handle_selection_clear(ClipboardContext *ctx, XSelectionClearEvent *cev);
 static void send_selection_notify(Display *dpy, XSelectionRequestEvent *req, Atom property);
 static ClipboardData *get_data_for_selection(ClipboardContext *ctx, Atom selection);
+static void clear_data(ClipboardData *data);
+static void take_ownership(ClipboardContext *ctx, Window win, const char *text, const RGB8 *color, SelectionType type);
+static void history_add(ClipboardContext *ctx, const char *text, RGB8 color);
+static void history_compact(ClipboardContext *ctx);
 static PendingRequest *find_request(ClipboardContext *ctx, Window win, Atom property);
+static void handle_property_notify(ClipboardContext *ctx, XPropertyEvent *pev, int *handled);
+static void finish_request(ClipboardContext *ctx, PendingRequest *req, const char *text);
+static PendingRequest *insert_request(ClipboardContext *ctx, Window win, Atom property);
+static Atom get_request_property(ClipboardContext *ctx, Window win);
+static long long clipboard_now_ms(void);
+static void remove_incr_transfer(ClipboardContext *ctx, int index);
 
 /* ========== PUBLIC API IMPLEMENTATION ========== */
 
@@ -84,6 +196,13 @@ ClipboardContext *clipboard_create(Display *dpy) {
 		return NULL;
 	}
 	ctx->dpy = dpy;
+	ctx->requests = calloc(INITIAL_REQUEST_SLOTS, sizeof(PendingRequest));
+	if (!ctx->requests) {
+		free(ctx);
+		return NULL;
+	}
+	ctx->request_capacity = INITIAL_REQUEST_SLOTS;
+	ctx->history_budget = HISTORY_DEFAULT_BUDGET;
 
 	// Initialize atoms
 	ctx->clipboard_atom = XInternAtom(dpy, "CLIPBOARD", False);
@@ -92,6 +211,19 @@ ClipboardContext *clipboard_create(Display *dpy) {
 	ctx->targets_atom = XInternAtom(dpy, "TARGETS", False);
 	ctx->incr_atom = XInternAtom(dpy, "INCR", False);
 	ctx->property_atom = XInternAtom(dpy, CLIPBOARD_PROPERTY_ATOM_NAME, False);
+	ctx->plain_atom = XInternAtom(dpy, "text/plain", False);
+	ctx->plain_utf8_atom = XInternAtom(dpy, "text/plain;charset=utf-8", False);
+	for (int i = 0; i < COLOR_TARGET_COUNT; i++) {
+		ctx->color_atoms[i] = XInternAtom(dpy, color_target_names[i], False);
+	}
+
+	// Anything bigger than one request (in bytes, less header room) goes INCR
+	long max_request = XExtendedMaxRequestSize(dpy);
+	if (max_request == 0) {
+		max_request = XMaxRequestSize(dpy);
+	}
+	size_t max_bytes = (size_t)max_request * 4 - 100;
+	ctx->max_chunk = max_bytes < INCR_CHUNK_MAX ? max_bytes : INCR_CHUNK_MAX;
 
 	return ctx;
 }
@@ -101,14 +233,26 @@ void clipboard_destroy(ClipboardContext *ctx) {
 		return;
 	}
 	// Free owned data
+	clear_data(&ctx->clipboard_data);
+	clear_data(&ctx->primary_data);
 	free(ctx->clipboard_data.text);
 	free(ctx->primary_data.text);
+	free(ctx->history);
+	free(ctx->arena);
 	// Cancel pending requests
-	for (int i = 0; i < MAX_PENDING_REQUESTS; i++) {
+	for (size_t i = 0; i < ctx->request_capacity; i++) {
 		if (ctx->requests[i].active && ctx->requests[i].callback) {
 			ctx->requests[i].callback(NULL, ctx->requests[i].user_data);
 		}
+		free(ctx->requests[i].incr_buf);
 	}
+	free(ctx->requests);
+	free(ctx->extra_properties);
+	// Abandon outgoing transfers
+	for (int i = 0; i < ctx->transfer_count; i++) {
+		free(ctx->transfers[i].data);
+	}
+	free(ctx->transfers);
 	free(ctx);
 }
 
@@ -116,25 +260,74 @@ void clipboard_set_text(ClipboardContext *ctx, Window win, const char *text, Sel
 	if (!ctx) {
 		return;
 	}
-	Atom selection = (type == SELECTION_CLIPBOARD) ? ctx->clipboard_atom : XA_PRIMARY;
-	ClipboardData *data = get_data_for_selection(ctx, selection);
-	if (!data) {
+	take_ownership(ctx, win, text, NULL, type);
+}
+
+void clipboard_set_color(ClipboardContext *ctx, Window win, const char *text, RGB8 color, SelectionType type) {
+	if (!ctx) {
 		return;
 	}
-	// Free old text
-	free(data->text);
-	data->text = NULL;
-	data->owner_window = None;
-	// Set new text
-	if (text) {
-		data->text = strdup(text);
-		data->owner_window = win;
-		XSetSelectionOwner(ctx->dpy, selection, win, CurrentTime);
+	char hex[8];
+	if (!text) {
+		rgb8_to_hex(color, hex);
+		text = hex;
 	}
-	else {
-		// Clearing - give up ownership
-		XSetSelectionOwner(ctx->dpy, selection, None, CurrentTime);
+	take_ownership(ctx, win, text, &color, type);
+	// Record from the owned copy: text may point into the history arena,
+	// which history_add() is free to compact
+	ClipboardData *data = get_data_for_selection(ctx, (type == SELECTION_CLIPBOARD) ? ctx->clipboard_atom : XA_PRIMARY);
+	if (data && data->owner_window != None) {
+		history_add(ctx, data->text, color);
+	}
+}
+
+void clipboard_history_set_budget(ClipboardContext *ctx, size_t bytes) {
+	if (!ctx) {
+		return;
+	}
+	ctx->history_budget = bytes;
+	// Shrink immediately by dropping the oldest entries
+	while (ctx->history_count > 0 && ctx->arena_live + ctx->history_count * sizeof(HistoryEntry) > bytes) {
+		ctx->history_count--;
+		ctx->arena_live -= ctx->history[ctx->history_count].text_size;
 	}
+	// Resize the arena to the new budget (it is allocated lazily otherwise)
+	if (ctx->arena) {
+		history_compact(ctx);
+		char *resized = bytes ? realloc(ctx->arena, bytes) : NULL;
+		if (!resized) {
+			free(ctx->arena);
+			ctx->history_count = 0;
+			ctx->arena_used = 0;
+			ctx->arena_live = 0;
+		}
+		ctx->arena = resized;
+	}
+}
+
+size_t clipboard_history_count(const ClipboardContext *ctx) {
+	return ctx ? ctx->history_count : 0;
+}
+
+const char *clipboard_history_get(const ClipboardContext *ctx, size_t index, RGB8 *color) {
+	if (!ctx || index >= ctx->history_count) {
+		return NULL;
+	}
+	const HistoryEntry *entry = &ctx->history[index];
+	if (color) {
+		*color = entry->color;
+	}
+	return ctx->arena + entry->text_offset;
+}
+
+int clipboard_history_reown(ClipboardContext *ctx, Window win, size_t index, SelectionType type) {
+	RGB8 color;
+	const char *text = clipboard_history_get(ctx, index, &color);
+	if (!text) {
+		return -1;
+	}
+	clipboard_set_color(ctx, win, text, color, type);
+	return 0;
 }
 
 void clipboard_request_text(ClipboardContext *ctx, Window win, ClipboardCallback callback, void *user_data, SelectionType type) {
@@ -152,36 +345,58 @@ void clipboard_request_text(ClipboardContext *ctx, Window win, ClipboardCallback
 	}
 	// If we own it, return our own data immediately
 	ClipboardData *data = get_data_for_selection(ctx, selection);
-	if (data && owner == data->owner_window && data->text) {
+	if (data && data->owner_window != None && owner == data->owner_window) {
 		callback(data->text, user_data);
 		return;
 	}
-	// Find free request slot
-	PendingRequest *req = NULL;
-	for (int i = 0; i < MAX_PENDING_REQUESTS; i++) {
-		if (!ctx->requests[i].active) {
-			req = &ctx->requests[i];
-			break;
-		}
-	}
+	// Claim a property no other pending request on this window is using
+	Atom property = get_request_property(ctx, win);
+	PendingRequest *req = property != None ? insert_request(ctx, win, property) : NULL;
 	if (!req) {
-		fprintf(stderr, "clipboard: too many pending requests\n");
+		fprintf(stderr, "clipboard: out of memory queueing paste request\n");
 		callback(NULL, user_data);
 		return;
 	}
 	// Setup request
-	req->window = win;
 	req->callback = callback;
 	req->user_data = user_data;
 	req->type = type;
-	req->property = ctx->property_atom;
-	req->active = 1;
+	req->deadline = clipboard_now_ms() + REQUEST_TIMEOUT_MS;
 
 	// Request conversion to UTF8
 	XConvertSelection(ctx->dpy, selection, ctx->utf8_atom, req->property, win, CurrentTime);
 	XFlush(ctx->dpy);
 }
 
+void clipboard_process_timeouts(ClipboardContext *ctx) {
+	if (!ctx || (ctx->request_count == 0 && ctx->transfer_count == 0)) {
+		return;
+	}
+	long long now = clipboard_now_ms();
+	// Fail one expired request at a time: the callback may queue new
+	// requests and grow the table, so rescan after each.
+	for (;;) {
+		PendingRequest *expired = NULL;
+		for (size_t i = 0; i < ctx->request_capacity && ctx->request_count > 0; i++) {
+			if (ctx->requests[i].active && ctx->requests[i].deadline <= now) {
+				expired = &ctx->requests[i];
+				break;
+			}
+		}
+		if (!expired) {
+			break;
+		}
+		fprintf(stderr, "clipboard: paste request timed out\n");
+		finish_request(ctx, expired, NULL);
+	}
+	// Drop outgoing INCR transfers whose requestor went away
+	for (int i = ctx->transfer_count - 1; i >= 0; i--) {
+		if (ctx->transfers[i].deadline <= now) {
+			remove_incr_transfer(ctx, i);
+		}
+	}
+}
+
 int clipboard_handle_event(ClipboardContext *ctx, XEvent *ev) {
 	if (!ctx || !ev) {
 		return 0;
@@ -198,6 +413,13 @@ int clipboard_handle_event(ClipboardContext *ctx, XEvent *ev) {
 		case SelectionClear:
 			handle_selection_clear(ctx, &ev->xselectionclear);
 			return 1;
+
+		case PropertyNotify: {
+			// Only consumed when it drives one of our INCR transfers
+			int handled = 0;
+			handle_property_notify(ctx, &ev->xproperty, &handled);
+			return handled;
+		}
 	}
 	return 0;
 }
@@ -214,15 +436,250 @@ static ClipboardData *get_data_for_selection(ClipboardContext *ctx, Atom selecti
 	return NULL;
 }
 
+/* Forget ownership and generated formats; the text buffer is kept for reuse */
+static void clear_data(ClipboardData *data) {
+	data->owner_window = None;
+	data->has_color = 0;
+	for (int i = 0; i < COLOR_TARGET_COUNT; i++) {
+		free(data->cache[i]);
+		data->cache[i] = NULL;
+		data->cache_len[i] = 0;
+	}
+}
+
+static void take_ownership(ClipboardContext *ctx, Window win, const char *text, const RGB8 *color, SelectionType type) {
+	Atom selection = (type == SELECTION_CLIPBOARD) ? ctx->clipboard_atom : XA_PRIMARY;
+	ClipboardData *data = get_data_for_selection(ctx, selection);
+	if (!data) {
+		return;
+	}
+	// Drop old text and any formats generated from it
+	clear_data(data);
+	// Set new text
+	if (text) {
+		size_t size = strlen(text) + 1;
+		if (size > data->text_cap) {
+			char *grown = realloc(data->text, size);
+			if (!grown) {
+				XSetSelectionOwner(ctx->dpy, selection, None, CurrentTime);
+				return;
+			}
+			data->text = grown;
+			data->text_cap = size;
+		}
+		memcpy(data->text, text, size);
+		data->owner_window = win;
+		if (color) {
+			data->has_color = 1;
+			data->color = *color;
+		}
+		XSetSelectionOwner(ctx->dpy, selection, win, CurrentTime);
+	}
+	else {
+		// Clearing - give up ownership
+		XSetSelectionOwner(ctx->dpy, selection, None, CurrentTime);
+	}
+}
+
+/* ========== COPY HISTORY ========== */
+
+static void history_remove(ClipboardContext *ctx, size_t index) {
+	ctx->arena_live -= ctx->history[index].text_size;
+	memmove(&ctx->history[index], &ctx->history[index + 1], (ctx->history_count - index - 1) * sizeof(HistoryEntry));
+	ctx->history_count--;
+}
+
+/* Slide live strings to the front of the arena, closing the holes left
+ * by removed entries. Entries keep their relative order in the arena. */
+static void history_compact(ClipboardContext *ctx) {
+	size_t write = 0;
+	while (write < ctx->arena_live) {
+		// Lowest-offset entry at or after the write position
+		HistoryEntry *next = NULL;
+		for (size_t i = 0; i < ctx->history_count; i++) {
+			HistoryEntry *e = &ctx->history[i];
+			if (e->text_offset >= write && (!next || e->text_offset < next->text_offset)) {
+				next = e;
+			}
+		}
+		if (!next) {
+			break;
+		}
+		memmove(ctx->arena + write, ctx->arena + next->text_offset, next->text_size);
+		next->text_offset = write;
+		write += next->text_size;
+	}
+	ctx->arena_used = write;
+}
+
+static void history_add(ClipboardContext *ctx, const char *text, RGB8 color) {
+	size_t size = strlen(text) + 1;
+	if (size + sizeof(HistoryEntry) > ctx->history_budget) {
+		return; // Would not fit even in an empty history
+	}
+	// De-duplicate by RGB: an identical copy just moves to the front
+	for (size_t i = 0; i < ctx->history_count; i++) {
+		HistoryEntry *e = &ctx->history[i];
+		if (e->color.r == color.r && e->color.g == color.g && e->color.b == color.b) {
+			if (e->text_size == size && memcmp(ctx->arena + e->text_offset, text, size) == 0) {
+				HistoryEntry keep = *e;
+				memmove(&ctx->history[1], &ctx->history[0], i * sizeof(HistoryEntry));
+				ctx->history[0] = keep;
+				return;
+			}
+			history_remove(ctx, i);
+			break;
+		}
+	}
+	// Evict the oldest entries until the new one fits the budget
+	while (ctx->history_count > 0 && ctx->arena_live + size + (ctx->history_count + 1) * sizeof(HistoryEntry) > ctx->history_budget) {
+		history_remove(ctx, ctx->history_count - 1);
+	}
+	if (ctx->history_count == ctx->history_capacity) {
+		size_t cap = ctx->history_capacity ? ctx->history_capacity * 2 : 32;
+		HistoryEntry *grown = realloc(ctx->history, cap * sizeof(HistoryEntry));
+		if (!grown) {
+			return;
+		}
+		ctx->history = grown;
+		ctx->history_capacity = cap;
+	}
+	// The arena is sized to the budget once; reclaim holes before giving up
+	if (!ctx->arena || ctx->arena_used + size > ctx->history_budget) {
+		if (!ctx->arena) {
+			ctx->arena = malloc(ctx->history_budget);
+			if (!ctx->arena) {
+				return;
+			}
+		}
+		else {
+			history_compact(ctx);
+		}
+	}
+	memcpy(ctx->arena + ctx->arena_used, text, size);
+	memmove(&ctx->history[1], &ctx->history[0], ctx->history_count * sizeof(HistoryEntry));
+	ctx->history[0] = (HistoryEntry) {
+		.color = color,
+		.text_offset = ctx->arena_used,
+		.text_size = size
+	};
+	ctx->history_count++;
+	ctx->arena_used += size;
+	ctx->arena_live += size;
+}
+
+static long long clipboard_now_ms(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static size_t request_hash(Window win, Atom property) {
+	unsigned long long h = (unsigned long long)win * 0x9E3779B97F4A7C15ull;
+	h ^= (unsigned long long)property + 0x632BE59BD9B4E019ull + (h << 6) + (h >> 2);
+	return (size_t)(h ^ (h >> 29));
+}
+
 static PendingRequest *find_request(ClipboardContext *ctx, Window win, Atom property) {
-	for (int i = 0; i < MAX_PENDING_REQUESTS; i++) {
-		if (ctx->requests[i].active &&
-		    ctx->requests[i].window == win &&
-		    ctx->requests[i].property == property) {
-			return &ctx->requests[i];
+	size_t mask = ctx->request_capacity - 1;
+	for (size_t i = request_hash(win, property) & mask;; i = (i + 1) & mask) {
+		PendingRequest *slot = &ctx->requests[i];
+		if (!slot->active) {
+			return NULL;
+		}
+		if (slot->window == win && slot->property == property) {
+			return slot;
+		}
+	}
+}
+
+/* Double the table and reinsert every live request */
+static int grow_requests(ClipboardContext *ctx) {
+	size_t cap = ctx->request_capacity * 2;
+	PendingRequest *slots = calloc(cap, sizeof(PendingRequest));
+	if (!slots) {
+		return -1;
+	}
+	for (size_t i = 0; i < ctx->request_capacity; i++) {
+		PendingRequest *old = &ctx->requests[i];
+		if (!old->active) {
+			continue;
+		}
+		size_t j = request_hash(old->window, old->property) & (cap - 1);
+		while (slots[j].active) {
+			j = (j + 1) & (cap - 1);
+		}
+		slots[j] = *old;
+	}
+	free(ctx->requests);
+	ctx->requests = slots;
+	ctx->request_capacity = cap;
+	return 0;
+}
+
+static PendingRequest *insert_request(ClipboardContext *ctx, Window win, Atom property) {
+	// Keep the load factor under 3/4 so probe chains stay short
+	if ((ctx->request_count + 1) * 4 > ctx->request_capacity * 3 && grow_requests(ctx) != 0) {
+		return NULL;
+	}
+	size_t mask = ctx->request_capacity - 1;
+	size_t i = request_hash(win, property) & mask;
+	while (ctx->requests[i].active) {
+		i = (i + 1) & mask;
+	}
+	PendingRequest *req = &ctx->requests[i];
+	memset(req, 0, sizeof(*req));
+	req->window = win;
+	req->property = property;
+	req->active = 1;
+	ctx->request_count++;
+	return req;
+}
+
+/* Backward-shift deletion: pull later members of the probe chain into the
+ * hole so lookups never need tombstones. */
+static void remove_request(ClipboardContext *ctx, PendingRequest *req) {
+	size_t mask = ctx->request_capacity - 1;
+	size_t hole = (size_t)(req - ctx->requests);
+	size_t i = hole;
+	for (;;) {
+		i = (i + 1) & mask;
+		PendingRequest *slot = &ctx->requests[i];
+		if (!slot->active) {
+			break;
+		}
+		size_t home = request_hash(slot->window, slot->property) & mask;
+		// Move the entry if its home lies cyclically outside (hole, i]
+		if (((i - home) & mask) >= ((i - hole) & mask)) {
+			ctx->requests[hole] = *slot;
+			hole = i;
+		}
+	}
+	memset(&ctx->requests[hole], 0, sizeof(PendingRequest));
+	ctx->request_count--;
+}
+
+/* Pick the first transfer property not already in flight on this window */
+static Atom get_request_property(ClipboardContext *ctx, Window win) {
+	if (!find_request(ctx, win, ctx->property_atom)) {
+		return ctx->property_atom;
+	}
+	for (int i = 0;; i++) {
+		if (i == ctx->extra_property_count) {
+			Atom *grown = realloc(ctx->extra_properties, (size_t)(i + 1) * sizeof(Atom));
+			if (!grown) {
+				return None;
+			}
+			char name[64];
+			snprintf(name, sizeof(name), "%s_%d", CLIPBOARD_PROPERTY_ATOM_NAME, i + 1);
+			grown[i] = XInternAtom(ctx->dpy, name, False);
+			ctx->extra_properties = grown;
+			ctx->extra_property_count = i + 1;
+		}
+		if (!find_request(ctx, win, ctx->extra_properties[i])) {
+			return ctx->extra_properties[i];
 		}
 	}
-	return NULL;
 }
 
 static void send_selection_notify(Display *dpy, XSelectionRequestEvent *req, Atom property) {
@@ -240,32 +697,364 @@ static void send_selection_notify(Display *dpy, XSelectionRequestEvent *req, Ato
 	XFlush(dpy);
 }
 
+/* Set by trap_x_error while a foreign window is being touched */
+static int x_error_trapped = 0;
+
+static int trap_x_error(Display *dpy, XErrorEvent *ev) {
+	(void)dpy;
+	(void)ev;
+	x_error_trapped = 1;
+	return 0;
+}
+
+/* Add PropertyChangeMask to one of our own windows without disturbing the
+ * events already selected on it. Only for our windows: the query is a
+ * round trip, and on a vanished foreign window it would be a fatal
+ * BadWindow. */
+static void watch_property_changes(Display *dpy, Window win) {
+	XWindowAttributes attrs;
+	if (XGetWindowAttributes(dpy, win, &attrs) && !(attrs.your_event_mask & PropertyChangeMask)) {
+		XSelectInput(dpy, win, attrs.your_event_mask | PropertyChangeMask);
+	}
+}
+
+/* Drop an outgoing transfer. Once no transfer is left for its requestor,
+ * stop selecting PropertyNotify on that foreign window (trapped, since it
+ * may already be gone). */
+static void remove_incr_transfer(ClipboardContext *ctx, int index) {
+	Window requestor = ctx->transfers[index].requestor;
+	free(ctx->transfers[index].data);
+	ctx->transfers[index] = ctx->transfers[--ctx->transfer_count];
+	for (int i = 0; i < ctx->transfer_count; i++) {
+		if (ctx->transfers[i].requestor == requestor) {
+			return;
+		}
+	}
+	x_error_trapped = 0;
+	int (*old_handler)(Display *, XErrorEvent *) = XSetErrorHandler(trap_x_error);
+	XSelectInput(ctx->dpy, requestor, NoEventMask);
+	XSync(ctx->dpy, False);
+	XSetErrorHandler(old_handler);
+	x_error_trapped = 0;
+}
+
+/* Begin an INCR send: announce the size, then wait for the requestor to
+ * delete the property before each chunk. Returns 0, -1 when out of memory
+ * or -2 when the requestor window no longer exists. */
+static int start_incr_transfer(ClipboardContext *ctx, XSelectionRequestEvent *req, Atom type, const unsigned char *payload, size_t size) {
+	// A new request on the same property supersedes an unfinished one
+	for (int i = 0; i < ctx->transfer_count; i++) {
+		if (ctx->transfers[i].requestor == req->requestor && ctx->transfers[i].property == req->property) {
+			remove_incr_transfer(ctx, i);
+			break;
+		}
+	}
+	if (ctx->transfer_count == ctx->transfer_capacity) {
+		int cap = ctx->transfer_capacity ? ctx->transfer_capacity * 2 : 4;
+		IncrTransfer *grown = realloc(ctx->transfers, (size_t)cap * sizeof(IncrTransfer));
+		if (!grown) {
+			return -1;
+		}
+		ctx->transfers = grown;
+		ctx->transfer_capacity = cap;
+	}
+	char *copy = malloc(size);
+	if (!copy) {
+		return -1;
+	}
+	memcpy(copy, payload, size);
+	IncrTransfer *t = &ctx->transfers[ctx->transfer_count++];
+	t->requestor = req->requestor;
+	t->property = req->property;
+	t->target = req->target;
+	t->type = type;
+	t->data = copy;
+	t->size = size;
+	t->offset = 0;
+	t->deadline = clipboard_now_ms() + REQUEST_TIMEOUT_MS;
+
+	// The requestor is a foreign window we select nothing else on, so the
+	// mask is set outright. It may already be gone: trap the BadWindow
+	// instead of letting the default handler exit.
+	long size_hint = (long)size;
+	x_error_trapped = 0;
+	int (*old_handler)(Display *, XErrorEvent *) = XSetErrorHandler(trap_x_error);
+	XSelectInput(ctx->dpy, req->requestor, PropertyChangeMask);
+	XChangeProperty(ctx->dpy, req->requestor, req->property, ctx->incr_atom, 32, PropModeReplace, (unsigned char *)&size_hint, 1);
+	XSync(ctx->dpy, False);
+	XSetErrorHandler(old_handler);
+	if (x_error_trapped) {
+		remove_incr_transfer(ctx, ctx->transfer_count - 1);
+		return -2;
+	}
+	return 0;
+}
+
+/* ========== COLOUR FORMAT GENERATION ========== */
+
+static unsigned char *dup_string(const char *str, size_t *len_out) {
+	size_t len = strlen(str);
+	unsigned char *out = malloc(len + 1);
+	if (out) {
+		memcpy(out, str, len + 1);
+		*len_out = len;
+	}
+	return out;
+}
+
+static uint32_t png_crc32(uint32_t crc, const unsigned char *buf, size_t len) {
+	crc = ~crc;
+	for (size_t i = 0; i < len; i++) {
+		crc ^= buf[i];
+		for (int k = 0; k < 8; k++) {
+			crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+		}
+	}
+	return ~crc;
+}
+
+static void put_be32(unsigned char *p, uint32_t v) {
+	p[0] = (unsigned char)(v >> 24);
+	p[1] = (unsigned char)(v >> 16);
+	p[2] = (unsigned char)(v >> 8);
+	p[3] = (unsigned char)v;
+}
+
+/* Append a PNG chunk (length, type, data, CRC) at p; returns bytes written */
+static size_t png_put_chunk(unsigned char *p, const char type[4], const unsigned char *body, size_t len) {
+	put_be32(p, (uint32_t)len);
+	memcpy(p + 4, type, 4);
+	if (len) {
+		memcpy(p + 8, body, len);
+	}
+	put_be32(p + 8 + len, png_crc32(0, p + 4, len + 4));
+	return len + 12;
+}
+
+/* Solid-colour RGB swatch as a PNG. The zlib stream uses stored (type 0)
+ * deflate blocks, so no compressor is needed. */
+static unsigned char *encode_png_swatch(RGB8 color, size_t *len_out) {
+	enum { W = SWATCH_PNG_SIZE, H = SWATCH_PNG_SIZE, ROW = 1 + W * 3, RAW = ROW * H };
+	enum { BLOCKS = (RAW + 65534) / 65535, ZLEN = 2 + BLOCKS * 5 + RAW + 4 };
+	unsigned char raw[RAW];
+	for (int y = 0; y < H; y++) {
+		unsigned char *row = raw + y * ROW;
+		row[0] = 0; // Filter: none
+		for (int x = 0; x < W; x++) {
+			row[1 + x * 3] = color.r;
+			row[2 + x * 3] = color.g;
+			row[3 + x * 3] = color.b;
+		}
+	}
+	unsigned char *z = malloc(ZLEN);
+	unsigned char *png = malloc(8 + 25 + 12 + ZLEN + 12);
+	if (!z || !png) {
+		free(z);
+		free(png);
+		return NULL;
+	}
+	// zlib stream: header, stored blocks, Adler-32
+	size_t zp = 0;
+	z[zp++] = 0x78;
+	z[zp++] = 0x01;
+	uint32_t a = 1, b = 0;
+	for (size_t off = 0; off < RAW;) {
+		size_t n = RAW - off < 65535 ? RAW - off : 65535;
+		z[zp++] = (off + n == RAW) ? 1 : 0;
+		z[zp++] = (unsigned char)n;
+		z[zp++] = (unsigned char)(n >> 8);
+		z[zp++] = (unsigned char)~n;
+		z[zp++] = (unsigned char)(~n >> 8);
+		memcpy(z + zp, raw + off, n);
+		for (size_t i = 0; i < n; i++) {
+			a = (a + raw[off + i]) % 65521u;
+			b = (b + a) % 65521u;
+		}
+		zp += n;
+		off += n;
+	}
+	put_be32(z + zp, (b << 16) | a);
+	zp += 4;
+
+	static const unsigned char signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+	unsigned char ihdr[13];
+	put_be32(ihdr, W);
+	put_be32(ihdr + 4, H);
+	ihdr[8] = 8; // Bit depth
+	ihdr[9] = 2; // Colour type: truecolour
+	ihdr[10] = ihdr[11] = ihdr[12] = 0;
+
+	size_t len = 0;
+	memcpy(png, signature, 8);
+	len += 8;
+	len += png_put_chunk(png + len, "IHDR", ihdr, sizeof(ihdr));
+	len += png_put_chunk(png + len, "IDAT", z, zp);
+	len += png_put_chunk(png + len, "IEND", NULL, 0);
+	free(z);
+	*len_out = len;
+	return png;
+}
+
+static unsigned char *generate_color_target(RGB8 c, ColorTarget target, size_t *len_out) {
+	char buf[160];
+	char hex[8];
+	HSL hsl;
+	switch (target) {
+		case COLOR_TARGET_HEX:
+			rgb8_to_hex(c, hex);
+			return dup_string(hex, len_out);
+		case COLOR_TARGET_CSS_RGB:
+			snprintf(buf, sizeof(buf), "rgb(%d, %d, %d)", c.r, c.g, c.b);
+			return dup_string(buf, len_out);
+		case COLOR_TARGET_CSS_HSL:
+			hsl = rgb_to_hsl(rgb8_to_rgbf(c));
+			snprintf(buf, sizeof(buf), "hsl(%.0f, %.0f%%, %.0f%%)", hsl.H, hsl.S * 100.0, hsl.L * 100.0);
+			return dup_string(buf, len_out);
+		case COLOR_TARGET_JSON:
+			rgb8_to_hex(c, hex);
+			hsl = rgb_to_hsl(rgb8_to_rgbf(c));
+			snprintf(buf, sizeof(buf), "{\"hex\": \"%s\", \"rgb\": [%d, %d, %d], \"hsl\": [%.1f, %.1f, %.1f]}",
+			         hex, c.r, c.g, c.b, hsl.H, hsl.S * 100.0, hsl.L * 100.0);
+			return dup_string(buf, len_out);
+		case COLOR_TARGET_PNG:
+			return encode_png_swatch(c, len_out);
+		case COLOR_TARGET_XCOLOR: {
+			// Native-endian CARD16 RGBA, as XChangeProperty expects for format 16
+			unsigned short *rgba = malloc(4 * sizeof(unsigned short));
+			if (!rgba) {
+				return NULL;
+			}
+			rgba[0] = (unsigned short)(c.r * 257);
+			rgba[1] = (unsigned short)(c.g * 257);
+			rgba[2] = (unsigned short)(c.b * 257);
+			rgba[3] = 0xFFFF;
+			*len_out = 4;
+			return (unsigned char *)rgba;
+		}
+		default:
+			return NULL;
+	}
+}
+
+/* Resolve a requested target to the bytes to send. Colour formats are
+ * built on first request and cached on the selection. Returns 0 and fills
+ * the outputs if the target is supported. nitems is in units of format. */
+static int get_target_payload(ClipboardContext *ctx, ClipboardData *data, Atom target, const unsigned char **payload, size_t *nitems, Atom *type, int *format) {
+	if (target == ctx->utf8_atom || target == XA_STRING || target == ctx->text_atom || target == ctx->plain_atom || target == ctx->plain_utf8_atom) {
+		*payload = (const unsigned char *)data->text;
+		*nitems = strlen(data->text);
+		*type = (target == ctx->text_atom) ? ctx->utf8_atom : target;
+		*format = 8;
+		return 0;
+	}
+	if (!data->has_color) {
+		return -1;
+	}
+	for (int i = 0; i < COLOR_TARGET_COUNT; i++) {
+		if (target != ctx->color_atoms[i]) {
+			continue;
+		}
+		if (!data->cache[i]) {
+			data->cache[i] = generate_color_target(data->color, (ColorTarget)i, &data->cache_len[i]);
+			if (!data->cache[i]) {
+				return -1;
+			}
+		}
+		*payload = data->cache[i];
+		*nitems = data->cache_len[i];
+		*type = target;
+		*format = (i == COLOR_TARGET_XCOLOR) ? 16 : 8;
+		return 0;
+	}
+	return -1;
+}
+
 static void handle_selection_request(ClipboardContext *ctx, XSelectionRequestEvent *req) {
 	ClipboardData *data = get_data_for_selection(ctx, req->selection);
 	// Check if we own this selection
-	if (!data || !data->text || req->requestor == data->owner_window) {
+	if (!data || data->owner_window == None || req->requestor == data->owner_window) {
 		send_selection_notify(ctx->dpy, req, None);
 		return;
 	}
+	// Obsolete clients may pass None; ICCCM says use the target atom instead
+	if (req->property == None) {
+		req->property = req->target;
+	}
 	// Handle TARGETS request
 	if (req->target == ctx->targets_atom) {
-		Atom targets[3] = {
-			ctx->targets_atom,
-			ctx->utf8_atom,
-			XA_STRING
-		};
-		XChangeProperty(ctx->dpy, req->requestor, req->property, XA_ATOM, 32, PropModeReplace, (unsigned char *)targets, 3);
+		Atom targets[6 + COLOR_TARGET_COUNT];
+		int n = 0;
+		targets[n++] = ctx->targets_atom;
+		targets[n++] = ctx->utf8_atom;
+		targets[n++] = ctx->plain_utf8_atom;
+		targets[n++] = XA_STRING;
+		targets[n++] = ctx->text_atom;
+		targets[n++] = ctx->plain_atom;
+		if (data->has_color) {
+			for (int i = 0; i < COLOR_TARGET_COUNT; i++) {
+				targets[n++] = ctx->color_atoms[i];
+			}
+		}
+		XChangeProperty(ctx->dpy, req->requestor, req->property, XA_ATOM, 32, PropModeReplace, (unsigned char *)targets, n);
 		send_selection_notify(ctx->dpy, req, req->property);
 		return;
 	}
-	// Handle UTF8_STRING or STRING request
-	if (req->target == ctx->utf8_atom || req->target == XA_STRING) {
-		XChangeProperty(ctx->dpy, req->requestor, req->property, req->target, 8, PropModeReplace, (unsigned char *)data->text, (int)strlen(data->text));
-		send_selection_notify(ctx->dpy, req, req->property);
+	const unsigned char *payload;
+	size_t nitems;
+	Atom type;
+	int format;
+	if (get_target_payload(ctx, data, req->target, &payload, &nitems, &type, &format) != 0) {
+		// Unsupported target
+		send_selection_notify(ctx->dpy, req, None);
 		return;
 	}
-	// Unsupported target
-	send_selection_notify(ctx->dpy, req, None);
+	if (format == 8 && nitems > ctx->max_chunk) {
+		// Too big for one request - hand it over in INCR chunks
+		int rc = start_incr_transfer(ctx, req, type, payload, nitems);
+		if (rc == -2) {
+			return; // Requestor went away; nobody is left to notify
+		}
+		if (rc != 0) {
+			fprintf(stderr, "clipboard: out of memory starting INCR transfer\n");
+			send_selection_notify(ctx->dpy, req, None);
+			return;
+		}
+	}
+	else {
+		XChangeProperty(ctx->dpy, req->requestor, req->property, type, format, PropModeReplace, payload, (int)nitems);
+	}
+	send_selection_notify(ctx->dpy, req, req->property);
+}
+
+/* Deliver the result of a paste request and release its slot. The slot is
+ * freed before the callback runs, so the callback may queue a new paste. */
+static void finish_request(ClipboardContext *ctx, PendingRequest *req, const char *text) {
+	ClipboardCallback callback = req->callback;
+	void *user_data = req->user_data;
+	char *incr_buf = req->incr_buf; // text may point into this
+	remove_request(ctx, req);
+	callback(text, user_data);
+	free(incr_buf);
+}
+
+/* Append one received INCR chunk, growing the buffer geometrically */
+static int append_incr_chunk(PendingRequest *req, const unsigned char *chunk, size_t len) {
+	if (req->incr_len + len + 1 > req->incr_cap) {
+		size_t cap = req->incr_cap ? req->incr_cap : 4096;
+		while (cap < req->incr_len + len + 1) {
+			cap *= 2;
+		}
+		char *grown = realloc(req->incr_buf, cap);
+		if (!grown) {
+			return -1;
+		}
+		req->incr_buf = grown;
+		req->incr_cap = cap;
+	}
+	memcpy(req->incr_buf + req->incr_len, chunk, len);
+	req->incr_len += len;
+	req->incr_buf[req->incr_len] = '\0';
+	return 0;
 }
 
 static void handle_selection_notify(ClipboardContext *ctx, XSelectionEvent *sev) {
@@ -276,8 +1065,7 @@ static void handle_selection_notify(ClipboardContext *ctx, XSelectionEvent *sev)
 	}
 	// Check if request was denied
 	if (sev->property == None) {
-		req->callback(NULL, req->user_data);
-		req->active = 0;
+		finish_request(ctx, req, NULL);
 		return;
 	}
 	// Read the property
@@ -287,49 +1075,123 @@ static void handle_selection_notify(ClipboardContext *ctx, XSelectionEvent *sev)
 	unsigned char *prop_data = NULL;
 	// First call to get size and type
 	if (XGetWindowProperty(ctx->dpy, sev->requestor, sev->property, 0, 0, False, AnyPropertyType, &actual_type, &actual_format, &nitems, &bytes_after, &prop_data) != Success) {
-		req->callback(NULL, req->user_data);
-		req->active = 0;
+		finish_request(ctx, req, NULL);
 		return;
 	}
 	if (prop_data) {
 		XFree(prop_data);
 		prop_data = NULL;
 	}
-	// Check for INCR (not supported)
+	// Large payload: the owner sends it in chunks. Watch for new values,
+	// then delete the INCR property to ask for the first chunk.
 	if (actual_type == ctx->incr_atom) {
-		fprintf(stderr, "clipboard: INCR protocol not supported (data too large)\n");
+		req->incr = 1;
+		req->incr_len = 0;
+		req->deadline = clipboard_now_ms() + REQUEST_TIMEOUT_MS;
+		watch_property_changes(ctx->dpy, sev->requestor);
 		XDeleteProperty(ctx->dpy, sev->requestor, sev->property);
-		req->callback(NULL, req->user_data);
-		req->active = 0;
+		XFlush(ctx->dpy);
 		return;
 	}
 	// Read the actual data
-	if (XGetWindowProperty(ctx->dpy, sev->requestor, sev->property, 0, (long)bytes_after, False, AnyPropertyType, &actual_type, &actual_format, &nitems, &bytes_after, &prop_data) != Success) {
-		req->callback(NULL, req->user_data);
-		req->active = 0;
+	if (XGetWindowProperty(ctx->dpy, sev->requestor, sev->property, 0, (long)(bytes_after + 3) / 4, False, AnyPropertyType, &actual_type, &actual_format, &nitems, &bytes_after, &prop_data) != Success) {
+		finish_request(ctx, req, NULL);
 		return;
 	}
 	// Verify we got text
 	if (actual_type == ctx->utf8_atom || actual_type == XA_STRING) {
-		req->callback((const char *)prop_data, req->user_data);
+		finish_request(ctx, req, (const char *)prop_data);
 	}
 	else {
-		req->callback(NULL, req->user_data);
+		finish_request(ctx, req, NULL);
 	}
 	// Cleanup
 	if (prop_data) {
 		XFree(prop_data);
 	}
 	XDeleteProperty(ctx->dpy, sev->requestor, sev->property);
-	req->active = 0;
+}
+
+/* Receiving side of INCR: each new property value is one chunk, and a
+ * zero-length chunk ends the transfer. */
+static void receive_incr_chunk(ClipboardContext *ctx, PendingRequest *req, XPropertyEvent *pev) {
+	Atom actual_type;
+	int actual_format;
+	unsigned long nitems, bytes_after;
+	unsigned char *prop_data = NULL;
+	if (XGetWindowProperty(ctx->dpy, pev->window, pev->atom, 0, LONG_MAX / 4, True, AnyPropertyType, &actual_type, &actual_format, &nitems, &bytes_after, &prop_data) != Success) {
+		finish_request(ctx, req, NULL);
+		return;
+	}
+	size_t len = nitems * (size_t)(actual_format / 8);
+	if (len == 0) {
+		// End of transfer
+		if (prop_data) {
+			XFree(prop_data);
+		}
+		if (actual_type == ctx->utf8_atom || actual_type == XA_STRING) {
+			finish_request(ctx, req, req->incr_buf ? req->incr_buf : "");
+		}
+		else {
+			finish_request(ctx, req, NULL);
+		}
+		return;
+	}
+	if (append_incr_chunk(req, prop_data, len) != 0) {
+		fprintf(stderr, "clipboard: out of memory receiving INCR data\n");
+		XFree(prop_data);
+		finish_request(ctx, req, NULL);
+		return;
+	}
+	XFree(prop_data);
+	req->deadline = clipboard_now_ms() + REQUEST_TIMEOUT_MS;
+}
+
+/* Sending side of INCR: the requestor deleted the property, so write the
+ * next chunk (or the terminating empty value). The requestor may have been
+ * destroyed since, so the write is trapped like in start_incr_transfer()
+ * and a failed one drops the transfer. */
+static void send_incr_chunk(ClipboardContext *ctx, int index) {
+	IncrTransfer *t = &ctx->transfers[index];
+	size_t remaining = t->size - t->offset;
+	size_t len = remaining < ctx->max_chunk ? remaining : ctx->max_chunk;
+	x_error_trapped = 0;
+	int (*old_handler)(Display *, XErrorEvent *) = XSetErrorHandler(trap_x_error);
+	XChangeProperty(ctx->dpy, t->requestor, t->property, t->type, 8, PropModeReplace, (unsigned char *)t->data + t->offset, (int)len);
+	XSync(ctx->dpy, False);
+	XSetErrorHandler(old_handler);
+	if (x_error_trapped || len == 0) {
+		remove_incr_transfer(ctx, index);
+		return;
+	}
+	t->offset += len;
+	t->deadline = clipboard_now_ms() + REQUEST_TIMEOUT_MS;
+}
+
+static void handle_property_notify(ClipboardContext *ctx, XPropertyEvent *pev, int *handled) {
+	if (pev->state == PropertyNewValue) {
+		PendingRequest *req = find_request(ctx, pev->window, pev->atom);
+		if (req && req->incr) {
+			receive_incr_chunk(ctx, req, pev);
+			*handled = 1;
+		}
+		return;
+	}
+	// PropertyDelete
+	for (int i = 0; i < ctx->transfer_count; i++) {
+		if (ctx->transfers[i].requestor == pev->window && ctx->transfers[i].property == pev->atom) {
+			send_incr_chunk(ctx, i);
+			*handled = 1;
+			return;
+		}
+	}
 }
 
 static void handle_selection_clear(ClipboardContext *ctx, XSelectionClearEvent *cev) {
 	ClipboardData *data = get_data_for_selection(ctx, cev->selection);
 	if (data) {
 		// We lost ownership - clear our data
-		free(data->text);
-		data->text = NULL;
-		data->owner_window = None;
+		// (in-flight INCR transfers keep their own copy and run to completion)
+		clear_data(data);
 	}
 }
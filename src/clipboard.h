@@ -1,7 +1,9 @@
 #ifndef CLIPBOARD_H_
 #define CLIPBOARD_H_
 
+#include <stddef.h>
 #include <X11/Xlib.h>
+#include "colormath.h"
 
 /* ========== CLIPBOARD SYSTEM INTERFACE ========== */
 
@@ -15,8 +17,10 @@
  * Usage:
  *   1. Create context: clipboard_create(display)
  *   2. Set text: clipboard_set_text(ctx, window, text, type)
+ *      or a colour: clipboard_set_color(ctx, window, text, rgb, type)
  *   3. Request text: clipboard_request_text(ctx, window, callback, data, type)
- *   4. Handle events: clipboard_handle_event(ctx, &event) in main loop
+ *   4. Handle events: clipboard_handle_event(ctx, &event) in main loop,
+ *      and clipboard_process_timeouts(ctx) once per iteration
  *   5. Cleanup: clipboard_destroy(ctx)
  */
 
@@ -76,6 +80,69 @@ void clipboard_destroy(ClipboardContext *ctx);
  */
 void clipboard_set_text(ClipboardContext *ctx, Window win, const char *text, SelectionType type);
 
+/**
+ * @brief Copy a colour to clipboard/selection in several formats
+ * @param ctx Clipboard context
+ * @param win Window that will own the selection
+ * @param text Text offered as UTF8_STRING/STRING (NULL for "#RRGGBB")
+ * @param color Colour being copied
+ * @param type SELECTION_CLIPBOARD or SELECTION_PRIMARY
+ *
+ * Like clipboard_set_text(), but additionally advertises these targets so
+ * each requestor can take the representation it understands best:
+ *   text/x-color-hex, text/css (rgb()), text/x-css-hsl (hsl()),
+ *   application/json, image/png (solid swatch) and application/x-color
+ *   (GTK/Qt colour drops). Each format is generated only when first
+ *   requested and is cached until ownership changes.
+ */
+void clipboard_set_color(ClipboardContext *ctx, Window win, const char *text, RGB8 color, SelectionType type);
+
+/* ========== COPY HISTORY ========== */
+
+/**
+ * @brief Set the byte budget of the copy history
+ * @param ctx Clipboard context
+ * @param bytes Budget covering history text plus per-entry bookkeeping
+ *
+ * Every clipboard_set_color() is recorded, most recent first, with one
+ * entry per RGB value (copying a colour again moves it to the front and
+ * keeps the latest text). The oldest entries are dropped to stay within
+ * the budget; 0 disables the history. Defaults to 16 KiB.
+ */
+void clipboard_history_set_budget(ClipboardContext *ctx, size_t bytes);
+
+/**
+ * @brief Get the number of colours in the copy history
+ * @param ctx Clipboard context
+ * @return Number of entries
+ */
+size_t clipboard_history_count(const ClipboardContext *ctx);
+
+/**
+ * @brief Get one copy history entry
+ * @param ctx Clipboard context
+ * @param index 0 for the most recent copy
+ * @param color Receives the entry's colour (may be NULL)
+ *
+ * @return Text that was copied, or NULL if index is out of range. The
+ *         pointer stays valid until the next copy or budget change.
+ */
+const char *clipboard_history_get(const ClipboardContext *ctx, size_t index, RGB8 *color);
+
+/**
+ * @brief Put a history entry back on the clipboard
+ * @param ctx Clipboard context
+ * @param win Window that will own the selection
+ * @param index 0 for the most recent copy
+ * @param type SELECTION_CLIPBOARD or SELECTION_PRIMARY
+ *
+ * Equivalent to clipboard_set_color() with the entry's text and colour;
+ * the entry moves to the front of the history.
+ *
+ * @return 0 on success, -1 if index is out of range
+ */
+int clipboard_history_reown(ClipboardContext *ctx, Window win, size_t index, SelectionType type);
+
 /**
  * @brief Request text from clipboard/selection
  * @param ctx Clipboard context
@@ -107,6 +174,10 @@ void clipboard_request_text(ClipboardContext *ctx, Window win, ClipboardCallback
  *   - SelectionRequest: Someone wants our clipboard data
  *   - SelectionNotify: Response to our paste request
  *   - SelectionClear: We lost clipboard ownership
+ *   - PropertyNotify: Next chunk of a large (INCR) transfer
+ *
+ * Payloads larger than the server's maximum request size are transferred
+ * with the ICCCM INCR protocol in both directions, one chunk per event.
  *
  * Example:
  *   while (1) {
@@ -118,4 +189,15 @@ void clipboard_request_text(ClipboardContext *ctx, Window win, ClipboardCallback
  */
 int clipboard_handle_event(ClipboardContext *ctx, XEvent *ev);
 
+/**
+ * @brief Expire paste requests whose owner never answered
+ * @param ctx Clipboard context
+ *
+ * Call once per main-loop iteration. Requests (and outgoing INCR
+ * transfers) that make no progress for about two seconds are dropped;
+ * a timed-out paste invokes its callback with NULL. Cheap when nothing
+ * is pending.
+ */
+void clipboard_process_timeouts(ClipboardContext *ctx);
+
 #endif /* CLIPBOARD_H_ */
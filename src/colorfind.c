@@ -0,0 +1,284 @@
+/* colorfind.c - Color Search Implementation
+ *
+ * Scans a 32-bit image for pixels within a ΔEOK tolerance of a target color
+ * and reports them as bounding boxes.
+ *
+ * Internal design notes:
+ * - A cell table over the 15-bit RGB cube (8x8x8 values per cell) decides
+ *   most pixels with one byte lookup. Cells are classified from the OKLab
+ *   values at their eight corners: the corner average is the cell center and
+ *   the farthest corner, with a safety margin, bounds the cell's radius.
+ *   Corners are shared on a 33^3 lattice, so building the table costs about
+ *   36k conversions regardless of image size.
+ * - Pixels in cells that straddle the tolerance sphere get an exact float
+ *   OKLab test (sRGB decode through a 256-entry table, then cbrtf).
+ * - Matches are accumulated per 16x16 tile. Each pool slice scans whole
+ *   tile rows, so no two slices ever write the same tile.
+ * - Tiles with matches are joined with their 8 neighbours by a flood fill;
+ *   each connected group becomes one box.
+ */
+
+#include "colorfind.h"
+#include <math.h>
+#include <stdlib.h>
+
+/* ========== INTERNAL CONSTANTS ========== */
+
+#define CELL_SIZE 8
+#define CELLS_PER_AXIS (256 / CELL_SIZE)
+#define LATTICE (CELLS_PER_AXIS + 1)
+#define TILE_SIZE 16
+#define RADIUS_MARGIN 1.1f  // Covers the curvature the corner bound misses
+
+enum { CELL_OUT = 0, CELL_IN, CELL_EDGE };
+
+/* ========== TYPE DEFINITIONS ========== */
+
+typedef struct {
+	unsigned long count;
+	int x0, y0, x1, y1; // Inclusive bounds of the matches
+} Tile;
+
+typedef struct {
+	const uint32_t *pixels;
+	int width, height, stride;
+	ColorFindFormat format;
+	const uint8_t *cells;
+	const float *linear;
+	float target[3];
+	float tolerance2;
+	Tile *tiles;
+	int tiles_x;
+	int tile_row0, tile_row1;
+} ScanJob;
+
+/* ========== OKLAB (FLOAT) ========== */
+
+static void build_linear_table(float linear[256]) {
+	for (int i = 0; i < 256; i++) {
+		double c = i / 255.0;
+		linear[i] = (float)((c <= 0.04045) ? c / 12.92 : pow((c + 0.055) / 1.055, 2.4));
+	}
+}
+
+static void to_oklab(const float linear[256], unsigned int r, unsigned int g, unsigned int b, float out[3]) {
+	float lr = linear[r], lg = linear[g], lb = linear[b];
+	float l = cbrtf(0.4122214708f * lr + 0.5363325363f * lg + 0.0514459929f * lb);
+	float m = cbrtf(0.2119034982f * lr + 0.6806995451f * lg + 0.1073969566f * lb);
+	float s = cbrtf(0.0883024619f * lr + 0.2817188376f * lg + 0.6299787005f * lb);
+	out[0] = 0.2104542553f * l + 0.7936177850f * m - 0.0040720468f * s;
+	out[1] = 1.9779984951f * l - 2.4285922050f * m + 0.4505937099f * s;
+	out[2] = 0.0259040371f * l + 0.7827717662f * m - 0.8086757660f * s;
+}
+
+static float dist2(const float a[3], const float b[3]) {
+	float d0 = a[0] - b[0], d1 = a[1] - b[1], d2 = a[2] - b[2];
+	return d0 * d0 + d1 * d1 + d2 * d2;
+}
+
+/* ========== CELL TABLE ========== */
+
+static unsigned int lattice_value(int i) {
+	return (unsigned int)(i * CELL_SIZE > 255 ? 255 : i * CELL_SIZE);
+}
+
+/* Classify every cell of the RGB cube against the tolerance sphere */
+static int build_cells(const float linear[256], const float target[3], float tolerance, uint8_t *cells) {
+	float (*lattice)[3] = malloc((size_t)LATTICE * LATTICE * LATTICE * sizeof(*lattice));
+	if (!lattice) {
+		return -1;
+	}
+	for (int r = 0; r < LATTICE; r++) {
+		for (int g = 0; g < LATTICE; g++) {
+			for (int b = 0; b < LATTICE; b++) {
+				to_oklab(linear, lattice_value(r), lattice_value(g), lattice_value(b), lattice[(r * LATTICE + g) * LATTICE + b]);
+			}
+		}
+	}
+	for (int r = 0; r < CELLS_PER_AXIS; r++) {
+		for (int g = 0; g < CELLS_PER_AXIS; g++) {
+			for (int b = 0; b < CELLS_PER_AXIS; b++) {
+				const float *corner[8];
+				float center[3] = {0.0f, 0.0f, 0.0f};
+				for (int c = 0; c < 8; c++) {
+					corner[c] = lattice[((r + (c >> 2)) * LATTICE + g + ((c >> 1) & 1)) * LATTICE + b + (c & 1)];
+					center[0] += corner[c][0] / 8.0f;
+					center[1] += corner[c][1] / 8.0f;
+					center[2] += corner[c][2] / 8.0f;
+				}
+				float radius2 = 0.0f;
+				for (int c = 0; c < 8; c++) {
+					float d = dist2(center, corner[c]);
+					radius2 = d > radius2 ? d : radius2;
+				}
+				float radius = sqrtf(radius2) * RADIUS_MARGIN;
+				float d = sqrtf(dist2(center, target));
+				uint8_t cls = CELL_EDGE;
+				if (d - radius > tolerance) {
+					cls = CELL_OUT;
+				}
+				else if (d + radius <= tolerance) {
+					cls = CELL_IN;
+				}
+				cells[(r * CELLS_PER_AXIS + g) * CELLS_PER_AXIS + b] = cls;
+			}
+		}
+	}
+	free(lattice);
+	return 0;
+}
+
+/* ========== SCAN ========== */
+
+static void scan_worker(void *arg) {
+	ScanJob *job = arg;
+	const int rs = job->format.red_shift, gs = job->format.green_shift, bs = job->format.blue_shift;
+	int y_end = job->tile_row1 * TILE_SIZE < job->height ? job->tile_row1 * TILE_SIZE : job->height;
+	for (int y = job->tile_row0 * TILE_SIZE; y < y_end; y++) {
+		const uint32_t *row = job->pixels + (size_t)y * (size_t)job->stride;
+		Tile *tile_row = job->tiles + (size_t)(y / TILE_SIZE) * (size_t)job->tiles_x;
+		for (int x = 0; x < job->width; x++) {
+			uint32_t p = row[x];
+			unsigned int r = (p >> rs) & 0xFF, g = (p >> gs) & 0xFF, b = (p >> bs) & 0xFF;
+			uint8_t cls = job->cells[((r >> 3) << 10) | ((g >> 3) << 5) | (b >> 3)];
+			if (cls == CELL_OUT) {
+				continue;
+			}
+			if (cls == CELL_EDGE) {
+				float lab[3];
+				to_oklab(job->linear, r, g, b, lab);
+				if (dist2(lab, job->target) > job->tolerance2) {
+					continue;
+				}
+			}
+			Tile *t = &tile_row[x / TILE_SIZE];
+			if (!t->count++) {
+				t->x0 = t->x1 = x;
+				t->y0 = t->y1 = y;
+				continue;
+			}
+			t->x0 = x < t->x0 ? x : t->x0;
+			t->x1 = x > t->x1 ? x : t->x1;
+			t->y1 = y; // Rows are scanned top to bottom
+		}
+	}
+}
+
+/* ========== GROUPING ========== */
+
+/* Keep the max_boxes boxes with the most matches, sorted descending */
+static void insert_box(ColorFindBox *boxes, int *count, int max_boxes, const ColorFindBox *box) {
+	int j = *count;
+	if (j == max_boxes) {
+		if (boxes[j - 1].matches >= box->matches) {
+			return;
+		}
+		j--;
+	}
+	else {
+		(*count)++;
+	}
+	while (j > 0 && boxes[j - 1].matches < box->matches) {
+		boxes[j] = boxes[j - 1];
+		j--;
+	}
+	boxes[j] = *box;
+}
+
+/* Add a tile to the group being built and mark it consumed */
+static void take_tile(Tile *t, int *x0, int *y0, int *x1, int *y1, unsigned long *matches) {
+	*x0 = t->x0 < *x0 ? t->x0 : *x0;
+	*y0 = t->y0 < *y0 ? t->y0 : *y0;
+	*x1 = t->x1 > *x1 ? t->x1 : *x1;
+	*y1 = t->y1 > *y1 ? t->y1 : *y1;
+	*matches += t->count;
+	t->count = 0;
+}
+
+/* Flood-fill tiles with matches into boxes; returns -1 on allocation failure.
+ * A tile is consumed when it is pushed, so the stack never exceeds the tile count. */
+static int group_tiles(Tile *tiles, int tiles_x, int tiles_y, ColorFindBox *boxes, int max_boxes, int *box_count) {
+	int *stack = malloc((size_t)tiles_x * (size_t)tiles_y * sizeof(int));
+	if (!stack) {
+		return -1;
+	}
+	*box_count = 0;
+	for (int start = 0; start < tiles_x * tiles_y; start++) {
+		if (!tiles[start].count) {
+			continue;
+		}
+		int x0 = tiles[start].x0, y0 = tiles[start].y0, x1 = tiles[start].x1, y1 = tiles[start].y1;
+		unsigned long matches = 0;
+		int top = 0;
+		take_tile(&tiles[start], &x0, &y0, &x1, &y1, &matches);
+		stack[top++] = start;
+		while (top > 0) {
+			int i = stack[--top];
+			int tx = i % tiles_x, ty = i / tiles_x;
+			for (int dy = -1; dy <= 1; dy++) {
+				for (int dx = -1; dx <= 1; dx++) {
+					int nx = tx + dx, ny = ty + dy;
+					if (nx < 0 || ny < 0 || nx >= tiles_x || ny >= tiles_y || !tiles[ny * tiles_x + nx].count) {
+						continue;
+					}
+					take_tile(&tiles[ny * tiles_x + nx], &x0, &y0, &x1, &y1, &matches);
+					stack[top++] = ny * tiles_x + nx;
+				}
+			}
+		}
+		ColorFindBox box = {x0, y0, x1 - x0 + 1, y1 - y0 + 1, matches};
+		insert_box(boxes, box_count, max_boxes, &box);
+	}
+	free(stack);
+	return 0;
+}
+
+/* ========== SEARCH ========== */
+
+int colorfind_scan(WorkPool *pool, const uint32_t *pixels, int width, int height, int stride, const ColorFindFormat *format, RGB8 target, double tolerance, ColorFindBox *boxes, int max_boxes, unsigned long *match_count) {
+	if (!pixels || !format || !boxes || width <= 0 || height <= 0 || stride < width || max_boxes < 1 || tolerance < 0.0) {
+		return -1;
+	}
+	float linear[256];
+	float target_lab[3];
+	build_linear_table(linear);
+	to_oklab(linear, target.r, target.g, target.b, target_lab);
+
+	uint8_t *cells = malloc(CELLS_PER_AXIS * CELLS_PER_AXIS * CELLS_PER_AXIS);
+	int tiles_x = (width + TILE_SIZE - 1) / TILE_SIZE;
+	int tiles_y = (height + TILE_SIZE - 1) / TILE_SIZE;
+	Tile *tiles = calloc((size_t)tiles_x * (size_t)tiles_y, sizeof(Tile));
+	if (!cells || !tiles || build_cells(linear, target_lab, (float)tolerance, cells) != 0) {
+		free(cells);
+		free(tiles);
+		return -1;
+	}
+
+	int threads = workpool_size(pool);
+	threads = threads > tiles_y ? tiles_y : threads;
+	ScanJob jobs[WORKPOOL_MAX_WORKERS];
+	for (int i = 0; i < threads; i++) {
+		jobs[i] = (ScanJob){
+			pixels, width, height, stride, *format, cells, linear,
+			{target_lab[0], target_lab[1], target_lab[2]}, (float)(tolerance * tolerance),
+			tiles, tiles_x, tiles_y * i / threads, tiles_y * (i + 1) / threads
+		};
+	}
+	workpool_parallel(pool, scan_worker, jobs, sizeof(ScanJob), threads);
+	free(cells);
+
+	unsigned long total = 0;
+	for (int i = 0; i < tiles_x * tiles_y; i++) {
+		total += tiles[i].count;
+	}
+	int count = 0;
+	int rc = group_tiles(tiles, tiles_x, tiles_y, boxes, max_boxes, &count);
+	free(tiles);
+	if (rc != 0) {
+		return -1;
+	}
+	if (match_count) {
+		*match_count = total;
+	}
+	return count;
+}
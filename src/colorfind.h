@@ -0,0 +1,77 @@
+#ifndef COLORFIND_H_
+#define COLORFIND_H_
+
+/* ========== COLOR SEARCH INTERFACE ========== */
+
+/**
+ * @file colorfind.h
+ * @brief Find every pixel of an image within a ΔE tolerance of a color
+ *
+ * Distances are Euclidean in OKLab (ΔEOK). Matching pixels are grouped into
+ * 16x16 tiles and neighbouring tiles are merged, so the result is a short
+ * list of bounding boxes rather than a pixel mask.
+ *
+ * Most pixels are decided by a 32 KiB table over the 15-bit RGB cube that
+ * classifies each cell as entirely inside, entirely outside or straddling
+ * the tolerance sphere; only pixels in straddling cells are converted to
+ * OKLab. The scan is split across the workers of a WorkPool by tile row;
+ * a 3840x2160 image scans in a few milliseconds on a desktop CPU.
+ *
+ * Dependencies:
+ * - colormath.h (RGB8 type, OKLab conversion)
+ * - workpool.h (parallel scan)
+ *
+ * Usage:
+ *   ColorFindFormat fmt = {16, 8, 0};
+ *   ColorFindBox boxes[64];
+ *   unsigned long matches;
+ *   int n = colorfind_scan(pool, pixels, width, height, stride, &fmt,
+ *                          target, 0.02, boxes, 64, &matches);
+ *
+ * Thread safety: Reentrant; may be called from inside a pool job
+ * Memory: Temporary buffers are freed before returning
+ */
+
+#include <stdint.h>
+#include "colormath.h"
+#include "workpool.h"
+
+/* ========== TYPE DEFINITIONS ========== */
+
+/* Position of the 8-bit channels inside each 32-bit pixel */
+typedef struct {
+	int red_shift;
+	int green_shift;
+	int blue_shift;
+} ColorFindFormat;
+
+/* Bounding box of a group of matching pixels */
+typedef struct {
+	int x, y;
+	int width, height;
+	unsigned long matches; /* Matching pixels inside the box */
+} ColorFindBox;
+
+/* ========== SEARCH ========== */
+
+/**
+ * @brief Find the areas of an image that match a color
+ * @param pool Pool the scan is split across (NULL = calling thread only)
+ * @param pixels First pixel of the image
+ * @param width Image width in pixels
+ * @param height Image height in pixels
+ * @param stride Distance between rows, in pixels
+ * @param format Channel layout of the pixels
+ * @param target Color to look for
+ * @param tolerance Largest ΔEOK that still matches (0.02 is about one
+ *                  just-noticeable difference)
+ * @param boxes Receives the boxes, largest match count first
+ * @param max_boxes Capacity of boxes; further boxes are dropped
+ * @param match_count Receives the total number of matching pixels (may be NULL)
+ *
+ * @return Number of boxes written, or -1 on invalid input or allocation
+ *         failure
+ */
+int colorfind_scan(WorkPool *pool, const uint32_t *pixels, int width, int height, int stride, const ColorFindFormat *format, RGB8 target, double tolerance, ColorFindBox *boxes, int max_boxes, unsigned long *match_count);
+
+#endif /* COLORFIND_H_ */
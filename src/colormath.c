@@ -6,6 +6,8 @@
  * Algorithms based on:
  * - RGB ↔ HSV: Smith's algorithm (1978)
  * - RGB ↔ HSL: CSS3 Color Module specification
+ * - RGB ↔ OKLab: Björn Ottosson, "A perceptual color space for image
+ *   processing" (2020), with the sRGB transfer curve from IEC 61966-2-1
  *
  * All functions handle edge cases (achromatic colors, out-of-range values)
  * correctly and use floating-point precision for accuracy.
@@ -274,3 +276,54 @@ RGBf hsl_to_rgb(HSL hsl) {
 	};
 	return out;
 }
+
+/* ========== RGB ↔ OKLab Conversions ========== */
+
+/* sRGB transfer curve: encoded [0,1] → linear light [0,1] */
+static double _srgb_to_linear(double c) {
+	return (c <= 0.04045) ? c / 12.92 : pow((c + 0.055) / 1.055, 2.4);
+}
+
+/* Inverse transfer curve: linear light [0,1] → encoded [0,1] */
+static double _linear_to_srgb(double c) {
+	return (c <= 0.0031308) ? c * 12.92 : 1.055 * pow(c, 1.0 / 2.4) - 0.055;
+}
+
+/* Convert sRGB to OKLab
+ * Linear RGB → LMS cone response → cube root → Lab.
+ */
+OKLab rgb_to_oklab(RGBf rgb) {
+	double r = _srgb_to_linear(cm_clamp01(rgb.r));
+	double g = _srgb_to_linear(cm_clamp01(rgb.g));
+	double b = _srgb_to_linear(cm_clamp01(rgb.b));
+
+	double l = cbrt(0.4122214708 * r + 0.5363325363 * g + 0.0514459929 * b);
+	double m = cbrt(0.2119034982 * r + 0.6806995451 * g + 0.1073969566 * b);
+	double s = cbrt(0.0883024619 * r + 0.2817188376 * g + 0.6299787005 * b);
+
+	OKLab out = {
+		0.2104542553 * l + 0.7936177850 * m - 0.0040720468 * s,
+		1.9779984951 * l - 2.4285922050 * m + 0.4505937099 * s,
+		0.0259040371 * l + 0.7827717662 * m - 0.8086757660 * s
+	};
+	return out;
+}
+
+/* Convert OKLab to sRGB
+ * Exact inverse of rgb_to_oklab(); out-of-gamut results are clamped.
+ */
+RGBf oklab_to_rgb(OKLab lab) {
+	double l = lab.L + 0.3963377774 * lab.a + 0.2158037573 * lab.b;
+	double m = lab.L - 0.1055613458 * lab.a - 0.0638541728 * lab.b;
+	double s = lab.L - 0.0894841775 * lab.a - 1.2914855480 * lab.b;
+	l = l * l * l;
+	m = m * m * m;
+	s = s * s * s;
+
+	RGBf out = {
+		cm_clamp01(_linear_to_srgb(cm_clamp01(4.0767416621 * l - 3.3077115913 * m + 0.2309699292 * s))),
+		cm_clamp01(_linear_to_srgb(cm_clamp01(-1.2684380046 * l + 2.6097574011 * m - 0.3413193965 * s))),
+		cm_clamp01(_linear_to_srgb(cm_clamp01(-0.0041960863 * l - 0.7034186147 * m + 1.7076147010 * s)))
+	};
+	return out;
+}
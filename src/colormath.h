@@ -11,6 +11,7 @@
  * - RGB (0-1 float and 0-255 integer representations)
  * - HSV (Hue-Saturation-Value) color space
  * - HSL (Hue-Saturation-Lightness) color space
+ * - OKLab perceptual color space (for color distances)
  * - Hexadecimal color string parsing and formatting
  * - Fast, branchless algorithms where possible
  *
@@ -19,6 +20,7 @@
  *   HSV to RGB: RGBf rgb = hsv_to_rgb((HSV){h, s, v});
  *   RGB to HSL: HSL hsl = rgb_to_hsl((RGBf){r, g, b});
  *   HSL to RGB: RGBf rgb = hsl_to_rgb((HSL){h, s, l});
+ *   RGB to OKLab: OKLab lab = rgb_to_oklab((RGBf){r, g, b});
  *   Parse hex: RGB8 color = hex_to_rgb8("#FF5733");
  *   Format hex: hex_from_rgb8((RGB8){255, 87, 51}, buf, sizeof(buf));
  *
@@ -74,6 +76,16 @@ typedef struct {
 	double L; /* Lightness [0.0 .. 1.0] */
 } HSL;
 
+/* OKLab perceptual color space (Björn Ottosson, 2020)
+ * Euclidean distance between two OKLab colors approximates perceived
+ * difference, which makes it suitable for clustering and matching.
+ */
+typedef struct {
+	double L; /* Perceived lightness [0.0 .. 1.0] */
+	double a; /* Green (-) to red (+), roughly [-0.4 .. 0.4] */
+	double b; /* Blue (-) to yellow (+), roughly [-0.4 .. 0.4] */
+} OKLab;
+
 /* ========== UTILITY FUNCTIONS ========== */
 
 /* Clamp a value to [0.0 .. 1.0] range
@@ -170,4 +182,25 @@ HSL rgb_to_hsl(RGBf rgb);
  */
 RGBf hsl_to_rgb(HSL hsl);
 
+/* ========== RGB ↔ OKLAB CONVERSIONS ========== */
+
+/* Convert sRGB to OKLab color space
+ *
+ * Decodes the sRGB transfer curve, then applies Ottosson's linear-light
+ * LMS transform and cube root.
+ *
+ * @param rgb Normalized sRGB color [0.0..1.0]
+ * @return OKLab color
+ */
+OKLab rgb_to_oklab(RGBf rgb);
+
+/* Convert OKLab to sRGB color space
+ *
+ * Inverse of rgb_to_oklab(). Colors outside the sRGB gamut are clamped.
+ *
+ * @param lab OKLab color
+ * @return Normalized sRGB color [0.0..1.0]
+ */
+RGBf oklab_to_rgb(OKLab lab);
+
 #endif /* COLORMATH_H_ */
@@ -0,0 +1,536 @@
+/* compositor.c - Single-Window Compositor Implementation
+ *
+ * Renders widget nodes into one back buffer for a host window and presents
+ * the damaged area once per frame.
+ *
+ * Internal design notes:
+ * - Nodes live in a growable array in paint order (later = on top). Removed
+ *   nodes leave a free slot so ids stay stable.
+ * - Damage is a single bounding rectangle. Before painting it is grown to
+ *   cover every node it touches, because nodes always paint their whole
+ *   rectangle and must not overdraw a node above them outside the clip.
+ * - With DBE the back buffer uses the XdbeCopied swap action, so it keeps
+ *   its contents after a swap and only damaged nodes are repainted. Without
+ *   DBE a back pixmap is used and the damaged rectangle is copied.
+ * - One XftDraw is kept for the back buffer and shared by every node; it is
+ *   clipped to each node's rectangle while that node paints.
+ * - Input routing keeps two node indices: the grab (set by a press, held
+ *   until that button is released, or dropped by the first press or motion
+ *   with no button held) and the hovered node, whose cursor the host window
+ *   shows. Crossing events are synthesized only when the hovered node
+ *   changes.
+ */
+
+#include "compositor.h"
+#include "dbe.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+	CompositorPaintFn paint; // NULL for a free slot
+	void *user_data;
+	int x, y, width, height;
+	int visible;
+	Window input; // Input id carried by routed events
+	Cursor cursor; // None: the host's cursor
+} CompositorNode;
+
+struct Compositor {
+	Display *dpy;
+	int screen;
+	Window win;
+	int width, height;
+	unsigned long background;
+	GC gc;
+	XftDraw *draw; // Shared by the nodes' paint callbacks
+
+	// Back buffer: DBE when available, otherwise a pixmap
+	DbeContext *dbe_ctx;
+	XdbeBackBuffer dbe_back_buffer;
+	Pixmap back_pixmap;
+
+	CompositorNode *nodes;
+	int node_count;
+	int node_cap;
+
+	// Damaged area (empty when dmg_w or dmg_h is 0)
+	int dmg_x, dmg_y, dmg_w, dmg_h;
+
+	// Input routing (node indices, -1 for none)
+	int grab_node;
+	unsigned int grab_button;
+	int hover_node;
+};
+
+/* ========== INTERNAL HELPERS ========== */
+
+static int rects_intersect(int ax, int ay, int aw, int ah, int bx, int by, int bw, int bh) {
+	return ax < bx + bw && bx < ax + aw && ay < by + bh && by < ay + ah;
+}
+
+/* Grow the damaged rectangle to include another one */
+static void damage_union(Compositor *comp, int x, int y, int w, int h) {
+	if (w <= 0 || h <= 0) {
+		return;
+	}
+	if (comp->dmg_w <= 0 || comp->dmg_h <= 0) {
+		comp->dmg_x = x;
+		comp->dmg_y = y;
+		comp->dmg_w = w;
+		comp->dmg_h = h;
+		return;
+	}
+	int x1 = x < comp->dmg_x ? x : comp->dmg_x;
+	int y1 = y < comp->dmg_y ? y : comp->dmg_y;
+	int x2 = (x + w) > (comp->dmg_x + comp->dmg_w) ? (x + w) : (comp->dmg_x + comp->dmg_w);
+	int y2 = (y + h) > (comp->dmg_y + comp->dmg_h) ? (y + h) : (comp->dmg_y + comp->dmg_h);
+	comp->dmg_x = x1;
+	comp->dmg_y = y1;
+	comp->dmg_w = x2 - x1;
+	comp->dmg_h = y2 - y1;
+}
+
+static CompositorNode *get_node(const Compositor *comp, int id) {
+	if (!comp || id < 0 || id >= comp->node_count || !comp->nodes[id].paint) {
+		return NULL;
+	}
+	return &comp->nodes[id];
+}
+
+static void damage_node_rect(Compositor *comp, const CompositorNode *node) {
+	if (node->visible) {
+		damage_union(comp, node->x, node->y, node->width, node->height);
+	}
+}
+
+static Drawable back_buffer(const Compositor *comp) {
+	return comp->dbe_back_buffer != None ? comp->dbe_back_buffer : comp->back_pixmap;
+}
+
+/* (Re)create the back pixmap, when DBE is not used, and the shared XftDraw */
+static void create_back_buffer(Compositor *comp, int depth) {
+	if (comp->draw) {
+		XftDrawDestroy(comp->draw);
+		comp->draw = NULL;
+	}
+	if (comp->dbe_back_buffer == None) {
+		if (comp->back_pixmap) {
+			XFreePixmap(comp->dpy, comp->back_pixmap);
+		}
+		comp->back_pixmap = XCreatePixmap(comp->dpy, comp->win, (unsigned int)comp->width, (unsigned int)comp->height, (unsigned int)depth);
+		XSetForeground(comp->dpy, comp->gc, comp->background);
+		XFillRectangle(comp->dpy, comp->back_pixmap, comp->gc, 0, 0, (unsigned int)comp->width, (unsigned int)comp->height);
+	}
+	comp->draw = XftDrawCreate(comp->dpy, back_buffer(comp), DefaultVisual(comp->dpy, comp->screen), DefaultColormap(comp->dpy, comp->screen));
+}
+
+/* ========== LIFECYCLE MANAGEMENT ========== */
+
+Compositor *compositor_create(Display *dpy, int screen, Window win, unsigned long background) {
+	if (!dpy || !win) {
+		return NULL;
+	}
+	XWindowAttributes wa;
+	if (!XGetWindowAttributes(dpy, win, &wa)) {
+		return NULL;
+	}
+	Compositor *comp = calloc(1, sizeof(Compositor));
+	if (!comp) {
+		return NULL;
+	}
+	comp->dpy = dpy;
+	comp->screen = screen;
+	comp->win = win;
+	comp->width = wa.width > 0 ? wa.width : 1;
+	comp->height = wa.height > 0 ? wa.height : 1;
+	comp->background = background;
+	comp->gc = XCreateGC(dpy, win, 0, NULL);
+	comp->grab_node = -1;
+	comp->hover_node = -1;
+
+	comp->dbe_ctx = dbe_init(dpy, screen);
+	comp->dbe_back_buffer = None;
+	if (comp->dbe_ctx && dbe_is_supported(comp->dbe_ctx)) {
+		comp->dbe_back_buffer = dbe_allocate_back_buffer(comp->dbe_ctx, win, XdbeCopied);
+	}
+	create_back_buffer(comp, wa.depth);
+	damage_union(comp, 0, 0, comp->width, comp->height);
+	return comp;
+}
+
+void compositor_destroy(Compositor *comp) {
+	if (!comp) {
+		return;
+	}
+	if (comp->hover_node >= 0) {
+		XUndefineCursor(comp->dpy, comp->win);
+	}
+	if (comp->draw) {
+		XftDrawDestroy(comp->draw);
+	}
+	if (comp->dbe_back_buffer != None) {
+		dbe_deallocate_back_buffer(comp->dbe_ctx, comp->dbe_back_buffer);
+	}
+	if (comp->dbe_ctx) {
+		dbe_destroy(comp->dbe_ctx);
+	}
+	if (comp->back_pixmap) {
+		XFreePixmap(comp->dpy, comp->back_pixmap);
+	}
+	if (comp->gc) {
+		XFreeGC(comp->dpy, comp->gc);
+	}
+	free(comp->nodes);
+	free(comp);
+}
+
+Window compositor_get_window(const Compositor *comp) {
+	return comp ? comp->win : None;
+}
+
+XftDraw *compositor_get_draw(const Compositor *comp) {
+	return comp ? comp->draw : NULL;
+}
+
+void compositor_resize(Compositor *comp, int width, int height) {
+	if (!comp || width <= 0 || height <= 0 || (width == comp->width && height == comp->height)) {
+		return;
+	}
+	comp->width = width;
+	comp->height = height;
+	if (comp->dbe_back_buffer == None) {
+		XWindowAttributes wa;
+		if (!XGetWindowAttributes(comp->dpy, comp->win, &wa)) {
+			return;
+		}
+		create_back_buffer(comp, wa.depth);
+	}
+	// The newly exposed part of a DBE buffer is undefined as well
+	damage_union(comp, 0, 0, comp->width, comp->height);
+}
+
+/* ========== NODES ========== */
+
+int compositor_add_node(Compositor *comp, CompositorPaintFn paint, void *user_data) {
+	if (!comp || !paint) {
+		return -1;
+	}
+	if (comp->node_count == comp->node_cap) {
+		int cap = comp->node_cap ? comp->node_cap * 2 : 16;
+		CompositorNode *grown = realloc(comp->nodes, (size_t)cap * sizeof(CompositorNode));
+		if (!grown) {
+			return -1;
+		}
+		comp->nodes = grown;
+		comp->node_cap = cap;
+	}
+	int id = comp->node_count++;
+	comp->nodes[id] = (CompositorNode){paint, user_data, 0, 0, 0, 0, 1, XAllocID(comp->dpy), None};
+	return id;
+}
+
+Window compositor_node_window(const Compositor *comp, int id) {
+	const CompositorNode *node = get_node(comp, id);
+	return node ? node->input : None;
+}
+
+void compositor_set_node_cursor(Compositor *comp, int id, Cursor cursor) {
+	CompositorNode *node = get_node(comp, id);
+	if (!node) {
+		return;
+	}
+	node->cursor = cursor;
+	if (comp->hover_node == id) {
+		XDefineCursor(comp->dpy, comp->win, cursor);
+	}
+}
+
+void compositor_remove_node(Compositor *comp, int id) {
+	CompositorNode *node = get_node(comp, id);
+	if (!node) {
+		return;
+	}
+	damage_node_rect(comp, node);
+	node->paint = NULL;
+	node->visible = 0;
+	if (comp->grab_node == id) {
+		comp->grab_node = -1;
+	}
+	if (comp->hover_node == id) {
+		comp->hover_node = -1;
+		XUndefineCursor(comp->dpy, comp->win);
+	}
+}
+
+void compositor_set_node_bounds(Compositor *comp, int id, int x, int y, int width, int height) {
+	CompositorNode *node = get_node(comp, id);
+	if (!node) {
+		return;
+	}
+	if (node->x == x && node->y == y && node->width == width && node->height == height) {
+		return;
+	}
+	damage_node_rect(comp, node);
+	node->x = x;
+	node->y = y;
+	node->width = width;
+	node->height = height;
+	damage_node_rect(comp, node);
+}
+
+void compositor_set_node_visible(Compositor *comp, int id, int visible) {
+	CompositorNode *node = get_node(comp, id);
+	if (!node || node->visible == (visible != 0)) {
+		return;
+	}
+	damage_union(comp, node->x, node->y, node->width, node->height);
+	node->visible = visible != 0;
+}
+
+void compositor_damage_node(Compositor *comp, int id) {
+	CompositorNode *node = get_node(comp, id);
+	if (node) {
+		damage_node_rect(comp, node);
+	}
+}
+
+/* ========== FRAMES ========== */
+
+void compositor_damage_rect(Compositor *comp, int x, int y, int width, int height) {
+	if (comp) {
+		damage_union(comp, x, y, width, height);
+	}
+}
+
+void compositor_set_background(Compositor *comp, unsigned long background) {
+	if (!comp || comp->background == background) {
+		return;
+	}
+	comp->background = background;
+	damage_union(comp, 0, 0, comp->width, comp->height);
+}
+
+int compositor_handle_expose(Compositor *comp, const XExposeEvent *ev) {
+	if (!comp || !ev || ev->window != comp->win) {
+		return 0;
+	}
+	if (comp->dbe_back_buffer != None) {
+		// The retained back buffer is intact; swapping it restores the window
+		damage_union(comp, ev->x, ev->y, ev->width, ev->height);
+	}
+	else {
+		XCopyArea(comp->dpy, comp->back_pixmap, comp->win, comp->gc, ev->x, ev->y, (unsigned int)ev->width, (unsigned int)ev->height, ev->x, ev->y);
+	}
+	return 1;
+}
+
+int compositor_present(Compositor *comp) {
+	if (!comp || comp->dmg_w <= 0 || comp->dmg_h <= 0) {
+		return 0;
+	}
+	// Nodes paint their whole rectangle: grow the damage until it covers
+	// every node it touches so no node is partially overdrawn
+	int grown = 1;
+	while (grown) {
+		grown = 0;
+		for (int i = 0; i < comp->node_count; i++) {
+			const CompositorNode *n = &comp->nodes[i];
+			if (!n->paint || !n->visible || !rects_intersect(n->x, n->y, n->width, n->height, comp->dmg_x, comp->dmg_y, comp->dmg_w, comp->dmg_h)) {
+				continue;
+			}
+			int x = comp->dmg_x, y = comp->dmg_y, w = comp->dmg_w, h = comp->dmg_h;
+			damage_union(comp, n->x, n->y, n->width, n->height);
+			if (x != comp->dmg_x || y != comp->dmg_y || w != comp->dmg_w || h != comp->dmg_h) {
+				grown = 1;
+			}
+		}
+	}
+
+	Drawable target = back_buffer(comp);
+	XSetForeground(comp->dpy, comp->gc, comp->background);
+	XFillRectangle(comp->dpy, target, comp->gc, comp->dmg_x, comp->dmg_y, (unsigned int)comp->dmg_w, (unsigned int)comp->dmg_h);
+	for (int i = 0; i < comp->node_count; i++) {
+		const CompositorNode *n = &comp->nodes[i];
+		if (n->paint && n->visible && rects_intersect(n->x, n->y, n->width, n->height, comp->dmg_x, comp->dmg_y, comp->dmg_w, comp->dmg_h)) {
+			XRectangle clip = {(short)n->x, (short)n->y, (unsigned short)n->width, (unsigned short)n->height};
+			XftDrawSetClipRectangles(comp->draw, 0, 0, &clip, 1);
+			n->paint(target, n->x, n->y, n->user_data);
+		}
+	}
+	XftDrawSetClip(comp->draw, NULL);
+
+	// One presentation per frame
+	if (comp->dbe_back_buffer != None) {
+		dbe_swap_buffers(comp->dbe_ctx, comp->win, XdbeCopied);
+	}
+	else {
+		XCopyArea(comp->dpy, comp->back_pixmap, comp->win, comp->gc, comp->dmg_x, comp->dmg_y, (unsigned int)comp->dmg_w, (unsigned int)comp->dmg_h, comp->dmg_x, comp->dmg_y);
+	}
+	XFlush(comp->dpy);
+	comp->dmg_x = comp->dmg_y = comp->dmg_w = comp->dmg_h = 0;
+	return 1;
+}
+
+/* ========== INPUT ========== */
+
+static int node_contains(const CompositorNode *n, int x, int y) {
+	return n->paint && n->visible && x >= n->x && y >= n->y && x < n->x + n->width && y < n->y + n->height;
+}
+
+/* Index of the topmost visible node under a point, or -1 */
+static int node_at(const Compositor *comp, int x, int y) {
+	for (int i = comp->node_count - 1; i >= 0; i--) {
+		if (node_contains(&comp->nodes[i], x, y)) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+void *compositor_hit_test(const Compositor *comp, int x, int y) {
+	if (!comp) {
+		return NULL;
+	}
+	int id = node_at(comp, x, y);
+	return id >= 0 ? comp->nodes[id].user_data : NULL;
+}
+
+/* Crossing event for node id, built from a host pointer event */
+static XEvent make_crossing(const Compositor *comp, int type, int id, const XEvent *src, int x, int y, Window root, Time when, int x_root, int y_root, unsigned int state) {
+	const CompositorNode *n = &comp->nodes[id];
+	XEvent ev;
+	memset(&ev, 0, sizeof(ev));
+	ev.xcrossing.type = type;
+	ev.xcrossing.serial = src->xany.serial;
+	ev.xcrossing.send_event = False;
+	ev.xcrossing.display = comp->dpy;
+	ev.xcrossing.window = n->input;
+	ev.xcrossing.root = root;
+	ev.xcrossing.time = when;
+	ev.xcrossing.x = x - n->x;
+	ev.xcrossing.y = y - n->y;
+	ev.xcrossing.x_root = x_root;
+	ev.xcrossing.y_root = y_root;
+	ev.xcrossing.mode = NotifyNormal;
+	ev.xcrossing.detail = NotifyAncestor;
+	ev.xcrossing.same_screen = True;
+	ev.xcrossing.state = state;
+	return ev;
+}
+
+/* Move the hover to node id (or none). The original event is queued again
+ * to be routed after the crossing events; *ev becomes the first of those. */
+static int change_hover(Compositor *comp, XEvent *ev, int id, int x, int y, Window root, Time when, int x_root, int y_root, unsigned int state, int requeue) {
+	int old = comp->hover_node;
+	comp->hover_node = id;
+	XDefineCursor(comp->dpy, comp->win, id >= 0 ? comp->nodes[id].cursor : None);
+	XEvent orig = *ev;
+	if (requeue) {
+		XPutBackEvent(comp->dpy, &orig);
+	}
+	if (old >= 0 && id >= 0) {
+		XEvent enter = make_crossing(comp, EnterNotify, id, &orig, x, y, root, when, x_root, y_root, state);
+		XPutBackEvent(comp->dpy, &enter);
+	}
+	*ev = make_crossing(comp, old >= 0 ? LeaveNotify : EnterNotify, old >= 0 ? old : id, &orig, x, y, root, when, x_root, y_root, state);
+	return 1;
+}
+
+/* Point an event at node id with node-relative coordinates */
+static int retarget(const Compositor *comp, XEvent *ev, int id, int *x, int *y) {
+	const CompositorNode *n = &comp->nodes[id];
+	ev->xany.window = n->input;
+	*x -= n->x;
+	*y -= n->y;
+	return 1;
+}
+
+/* Drop a grab whose release the host never saw: a widget may take an active
+ * pointer grab of its own (a dropdown, a tear-off) and the release then goes
+ * to that window. Events reporting no button held end such a grab. */
+static void expire_grab(Compositor *comp, unsigned int state) {
+	const unsigned int buttons = Button1Mask | Button2Mask | Button3Mask | Button4Mask | Button5Mask;
+	if (comp->grab_node >= 0 && !(state & buttons)) {
+		comp->grab_node = -1;
+	}
+}
+
+int compositor_route_event(Compositor *comp, XEvent *ev) {
+	if (!comp || !ev || ev->xany.window != comp->win) {
+		return 0;
+	}
+	switch (ev->type) {
+		case ButtonPress: {
+			expire_grab(comp, ev->xbutton.state);
+			int id = comp->grab_node >= 0 ? comp->grab_node : node_at(comp, ev->xbutton.x, ev->xbutton.y);
+			if (id < 0) {
+				return 0;
+			}
+			if (comp->grab_node < 0) {
+				comp->grab_node = id;
+				comp->grab_button = ev->xbutton.button;
+			}
+			return retarget(comp, ev, id, &ev->xbutton.x, &ev->xbutton.y);
+		}
+		case ButtonRelease: {
+			int id = comp->grab_node >= 0 ? comp->grab_node : node_at(comp, ev->xbutton.x, ev->xbutton.y);
+			if (comp->grab_node >= 0 && ev->xbutton.button == comp->grab_button) {
+				comp->grab_node = -1;
+				// The pointer may have left the node during the grab: route a
+				// motion next so the hover catches up
+				if (node_at(comp, ev->xbutton.x, ev->xbutton.y) != comp->hover_node) {
+					XEvent motion;
+					memset(&motion, 0, sizeof(motion));
+					motion.xmotion.type = MotionNotify;
+					motion.xmotion.serial = ev->xbutton.serial;
+					motion.xmotion.display = comp->dpy;
+					motion.xmotion.window = comp->win;
+					motion.xmotion.root = ev->xbutton.root;
+					motion.xmotion.time = ev->xbutton.time;
+					motion.xmotion.x = ev->xbutton.x;
+					motion.xmotion.y = ev->xbutton.y;
+					motion.xmotion.x_root = ev->xbutton.x_root;
+					motion.xmotion.y_root = ev->xbutton.y_root;
+					motion.xmotion.same_screen = True;
+					XPutBackEvent(comp->dpy, &motion);
+				}
+			}
+			if (id < 0) {
+				return 0;
+			}
+			return retarget(comp, ev, id, &ev->xbutton.x, &ev->xbutton.y);
+		}
+		case MotionNotify: {
+			const XMotionEvent *m = &ev->xmotion;
+			expire_grab(comp, m->state);
+			int id = node_at(comp, m->x, m->y);
+			if (comp->grab_node >= 0 && id != comp->grab_node) {
+				id = -1; // Only the grabbing node gets crossing events
+			}
+			if (id != comp->hover_node) {
+				return change_hover(comp, ev, id, m->x, m->y, m->root, m->time, m->x_root, m->y_root, m->state, 1);
+			}
+			id = comp->grab_node >= 0 ? comp->grab_node : id;
+			if (id < 0) {
+				return 0;
+			}
+			return retarget(comp, ev, id, &ev->xmotion.x, &ev->xmotion.y);
+		}
+		case EnterNotify:
+		case LeaveNotify: {
+			const XCrossingEvent *c = &ev->xcrossing;
+			int id = ev->type == EnterNotify ? node_at(comp, c->x, c->y) : -1;
+			if (comp->grab_node >= 0 && id != comp->grab_node) {
+				id = -1;
+			}
+			if (id == comp->hover_node) {
+				return 0;
+			}
+			return change_hover(comp, ev, id, c->x, c->y, c->root, c->time, c->x_root, c->y_root, c->state, 0);
+		}
+		default:
+		break;
+	}
+	return 0;
+}
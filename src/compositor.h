@@ -0,0 +1,233 @@
+#ifndef COMPOSITOR_H_
+#define COMPOSITOR_H_
+
+/* ========== SINGLE-WINDOW COMPOSITOR INTERFACE ========== */
+
+/**
+ * @file compositor.h
+ * @brief Retained-mode compositor drawing widgets into one shared back buffer
+ *
+ * Widgets normally own an X window each, with their own back buffer and
+ * expose traffic. A compositor instead keeps a list of nodes (rectangles in
+ * the host window's coordinates with a paint callback) and renders them all
+ * into a single back buffer for the host window. Damaged areas are collected
+ * between frames and presented with one DBE swap (or one copy from a back
+ * pixmap when DBE is unavailable) per frame.
+ *
+ * Node windows are not needed at all: the host window selects pointer
+ * events and compositor_route_event() hit-tests them in the client,
+ * retargeting each one to the node under the pointer. Every node has an
+ * input id (an XID reserved with XAllocID() but never created on the
+ * server) that routed events carry in xany.window, so widgets keep matching
+ * events against "their" window as they do with real ones.
+ *
+ * Dependencies:
+ * - X11 (Xlib)
+ * - dbe.h (optional double-buffering)
+ *
+ * Usage:
+ *   Compositor *comp = compositor_create(display, screen, main_window, bg);
+ *   int id = compositor_add_node(comp, paint_label, label);
+ *   compositor_set_node_bounds(comp, id, x, y, w, h);
+ *   ...
+ *   compositor_route_event(comp, &event); // after each XNextEvent()
+ *   compositor_damage_node(comp, id);     // content changed
+ *   compositor_present(comp);             // once per main loop iteration
+ *
+ * Thread safety: Not thread-safe (uses X11 APIs)
+ * Memory: Caller must call compositor_destroy() to free resources
+ */
+
+#include <X11/Xlib.h>
+#include <X11/Xft/Xft.h>
+
+/* ========== TYPE DEFINITIONS ========== */
+
+typedef struct Compositor Compositor;
+
+/**
+ * Node paint callback
+ * @param target Drawable to paint into (the shared back buffer)
+ * @param x Node position in target
+ * @param y Node position in target
+ * @param user_data User data passed to compositor_add_node()
+ *
+ * The callback paints the node's whole rectangle; it is only called when
+ * that rectangle intersects the damaged area. During the call the shared
+ * XftDraw (compositor_get_draw()) is clipped to the node's rectangle.
+ */
+typedef void (*CompositorPaintFn)(Drawable target, int x, int y, void *user_data);
+
+/* ========== LIFECYCLE MANAGEMENT ========== */
+
+/**
+ * @brief Create a compositor for a host window
+ * @param dpy X11 display connection
+ * @param screen Screen number
+ * @param win Host window (must select ExposureMask for compositor_handle_expose())
+ * @param background Pixel painted where no node covers the window
+ * @return Compositor, or NULL on failure
+ */
+Compositor *compositor_create(Display *dpy, int screen, Window win, unsigned long background);
+
+/**
+ * @brief Destroy a compositor and its back buffer
+ * @param comp Compositor (may be NULL)
+ *
+ * Nodes are dropped; their owners must not use their ids afterwards.
+ */
+void compositor_destroy(Compositor *comp);
+
+/**
+ * @brief Get the host window
+ * @param comp Compositor
+ * @return Host window, or None if comp is NULL
+ *
+ * Nodes use it wherever a real window is needed (GC and pixmap creation,
+ * selection ownership, coordinate translation).
+ */
+Window compositor_get_window(const Compositor *comp);
+
+/**
+ * @brief Get the Xft context of the shared back buffer
+ * @param comp Compositor
+ * @return XftDraw for the drawable passed to paint callbacks
+ */
+XftDraw *compositor_get_draw(const Compositor *comp);
+
+/**
+ * @brief Follow a resize of the host window
+ * @param comp Compositor
+ * @param width New host width
+ * @param height New host height
+ *
+ * Reallocates the back pixmap (the DBE back buffer follows the window by
+ * itself) and damages the whole window.
+ */
+void compositor_resize(Compositor *comp, int width, int height);
+
+/* ========== NODES ========== */
+
+/**
+ * @brief Add a node on top of the existing ones
+ * @param comp Compositor
+ * @param paint Paint callback
+ * @param user_data Passed to paint and returned by compositor_hit_test()
+ * @return Node id, or -1 on failure. The node starts visible with an empty
+ *         rectangle; set it with compositor_set_node_bounds().
+ */
+int compositor_add_node(Compositor *comp, CompositorPaintFn paint, void *user_data);
+
+/**
+ * @brief Get a node's input id
+ * @param comp Compositor
+ * @param id Node id
+ * @return The XID that events routed to the node carry in xany.window, or
+ *         None for an unknown node. It is not a server window: never pass
+ *         it to Xlib requests.
+ */
+Window compositor_node_window(const Compositor *comp, int id);
+
+/**
+ * @brief Set the pointer cursor shown while the node is hovered
+ * @param comp Compositor
+ * @param id Node id
+ * @param cursor Cursor (owned by the caller), or None for the host's cursor
+ */
+void compositor_set_node_cursor(Compositor *comp, int id, Cursor cursor);
+
+/**
+ * @brief Remove a node and damage the area it covered
+ * @param comp Compositor
+ * @param id Node id
+ */
+void compositor_remove_node(Compositor *comp, int id);
+
+/**
+ * @brief Move and/or resize a node; damages its old and new rectangles
+ * @param comp Compositor
+ * @param id Node id
+ * @param x X position in the host window
+ * @param y Y position in the host window
+ * @param width Width
+ * @param height Height
+ */
+void compositor_set_node_bounds(Compositor *comp, int id, int x, int y, int width, int height);
+
+/**
+ * @brief Show or hide a node
+ * @param comp Compositor
+ * @param id Node id
+ * @param visible Non-zero to show
+ */
+void compositor_set_node_visible(Compositor *comp, int id, int visible);
+
+/**
+ * @brief Mark a node's content as changed
+ * @param comp Compositor
+ * @param id Node id
+ */
+void compositor_damage_node(Compositor *comp, int id);
+
+/* ========== FRAMES ========== */
+
+/**
+ * @brief Mark an area of the host window as needing a repaint
+ * @param comp Compositor
+ * @param x X position
+ * @param y Y position
+ * @param width Width
+ * @param height Height
+ */
+void compositor_damage_rect(Compositor *comp, int x, int y, int width, int height);
+
+/**
+ * @brief Change the background pixel and repaint everything
+ * @param comp Compositor
+ * @param background New background pixel
+ */
+void compositor_set_background(Compositor *comp, unsigned long background);
+
+/**
+ * @brief Handle an Expose event for the host window
+ * @param comp Compositor
+ * @param ev Expose event
+ * @return 1 if the event was for the host window, 0 otherwise
+ */
+int compositor_handle_expose(Compositor *comp, const XExposeEvent *ev);
+
+/**
+ * @brief Repaint the damaged area and present it
+ * @param comp Compositor
+ * @return 1 if a frame was presented, 0 if nothing was damaged
+ */
+int compositor_present(Compositor *comp);
+
+/* ========== INPUT ========== */
+
+/**
+ * @brief Find the topmost visible node under a point
+ * @param comp Compositor
+ * @param x X position in the host window
+ * @param y Y position in the host window
+ * @return The node's user data, or NULL if no node is hit
+ */
+void *compositor_hit_test(const Compositor *comp, int x, int y);
+
+/**
+ * @brief Route a host window pointer event to the node it belongs to
+ * @param comp Compositor (may be NULL)
+ * @param ev Event; rewritten in place when routed
+ * @return 1 if the event now targets a node, 0 if it was left untouched
+ *
+ * ButtonPress, ButtonRelease, MotionNotify, EnterNotify and LeaveNotify on
+ * the host window are hit-tested. A routed event's xany.window becomes the
+ * node's input id and its x/y become node-relative. A press grabs the node
+ * until the button is released, like the server's implicit grab. Hover
+ * changes produce LeaveNotify/EnterNotify for the nodes involved; the extra
+ * events are pushed back onto the queue with XPutBackEvent(). Every other
+ * event is left for the normal handlers.
+ */
+int compositor_route_event(Compositor *comp, XEvent *ev);
+
+#endif /* COMPOSITOR_H_ */
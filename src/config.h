@@ -40,6 +40,7 @@
 #include <stddef.h>
 #include <X11/Xlib.h>
 #include <X11/Xft/Xft.h>
+#include "layout.h"
 
 /* ========== TYPE DEFINITIONS ========== */
 
@@ -59,6 +60,12 @@ typedef enum {
 	BORDER_MODE_TRIADIC
 } BorderMode;
 
+/* Main window widget placement */
+typedef enum {
+	LAYOUT_MODE_FIXED = 0, /* Each widget at the x/y keys of its own section */
+	LAYOUT_MODE_AUTO       /* Rows and columns computed from [layout] */
+} LayoutMode;
+
 /* Complete configuration structure for the widget toolkit */
 typedef struct PixelPrismConfig {
 	/* Appearance - Entry (shared config for all entry types) */
@@ -142,6 +149,19 @@ typedef struct PixelPrismConfig {
 		int border_radius;
 	} swatch_widget;
 
+	/* Widget geometry - palette strip */
+	struct {
+		int palette_x, palette_y;
+		int width, height;
+		int padding;
+		int cell_size;
+		int cell_spacing;
+		int cell_radius;
+		int border_width;
+		int border_radius;
+		int max_colors;
+	} palette_widget;
+
 	/* Widget geometry - menubar */
 	struct {
 		int menubar_x, menubar_y;
@@ -178,6 +198,8 @@ typedef struct PixelPrismConfig {
 		int square_show;
 		int crosshair_show_after_pick;
 		int square_show_after_pick;
+		int region_colors; /* Dominant colors extracted from a dragged region */
+		int capture_thread; /* Capture the magnifier on its own thread and X connection */
 	} zoom_widget;
 
 	/* Appearance - Main window */
@@ -207,11 +229,29 @@ typedef struct PixelPrismConfig {
 		ConfigColor border;
 	} swatch;
 
+	/* Palette strip appearance (styling only - colors) */
+	struct {
+		ConfigColor bg;
+		ConfigColor border;
+		ConfigColor hover_border;
+	} palette;
+
 	/* Behavior - Cursor */
 	int cursor_blink_ms;
 	ConfigColor cursor_color;
 	int cursor_thickness;
 
+	/* Layout - widget placement in the main window */
+	struct {
+		LayoutMode mode;
+		int origin_x, origin_y; /* Top-left of the label/entry rows (auto) */
+		int row_spacing;        /* Gap between rows */
+		int column_spacing;     /* Gap between a label and its entry */
+		int tool_spacing;       /* Gap between swatch, palette and button */
+		LayoutAlign row_align;  /* Label/entry alignment within a row */
+		LayoutAlign tool_align; /* Swatch/palette/button alignment */
+	} widget_layout;
+
 	/* Layout - deprecated, kept for backward compat during transition */
 	struct {
 		char default_font_family[64];
@@ -245,12 +285,18 @@ typedef struct PixelPrismConfig {
 	int always_on_top;
 	int show_tray_icon;
 	int minimize_to_tray;
+	int single_window; /* Draw widgets through one compositor (read at startup) */
 
 	/* Clipboard Options */
 	int auto_copy;
 	char auto_copy_format[8]; /* hex, hsv, hsl, rgb, rgbi */
 	int hex_prefix; /* Include # symbol when copying hex */
 	int auto_copy_primary; /* Auto-copy selection to PRIMARY */
+	int clipboard_history_size; /* Copy history byte budget (0 = off) */
+
+	/* Color search */
+	double find_tolerance; /* Largest ΔEOK that still matches, times 100 */
+	int find_highlight_ms; /* How long matches stay outlined (0 = until the next search) */
 
 	/* Change tracking */
 	int config_changed; /* 0 = no changes, 1 = unsaved changes */
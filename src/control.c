@@ -0,0 +1,918 @@
+/* control.c - Unix Socket Control Server Implementation
+ *
+ * Line-oriented command server for driving a running instance from
+ * scripts. One epoll instance watches the listening socket and every
+ * client; the application only watches the epoll descriptor.
+ *
+ * Internal design notes:
+ * - Clients live in a slot table. A client id is (generation << 16) | slot,
+ *   so a reply for a client that has since disconnected (and whose slot
+ *   was reused) is detected instead of being delivered to a stranger.
+ * - Input is accumulated in a fixed per-client line buffer; each complete
+ *   line is tokenised in place and handed to the handler.
+ * - Replies are sent straight away; whatever the socket does not accept is
+ *   queued and EPOLLOUT is enabled until the queue drains.
+ * - Clients are only freed at the end of control_dispatch(), so pointers
+ *   held while walking the epoll batch stay valid.
+ * - The single-instance lock is a flock() on "<socket>.lock" rather than
+ *   the socket itself: two launches racing through startup cannot both see
+ *   "no instance" the way they could with a connect() probe alone.
+ * - Without XDG_RUNTIME_DIR the socket lives in /tmp/pixelprism-<uid>/, a
+ *   directory that must be ours and mode 0700. Another user can therefore
+ *   neither squat the path nor reach the socket. The socket is bound under
+ *   a 0177 umask, so it is never connectable by others even briefly.
+ * - Both ends check SO_PEERCRED. The server drops clients running as
+ *   another user, and the client side refuses to talk to a socket it does
+ *   not own.
+ */
+
+#define _GNU_SOURCE // accept4()
+
+#include "control.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/file.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+/* Longest accepted command line (including JSON framing) */
+#define CONTROL_LINE_MAX 4096
+
+/* epoll events handled per dispatch batch */
+#define CONTROL_MAX_EVENTS 32
+
+/* Pending connections queued by the kernel */
+#define CONTROL_BACKLOG 64
+
+/* Slots are addressed by the low 16 bits of a client id */
+#define CONTROL_MAX_CLIENTS 0xFFFF
+
+/* One connected client */
+typedef struct {
+	int fd;
+	unsigned int id;
+	int json; // Command being handled was JSON - answer in JSON
+	int dead; // Closed at the end of the current dispatch
+	int want_write; // EPOLLOUT currently enabled
+	int discarding; // Skipping the rest of an over-long line
+	char in[CONTROL_LINE_MAX];
+	size_t in_len;
+	char *out; // Queued reply bytes not yet accepted by the socket
+	size_t out_len;
+	size_t out_cap;
+} ControlClient;
+
+/* Control server */
+struct ControlServer {
+	int listen_fd;
+	int epoll_fd;
+	char path[sizeof(((struct sockaddr_un *)0)->sun_path)];
+	ControlCommandHandler handler;
+	void *user_data;
+
+	// Client slot table
+	ControlClient **slots;
+	unsigned int slot_count;
+	unsigned int generation;
+	int client_count;
+
+	// Counters
+	unsigned long commands;
+	unsigned long errors;
+	unsigned long connections;
+	double total_service_us;
+	double max_service_us;
+	struct timespec started;
+};
+
+/* ========== INTERNAL HELPERS ========== */
+
+static double elapsed_us(const struct timespec *from, const struct timespec *to) {
+	return (double)(to->tv_sec - from->tv_sec) * 1e6 + (double)(to->tv_nsec - from->tv_nsec) / 1e3;
+}
+
+static ControlClient *client_from_id(const ControlServer *server, unsigned int id) {
+	unsigned int slot = id & 0xFFFFu;
+	if (slot >= server->slot_count) {
+		return NULL;
+	}
+	ControlClient *c = server->slots[slot];
+	return (c && c->id == id && !c->dead) ? c : NULL;
+}
+
+static void set_want_write(ControlServer *server, ControlClient *c, int want) {
+	if (c->want_write == want) {
+		return;
+	}
+	struct epoll_event ev = {
+		.events = EPOLLIN | (want ? EPOLLOUT : 0),
+		.data.ptr = c
+	};
+	if (epoll_ctl(server->epoll_fd, EPOLL_CTL_MOD, c->fd, &ev) == 0) {
+		c->want_write = want;
+	}
+}
+
+/* Push queued output to the socket without blocking */
+static void flush_client(ControlServer *server, ControlClient *c) {
+	size_t sent = 0;
+	while (sent < c->out_len) {
+		ssize_t n = send(c->fd, c->out + sent, c->out_len - sent, MSG_NOSIGNAL);
+		if (n > 0) {
+			sent += (size_t)n;
+			continue;
+		}
+		if (n < 0 && errno == EINTR) {
+			continue;
+		}
+		if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+			break;
+		}
+		c->dead = 1;
+		return;
+	}
+	memmove(c->out, c->out + sent, c->out_len - sent);
+	c->out_len -= sent;
+	set_want_write(server, c, c->out_len > 0);
+}
+
+static int queue_output(ControlClient *c, const char *data, size_t len) {
+	if (c->out_len + len > c->out_cap) {
+		size_t cap = c->out_cap ? c->out_cap : 256;
+		while (cap < c->out_len + len) {
+			cap *= 2;
+		}
+		char *grown = realloc(c->out, cap);
+		if (!grown) {
+			return -1;
+		}
+		c->out = grown;
+		c->out_cap = cap;
+	}
+	memcpy(c->out + c->out_len, data, len);
+	c->out_len += len;
+	return 0;
+}
+
+/* Append text as a JSON string literal body (without quotes) */
+static int queue_json_escaped(ControlClient *c, const char *text) {
+	char buf[256];
+	size_t n = 0;
+	for (const unsigned char *p = (const unsigned char *)text; *p; p++) {
+		if (n + 6 >= sizeof(buf)) {
+			if (queue_output(c, buf, n) != 0) {
+				return -1;
+			}
+			n = 0;
+		}
+		if (*p == '"' || *p == '\\') {
+			buf[n++] = '\\';
+			buf[n++] = (char)*p;
+		}
+		else if (*p < 0x20) {
+			n += (size_t)snprintf(buf + n, sizeof(buf) - n, "\\u%04x", *p);
+		}
+		else {
+			buf[n++] = (char)*p;
+		}
+	}
+	return queue_output(c, buf, n);
+}
+
+static void close_client(ControlServer *server, ControlClient *c) {
+	epoll_ctl(server->epoll_fd, EPOLL_CTL_DEL, c->fd, NULL);
+	close(c->fd);
+	server->slots[c->id & 0xFFFFu] = NULL;
+	server->client_count--;
+	free(c->out);
+	free(c);
+}
+
+/* Whether the process at the other end of a Unix socket runs as our user */
+static int peer_is_us(int fd) {
+	struct ucred cred;
+	socklen_t len = sizeof(cred);
+	return getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &cred, &len) == 0 && cred.uid == getuid();
+}
+
+static void accept_clients(ControlServer *server) {
+	for (;;) {
+		int fd = accept4(server->listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+		if (fd < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			return; // EAGAIN: backlog drained (or a transient error)
+		}
+		if (!peer_is_us(fd)) {
+			close(fd);
+			continue;
+		}
+		// Find a free slot, growing the table when full
+		unsigned int slot = 0;
+		while (slot < server->slot_count && server->slots[slot]) {
+			slot++;
+		}
+		if (slot == server->slot_count) {
+			unsigned int cap = server->slot_count ? server->slot_count * 2 : 16;
+			if (cap > CONTROL_MAX_CLIENTS) {
+				cap = CONTROL_MAX_CLIENTS;
+			}
+			ControlClient **grown = cap > server->slot_count ? realloc(server->slots, cap * sizeof(*grown)) : NULL;
+			if (!grown) {
+				close(fd);
+				continue;
+			}
+			memset(grown + server->slot_count, 0, (cap - server->slot_count) * sizeof(*grown));
+			server->slots = grown;
+			server->slot_count = cap;
+		}
+		ControlClient *c = calloc(1, sizeof(ControlClient));
+		if (!c) {
+			close(fd);
+			continue;
+		}
+		c->fd = fd;
+		server->generation = (server->generation + 1) & 0xFFFFu;
+		if (server->generation == 0) {
+			server->generation = 1;
+		}
+		c->id = (server->generation << 16) | slot;
+		struct epoll_event ev = {
+			.events = EPOLLIN,
+			.data.ptr = c
+		};
+		if (epoll_ctl(server->epoll_fd, EPOLL_CTL_ADD, fd, &ev) != 0) {
+			close(fd);
+			free(c);
+			continue;
+		}
+		server->slots[slot] = c;
+		server->client_count++;
+		server->connections++;
+	}
+}
+
+/* ========== COMMAND PARSING ========== */
+
+/* Split a plain command line into words, in place */
+static int split_words(char *line, char **argv) {
+	int argc = 0;
+	char *save = NULL;
+	for (char *tok = strtok_r(line, " \t\r", &save); tok && argc < CONTROL_MAX_ARGS; tok = strtok_r(NULL, " \t\r", &save)) {
+		argv[argc++] = tok;
+	}
+	return argc;
+}
+
+static char *skip_ws(char *p) {
+	while (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n') {
+		p++;
+	}
+	return p;
+}
+
+/* Parse a JSON string starting at the opening quote, unescaping in place.
+ * Returns the NUL-terminated value and advances *pp past the closing quote. */
+static char *json_string(char **pp) {
+	char *p = *pp + 1;
+	char *out = p;
+	char *value = p;
+	while (*p && *p != '"') {
+		if (*p == '\\' && p[1]) {
+			p++;
+			switch (*p) {
+				case 'n': *out++ = '\n'; break;
+				case 't': *out++ = '\t'; break;
+				case 'r': *out++ = '\r'; break;
+				default: *out++ = *p; break; // \" \\ \/ (no \u support)
+			}
+			p++;
+			continue;
+		}
+		*out++ = *p++;
+	}
+	if (*p != '"') {
+		return NULL;
+	}
+	*out = '\0';
+	*pp = p + 1;
+	return value;
+}
+
+/* Parse one string or bare scalar (number, true, false, null), in place.
+ * The value is NUL-terminated; the structural character that followed it
+ * (',', ']', '}' or '\0') is stored in *delim and consumed. Objects and
+ * nested arrays are not supported. */
+static char *json_value(char **pp, char *delim) {
+	char *p = skip_ws(*pp);
+	char *value;
+	if (*p == '"') {
+		value = json_string(&p);
+		if (!value) {
+			return NULL;
+		}
+	}
+	else {
+		value = p;
+		while (*p && *p != ',' && *p != ']' && *p != '}' && *p != ' ' && *p != '\t' && *p != '"' && *p != '{' && *p != '[') {
+			p++;
+		}
+		if (p == value) {
+			return NULL;
+		}
+		if (*p == ' ' || *p == '\t') {
+			*p++ = '\0';
+		}
+	}
+	p = skip_ws(p);
+	*delim = *p;
+	if (*p != ',' && *p != ']' && *p != '}') {
+		return NULL;
+	}
+	*p++ = '\0';
+	*pp = p;
+	return value;
+}
+
+/* Parse {"cmd": "...", "args": [...]} into argv, in place */
+static int parse_json_command(char *line, char **argv) {
+	char *args[CONTROL_MAX_ARGS - 1];
+	int nargs = 0;
+	char *cmd = NULL;
+	char *p = skip_ws(line);
+	char delim = ',';
+	if (*p++ != '{') {
+		return 0;
+	}
+	p = skip_ws(p);
+	if (*p == '}') {
+		return 0;
+	}
+	while (delim == ',') {
+		p = skip_ws(p);
+		char *key = (*p == '"') ? json_string(&p) : NULL;
+		p = key ? skip_ws(p) : p;
+		if (!key || *p++ != ':') {
+			return 0;
+		}
+		p = skip_ws(p);
+		if (strcmp(key, "args") == 0 && *p == '[') {
+			p = skip_ws(p + 1);
+			delim = ',';
+			if (*p == ']') {
+				p++;
+			}
+			else {
+				while (delim == ',') {
+					char *v = json_value(&p, &delim);
+					if (!v || delim == '}') {
+						return 0;
+					}
+					if (nargs < CONTROL_MAX_ARGS - 1) {
+						args[nargs++] = v;
+					}
+				}
+			}
+			// Closing bracket consumed; find what follows the array
+			p = skip_ws(p);
+			delim = *p;
+			if (delim != ',' && delim != '}') {
+				return 0;
+			}
+			p++;
+		}
+		else {
+			char *v = json_value(&p, &delim);
+			if (!v || delim == ']') {
+				return 0;
+			}
+			if (strcmp(key, "cmd") == 0 || strcmp(key, "command") == 0) {
+				cmd = v;
+			}
+		}
+	}
+	if (!cmd || !*cmd) {
+		return 0;
+	}
+	argv[0] = cmd;
+	for (int i = 0; i < nargs; i++) {
+		argv[i + 1] = args[i];
+	}
+	return nargs + 1;
+}
+
+static void run_command(ControlServer *server, ControlClient *c, char *line) {
+	char *argv[CONTROL_MAX_ARGS];
+	char *p = skip_ws(line);
+	if (*p == '\0') {
+		return; // Blank line
+	}
+	c->json = (*p == '{');
+	int argc = c->json ? parse_json_command(p, argv) : split_words(p, argv);
+	if (argc <= 0) {
+		control_reply(server, c->id, 0, "malformed command");
+		return;
+	}
+	struct timespec t0, t1;
+	clock_gettime(CLOCK_MONOTONIC, &t0);
+	server->handler(server, c->id, argc, argv, server->user_data);
+	clock_gettime(CLOCK_MONOTONIC, &t1);
+	double us = elapsed_us(&t0, &t1);
+	server->commands++;
+	server->total_service_us += us;
+	if (us > server->max_service_us) {
+		server->max_service_us = us;
+	}
+}
+
+static void read_client(ControlServer *server, ControlClient *c) {
+	for (;;) {
+		if (c->in_len == sizeof(c->in)) {
+			// No newline within the limit: drop the line up to its end
+			c->in_len = 0;
+			if (!c->discarding) {
+				c->discarding = 1;
+				control_reply(server, c->id, 0, "line too long");
+			}
+		}
+		ssize_t n = recv(c->fd, c->in + c->in_len, sizeof(c->in) - c->in_len, 0);
+		if (n == 0) {
+			c->dead = 1;
+			return;
+		}
+		if (n < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			if (errno != EAGAIN && errno != EWOULDBLOCK) {
+				c->dead = 1;
+			}
+			return;
+		}
+		size_t start = 0;
+		size_t end = c->in_len + (size_t)n;
+		for (size_t i = c->in_len; i < end && !c->dead; i++) {
+			if (c->in[i] == '\n') {
+				c->in[i] = '\0';
+				if (c->discarding) {
+					c->discarding = 0;
+				}
+				else {
+					run_command(server, c, c->in + start);
+				}
+				start = i + 1;
+			}
+		}
+		memmove(c->in, c->in + start, end - start);
+		c->in_len = end - start;
+	}
+}
+
+/* ========== PUBLIC API ========== */
+
+/* Create dir if missing and make sure it is a private directory of ours */
+static int ensure_private_dir(const char *dir) {
+	if (mkdir(dir, 0700) != 0 && errno != EEXIST) {
+		fprintf(stderr, "control: cannot create %s: %s\n", dir, strerror(errno));
+		return -1;
+	}
+	struct stat st;
+	if (lstat(dir, &st) != 0 || !S_ISDIR(st.st_mode) || st.st_uid != getuid() || (st.st_mode & 077)) {
+		fprintf(stderr, "control: %s is not a private directory owned by this user\n", dir);
+		return -1;
+	}
+	return 0;
+}
+
+int control_default_path(char *out, size_t size) {
+	const char *runtime = getenv("XDG_RUNTIME_DIR");
+	int n;
+	if (runtime && *runtime) {
+		n = snprintf(out, size, "%s/pixelprism.sock", runtime);
+		return (n < 0 || (size_t)n >= size) ? -1 : 0;
+	}
+	char dir[64];
+	snprintf(dir, sizeof(dir), "/tmp/pixelprism-%u", (unsigned int)getuid());
+	if (ensure_private_dir(dir) != 0) {
+		return -1;
+	}
+	n = snprintf(out, size, "%s/pixelprism.sock", dir);
+	return (n < 0 || (size_t)n >= size) ? -1 : 0;
+}
+
+ControlServer *control_create(const char *path, ControlCommandHandler handler, void *user_data) {
+	if (!handler) {
+		return NULL;
+	}
+	ControlServer *server = calloc(1, sizeof(ControlServer));
+	if (!server) {
+		return NULL;
+	}
+	server->listen_fd = -1;
+	server->epoll_fd = -1;
+	server->handler = handler;
+	server->user_data = user_data;
+	clock_gettime(CLOCK_MONOTONIC, &server->started);
+
+	if (path) {
+		if (strlen(path) >= sizeof(server->path)) {
+			fprintf(stderr, "control: socket path too long: %s\n", path);
+			free(server);
+			return NULL;
+		}
+		strcpy(server->path, path);
+	}
+	else if (control_default_path(server->path, sizeof(server->path)) != 0) {
+		fprintf(stderr, "control: cannot build socket path\n");
+		free(server);
+		return NULL;
+	}
+
+	struct sockaddr_un addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strcpy(addr.sun_path, server->path);
+
+	server->listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if (server->listen_fd < 0) {
+		perror("control: socket");
+		control_destroy(server);
+		return NULL;
+	}
+	// The socket file is created 0600 by bind itself; no chmod window
+	mode_t old_umask = umask(0177);
+	int bound = bind(server->listen_fd, (struct sockaddr *)&addr, sizeof(addr));
+	if (bound != 0 && errno == EADDRINUSE) {
+		// Live instance or stale file? Only a live one accepts connections.
+		int probe = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+		int live = probe >= 0 && connect(probe, (struct sockaddr *)&addr, sizeof(addr)) == 0;
+		if (probe >= 0) {
+			close(probe);
+		}
+		if (live) {
+			umask(old_umask);
+			fprintf(stderr, "control: %s is in use by another instance\n", server->path);
+			server->path[0] = '\0';
+			control_destroy(server);
+			return NULL;
+		}
+		unlink(server->path);
+		bound = bind(server->listen_fd, (struct sockaddr *)&addr, sizeof(addr));
+	}
+	umask(old_umask);
+	if (bound != 0) {
+		perror("control: bind");
+		server->path[0] = '\0'; // Not ours - do not unlink
+		control_destroy(server);
+		return NULL;
+	}
+	if (listen(server->listen_fd, CONTROL_BACKLOG) != 0) {
+		perror("control: listen");
+		control_destroy(server);
+		return NULL;
+	}
+	server->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+	struct epoll_event ev = {
+		.events = EPOLLIN,
+		.data.ptr = NULL // NULL marks the listening socket
+	};
+	if (server->epoll_fd < 0 || epoll_ctl(server->epoll_fd, EPOLL_CTL_ADD, server->listen_fd, &ev) != 0) {
+		perror("control: epoll");
+		control_destroy(server);
+		return NULL;
+	}
+	return server;
+}
+
+void control_destroy(ControlServer *server) {
+	if (!server) {
+		return;
+	}
+	for (unsigned int i = 0; i < server->slot_count; i++) {
+		if (server->slots[i]) {
+			close_client(server, server->slots[i]);
+		}
+	}
+	free(server->slots);
+	if (server->epoll_fd >= 0) {
+		close(server->epoll_fd);
+	}
+	if (server->listen_fd >= 0) {
+		close(server->listen_fd);
+	}
+	if (server->path[0]) {
+		unlink(server->path);
+	}
+	free(server);
+}
+
+int control_get_fd(const ControlServer *server) {
+	return server ? server->epoll_fd : -1;
+}
+
+void control_dispatch(ControlServer *server) {
+	if (!server) {
+		return;
+	}
+	struct epoll_event events[CONTROL_MAX_EVENTS];
+	int n;
+	do {
+		n = epoll_wait(server->epoll_fd, events, CONTROL_MAX_EVENTS, 0);
+	} while (n < 0 && errno == EINTR);
+	for (int i = 0; i < n; i++) {
+		ControlClient *c = events[i].data.ptr;
+		if (!c) {
+			accept_clients(server);
+			continue;
+		}
+		if (!c->dead && (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR))) {
+			read_client(server, c);
+		}
+		if (!c->dead && (events[i].events & EPOLLOUT)) {
+			flush_client(server, c);
+		}
+	}
+	// Replies issued from handlers may have marked other clients dead too
+	for (unsigned int i = 0; i < server->slot_count; i++) {
+		if (server->slots[i] && server->slots[i]->dead) {
+			close_client(server, server->slots[i]);
+		}
+	}
+}
+
+/* Queue one reply line in the given format */
+static int reply_client(ControlServer *server, ControlClient *c, int json, int ok, const char *text) {
+	if (!text) {
+		text = "";
+	}
+	int rc;
+	if (json) {
+		const char *head = ok ? "{\"ok\": true, \"result\": \"" : "{\"ok\": false, \"error\": \"";
+		rc = queue_output(c, head, strlen(head));
+		rc |= queue_json_escaped(c, text);
+		rc |= queue_output(c, "\"}\n", 3);
+	}
+	else {
+		rc = queue_output(c, ok ? "OK " : "ERR ", ok ? 3 : 4);
+		rc |= queue_output(c, text, strlen(text));
+		rc |= queue_output(c, "\n", 1);
+	}
+	if (rc != 0) {
+		c->dead = 1;
+		return -1;
+	}
+	if (!ok) {
+		server->errors++;
+	}
+	flush_client(server, c);
+	return c->dead ? -1 : 0;
+}
+
+int control_reply(ControlServer *server, unsigned int client_id, int ok, const char *text) {
+	if (!server) {
+		return -1;
+	}
+	ControlClient *c = client_from_id(server, client_id);
+	if (!c) {
+		return -1;
+	}
+	return reply_client(server, c, c->json, ok, text);
+}
+
+ControlReplyTo control_reply_to(const ControlServer *server, unsigned int client_id) {
+	ControlReplyTo to = {client_id, 0};
+	const ControlClient *c = server ? client_from_id(server, client_id) : NULL;
+	if (c) {
+		to.json = c->json;
+	}
+	return to;
+}
+
+int control_reply_later(ControlServer *server, ControlReplyTo to, int ok, const char *text) {
+	if (!server) {
+		return -1;
+	}
+	ControlClient *c = client_from_id(server, to.client_id);
+	if (!c) {
+		return -1;
+	}
+	return reply_client(server, c, to.json, ok, text);
+}
+
+void control_get_stats(const ControlServer *server, ControlStats *out) {
+	if (!server || !out) {
+		return;
+	}
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	out->commands = server->commands;
+	out->errors = server->errors;
+	out->connections = server->connections;
+	out->clients = server->client_count;
+	out->avg_service_us = server->commands ? server->total_service_us / (double)server->commands : 0.0;
+	out->max_service_us = server->max_service_us;
+	out->uptime_s = elapsed_us(&server->started, &now) / 1e6;
+}
+
+/* ========== SINGLE INSTANCE ========== */
+
+int control_lock_instance(const char *socket_path) {
+	char lock_path[sizeof(((struct sockaddr_un *)0)->sun_path) + 8];
+	int n = snprintf(lock_path, sizeof(lock_path), "%s.lock", socket_path);
+	if (n < 0 || (size_t)n >= sizeof(lock_path)) {
+		return -2;
+	}
+	int fd = open(lock_path, O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+	if (fd < 0) {
+		fprintf(stderr, "control: cannot open %s: %s\n", lock_path, strerror(errno));
+		return -2;
+	}
+	if (flock(fd, LOCK_EX | LOCK_NB) != 0) {
+		int held = (errno == EWOULDBLOCK);
+		close(fd);
+		return held ? -1 : -2;
+	}
+	return fd;
+}
+
+static long long monotonic_ms(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/* Append s as a quoted JSON string; returns -1 if it does not fit */
+static int append_json_string(char *buf, size_t size, size_t *len, const char *s) {
+	if (*len + 1 >= size) {
+		return -1;
+	}
+	buf[(*len)++] = '"';
+	for (const unsigned char *p = (const unsigned char *)s; *p; p++) {
+		if (*len + 7 >= size) {
+			return -1;
+		}
+		if (*p == '"' || *p == '\\') {
+			buf[(*len)++] = '\\';
+			buf[(*len)++] = (char)*p;
+		}
+		else if (*p < 0x20) {
+			*len += (size_t)snprintf(buf + *len, size - *len, "\\u%04x", *p);
+		}
+		else {
+			buf[(*len)++] = (char)*p;
+		}
+	}
+	if (*len + 1 >= size) {
+		return -1;
+	}
+	buf[(*len)++] = '"';
+	buf[*len] = '\0';
+	return 0;
+}
+
+/* Connect, retrying while the primary instance has not started listening */
+static int connect_instance(const char *path, int timeout_ms) {
+	struct sockaddr_un addr;
+	if (strlen(path) >= sizeof(addr.sun_path)) {
+		return -1;
+	}
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strcpy(addr.sun_path, path);
+	long long deadline = monotonic_ms() + timeout_ms;
+	for (;;) {
+		int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+		if (fd < 0) {
+			return -1;
+		}
+		if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) == 0) {
+			if (peer_is_us(fd)) {
+				return fd;
+			}
+			fprintf(stderr, "control: %s is served by another user; not forwarding\n", path);
+			close(fd);
+			return -1;
+		}
+		int err = errno;
+		close(fd);
+		if ((err != ENOENT && err != ECONNREFUSED && err != EAGAIN) || monotonic_ms() >= deadline) {
+			return -1;
+		}
+		usleep(10000);
+	}
+}
+
+/* Copy the result/error string of a JSON reply line into out, unescaped */
+static int parse_reply(const char *line, char *out, size_t size) {
+	int ok = strncmp(line, "{\"ok\": true", 11) == 0;
+	const char *p = strstr(line, ok ? "\"result\": \"" : "\"error\": \"");
+	size_t n = 0;
+	if (p) {
+		p = strchr(p + 2, ':') + 3;
+		for (; *p && *p != '"' && n + 1 < size; p++) {
+			if (*p == '\\' && p[1]) {
+				p++;
+				if (*p == 'u') {
+					// Control characters only - render as a space
+					out[n++] = ' ';
+					for (int k = 0; k < 4 && p[1]; k++) {
+						p++;
+					}
+					continue;
+				}
+			}
+			out[n++] = *p;
+		}
+	}
+	if (size) {
+		out[n] = '\0';
+	}
+	return ok;
+}
+
+int control_send(const char *path, int argc, const char *const *argv, char *reply, size_t size, int timeout_ms) {
+	char line[CONTROL_LINE_MAX];
+	size_t len = 0;
+	if (argc < 1) {
+		return -1;
+	}
+	strcpy(line, "{\"cmd\": ");
+	len = strlen(line);
+	int rc = append_json_string(line, sizeof(line), &len, argv[0]);
+	if (rc == 0 && len + 12 < sizeof(line)) {
+		strcpy(line + len, ", \"args\": [");
+		len += strlen(line + len);
+	}
+	for (int i = 1; rc == 0 && i < argc; i++) {
+		if (i > 1 && len + 2 < sizeof(line)) {
+			line[len++] = ',';
+			line[len++] = ' ';
+		}
+		rc = append_json_string(line, sizeof(line), &len, argv[i]);
+	}
+	if (rc != 0 || len + 3 >= sizeof(line)) {
+		fprintf(stderr, "control: command too long\n");
+		return -1;
+	}
+	memcpy(line + len, "]}\n", 3);
+	len += 3;
+
+	int fd = connect_instance(path, timeout_ms);
+	if (fd < 0) {
+		return -1;
+	}
+	size_t sent = 0;
+	while (sent < len) {
+		ssize_t n = send(fd, line + sent, len - sent, MSG_NOSIGNAL);
+		if (n < 0 && errno == EINTR) {
+			continue;
+		}
+		if (n <= 0) {
+			close(fd);
+			return -1;
+		}
+		sent += (size_t)n;
+	}
+	if (!reply) {
+		close(fd);
+		return 1;
+	}
+
+	// Read one reply line
+	char in[CONTROL_LINE_MAX];
+	size_t in_len = 0;
+	long long deadline = monotonic_ms() + timeout_ms;
+	for (;;) {
+		char *nl = memchr(in, '\n', in_len);
+		if (nl) {
+			*nl = '\0';
+			break;
+		}
+		long long left = deadline - monotonic_ms();
+		struct pollfd pfd = { .fd = fd, .events = POLLIN };
+		if (left <= 0 || in_len + 1 >= sizeof(in) || poll(&pfd, 1, (int)left) <= 0) {
+			close(fd);
+			return -1;
+		}
+		ssize_t n = recv(fd, in + in_len, sizeof(in) - 1 - in_len, 0);
+		if (n <= 0) {
+			if (n < 0 && errno == EINTR) {
+				continue;
+			}
+			close(fd);
+			return -1;
+		}
+		in_len += (size_t)n;
+	}
+	close(fd);
+	return parse_reply(in, reply, size);
+}
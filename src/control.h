@@ -0,0 +1,213 @@
+#ifndef CONTROL_H_
+#define CONTROL_H_
+
+/* ========== CONTROL SOCKET INTERFACE ========== */
+
+/**
+ * @file control.h
+ * @brief Unix domain socket command server for a running instance
+ *
+ * Lets scripts talk to an already running PixelPrism instead of starting a
+ * new GUI process. The server listens on a Unix socket (by default
+ * $XDG_RUNTIME_DIR/pixelprism.sock) and multiplexes every client through a
+ * single epoll instance, so the main loop only has to watch one descriptor.
+ *
+ * Protocol: one command per line, either plain words or a JSON object.
+ *
+ *   get hex                          -> OK #FF8040
+ *   {"cmd": "get", "args": ["hex"]}  -> {"ok": true, "result": "#FF8040"}
+ *
+ * Failures answer "ERR <message>" or {"ok": false, "error": "..."}.
+ * Replies are written in the style of the request they answer.
+ *
+ * All sockets are non-blocking. Partial lines are buffered per client and
+ * replies that do not fit the socket buffer are queued and flushed when the
+ * client becomes writable, so a slow reader never stalls the event loop.
+ *
+ * Dependencies:
+ * - Linux epoll, POSIX sockets
+ *
+ * Usage:
+ *   1. Create server: control_create(path, handler, user_data)
+ *   2. Add control_get_fd(server) to the main loop's select() set
+ *   3. When readable, call control_dispatch(server); the handler is invoked
+ *      once per complete command and answers with control_reply(). To answer
+ *      later, keep control_reply_to() from inside the handler and pass it to
+ *      control_reply_later() (the client id stays valid until disconnect)
+ *   4. Cleanup: control_destroy(server)
+ *
+ * Single instance:
+ *   control_lock_instance() takes an exclusive lock next to the socket. The
+ *   process holding it owns the socket; later launches hand their request
+ *   to it with control_send() and exit without touching X.
+ *
+ * Thread safety: Not thread-safe (call from the main loop only)
+ * This module has no X11 dependency.
+ */
+
+#include <stddef.h>
+
+/* ========== TYPE DEFINITIONS ========== */
+
+/* Opaque server handle */
+typedef struct ControlServer ControlServer;
+
+/* Maximum number of words in one command */
+#define CONTROL_MAX_ARGS 16
+
+/**
+ * Command callback
+ * @param server Server that received the command
+ * @param client_id Id to pass to control_reply()
+ * @param argc Number of words (argv[0] is the command name, argc >= 1)
+ * @param argv Words of the command, valid only during the call
+ * @param user_data User data passed to control_create()
+ */
+typedef void (*ControlCommandHandler)(ControlServer *server, unsigned int client_id, int argc, char **argv, void *user_data);
+
+/* Where a deferred reply goes and in which format (see control_reply_to()) */
+typedef struct {
+	unsigned int client_id;
+	int json; /* The command was JSON - answer in JSON */
+} ControlReplyTo;
+
+/* Server counters reported by the "stats" command */
+typedef struct {
+	unsigned long commands; /* Commands dispatched */
+	unsigned long errors; /* Malformed or failed commands */
+	unsigned long connections; /* Clients accepted since start */
+	int clients; /* Currently connected clients */
+	double avg_service_us; /* Mean handler time per command */
+	double max_service_us; /* Slowest handler call */
+	double uptime_s; /* Seconds since control_create() */
+} ControlStats;
+
+/* ========== LIFECYCLE MANAGEMENT ========== */
+
+/**
+ * @brief Build the default socket path
+ * @param out Destination buffer
+ * @param size Size of out
+ *
+ * Uses $XDG_RUNTIME_DIR/pixelprism.sock, or
+ * /tmp/pixelprism-<uid>/pixelprism.sock when XDG_RUNTIME_DIR is unset. In
+ * the latter case the directory is created with mode 0700 and refused if
+ * it belongs to someone else or is accessible to others.
+ *
+ * @return 0 on success, -1 if the path does not fit or the directory is
+ *         not private
+ */
+int control_default_path(char *out, size_t size);
+
+/**
+ * @brief Create the control server and start listening
+ * @param path Socket path (NULL for control_default_path())
+ * @param handler Command callback
+ * @param user_data Passed to handler
+ *
+ * A stale socket left by a crashed instance is replaced; a socket that
+ * still accepts connections belongs to a live instance and is left alone.
+ * The socket is created with mode 0600, and clients running as another
+ * user are disconnected on accept.
+ *
+ * @return Server, or NULL on failure
+ */
+ControlServer *control_create(const char *path, ControlCommandHandler handler, void *user_data);
+
+/**
+ * @brief Close all clients, remove the socket file and free the server
+ * @param server Server to destroy
+ */
+void control_destroy(ControlServer *server);
+
+/* ========== EVENT HANDLING ========== */
+
+/**
+ * @brief Get the descriptor to watch for readability
+ * @param server Control server
+ * @return epoll descriptor, or -1
+ */
+int control_get_fd(const ControlServer *server);
+
+/**
+ * @brief Accept clients, read commands and flush queued replies
+ * @param server Control server
+ *
+ * Never blocks. Invokes the handler for each complete command line.
+ */
+void control_dispatch(ControlServer *server);
+
+/**
+ * @brief Answer a command
+ * @param server Control server
+ * @param client_id Id passed to the handler
+ * @param ok 1 for success, 0 for an error reply
+ * @param text Result (ok) or error message (not ok)
+ *
+ * @return 0 if queued or sent, -1 if the client has disconnected
+ */
+int control_reply(ControlServer *server, unsigned int client_id, int ok, const char *text);
+
+/**
+ * @brief Remember how to answer the command being handled
+ * @param server Control server
+ * @param client_id Id passed to the handler
+ *
+ * Call from the handler. The result keeps the command's reply format, so a
+ * deferred answer is not formatted for whatever the client sent next.
+ */
+ControlReplyTo control_reply_to(const ControlServer *server, unsigned int client_id);
+
+/**
+ * @brief Answer a command after its handler has returned
+ * @param server Control server
+ * @param to Result of control_reply_to() for that command
+ * @param ok 1 for success, 0 for an error reply
+ * @param text Result (ok) or error message (not ok)
+ *
+ * @return 0 if queued or sent, -1 if the client has disconnected
+ */
+int control_reply_later(ControlServer *server, ControlReplyTo to, int ok, const char *text);
+
+/**
+ * @brief Read server counters
+ * @param server Control server
+ * @param out Receives the counters
+ */
+void control_get_stats(const ControlServer *server, ControlStats *out);
+
+/* ========== SINGLE INSTANCE ========== */
+
+/**
+ * @brief Try to become the primary instance
+ * @param socket_path Control socket path; the lock file is "<path>.lock"
+ *
+ * The lock is released automatically when the process exits, so a crashed
+ * instance never blocks the next launch.
+ *
+ * @return Lock descriptor (keep open for the life of the process) if this
+ *         process is now primary, -1 if another instance holds the lock,
+ *         -2 if the lock file cannot be used (run without single-instance)
+ */
+int control_lock_instance(const char *socket_path);
+
+/**
+ * @brief Send one command to a running instance
+ * @param path Control socket path
+ * @param argc Number of words (argv[0] is the command name)
+ * @param argv Command words; sent as a JSON command so words may contain
+ *             spaces
+ * @param reply Receives the result or error text (NULL: do not wait for
+ *              the reply, e.g. for "pick")
+ * @param size Size of reply
+ * @param timeout_ms How long to retry the connection while the primary
+ *                   instance is still starting, and how long to wait for
+ *                   the reply
+ *
+ * @return 1 if the command succeeded (or was sent, when reply is NULL),
+ *         0 if the instance answered with an error, -1 if no instance
+ *         could be reached
+ */
+int control_send(const char *path, int argc, const char *const *argv, char *reply, size_t size, int timeout_ms);
+
+#endif /* CONTROL_H_ */
@@ -17,8 +17,23 @@
  *
  * Internal design notes:
  * - Text is stored as UTF-8; selection indices are byte offsets.
- * - Undo/redo uses a ring buffer of snapshots rather than incremental deltas.
+ * - Undo/redo records edit deltas (position, removed bytes, inserted bytes)
+ *   in a fixed ring of steps whose text lives in one per-entry byte arena.
+ *   Consecutive typing coalesces into one step; the oldest steps are evicted
+ *   when either the ring or the arena is full. All text changes go through
+ *   edit_replace() so the deltas stay exact; entry_set_text() records its
+ *   replacement as one step that typing never coalesces into. Only
+ *   entry_set_text_no_undo() bypasses the history, for transient text that
+ *   the caller puts back before the user can undo.
  * - Cursor blink timing is driven by gettimeofday to avoid global timers.
+ * - Full redraws snapshot the caret-free frame into a text layer pixmap;
+ *   blink toggles restore or draw just the caret column (see blink_caret()).
+ * - Prefix pixel widths are cached per text and font (see text_x()), so
+ *   hit-testing is a binary search and drawing never re-measures prefixes.
+ * - Created with a compositor, the entry has no window: win is the node's
+ *   input id, the back pixmap is drawn as before and entry_paint() copies it
+ *   into the compositor's frame with the border on top. Focus and clipboard
+ *   ownership then use the parent window.
  */
 
 #include "entry.h"
@@ -44,6 +59,20 @@
 /* forward from header */
 void entry_draw(struct MiniEntry *e);
 
+#define UNDO_ARENA_SIZE 16384 // Bytes of removed/inserted text kept per entry
+
+/* One undoable edit: text[pos..pos+removed_len) was replaced by inserted_len
+ * bytes. The payload (removed bytes, then inserted bytes) starts at arena
+ * offset off, counted monotonically and wrapped modulo UNDO_ARENA_SIZE. */
+typedef struct {
+	size_t off;
+	int pos;
+	int removed_len;
+	int inserted_len;
+} UndoStep;
+
+static void entry_paint(Drawable target, int x, int y, void *user_data);
+
 /* ========== SAFE HELPERS ========== */
 static void *safe_realloc(void *p, size_t n) {
 	void *q = p ? realloc(p, n) : malloc(n);
@@ -101,6 +130,11 @@ struct MiniEntry {
 	ContextMenu *menu;
 	GC gc;
 
+	// Compositor node (comp is NULL for an entry with its own window)
+	Compositor *comp;
+	int node;
+	Cursor pointer_cursor; // Node pointer cursor, freed on destroy
+
 	// Back buffers (Pixmaps)
 	Pixmap back_pixmap; // entry buffer
 	
@@ -109,6 +143,11 @@ struct MiniEntry {
 	XdbeBackBuffer dbe_back_buffer;
 	int use_dbe; // 1 if DBE is available and initialized
 
+	// Caret-free copy of the last full frame, used for blink-only repaints
+	Pixmap text_layer;
+	int text_layer_valid;
+	int caret_x, caret_y, caret_h; // Caret column of the last full frame
+
 	// Xft
 	XftDraw *draw;
 	XftFont *font;
@@ -149,13 +188,17 @@ struct MiniEntry {
 	int last_click_x;
 	int click_count;
 
-	// Undo/Redo
-	char **undo_stack;
+	// Undo/Redo: steps[first .. first+count) (mod capacity), the first
+	// undo_top of them applied; the rest can be redone
+	UndoStep *undo_steps;
 	int undo_capacity;
+	int undo_first;
+	int undo_count;
 	int undo_top;
-	char **redo_stack;
-	int redo_capacity;
-	int redo_top;
+	int undo_typing; // Newest step is an open typing run
+	char *undo_arena;
+	size_t arena_tail; // Offset of the oldest payload
+	size_t arena_head; // Offset past the newest payload
 
 	// Focus/blink
 	int is_focused;
@@ -169,6 +212,12 @@ struct MiniEntry {
 	// Scrolling
 	int scroll_x;
 
+	// Prefix advance cache: adv[i] = pixel width of text[0..i)
+	int *adv;
+	char *adv_text; // Copy of the text the cache was built for
+	int adv_len; // Cached text length, -1 when invalid
+	int adv_cap;
+
 	// Clipboard
 	ClipboardContext *clipboard_ctx;
 	Atom XA_CLIPBOARD; // Still needed for Ctrl+V detection
@@ -178,6 +227,7 @@ struct MiniEntry {
 
 	// Validation and callbacks
 	MiniEntryCallback on_change;
+	MiniEntryCallback on_edit;
 	void *user_data;
 	int validation_state; // 0=normal, 1=invalid(red), 2=valid_flash(green)
 	long long validation_flash_start;
@@ -286,6 +336,16 @@ static Pixmap create_back_pixmap(Display *dpy, Window parent, int w, int h, int
 	return XCreatePixmap(dpy, parent, (unsigned int)w, (unsigned int)h, (unsigned int)DefaultDepth(dpy, screen));
 }
 
+/* Real window behind the entry: its own, or the parent for a compositor node */
+static Window surface_window(const struct MiniEntry *e) {
+	return e->comp ? e->parent : e->win;
+}
+
+/* Keep the compositor node on the entry's rectangle */
+static void sync_node(struct MiniEntry *e) {
+	compositor_set_node_bounds(e->comp, e->node, e->x, e->y, e->w, e->h);
+}
+
 static void recreate_entry_buffers(struct MiniEntry *e) {
 	// Clean up existing buffers
 	if (e->back_pixmap) {
@@ -296,8 +356,8 @@ static void recreate_entry_buffers(struct MiniEntry *e) {
 		e->dbe_back_buffer = None;
 	}
 	
-	// Initialize DBE if available
-	if (e->dbe_ctx && dbe_is_supported(e->dbe_ctx)) {
+	// Initialize DBE if available (a compositor node has no window to swap)
+	if (!e->comp && e->dbe_ctx && dbe_is_supported(e->dbe_ctx)) {
 		e->dbe_back_buffer = dbe_allocate_back_buffer(e->dbe_ctx, e->win, XdbeUndefined);
 		e->use_dbe = (e->dbe_back_buffer != None);
 	} else {
@@ -306,10 +366,16 @@ static void recreate_entry_buffers(struct MiniEntry *e) {
 	
 	// Create pixmap fallback if DBE is not available
 	if (!e->use_dbe) {
-		e->back_pixmap = create_back_pixmap(e->dpy, e->win, e->w, e->h, e->screen);
+		e->back_pixmap = create_back_pixmap(e->dpy, surface_window(e), e->w, e->h, e->screen);
 	} else {
 		e->back_pixmap = None;
 	}
+
+	if (e->text_layer) {
+		XFreePixmap(e->dpy, e->text_layer);
+	}
+	e->text_layer = create_back_pixmap(e->dpy, surface_window(e), e->w, e->h, e->screen);
+	e->text_layer_valid = 0;
 	
 	// Recreate XftDraw context
 	if (e->draw) {
@@ -393,35 +459,195 @@ static void reserve_text(struct MiniEntry *e, int need) {
 	e->text_cap = cap;
 }
 
+/* ========== GLYPH ADVANCE CACHE ========== */
+static void advances_invalidate(struct MiniEntry *e) {
+	e->adv_len = -1;
+}
+
+/* Byte length of the UTF-8 sequence starting with lead byte c */
+static int utf8_seq_len(unsigned char c) {
+	if (c >= 0xF0) {
+		return 4;
+	}
+	if (c >= 0xE0) {
+		return 3;
+	}
+	if (c >= 0xC0) {
+		return 2;
+	}
+	return 1;
+}
+
+/* Rebuild the prefix advance array if the text or font changed.
+ * One extents call per character instead of one per prefix. */
+static void advances_update(struct MiniEntry *e) {
+	ensure_text_len(e);
+	int len = e->text_len;
+	if (e->adv_len == len && memcmp(e->adv_text, e->text, (size_t)len) == 0) {
+		return;
+	}
+	if (len + 1 > e->adv_cap) {
+		e->adv_cap = len + 1 > 32 ? len + 1 : 32;
+		e->adv = safe_realloc(e->adv, sizeof(int) * (size_t)e->adv_cap);
+		e->adv_text = safe_realloc(e->adv_text, (size_t)e->adv_cap);
+	}
+	memcpy(e->adv_text, e->text, (size_t)len);
+	e->adv[0] = 0;
+	for (int i = 0; i < len;) {
+		int clen = utf8_seq_len((unsigned char)e->text[i]);
+		if (clen > len - i) {
+			clen = len - i;
+		}
+		XGlyphInfo g;
+		XftTextExtentsUtf8(e->dpy, e->font, (const FcChar8 *)e->text + i, clen, &g);
+		// Offsets inside a multi-byte character map to its start
+		for (int k = 1; k < clen; k++) {
+			e->adv[i + k] = e->adv[i];
+		}
+		e->adv[i + clen] = e->adv[i] + g.xOff;
+		i += clen;
+	}
+	e->adv_len = len;
+}
+
+/* Pixel width of text[0..index) */
+static int text_x(struct MiniEntry *e, int index) {
+	advances_update(e);
+	if (index < 0) {
+		index = 0;
+	}
+	if (index > e->adv_len) {
+		index = e->adv_len;
+	}
+	return e->adv[index];
+}
+
 /* ========== UNDO/REDO ========== */
-static void undo_push(struct MiniEntry *e) {
-	ensure_text(e);
-	if (e->undo_top >= e->undo_capacity) {
-		free(e->undo_stack[0]);
-		memmove(e->undo_stack, e->undo_stack + 1, sizeof(char *) * (size_t)(e->undo_capacity - 1));
-		e->undo_top = e->undo_capacity - 1;
+static UndoStep *undo_step(struct MiniEntry *e, int i) {
+	return &e->undo_steps[(e->undo_first + i) % e->undo_capacity];
+}
+
+static void arena_put(struct MiniEntry *e, size_t off, const char *src, int len) {
+	for (int i = 0; i < len; i++) {
+		e->undo_arena[(off + (size_t)i) % UNDO_ARENA_SIZE] = src[i];
+	}
+}
+
+static void arena_get(struct MiniEntry *e, size_t off, char *dst, int len) {
+	for (int i = 0; i < len; i++) {
+		dst[i] = e->undo_arena[(off + (size_t)i) % UNDO_ARENA_SIZE];
+	}
+}
+
+static void undo_clear(struct MiniEntry *e) {
+	e->undo_first = e->undo_count = e->undo_top = 0;
+	e->undo_typing = 0;
+	e->arena_tail = e->arena_head = 0;
+}
+
+static void undo_evict_oldest(struct MiniEntry *e) {
+	e->undo_first = (e->undo_first + 1) % e->undo_capacity;
+	e->undo_count--;
+	e->undo_top--;
+	e->arena_tail = e->undo_count ? undo_step(e, 0)->off : e->arena_head;
+}
+
+/* Record that text[pos..pos+len) is about to be replaced by ins[0..ilen).
+ * Typed characters that continue the newest step are appended to it. */
+static void undo_record(struct MiniEntry *e, int pos, int len, const char *ins, int ilen, int typing) {
+	if (e->undo_capacity <= 0) {
+		return;
+	}
+	// A new edit discards everything that could have been redone
+	if (e->undo_count > e->undo_top) {
+		e->undo_count = e->undo_top;
+		if (e->undo_top) {
+			UndoStep *top = undo_step(e, e->undo_top - 1);
+			e->arena_head = top->off + (size_t)(top->removed_len + top->inserted_len);
+		}
+		else {
+			e->arena_head = e->arena_tail;
+		}
+		e->undo_typing = 0;
+	}
+	size_t need = (size_t)len + (size_t)ilen;
+	if (need > UNDO_ARENA_SIZE) {
+		undo_clear(e); // Cannot be undone; older steps no longer apply
+		return;
 	}
-	e->undo_stack[e->undo_top++] = safe_strdup(e->text);
-	for (int i = 0; i < e->redo_top; i++) {
-		free(e->redo_stack[i]);
+	if (typing && len == 0 && e->undo_typing && e->undo_top) {
+		UndoStep *top = undo_step(e, e->undo_top - 1);
+		if (pos == top->pos + top->inserted_len && e->arena_head - e->arena_tail + need <= UNDO_ARENA_SIZE) {
+			arena_put(e, e->arena_head, ins, ilen);
+			e->arena_head += need;
+			top->inserted_len += ilen;
+			return;
+		}
+	}
+	while (e->undo_count && (e->undo_count == e->undo_capacity || e->arena_head - e->arena_tail + need > UNDO_ARENA_SIZE)) {
+		undo_evict_oldest(e);
+	}
+	UndoStep *st = undo_step(e, e->undo_count);
+	st->off = e->arena_head;
+	st->pos = pos;
+	st->removed_len = len;
+	st->inserted_len = ilen;
+	arena_put(e, st->off, e->text + pos, len);
+	arena_put(e, st->off + (size_t)len, ins, ilen);
+	e->arena_head += need;
+	e->undo_count++;
+	e->undo_top = e->undo_count;
+	e->undo_typing = typing;
+}
+
+/* Replace len bytes at pos with ilen bytes; returns the start of the gap */
+static char *text_splice(struct MiniEntry *e, int pos, int len, int ilen) {
+	reserve_text(e, e->text_len - len + ilen + 1);
+	memmove(e->text + pos + ilen, e->text + pos + len, (size_t)(e->text_len - pos - len + 1));
+	e->text_len += ilen - len;
+	return e->text + pos;
+}
+
+/* Apply a replacement without recording it, leaving a collapsed cursor
+ * after the inserted text */
+static void apply_replace(struct MiniEntry *e, int pos, int len, const char *ins, int ilen) {
+	char *gap = text_splice(e, pos, len, ilen);
+	if (ilen) {
+		memcpy(gap, ins, (size_t)ilen);
+	}
+	e->cursor = pos + ilen;
+	e->sel_anchor = e->sel_active = e->cursor;
+}
+
+/* The single entry point for edits: records the delta, then applies it */
+static void edit_replace(struct MiniEntry *e, int pos, int len, const char *ins, int ilen, int typing) {
+	ensure_text_len(e);
+	undo_record(e, pos, len, ins, ilen, typing);
+	apply_replace(e, pos, len, ins, ilen);
+}
+
+/* edit_replace() for changes made by the user; reports them through on_edit */
+static void user_edit(struct MiniEntry *e, int pos, int len, const char *ins, int ilen, int typing) {
+	edit_replace(e, pos, len, ins, ilen, typing);
+	if (e->on_edit) {
+		e->on_edit(e, e->user_data);
 	}
-	e->redo_top = 0;
 }
 
 static void do_undo(struct MiniEntry *e) {
-	ensure_text(e);
+	ensure_text_len(e);
 	if (!e->undo_top) {
 		return;
 	}
-	char *cur = safe_strdup(e->text);
-	e->redo_stack[e->redo_top++] = cur;
-	free(e->text);
-	e->text = e->undo_stack[--e->undo_top];
-	e->text_len = (int)strlen(e->text);
-	e->text_cap = e->text_len + 1;
-	if (e->cursor > e->text_len) {
-		e->cursor = e->text_len;
+	UndoStep *st = undo_step(e, e->undo_top - 1);
+	if (st->pos + st->inserted_len > e->text_len) {
+		undo_clear(e); // Text was replaced behind the history's back
+		return;
 	}
+	e->undo_top--;
+	arena_get(e, st->off, text_splice(e, st->pos, st->inserted_len, st->removed_len), st->removed_len);
+	e->undo_typing = 0;
+	e->cursor = st->pos + st->removed_len;
 	e->sel_anchor = e->sel_active = e->cursor;
 	if (e->on_change) {
 		e->on_change(e, e->user_data);
@@ -429,19 +655,19 @@ static void do_undo(struct MiniEntry *e) {
 }
 
 static void do_redo(struct MiniEntry *e) {
-	ensure_text(e);
-	if (!e->redo_top) {
+	ensure_text_len(e);
+	if (e->undo_top >= e->undo_count) {
 		return;
 	}
-	char *cur = safe_strdup(e->text);
-	e->undo_stack[e->undo_top++] = cur;
-	free(e->text);
-	e->text = e->redo_stack[--e->redo_top];
-	e->text_len = (int)strlen(e->text);
-	e->text_cap = e->text_len + 1;
-	if (e->cursor > e->text_len) {
-		e->cursor = e->text_len;
+	UndoStep *st = undo_step(e, e->undo_top);
+	if (st->pos + st->removed_len > e->text_len) {
+		undo_clear(e); // Text was replaced behind the history's back
+		return;
 	}
+	e->undo_top++;
+	arena_get(e, st->off + (size_t)st->removed_len, text_splice(e, st->pos, st->removed_len, st->inserted_len), st->inserted_len);
+	e->undo_typing = 0;
+	e->cursor = st->pos + st->inserted_len;
 	e->sel_anchor = e->sel_active = e->cursor;
 	if (e->on_change) {
 		e->on_change(e, e->user_data);
@@ -454,6 +680,7 @@ static void update_fonts(struct MiniEntry *e) {
 		XftFontClose(e->dpy, e->font);
 	}
 	e->font = open_font(e->dpy, e->screen, e->entry_blk->font_family, e->entry_blk->font_size);
+	advances_invalidate(e);
 
 	int pad = e->padding;
 	int new_h = e->font->ascent + e->font->descent + pad * 2 + 2;
@@ -462,7 +689,12 @@ static void update_fonts(struct MiniEntry *e) {
 	}
 	if (new_h != e->h) {
 		e->h = new_h;
-		XResizeWindow(e->dpy, e->win, (unsigned)e->w, (unsigned)e->h);
+		if (e->comp) {
+			sync_node(e);
+		}
+		else {
+			XResizeWindow(e->dpy, e->win, (unsigned)e->w, (unsigned)e->h);
+		}
 	}
 }
 
@@ -497,7 +729,7 @@ static void draw_entry_bg(struct MiniEntry *e) {
 	damage_all(e);
 }
 
-static void draw_entry_border(struct MiniEntry *e) {
+static void draw_entry_border(struct MiniEntry *e, Drawable d, int ox, int oy) {
 	unsigned long border_color = e->px_border;
 	// Validation states take priority over focus
 	if (e->validation_state == 1) {
@@ -519,7 +751,7 @@ static void draw_entry_border(struct MiniEntry *e) {
 	XSetForeground(e->dpy, e->gc, border_color);
 	XSetLineAttributes(e->dpy, e->gc, (unsigned int)bw, LineSolid, CapButt, JoinMiter);
 	int inset = bw / 2;
-	draw_rounded_rect(e->dpy, e->win, e->gc, inset, inset, e->w - bw, e->h - bw, radius);
+	draw_rounded_rect(e->dpy, d, e->gc, ox + inset, oy + inset, e->w - bw, e->h - bw, radius);
 }
 
 static void draw_selection(struct MiniEntry *e) {
@@ -534,11 +766,8 @@ static void draw_selection(struct MiniEntry *e) {
 		b = t;
 	}
 	int pad = e->padding;
-	XGlyphInfo A, B;
-	XftTextExtentsUtf8(e->dpy, e->font, (const FcChar8 *)e->text, a, &A);
-	XftTextExtentsUtf8(e->dpy, e->font, (const FcChar8 *)e->text, b, &B);
-	int x0 = pad + 2 + A.xOff - e->scroll_x;
-	int x1 = pad + 2 + B.xOff - e->scroll_x;
+	int x0 = pad + 2 + text_x(e, a) - e->scroll_x;
+	int x1 = pad + 2 + text_x(e, b) - e->scroll_x;
 
 	// --- Centered baseline calculation (visual vertical alignment fix) ---
 	int text_h = e->font->ascent + e->font->descent;
@@ -591,17 +820,13 @@ static void draw_text_and_cursor(struct MiniEntry *e) {
 		}
 		// Selected text with different color
 		if (b > a) {
-			XGlyphInfo ext_before;
-			XftTextExtentsUtf8(e->dpy, e->font, (const FcChar8 *)e->text, a, &ext_before);
-			int sel_x = x_offset + ext_before.xOff;
+			int sel_x = x_offset + text_x(e, a);
 
 			XftDrawStringUtf8(e->draw, &e->xft_selection_text, e->font, sel_x, baseline, (const FcChar8 *)(e->text + a), b - a);
 		}
 		// After selection
 		if (b < e->text_len) {
-			XGlyphInfo ext_before_end;
-			XftTextExtentsUtf8(e->dpy, e->font, (const FcChar8 *)e->text, b, &ext_before_end);
-			int after_x = x_offset + ext_before_end.xOff;
+			int after_x = x_offset + text_x(e, b);
 
 			XftDrawStringUtf8(e->draw, &e->xft_fg, e->font, after_x, baseline, (const FcChar8 *)(e->text + b), e->text_len - b);
 		}
@@ -611,19 +836,25 @@ static void draw_text_and_cursor(struct MiniEntry *e) {
 		XftDrawStringUtf8(e->draw, &e->xft_fg, e->font, x_offset, baseline, (const FcChar8 *)e->text, e->text_len);
 	}
 	damage_add(e, 1, 1, e->w - 2, e->h - 2);
+	e->text_layer_valid = 0;
 	// Caret - only show if focused AND window has focus
 	if (e->is_focused && e->window_has_focus) {
-		int n = e->cursor;
-		XGlyphInfo ext;
-		XftTextExtentsUtf8(e->dpy, e->font, (const FcChar8 *)e->text, n, &ext);
-		int cx = pad + 2 + ext.xOff - e->scroll_x;
+		int cx = pad + 2 + text_x(e, e->cursor) - e->scroll_x;
 		int cy0 = baseline - e->font->ascent;
 		int cy1 = baseline + e->font->descent;
 		int thickness = e->theme.cursor_thickness;
+		Drawable draw_target = e->use_dbe ? e->dbe_back_buffer : e->back_pixmap;
+		// Keep the caret-free frame so blinking can restore the caret column
+		if (e->text_layer) {
+			XCopyArea(e->dpy, draw_target, e->text_layer, e->gc, 0, 0, (unsigned)e->w, (unsigned)e->h, 0, 0);
+			e->caret_x = cx;
+			e->caret_y = cy0;
+			e->caret_h = cy1 - cy0 + 1;
+			e->text_layer_valid = 1;
+		}
 		if (e->is_cursor_visible) {
 			XSetForeground(e->dpy, e->gc, e->cursor_color_px);
 			for (int i = 0; i < thickness; i++) {
-				Drawable draw_target = e->use_dbe ? e->dbe_back_buffer : e->back_pixmap;
 				XDrawLine(e->dpy, draw_target, e->gc, cx + i, cy0, cx + i, cy1);
 			}
 		}
@@ -638,6 +869,12 @@ static void blit_damage(struct MiniEntry *e) {
 	if (!e->draw) {
 		return;
 	}
+	if (e->comp) {
+		// Copied into the compositor's next frame by entry_paint()
+		compositor_damage_node(e->comp, e->node);
+		damage_reset(e);
+		return;
+	}
 	
 	// Use DBE swap if available, otherwise fallback to pixmap copy
 	if (e->use_dbe) {
@@ -650,7 +887,7 @@ static void blit_damage(struct MiniEntry *e) {
 	}
 
 	// Draw border directly to window after buffer swap/copy
-	draw_entry_border(e);
+	draw_entry_border(e, e->win, 0, 0);
 
 	XFlush(e->dpy);
 	damage_reset(e);
@@ -663,6 +900,12 @@ static void blit_damage_noflush(struct MiniEntry *e) {
 	if (!e->draw) {
 		return;
 	}
+	if (e->comp) {
+		// Copied into the compositor's next frame by entry_paint()
+		compositor_damage_node(e->comp, e->node);
+		damage_reset(e);
+		return;
+	}
 	
 	// Use DBE swap if available, otherwise fallback to pixmap copy
 	if (e->use_dbe) {
@@ -675,12 +918,50 @@ static void blit_damage_noflush(struct MiniEntry *e) {
 	}
 
 	// Draw border directly to window after buffer swap/copy
-	draw_entry_border(e);
+	draw_entry_border(e, e->win, 0, 0);
 
 	// XFlush skipped - caller will flush once for all widgets to present atomically
 	damage_reset(e);
 }
 
+/* Compositor paint callback: the back pixmap holds the whole entry, so it is
+ * copied at the node's position and the border drawn on top */
+static void entry_paint(Drawable target, int x, int y, void *user_data) {
+	struct MiniEntry *e = (struct MiniEntry *)user_data;
+	if (!e->back_pixmap) {
+		return;
+	}
+	XCopyArea(e->dpy, e->back_pixmap, target, e->gc, 0, 0, (unsigned)e->w, (unsigned)e->h, x, y);
+	draw_entry_border(e, target, x, y);
+}
+
+/* Repaint only the caret column after a blink toggle. The column is restored
+ * from the text layer and the caret drawn on top when visible. With DBE the
+ * back buffer is undefined after a swap, so the column goes straight to the
+ * window; otherwise it goes through the back pixmap and blit_damage(). */
+static void blink_caret(struct MiniEntry *e) {
+	if (!e->text_layer_valid || !e->draw) {
+		entry_draw(e);
+		return;
+	}
+	int thickness = e->theme.cursor_thickness;
+	int cx = e->caret_x, cy0 = e->caret_y, ch = e->caret_h;
+	Drawable target = e->use_dbe ? e->win : e->back_pixmap;
+	XCopyArea(e->dpy, e->text_layer, target, e->gc, cx - 1, cy0, (unsigned)(thickness + 2), (unsigned)ch, cx - 1, cy0);
+	if (e->is_cursor_visible) {
+		XSetForeground(e->dpy, e->gc, e->cursor_color_px);
+		for (int i = 0; i < thickness; i++) {
+			XDrawLine(e->dpy, target, e->gc, cx + i, cy0, cx + i, cy0 + ch - 1);
+		}
+	}
+	if (e->use_dbe) {
+		XFlush(e->dpy);
+		return;
+	}
+	damage_add(e, cx - 1, cy0, thickness + 2, ch);
+	blit_damage(e);
+}
+
 static void redraw(struct MiniEntry *e) {
 	draw_entry_bg(e);
 	draw_selection(e);
@@ -723,10 +1004,7 @@ static void delete_selection(struct MiniEntry *e) {
 		a = b;
 		b = t;
 	}
-	memmove(e->text + a, e->text + b, (size_t)(e->text_len - b + 1));
-	e->text_len -= (b - a);
-	e->cursor = a;
-	e->sel_anchor = e->sel_active = a;
+	user_edit(e, a, b - a, NULL, 0, 0);
 }
 
 /* ========== VALIDATION ========== */
@@ -772,9 +1050,7 @@ static int validate_char(struct MiniEntry *e, char ch, char *out) {
 
 static void ensure_cursor_visible(struct MiniEntry *e) {
 	int pad = e->padding;
-	XGlyphInfo ext;
-	XftTextExtentsUtf8(e->dpy, e->font, (const FcChar8 *)e->text, e->cursor, &ext);
-	int cursor_x = pad + 2 + ext.xOff;
+	int cursor_x = pad + 2 + text_x(e, e->cursor);
 
 	int visible_w = e->w - pad * 2;
 	int right_edge = e->scroll_x + visible_w - 8;
@@ -789,9 +1065,7 @@ static void ensure_cursor_visible(struct MiniEntry *e) {
 		e->scroll_x = 0;
 	}
 	// clamp to max (no overscroll to blank)
-	XGlyphInfo te;
-	XftTextExtentsUtf8(e->dpy, e->font, (const FcChar8 *)e->text, e->text_len, &te);
-	int text_w = te.xOff;
+	int text_w = text_x(e, e->text_len);
 	int max_scroll = text_w - visible_w;
 	if (max_scroll < 0) {
 		max_scroll = 0;
@@ -855,7 +1129,7 @@ static void update_selection_clipboard(struct MiniEntry *e) {
 	}
 	if (e->sel_anchor == e->sel_active) {
 		// No selection - clear PRIMARY
-		clipboard_set_text(e->clipboard_ctx, e->win, NULL, SELECTION_PRIMARY);
+		clipboard_set_text(e->clipboard_ctx, surface_window(e), NULL, SELECTION_PRIMARY);
 	}
 	else {
 		// Selection exists - auto-copy to PRIMARY
@@ -866,7 +1140,7 @@ static void update_selection_clipboard(struct MiniEntry *e) {
 			b = t;
 		}
 		char *text = safe_strndup(e->text + a, (size_t)(b - a));
-		clipboard_set_text(e->clipboard_ctx, e->win, text, SELECTION_PRIMARY);
+		clipboard_set_text(e->clipboard_ctx, surface_window(e), text, SELECTION_PRIMARY);
 		free(text);
 	}
 }
@@ -888,12 +1162,11 @@ static void copy_selection(struct MiniEntry *e, int cut) {
 	char *text = safe_strndup(e->text + a, (size_t)(b - a));
 
 	// Copy to both CLIPBOARD and PRIMARY
-	clipboard_set_text(e->clipboard_ctx, e->win, text, SELECTION_CLIPBOARD);
-	clipboard_set_text(e->clipboard_ctx, e->win, text, SELECTION_PRIMARY);
+	clipboard_set_text(e->clipboard_ctx, surface_window(e), text, SELECTION_CLIPBOARD);
+	clipboard_set_text(e->clipboard_ctx, surface_window(e), text, SELECTION_PRIMARY);
 
 	free(text);
 	if (cut) {
-		undo_push(e);
 		delete_selection(e);
 		entry_draw(e);
 	}
@@ -939,18 +1212,13 @@ static void filtered_paste(struct MiniEntry *e, const unsigned char *data) {
 		free(out);
 		return;
 	}
-	undo_push(e);
-	if (e->sel_anchor != e->sel_active) {
-		delete_selection(e);
-	}
-	if (e->text_len + o + 1 > e->text_cap) {
-		e->text = (char *)safe_realloc(e->text, (size_t)(e->text_len + o + 1));
-		e->text_cap = e->text_len + o + 1;
+	int a = e->sel_anchor, b = e->sel_active;
+	if (a > b) {
+		int t = a;
+		a = b;
+		b = t;
 	}
-	memmove(e->text + e->cursor + o, e->text + e->cursor, (size_t)(e->text_len - e->cursor + 1));
-	memcpy(e->text + e->cursor, out, (size_t)o);
-	e->text_len += o;
-	e->cursor += o;
+	user_edit(e, a, b - a, out, o, 0);
 	free(out);
 	ensure_cursor_visible(e);
 	entry_draw(e);
@@ -975,22 +1243,26 @@ static void paste_callback(const char *text, void *user_data) {
 static void paste_request(struct MiniEntry *e, Atom which) {
 	SelectionType type = (which == e->XA_CLIPBOARD) ?
 	                     SELECTION_CLIPBOARD : SELECTION_PRIMARY;
-	clipboard_request_text(e->clipboard_ctx, e->win, paste_callback, e, type);
+	clipboard_request_text(e->clipboard_ctx, surface_window(e), paste_callback, e, type);
 }
 
 /* ========== MAPPING x->index ========== */
+/* First index whose prefix ends right of x (binary search over the
+ * non-decreasing advance array) */
 static int x_to_index(struct MiniEntry *e, int x) {
-	ensure_text_len(e);
-	int pad = e->padding;
-	for (int i = 0; i <= e->text_len; i++) {
-		XGlyphInfo ext;
-		XftTextExtentsUtf8(e->dpy, e->font, (const FcChar8 *)e->text, i, &ext);
-		int pos = pad + 2 + ext.xOff;
-		if (x < pos) {
-			return i;
+	advances_update(e);
+	int target = x - (e->padding + 2);
+	int lo = 0, hi = e->adv_len + 1;
+	while (lo < hi) {
+		int mid = lo + (hi - lo) / 2;
+		if (e->adv[mid] > target) {
+			hi = mid;
+		}
+		else {
+			lo = mid + 1;
 		}
 	}
-	return e->text_len;
+	return lo > e->adv_len ? e->adv_len : lo;
 }
 
 /* ========== PUBLIC API ========== */
@@ -1001,7 +1273,7 @@ static int x_to_index(struct MiniEntry *e, int x) {
  * See entry.h for full documentation.
  * Initializes entry window, context menu, undo/redo buffers, and event handling.
  */
-MiniEntry *entry_create(Display *dpy, int screen, Window parent, const MiniTheme *theme, const MiniEntryConfig *cfg, ClipboardContext *clipboard_ctx) {
+MiniEntry *entry_create(Display *dpy, int screen, Window parent, const MiniTheme *theme, const MiniEntryConfig *cfg, ClipboardContext *clipboard_ctx, Compositor *compositor) {
 	struct MiniEntry *e = (struct MiniEntry *)calloc(1, sizeof(*e));
 	if (!e) {
 		return NULL;
@@ -1013,6 +1285,7 @@ MiniEntry *entry_create(Display *dpy, int screen, Window parent, const MiniTheme
 	e->cfg = *cfg;
 	e->clipboard_ctx = clipboard_ctx;
 	e->scroll_x = 0;
+	e->adv_len = -1;
 	e->window_has_focus = 1; // Assume window has focus initially
 	switch (cfg->kind) {
 		case ENTRY_TEXT:
@@ -1040,21 +1313,21 @@ MiniEntry *entry_create(Display *dpy, int screen, Window parent, const MiniTheme
 	e->text_cap = 1;
 	e->cursor = 0;
 	e->sel_anchor = e->sel_active = 0;
-	e->undo_capacity = e->theme.undo_depth;
-	e->redo_capacity = e->theme.undo_depth;
-	e->undo_stack = (char **)calloc((size_t)e->undo_capacity, sizeof(char *));
-	e->redo_stack = (char **)calloc((size_t)e->redo_capacity, sizeof(char *));
-	if (!e->undo_stack || !e->redo_stack) {
-		free(e->undo_stack);
-		free(e->redo_stack);
+	e->undo_capacity = e->theme.undo_depth > 0 ? e->theme.undo_depth : 0;
+	e->undo_steps = (UndoStep *)calloc((size_t)e->undo_capacity + 1, sizeof(UndoStep));
+	e->undo_arena = (char *)malloc(UNDO_ARENA_SIZE);
+	if (!e->undo_steps || !e->undo_arena) {
+		free(e->undo_steps);
+		free(e->undo_arena);
 		free(e->text);
 		free(e);
 		return NULL;
 	}
-	e->undo_top = e->redo_top = 0;
+	undo_clear(e);
 	e->XA_CLIPBOARD = XInternAtom(dpy, "CLIPBOARD", False);
 
 	e->on_change = cfg->on_change;
+	e->on_edit = cfg->on_edit;
 	e->user_data = cfg->user_data;
 	e->validation_state = 0;
 	e->validation_flash_start = 0;
@@ -1064,23 +1337,40 @@ MiniEntry *entry_create(Display *dpy, int screen, Window parent, const MiniTheme
 	e->dbe_back_buffer = None;
 	e->use_dbe = 0;
 
-	// Windows
-	XSetWindowAttributes a;
-	a.event_mask = ExposureMask | ButtonPressMask | ButtonReleaseMask | PointerMotionMask |
-	               KeyPressMask | FocusChangeMask | StructureNotifyMask | PropertyChangeMask |
-	               SubstructureNotifyMask;
-	a.background_pixmap = None;
-	
-	e->win = XCreateWindow(dpy, parent, e->x, e->y, (unsigned)e->w, (unsigned)e->h, 0,
-	                       CopyFromParent, InputOutput, CopyFromParent,
-	                       CWEventMask | CWBackPixmap, &a);
+	// Compositor node, or a window of its own
+	if (compositor) {
+		e->node = compositor_add_node(compositor, entry_paint, e);
+		if (e->node >= 0) {
+			e->comp = compositor;
+			e->win = compositor_node_window(compositor, e->node);
+			sync_node(e);
+		}
+	}
+	if (!e->comp) {
+		XSetWindowAttributes a;
+		a.event_mask = ExposureMask | ButtonPressMask | ButtonReleaseMask | PointerMotionMask |
+		               KeyPressMask | FocusChangeMask | StructureNotifyMask | PropertyChangeMask |
+		               SubstructureNotifyMask;
+		a.background_pixmap = None;
 
-	e->gc = XCreateGC(dpy, e->win, 0, NULL);
+		e->win = XCreateWindow(dpy, parent, e->x, e->y, (unsigned)e->w, (unsigned)e->h, 0,
+		                       CopyFromParent, InputOutput, CopyFromParent,
+		                       CWEventMask | CWBackPixmap, &a);
+	}
+
+	e->gc = XCreateGC(dpy, surface_window(e), 0, NULL);
 
-	// Set I-beam cursor for text entry
+	// Set I-beam cursor for text entry (the compositor shows a node's cursor
+	// on the host window while the pointer is over it)
 	Cursor text_cursor = XCreateFontCursor(dpy, XC_xterm);
-	XDefineCursor(dpy, e->win, text_cursor);
-	XFreeCursor(dpy, text_cursor);
+	if (e->comp) {
+		e->pointer_cursor = text_cursor;
+		compositor_set_node_cursor(e->comp, e->node, text_cursor);
+	}
+	else {
+		XDefineCursor(dpy, e->win, text_cursor);
+		XFreeCursor(dpy, text_cursor);
+	}
 
 	// Menu
 	e->menu = menu_create(dpy, screen, &e->theme);
@@ -1095,7 +1385,9 @@ MiniEntry *entry_create(Display *dpy, int screen, Window parent, const MiniTheme
 
 	damage_reset(e);
 
-	XMapWindow(dpy, e->win);
+	if (!e->comp) {
+		XMapWindow(dpy, e->win);
+	}
 
 	// Force an initial paint so widgets appear immediately
 	entry_draw(e);
@@ -1133,23 +1425,26 @@ void entry_destroy(struct MiniEntry *e) {
 	if (e->back_pixmap) {
 		XFreePixmap(e->dpy, e->back_pixmap);
 	}
+	if (e->text_layer) {
+		XFreePixmap(e->dpy, e->text_layer);
+	}
 	if (e->font) {
 		XftFontClose(e->dpy, e->font);
 	}
 	if (e->gc) {
 		XFreeGC(e->dpy, e->gc);
 	}
-	if (e->win) {
-		XDestroyWindow(e->dpy, e->win);
+	if (e->comp) {
+		compositor_remove_node(e->comp, e->node);
+		XFreeCursor(e->dpy, e->pointer_cursor);
 	}
-	for (int i = 0; i < e->undo_top; i++) {
-		free(e->undo_stack[i]);
-	}
-	for (int i = 0; i < e->redo_top; i++) {
-		free(e->redo_stack[i]);
+	else if (e->win) {
+		XDestroyWindow(e->dpy, e->win);
 	}
-	free(e->undo_stack);
-	free(e->redo_stack);
+	free(e->undo_steps);
+	free(e->undo_arena);
+	free(e->adv);
+	free(e->adv_text);
 	free(e->text);
 	free(e);
 }
@@ -1182,7 +1477,7 @@ void entry_focus(struct MiniEntry *e, int f) {
 		e->is_cursor_visible = 1;
 		e->last_blink_ms = get_time_ms();
 
-		XSetInputFocus(e->dpy, e->win, RevertToNone, CurrentTime);
+		XSetInputFocus(e->dpy, surface_window(e), RevertToNone, CurrentTime);
 	}
 	else {
 		if (focused_entry == e) {
@@ -1268,14 +1563,24 @@ void entry_set_theme_noflush(struct MiniEntry *e, const MiniTheme *theme) {
 void entry_move(struct MiniEntry *e, int x, int y) {
 	e->x = x;
 	e->y = y;
-	XMoveWindow(e->dpy, e->win, x, y);
+	if (e->comp) {
+		sync_node(e);
+	}
+	else {
+		XMoveWindow(e->dpy, e->win, x, y);
+	}
 	entry_draw(e);
 }
 
 void entry_move_noflush(struct MiniEntry *e, int x, int y) {
 	e->x = x;
 	e->y = y;
-	XMoveWindow(e->dpy, e->win, x, y);
+	if (e->comp) {
+		sync_node(e);
+	}
+	else {
+		XMoveWindow(e->dpy, e->win, x, y);
+	}
 	entry_draw_noflush(e);
 }
 
@@ -1292,7 +1597,12 @@ void entry_resize(struct MiniEntry *e, int w, int h) {
 	}
 	e->w = w;
 	e->h = h;
-	XResizeWindow(e->dpy, e->win, (unsigned)w, (unsigned)h);
+	if (e->comp) {
+		sync_node(e);
+	}
+	else {
+		XResizeWindow(e->dpy, e->win, (unsigned)w, (unsigned)h);
+	}
 	recreate_entry_buffers(e);
 	entry_draw(e);
 }
@@ -1309,34 +1619,97 @@ void entry_resize_noflush(struct MiniEntry *e, int w, int h) {
 	}
 	e->w = w;
 	e->h = h;
-	XResizeWindow(e->dpy, e->win, (unsigned)w, (unsigned)h);
+	if (e->comp) {
+		sync_node(e);
+	}
+	else {
+		XResizeWindow(e->dpy, e->win, (unsigned)w, (unsigned)h);
+	}
 	recreate_entry_buffers(e);
 	entry_draw_noflush(e);
 }
 
-void entry_set_text(struct MiniEntry *e, const char *t) {
+void entry_set_bounds_noflush(struct MiniEntry *e, int x, int y, int w, int h) {
+	if (w <= 0) {
+		w = e->w;
+	}
+	if (h <= 0) {
+		h = e->h;
+	}
+	XWindowChanges changes;
+	unsigned int mask = 0;
+	if (x != e->x) {
+		changes.x = x;
+		mask |= CWX;
+	}
+	if (y != e->y) {
+		changes.y = y;
+		mask |= CWY;
+	}
+	if (w != e->w) {
+		changes.width = w;
+		mask |= CWWidth;
+	}
+	if (h != e->h) {
+		changes.height = h;
+		mask |= CWHeight;
+	}
+	if (!mask) {
+		return;
+	}
+	e->x = x;
+	e->y = y;
+	e->w = w;
+	e->h = h;
+	if (e->comp) {
+		sync_node(e);
+	}
+	else {
+		XConfigureWindow(e->dpy, e->win, mask, &changes);
+	}
+	if (mask & (CWWidth | CWHeight)) {
+		recreate_entry_buffers(e);
+		entry_draw_noflush(e);
+	}
+}
+
+void entry_get_size(const struct MiniEntry *e, int *w, int *h) {
+	*w = e ? e->w : 0;
+	*h = e ? e->h : 0;
+}
+
+/* Replace the whole text programmatically, as one undo step when record is
+ * set (none if unchanged). on_edit is not called: this is not a user edit. */
+static void set_text(struct MiniEntry *e, const char *t, int record) {
 	if (!t) {
 		t = "";
 	}
-	free(e->text);
-	e->text = safe_strdup(t);
-	e->text_len = (int)strlen(e->text);
-	e->text_cap = e->text_len + 1;
+	ensure_text_len(e);
+	if (strcmp(e->text, t) != 0) {
+		if (record) {
+			edit_replace(e, 0, e->text_len, t, (int)strlen(t), 0);
+		}
+		else {
+			apply_replace(e, 0, e->text_len, t, (int)strlen(t));
+			e->undo_typing = 0;
+		}
+	}
 	e->cursor = e->text_len;
 	e->sel_anchor = e->sel_active = e->cursor;
+}
+
+void entry_set_text(struct MiniEntry *e, const char *t) {
+	set_text(e, t, 1);
 	entry_draw(e);
 }
 
 void entry_set_text_no_draw(struct MiniEntry *e, const char *t) {
-	if (!t) {
-		t = "";
-	}
-	free(e->text);
-	e->text = safe_strdup(t);
-	e->text_len = (int)strlen(e->text);
-	e->text_cap = e->text_len + 1;
-	e->cursor = e->text_len;
-	e->sel_anchor = e->sel_active = e->cursor;
+	set_text(e, t, 1);
+	// No draw - caller will handle
+}
+
+void entry_set_text_no_undo(struct MiniEntry *e, const char *t) {
+	set_text(e, t, 0);
 	// No draw - caller will handle
 }
 
@@ -1355,19 +1728,20 @@ static void insert_char(struct MiniEntry *e, char ch) {
 	if (!validate_char(e, ch, &out)) {
 		return;
 	}
-	undo_push(e);
-	if (e->sel_anchor != e->sel_active) {
-		delete_selection(e);
+	int a = e->sel_anchor, b = e->sel_active;
+	if (a > b) {
+		int t = a;
+		a = b;
+		b = t;
 	}
-	// Check max_len after deleting selection
-	if (e->cfg.max_length > 0 && e->text_len >= e->cfg.max_length) {
+	// Check max_len as if the selection were already deleted
+	if (e->cfg.max_length > 0 && e->text_len - (b - a) >= e->cfg.max_length) {
+		delete_selection(e);
+		entry_draw(e);
 		return;
 	}
-	reserve_text(e, e->text_len + 2);
-	memmove(e->text + e->cursor + 1, e->text + e->cursor, (size_t)(e->text_len - e->cursor + 1));
-	e->text[e->cursor] = out;
-	e->text_len++;
-	e->cursor++;
+	// The typed character replaces the selection in a single undo step
+	user_edit(e, a, b - a, &out, 1, 1);
 	ensure_cursor_visible(e);
 	entry_draw(e);
 }
@@ -1375,16 +1749,12 @@ static void insert_char(struct MiniEntry *e, char ch) {
 static void do_backspace(struct MiniEntry *e) {
 	ensure_text_len(e);
 	if (e->sel_anchor != e->sel_active) {
-		undo_push(e);
 		delete_selection(e);
 		entry_draw(e);
 		return;
 	}
 	if (e->cursor > 0) {
-		undo_push(e);
-		memmove(e->text + e->cursor - 1, e->text + e->cursor, (size_t)(e->text_len - e->cursor + 1));
-		e->text_len--;
-		e->cursor--;
+		user_edit(e, e->cursor - 1, 1, NULL, 0, 0);
 		ensure_cursor_visible(e);
 		entry_draw(e);
 	}
@@ -1393,15 +1763,12 @@ static void do_backspace(struct MiniEntry *e) {
 static void do_delete(struct MiniEntry *e) {
 	ensure_text_len(e);
 	if (e->sel_anchor != e->sel_active) {
-		undo_push(e);
 		delete_selection(e);
 		entry_draw(e);
 		return;
 	}
 	if (e->cursor < e->text_len) {
-		undo_push(e);
-		memmove(e->text + e->cursor, e->text + e->cursor + 1, (size_t)(e->text_len - e->cursor));
-		e->text_len--;
+		user_edit(e, e->cursor, 1, NULL, 0, 0);
 		ensure_cursor_visible(e);
 		entry_draw(e);
 	}
@@ -1537,7 +1904,8 @@ static void key_shortcuts(struct MiniEntry *e, XKeyEvent *kev) {
 			do_delete(e);
 		break;
 		default:
-			if (n == 1 && (unsigned char)buf[0] >= 32 && (unsigned char)buf[0] < 127) {
+			// Ctrl+key combinations are shortcuts (e.g. Ctrl+1..9 history), never text
+			if (!ctrl && n == 1 && (unsigned char)buf[0] >= 32 && (unsigned char)buf[0] < 127) {
 				insert_char(e, buf[0]);
 			}
 		break;
@@ -1556,7 +1924,7 @@ int entry_handle_event(struct MiniEntry *e, XEvent *ev) {
 		int can_select_all = (e->text_len > 0); // Can select all if there's text
 		int can_clear = (e->text_len > 0);
 		int can_undo = e->undo_top > 0;
-		int can_redo = e->redo_top > 0;
+		int can_redo = e->undo_top < e->undo_count;
 		int act = menu_handle_event(e->menu, ev, can_cut, can_copy, can_paste, can_select_all, can_clear, can_undo, can_redo);
 		if (act >= 0) {
 			switch (act) {
@@ -1578,13 +1946,7 @@ int entry_handle_event(struct MiniEntry *e, XEvent *ev) {
 				break;
 				case 4: // Clear
 					if (can_clear) {
-						undo_push(e);
-						free(e->text);
-						e->text = safe_strdup("");
-						e->text_len = 0;
-						e->text_cap = 1;
-						e->cursor = 0;
-						e->sel_anchor = e->sel_active = 0;
+						user_edit(e, 0, e->text_len, NULL, 0, 0);
 						// Ensure entry remains focused after clear
 						focused_entry = e;
 						e->is_focused = 1;
@@ -1724,9 +2086,7 @@ int entry_handle_event(struct MiniEntry *e, XEvent *ev) {
 				e->scroll_x = 0;
 			}
 			// clamp right
-			XGlyphInfo ext;
-			XftTextExtentsUtf8(e->dpy, e->font, (const FcChar8 *)e->text, e->text_len, &ext);
-			int text_w = ext.xOff;
+			int text_w = text_x(e, e->text_len);
 			int visible_w = e->w - e->padding * 2;
 			int max_scroll = text_w - visible_w;
 			if (max_scroll < 0) {
@@ -1795,7 +2155,7 @@ void entry_update_blink(struct MiniEntry *e) {
 	if (now - e->last_blink_ms >= blink_interval) {
 		e->is_cursor_visible = !e->is_cursor_visible;
 		e->last_blink_ms = now;
-		entry_draw(e);
+		blink_caret(e);
 	}
 }
 
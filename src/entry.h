@@ -27,9 +27,10 @@
  * - clipboard.h (copy/paste operations)
  * - context.h (right-click menu)
  * - config.h (EntryBlock styling)
+ * - compositor.h (optional single-window rendering)
  *
  * Usage:
- *   1. Create entry: entry_create(display, screen, parent, theme, config, clipboard)
+ *   1. Create entry: entry_create(display, screen, parent, theme, config, clipboard, NULL)
  *   2. Handle events: entry_handle_event(entry, &event) in main loop
  *   3. Get/set text: entry_get_text(entry) / entry_set_text(entry, "text")
  *   4. Validation: entry_set_validation_state(entry, state) to track state
@@ -45,6 +46,7 @@
 #include <X11/Xft/Xft.h>
 #include "config.h"
 #include "clipboard.h"
+#include "compositor.h"
 
 /* ========== ENTRY TYPE DEFINITIONS ========== */
 
@@ -82,6 +84,9 @@ typedef void (*MiniEntryCallback)(MiniEntry *entry, void *user_data);
  * @param height Height of entry widget
  * @param max_length Maximum number of characters allowed
  * @param on_change Callback function called when text changes
+ * @param on_edit Optional callback called after every user edit (keystroke,
+ *                paste, cut, clear) before the text is committed; not called
+ *                for entry_set_text() or undo/redo
  * @param user_data User data passed to callback function
  */
 typedef struct MiniEntryConfig {
@@ -92,6 +97,7 @@ typedef struct MiniEntryConfig {
 	int border_radius;
 	int max_length;
 	MiniEntryCallback on_change;
+	MiniEntryCallback on_edit;
 	void *user_data;
 } MiniEntryConfig;
 
@@ -105,10 +111,15 @@ typedef struct MiniEntryConfig {
  * @param entry_theme Theme configuration for appearance
  * @param entry_config Configuration structure for entry behavior
  * @param clipboard_ctx Clipboard context for copy/paste operations
+ * @param compositor Compositor of parent_window, or NULL for a window of its
+ *                   own. With a compositor the entry is a node drawn into the
+ *                   shared back buffer, gets its pointer events through
+ *                   compositor_route_event() and takes keyboard focus on the
+ *                   parent; destroy it before the compositor.
  *
  * @return Pointer to new entry context, or NULL on failure
  */
-MiniEntry *entry_create(Display *dpy, int screen, Window parent, const MiniTheme *theme, const MiniEntryConfig *cfg, ClipboardContext *clipboard_ctx);
+MiniEntry *entry_create(Display *dpy, int screen, Window parent, const MiniTheme *theme, const MiniEntryConfig *cfg, ClipboardContext *clipboard_ctx, Compositor *compositor);
 
 /**
  * @brief Destroy an entry widget and free its resources
@@ -201,10 +212,33 @@ void entry_resize(MiniEntry *e, int w, int h);
  */
 void entry_resize_noflush(MiniEntry *e, int w, int h);
 
+/**
+ * @brief Move and resize the entry with a single request, without flushing
+ * @param entry Entry context
+ * @param x New X coordinate
+ * @param y New Y coordinate
+ * @param w New width (<= 0 keeps the current width)
+ * @param h New height (<= 0 keeps the current height)
+ *
+ * Nothing is sent when the geometry is unchanged.
+ */
+void entry_set_bounds_noflush(MiniEntry *e, int x, int y, int w, int h);
+
+/**
+ * @brief Get the entry's current size (the height follows the font)
+ * @param entry Entry context
+ * @param w Receives the width
+ * @param h Receives the height
+ */
+void entry_get_size(const MiniEntry *e, int *w, int *h);
+
 /* ========== TEXT MANAGEMENT ========== */
 
 /**
  * @brief Set the text content of entry widget
+ *
+ * Programmatic update: a change is recorded as one undo step that later
+ * typing does not merge into. on_edit is not called.
  * @param entry Entry context
  * @param text New text content (null-terminated string)
  */
@@ -212,11 +246,23 @@ void entry_set_text(MiniEntry *e, const char *t);
 
 /**
  * @brief Set text content without redrawing (for batch updates)
+ *
+ * Same undo behavior as entry_set_text().
  * @param entry Entry context
  * @param text New text content (null-terminated string)
  */
 void entry_set_text_no_draw(MiniEntry *e, const char *t);
 
+/**
+ * @brief Set transient text without redrawing or recording an undo step
+ *
+ * For previews: the caller must put the recorded text back (with this
+ * function) before the user can undo in the entry.
+ * @param entry Entry context
+ * @param text New text content (null-terminated string)
+ */
+void entry_set_text_no_undo(MiniEntry *e, const char *t);
+
 /**
  * @brief Get current text content from entry widget
  * @param entry Entry context
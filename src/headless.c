@@ -0,0 +1,371 @@
+/* headless.c - Headless Command Line Interface Implementation
+ *
+ * One-shot picking and conversion modes that run without the GUI. The
+ * conversion path uses colormath only; the X display is opened solely by
+ * the pick modes, and only after all input has been parsed.
+ */
+
+#include "headless.h"
+#include "sampler.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+#include <X11/Xlib.h>
+
+/* Same text as the main window's entry fields */
+static const char *FORMAT_HSV_HSL = "%.1lf° %.1lf%% %.1lf%%";
+static const char *FORMAT_RGBF = "%.3f, %.3f, %.3f";
+static const char *FORMAT_RGBI = "%d, %d, %d";
+
+/* ========== INTERNAL HELPERS ========== */
+
+/* #RGB or #RRGGBB with nothing else on the line */
+static int parse_hex_strict(const char *text, RGB8 *out) {
+	if (*text == '#') {
+		text++;
+	}
+	size_t len = strlen(text);
+	if (len != 3 && len != 6) {
+		return 0;
+	}
+	for (size_t i = 0; i < len; i++) {
+		if (!isxdigit((unsigned char)text[i])) {
+			return 0;
+		}
+	}
+	char full[7];
+	if (len == 3) {
+		for (int i = 0; i < 3; i++) {
+			full[i * 2] = full[i * 2 + 1] = text[i];
+		}
+		full[6] = '\0';
+		text = full;
+	}
+	return hex_to_rgb8(text, out);
+}
+
+/* Parse three numbers separated by commas and/or spaces. Degree and percent
+ * signs are ignored. Sets *has_fraction if any number has a decimal point. */
+static int parse_triplet(const char *text, double v[3], int *has_fraction) {
+	char buf[128];
+	size_t n = 0;
+	*has_fraction = 0;
+	for (const char *p = text; *p && n + 1 < sizeof(buf); p++) {
+		unsigned char c = (unsigned char)*p;
+		if (c == ',' || c == '/' || c == '%') {
+			buf[n++] = ' ';
+		}
+		else if (c == 0xC2 && (unsigned char)p[1] == 0xB0) {
+			buf[n++] = ' '; // UTF-8 degree sign
+			p++;
+		}
+		else {
+			if (c == '.') {
+				*has_fraction = 1;
+			}
+			buf[n++] = (char)c;
+		}
+	}
+	buf[n] = '\0';
+	char *p = buf;
+	for (int i = 0; i < 3; i++) {
+		char *end;
+		v[i] = strtod(p, &end);
+		if (end == p) {
+			return 0;
+		}
+		p = end;
+	}
+	while (isspace((unsigned char)*p)) {
+		p++;
+	}
+	return *p == '\0';
+}
+
+static uint8_t clamp_channel(double v) {
+	if (v < 0.0) {
+		return 0;
+	}
+	if (v > 255.0) {
+		return 255;
+	}
+	return (uint8_t)(v + 0.5);
+}
+
+/* Parse "X,Y" or "X,Y,W,H" (commas and/or blanks between numbers) */
+static int parse_area(const char *text, SampleRect *out) {
+	long v[4];
+	int n = 0;
+	const char *p = text;
+	while (n < 4) {
+		while (*p == ' ' || *p == '\t') {
+			p++;
+		}
+		char *end;
+		v[n] = strtol(p, &end, 10);
+		if (end == p || v[n] < 0 || v[n] > 65535) {
+			return 0;
+		}
+		n++;
+		p = end;
+		while (*p == ' ' || *p == '\t') {
+			p++;
+		}
+		if (*p == ',') {
+			p++;
+		}
+		else if (*p == '\0' || *p == '\n' || *p == '\r') {
+			break;
+		}
+	}
+	while (isspace((unsigned char)*p)) {
+		p++;
+	}
+	if (*p != '\0' || (n != 2 && n != 4) || (n == 4 && (v[2] == 0 || v[3] == 0))) {
+		return 0;
+	}
+	out->x = (int)v[0];
+	out->y = (int)v[1];
+	out->width = n == 4 ? (int)v[2] : 1;
+	out->height = n == 4 ? (int)v[3] : 1;
+	return 1;
+}
+
+/* How results are printed */
+typedef struct {
+	const char *format;
+	int with_coords; // Prefix each line with the requested area
+} PrintOptions;
+
+/* Sampler sink: print one result per line as soon as it is handed over */
+static int print_sample(size_t index, const SampleRect *rect, RGB8 color, void *user_data) {
+	(void)index;
+	const PrintOptions *opts = user_data;
+	char buf[128];
+	headless_format_color(color, opts->format, buf, sizeof(buf));
+	if (!opts->with_coords) {
+		puts(buf);
+	}
+	else if (strcasecmp(opts->format, "json") == 0) {
+		// One self-contained object per line (NDJSON)
+		printf("{\"x\": %d, \"y\": %d, \"w\": %d, \"h\": %d, \"color\": %s}\n", rect->x, rect->y, rect->width, rect->height, buf);
+	}
+	else if (rect->width == 1 && rect->height == 1) {
+		printf("%d,%d\t%s\n", rect->x, rect->y, buf);
+	}
+	else {
+		printf("%d,%d,%d,%d\t%s\n", rect->x, rect->y, rect->width, rect->height, buf);
+	}
+	return ferror(stdout) ? 1 : 0;
+}
+
+/* Open the display, sample all areas and close it again */
+static int sample_screen(const SampleRect *areas, size_t count, int flags, const PrintOptions *opts) {
+	if (count == 0) {
+		return 0;
+	}
+	Display *dpy = XOpenDisplay(NULL);
+	if (!dpy) {
+		fprintf(stderr, "Cannot open display\n");
+		return -1;
+	}
+	int rc = sampler_sample_rects(dpy, DefaultScreen(dpy), areas, count, flags, print_sample, (void *)opts);
+	XCloseDisplay(dpy);
+	return rc;
+}
+
+/* ========== PARSING / FORMATTING ========== */
+
+int headless_parse_color(const char *text, RGB8 *out) {
+	if (!text || !out) {
+		return 0;
+	}
+	while (isspace((unsigned char)*text)) {
+		text++;
+	}
+	if (parse_hex_strict(text, out)) {
+		return 1;
+	}
+	double v[3];
+	int has_fraction;
+	const char *open = strchr(text, '(');
+	if (open) {
+		const char *close = strrchr(open, ')');
+		char inner[128];
+		size_t len = close ? (size_t)(close - open - 1) : 0;
+		if (!close || len >= sizeof(inner)) {
+			return 0;
+		}
+		memcpy(inner, open + 1, len);
+		inner[len] = '\0';
+		if (!parse_triplet(inner, v, &has_fraction)) {
+			return 0;
+		}
+		size_t name_len = (size_t)(open - text);
+		if (name_len == 3 && strncasecmp(text, "rgb", 3) == 0) {
+			*out = (RGB8){clamp_channel(v[0]), clamp_channel(v[1]), clamp_channel(v[2])};
+			return 1;
+		}
+		if (name_len == 3 && strncasecmp(text, "hsl", 3) == 0) {
+			*out = rgbf_to_rgb8(hsl_to_rgb((HSL){v[0], v[1] / 100.0, v[2] / 100.0}));
+			return 1;
+		}
+		if (name_len == 3 && strncasecmp(text, "hsv", 3) == 0) {
+			*out = rgbf_to_rgb8(hsv_to_rgb((HSV){v[0], v[1] / 100.0, v[2] / 100.0}));
+			return 1;
+		}
+		return 0;
+	}
+	if (!parse_triplet(text, v, &has_fraction)) {
+		return 0;
+	}
+	if (has_fraction && v[0] <= 1.0 && v[1] <= 1.0 && v[2] <= 1.0) {
+		// Float RGB as shown in the RGB float field
+		*out = rgbf_to_rgb8((RGBf){v[0], v[1], v[2]});
+	}
+	else {
+		*out = (RGB8){clamp_channel(v[0]), clamp_channel(v[1]), clamp_channel(v[2])};
+	}
+	return 1;
+}
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wformat-nonliteral"
+int headless_format_color(RGB8 color, const char *format, char *out, size_t size) {
+	RGBf rgbf = rgb8_to_rgbf(color);
+	char hex[8];
+	rgb8_to_hex(color, hex);
+	if (!format || strcasecmp(format, "hex") == 0) {
+		snprintf(out, size, "%s", hex);
+	}
+	else if (strcasecmp(format, "rgb") == 0) {
+		snprintf(out, size, FORMAT_RGBI, color.r, color.g, color.b);
+	}
+	else if (strcasecmp(format, "rgbf") == 0) {
+		snprintf(out, size, FORMAT_RGBF, rgbf.r, rgbf.g, rgbf.b);
+	}
+	else if (strcasecmp(format, "hsv") == 0) {
+		HSV hsv = rgb_to_hsv(rgbf);
+		snprintf(out, size, FORMAT_HSV_HSL, hsv.H, hsv.S * 100.0, hsv.V * 100.0);
+	}
+	else if (strcasecmp(format, "hsl") == 0) {
+		HSL hsl = rgb_to_hsl(rgbf);
+		snprintf(out, size, FORMAT_HSV_HSL, hsl.H, hsl.S * 100.0, hsl.L * 100.0);
+	}
+	else if (strcasecmp(format, "css") == 0) {
+		snprintf(out, size, "rgb(%d, %d, %d)", color.r, color.g, color.b);
+	}
+	else if (strcasecmp(format, "json") == 0) {
+		snprintf(out, size, "{\"hex\": \"%s\", \"r\": %d, \"g\": %d, \"b\": %d}", hex, color.r, color.g, color.b);
+	}
+	else {
+		return -1;
+	}
+	return 0;
+}
+#pragma GCC diagnostic pop
+
+/* ========== MODES ========== */
+
+int headless_convert(const char *color, const char *format) {
+	RGB8 rgb8;
+	char buf[128];
+	if (!headless_parse_color(color, &rgb8)) {
+		fprintf(stderr, "Invalid color: %s\n", color);
+		return 1;
+	}
+	if (headless_format_color(rgb8, format, buf, sizeof(buf)) != 0) {
+		fprintf(stderr, "Unknown format: %s (hex, rgb, rgbf, hsv, hsl, css, json)\n", format);
+		return 1;
+	}
+	puts(buf);
+	return 0;
+}
+
+static int check_format(const char *format) {
+	char buf[128];
+	if (headless_format_color((RGB8){0, 0, 0}, format, buf, sizeof(buf)) != 0) {
+		fprintf(stderr, "Unknown format: %s (hex, rgb, rgbf, hsv, hsl, css, json)\n", format);
+		return -1;
+	}
+	return 0;
+}
+
+int headless_pick(const char *const *coords, size_t count, const char *format, int average) {
+	if (check_format(format) != 0) {
+		return 1;
+	}
+	SampleRect *areas = malloc((count ? count : 1) * sizeof(SampleRect));
+	int rc = 1;
+	if (!areas) {
+		return 1;
+	}
+	for (size_t i = 0; i < count; i++) {
+		if (!parse_area(coords[i], &areas[i])) {
+			fprintf(stderr, "Invalid coordinate: %s (expected X,Y or X,Y,W,H)\n", coords[i]);
+			goto out;
+		}
+	}
+	PrintOptions opts = {format, 0};
+	if (sample_screen(areas, count, average ? SAMPLER_AVERAGE : 0, &opts) == 0) {
+		rc = 0;
+	}
+out:
+	free(areas);
+	return rc;
+}
+
+int headless_sample_file(const char *path, const char *format, int average) {
+	if (check_format(format) != 0) {
+		return 1;
+	}
+	FILE *fp = strcmp(path, "-") == 0 ? stdin : fopen(path, "r");
+	if (!fp) {
+		perror(path);
+		return 1;
+	}
+	SampleRect *areas = NULL;
+	size_t count = 0, cap = 0;
+	int rc = 1;
+	char line[256];
+	unsigned long lineno = 0;
+	while (fgets(line, sizeof(line), fp)) {
+		lineno++;
+		char *p = line;
+		while (isspace((unsigned char)*p)) {
+			p++;
+		}
+		char *hash = strchr(p, '#');
+		if (hash) {
+			*hash = '\0';
+		}
+		if (*p == '\0') {
+			continue;
+		}
+		if (count == cap) {
+			cap = cap ? cap * 2 : 256;
+			SampleRect *grown = realloc(areas, cap * sizeof(SampleRect));
+			if (!grown) {
+				goto out;
+			}
+			areas = grown;
+		}
+		if (!parse_area(p, &areas[count])) {
+			fprintf(stderr, "%s:%lu: invalid coordinate\n", path, lineno);
+			goto out;
+		}
+		count++;
+	}
+	PrintOptions opts = {format, 1};
+	if (sample_screen(areas, count, average ? SAMPLER_AVERAGE : 0, &opts) == 0) {
+		rc = 0;
+	}
+out:
+	if (fp != stdin) {
+		fclose(fp);
+	}
+	free(areas);
+	return rc;
+}
@@ -0,0 +1,95 @@
+#ifndef HEADLESS_H_
+#define HEADLESS_H_
+
+/* ========== HEADLESS COMMAND LINE INTERFACE ========== */
+
+/**
+ * @file headless.h
+ * @brief Command line picking and conversion without the GUI
+ *
+ * Implements the one-shot modes used from shell pipelines:
+ *
+ *   pixelprism --convert '#FF8040' --to hsl
+ *   pixelprism --pick 100,200 --pick 640,480 --format rgb
+ *   pixelprism --sample-file coords.txt --format json
+ *
+ * None of these build widgets, load the configuration or theme, or create
+ * the tray icon. Conversion never opens an X connection; picking opens the
+ * display only long enough to capture the requested pixels or areas (all
+ * of them from a single capture, see sampler.h). Results are printed as
+ * they are handed over by the sampler, one line each.
+ *
+ * Output formats: hex, rgb, rgbf, hsv, hsl, css, json. The text matches the
+ * main window's fields (hex is uppercase with a leading '#').
+ *
+ * Dependencies:
+ * - colormath.h (conversions)
+ * - sampler.h (screen capture, pick modes only)
+ *
+ * Thread safety: Not thread-safe
+ */
+
+#include <stddef.h>
+#include "colormath.h"
+
+/* ========== PARSING / FORMATTING ========== */
+
+/**
+ * @brief Parse a color written as #RGB, #RRGGBB, "r, g, b", rgb(...),
+ *        hsl(h, s%, l%) or hsv(h, s%, v%)
+ * @param text Color text
+ * @param out Receives the parsed color
+ * @return 1 on success, 0 on parse error
+ */
+int headless_parse_color(const char *text, RGB8 *out);
+
+/**
+ * @brief Format a color in one of the output formats
+ * @param color Color to format
+ * @param format Format name (hex, rgb, rgbf, hsv, hsl, css, json)
+ * @param out Destination buffer
+ * @param size Size of out
+ * @return 0 on success, -1 for an unknown format
+ */
+int headless_format_color(RGB8 color, const char *format, char *out, size_t size);
+
+/* ========== MODES ========== */
+/* Each mode prints its results to stdout and returns a process exit status. */
+
+/**
+ * @brief Convert a color between notations (no X connection)
+ * @param color Color text accepted by headless_parse_color()
+ * @param format Output format
+ * @return 0 on success, 1 on error
+ */
+int headless_convert(const char *color, const char *format);
+
+/**
+ * @brief Sample screen pixels or areas given as "X,Y" / "X,Y,W,H" strings
+ * @param coords Coordinate strings
+ * @param count Number of coordinates
+ * @param format Output format
+ * @param average Non-zero: mean color of each W x H area (otherwise the
+ *                area's center pixel)
+ *
+ * Prints one color per line in input order.
+ *
+ * @return 0 on success, 1 on error
+ */
+int headless_pick(const char *const *coords, size_t count, const char *format, int average);
+
+/**
+ * @brief Sample every point or area listed in a file
+ * @param path File with one "X,Y" or "X,Y,W,H" (commas or blanks) per line,
+ *             '#' comments allowed; "-" reads standard input
+ * @param format Output format
+ * @param average Non-zero: mean color of each area
+ *
+ * Streams one line per entry in file order: "X,Y<tab>color" (or
+ * "X,Y,W,H<tab>color"), or one JSON object per line for the json format.
+ *
+ * @return 0 on success, 1 on error
+ */
+int headless_sample_file(const char *path, const char *format, int average);
+
+#endif /* HEADLESS_H_ */
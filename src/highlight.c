@@ -0,0 +1,130 @@
+/* highlight.c - Screen Highlight Overlay Implementation
+ *
+ * Draws rectangle outlines over the whole screen with a single shaped
+ * override-redirect window.
+ *
+ * Internal design notes:
+ * - Nothing is ever drawn: the window background is the outline color and
+ *   the bounding shape is the union of four strips per rectangle, so the
+ *   server paints the outlines itself on map and expose.
+ * - The input shape is set to empty once at creation; the overlay never
+ *   takes clicks or changes the pointer.
+ * - The window is created once and reused; showing new outlines only
+ *   replaces the shape.
+ */
+
+#include "highlight.h"
+#include <X11/extensions/shape.h>
+#include <stdlib.h>
+#include <time.h>
+
+/* ========== INTERNAL STRUCTURE ========== */
+
+struct HighlightOverlay {
+	Display *dpy;
+	int screen;
+	Window win;
+	int visible;
+	long long hide_at_ms; // 0 when there is no timeout
+};
+
+/* ========== INTERNAL HELPERS ========== */
+
+static long long now_ms(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static XRectangle strip(int x, int y, int w, int h) {
+	XRectangle r = {(short)x, (short)y, (unsigned short)(w > 0 ? w : 0), (unsigned short)(h > 0 ? h : 0)};
+	return r;
+}
+
+/* ========== LIFECYCLE MANAGEMENT ========== */
+
+HighlightOverlay *highlight_create(Display *dpy, int screen) {
+	int event_base, error_base;
+	if (!dpy || !XShapeQueryExtension(dpy, &event_base, &error_base)) {
+		return NULL;
+	}
+	HighlightOverlay *hl = calloc(1, sizeof(HighlightOverlay));
+	if (!hl) {
+		return NULL;
+	}
+	hl->dpy = dpy;
+	hl->screen = screen;
+
+	XSetWindowAttributes attrs;
+	attrs.override_redirect = True;
+	attrs.background_pixel = BlackPixel(dpy, screen);
+	hl->win = XCreateWindow(dpy, RootWindow(dpy, screen), 0, 0, (unsigned int)DisplayWidth(dpy, screen), (unsigned int)DisplayHeight(dpy, screen), 0, CopyFromParent, InputOutput, CopyFromParent, CWOverrideRedirect | CWBackPixel, &attrs);
+	XShapeCombineRectangles(dpy, hl->win, ShapeInput, 0, 0, NULL, 0, ShapeSet, Unsorted);
+	return hl;
+}
+
+void highlight_destroy(HighlightOverlay *hl) {
+	if (!hl) {
+		return;
+	}
+	XDestroyWindow(hl->dpy, hl->win);
+	free(hl);
+}
+
+/* ========== DISPLAY ========== */
+
+void highlight_show(HighlightOverlay *hl, const XRectangle *rects, int count, unsigned long pixel, int thickness, int timeout_ms) {
+	if (!hl) {
+		return;
+	}
+	if (!rects || count <= 0) {
+		highlight_hide(hl);
+		return;
+	}
+	XRectangle *strips = malloc((size_t)count * 4 * sizeof(XRectangle));
+	if (!strips) {
+		return;
+	}
+	int t = thickness > 0 ? thickness : 1;
+	for (int i = 0; i < count; i++) {
+		int x = rects[i].x, y = rects[i].y, w = rects[i].width, h = rects[i].height;
+		strips[i * 4 + 0] = strip(x - t, y - t, w + 2 * t, t); // Top
+		strips[i * 4 + 1] = strip(x - t, y + h, w + 2 * t, t); // Bottom
+		strips[i * 4 + 2] = strip(x - t, y, t, h);             // Left
+		strips[i * 4 + 3] = strip(x + w, y, t, h);             // Right
+	}
+	XShapeCombineRectangles(hl->dpy, hl->win, ShapeBounding, 0, 0, strips, count * 4, ShapeSet, Unsorted);
+	free(strips);
+
+	XSetWindowBackground(hl->dpy, hl->win, pixel);
+	if (hl->visible) {
+		XClearWindow(hl->dpy, hl->win);
+		XRaiseWindow(hl->dpy, hl->win);
+	}
+	else {
+		XMapRaised(hl->dpy, hl->win);
+		hl->visible = 1;
+	}
+	hl->hide_at_ms = timeout_ms > 0 ? now_ms() + timeout_ms : 0;
+	XFlush(hl->dpy);
+}
+
+void highlight_hide(HighlightOverlay *hl) {
+	if (!hl || !hl->visible) {
+		return;
+	}
+	XUnmapWindow(hl->dpy, hl->win);
+	hl->visible = 0;
+	hl->hide_at_ms = 0;
+	XFlush(hl->dpy);
+}
+
+void highlight_tick(HighlightOverlay *hl) {
+	if (hl && hl->visible && hl->hide_at_ms && now_ms() >= hl->hide_at_ms) {
+		highlight_hide(hl);
+	}
+}
+
+int highlight_is_visible(const HighlightOverlay *hl) {
+	return hl ? hl->visible : 0;
+}
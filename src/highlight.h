@@ -0,0 +1,88 @@
+#ifndef HIGHLIGHT_H_
+#define HIGHLIGHT_H_
+
+/* ========== SCREEN HIGHLIGHT OVERLAY INTERFACE ========== */
+
+/**
+ * @file highlight.h
+ * @brief Transient outlines drawn over arbitrary areas of the screen
+ *
+ * One override-redirect window covers the root window and is shaped down
+ * to the outlines of the requested rectangles, so only the outlines are
+ * visible and everything else on screen shows through. Its input shape is
+ * empty, so clicks and pointer motion pass through to the windows below.
+ * The overlay hides itself once its timeout expires.
+ *
+ * Dependencies:
+ * - X11 (Xlib, XShape extension)
+ *
+ * Usage:
+ *   HighlightOverlay *hl = highlight_create(display, DefaultScreen(display));
+ *   highlight_show(hl, rects, count, pixel, 2, 3000);
+ *   ...
+ *   highlight_tick(hl);   // once per main loop iteration
+ *   highlight_destroy(hl);
+ *
+ * Thread safety: Not thread-safe (uses X11 APIs)
+ * Memory: Caller must call highlight_destroy() to free resources
+ */
+
+#include <X11/Xlib.h>
+
+/* ========== TYPE DEFINITIONS ========== */
+
+typedef struct HighlightOverlay HighlightOverlay;
+
+/* ========== LIFECYCLE MANAGEMENT ========== */
+
+/**
+ * @brief Create a hidden overlay for a screen
+ * @param dpy X11 display connection
+ * @param screen Screen number
+ *
+ * @return New overlay, or NULL if the display lacks the SHAPE extension or
+ *         allocation fails
+ */
+HighlightOverlay *highlight_create(Display *dpy, int screen);
+
+/**
+ * @brief Destroy an overlay and its window
+ * @param hl Overlay
+ */
+void highlight_destroy(HighlightOverlay *hl);
+
+/* ========== DISPLAY ========== */
+
+/**
+ * @brief Outline a set of rectangles
+ * @param hl Overlay
+ * @param rects Rectangles in root window coordinates
+ * @param count Number of rectangles
+ * @param pixel Outline color
+ * @param thickness Outline width in pixels, drawn outside each rectangle
+ * @param timeout_ms Hide after this many milliseconds (0 keeps it up)
+ *
+ * Replaces any outlines already shown. A count of 0 hides the overlay.
+ */
+void highlight_show(HighlightOverlay *hl, const XRectangle *rects, int count, unsigned long pixel, int thickness, int timeout_ms);
+
+/**
+ * @brief Hide the overlay
+ * @param hl Overlay
+ */
+void highlight_hide(HighlightOverlay *hl);
+
+/**
+ * @brief Hide the overlay if its timeout has passed
+ * @param hl Overlay
+ */
+void highlight_tick(HighlightOverlay *hl);
+
+/**
+ * @brief Check whether the overlay is on screen
+ * @param hl Overlay
+ * @return 1 if visible, 0 otherwise
+ */
+int highlight_is_visible(const HighlightOverlay *hl);
+
+#endif /* HIGHLIGHT_H_ */
@@ -1,275 +1,100 @@
 /* icons.c - Embedded Application Icons
  *
- * Contains XPM-format icon data embedded directly in the source code.
- * Provides application icon and window manager icon for PixelPrism.
+ * Creates X pixmaps from the icon pixels generated into icons_data.c by
+ * tools/xpm2argb. The artwork itself is kept as XPM in icons/.
  *
- * Icons:
- * - pixelprism_xpm: Main application icon (75x75, 122 colors)
- * - pixelprism_icon_xpm: Window manager icon
- *
- * XPM format allows icons to be compiled directly into the binary
- * without requiring external image files at runtime.
+ * Internal design notes:
+ * - Pixels are stored premultiplied for XRender, but the icons only have
+ *   binary transparency at their native sizes, so pixmaps are created in
+ *   the screen's default visual and transparency comes from the mask.
+ * - The image is filled client-side and sent with a single XPutImage; the
+ *   mask is one XCreateBitmapFromData.
  */
 
-/* XPM */
-char *pixelprism_xpm[] = {
-"75 75 122 2",
-"  	c None",
-". 	c #FF9090",
-"+ 	c #FFA4A4",
-"@ 	c #FFA7A7",
-"# 	c #FF9292",
-"$ 	c #FF7272",
-"% 	c #FFD3D3",
-"& 	c #FFD2D2",
-"* 	c #FFCACA",
-"= 	c #FFA5A5",
-"- 	c #FF8383",
-"; 	c #FF6E6E",
-"> 	c #FF5A5A",
-", 	c #FFCDCD",
-"' 	c #FFBBBB",
-") 	c #FF6868",
-"! 	c #FF1010",
-"~ 	c #FF0000",
-"{ 	c #FF8585",
-"] 	c #FFD1D1",
-"^ 	c #FF8080",
-"/ 	c #FF0707",
-"( 	c #FF8282",
-"_ 	c #FFC8C8",
-": 	c #FF3D3D",
-"< 	c #FF6B6B",
-"[ 	c #FFC0C0",
-"} 	c #FF2C2C",
-"| 	c #FFC9C9",
-"1 	c #FFCBCB",
-"2 	c #FF2E2E",
-"3 	c #FFA8A8",
-"4 	c #FF4C4C",
-"5 	c #FF6565",
-"6 	c #FF8888",
-"7 	c #FFAFAF",
-"8 	c #FFC4C4",
-"9 	c #FF1111",
-"0 	c #FF6C6C",
-"a 	c #FF8787",
-"b 	c #FF1414",
-"c 	c #FFBFBF",
-"d 	c #FF9191",
-"e 	c #FFB6B6",
-"f 	c #FFAEAE",
-"g 	c #FF0E0E",
-"h 	c #FFB4B4",
-"i 	c #FFB3B3",
-"j 	c #FF1313",
-"k 	c #FFB0B0",
-"l 	c #FFB9B9",
-"m 	c #FF1A1A",
-"n 	c #FFBDBD",
-"o 	c #FF2121",
-"p 	c #FFABAB",
-"q 	c #FF2323",
-"r 	c #FFFFFF",
-"s 	c #B0FFB0",
-"t 	c #C4FFC4",
-"u 	c #7FFF7F",
-"v 	c #02FF02",
-"w 	c #00FF00",
-"x 	c #A6FFA6",
-"y 	c #B9FFB9",
-"z 	c #61FF61",
-"A 	c #ABFFAB",
-"B 	c #B6FFB6",
-"C 	c #4CFF4C",
-"D 	c #AFFFAF",
-"E 	c #38FF38",
-"F 	c #3CFF3C",
-"G 	c #B4FFB4",
-"H 	c #ACFFAC",
-"I 	c #2AFF2A",
-"J 	c #3FFF3F",
-"K 	c #B5FFB5",
-"L 	c #A2FFA2",
-"M 	c #1CFF1C",
-"N 	c #51FF51",
-"O 	c #98FF98",
-"P 	c #0EFF0E",
-"Q 	c #5BFF5B",
-"R 	c #BCFFBC",
-"S 	c #93FF93",
-"T 	c #0AFF0A",
-"U 	c #B8FFB8",
-"V 	c #8DFF8D",
-"W 	c #06FF06",
-"X 	c #99FF99",
-"Y 	c #03FF03",
-"Z 	c #8CFF8C",
-"` 	c #29FF29",
-" .	c #7AFF7A",
-"..	c #4DFF4D",
-"+.	c #54FF54",
-"@.	c #0CFF0C",
-"#.	c #2EFF2E",
-"$.	c #0FFF0F",
-"%.	c #0E0EFF",
-"&.	c #5151FF",
-"*.	c #0000FF",
-"=.	c #5757FF",
-"-.	c #7272FF",
-";.	c #2F2FFF",
-">.	c #9C9CFF",
-",.	c #0101FF",
-"'.	c #9E9EFF",
-").	c #8484FF",
-"!.	c #7373FF",
-"~.	c #B8B8FF",
-"{.	c #4242FF",
-"].	c #D5D5FF",
-"^.	c #5D5DFF",
-"/.	c #CECEFF",
-"(.	c #6C6CFF",
-"_.	c #C9C9FF",
-":.	c #0303FF",
-"<.	c #D6D6FF",
-"[.	c #8888FF",
-"}.	c #A3A3FF",
-"|.	c #3232FF",
-"1.	c #1515FF",
-"                                                                                                                                                      ",
-"                                                                                                                                                      ",
-"                                                                                                                                                      ",
-"                                                                                                                                                      ",
-"                                                                                                                                                      ",
-"                                                                                                                                                      ",
-"                                                                                                              . + @ # $                               ",
-"                                                                                                          @ % & * = - ; >                             ",
-"                                                                                                      $ , % ' ) ! ~ ~ ~ ~ ~                           ",
-"                                                                                                    { % ] ^ / ~ ~ ~ ~ ~ ~ ~ ~                         ",
-"                                                                                                  ( % _ : ~ ~ ~ ~ ~ ~ ~ ~ ~ ~                         ",
-"                                                                                                < % [ } ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~                       ",
-"                                                                                                | 1 2 ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~                       ",
-"                                                                                              3 ] 4 ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~                         ",
-"                                                                                            5 & 6 ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~                         ",
-"                                                                                            7 8 9 ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~                         ",
-"                                                                                            ] 0 ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~                           ",
-"                                                                                          a , b ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~                           ",
-"                                                                                          c d ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~                             ",
-"                                                                                        e f g ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~                               ",
-"                                                                                      h i j ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~                                 ",
-"                                                                                    k l m ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~                                   ",
-"                                                                                  7 n o ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~                                     ",
-"                                                                                p c q ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~                                         ",
-"                                                                                f } ~ ~ ~ ~ ~ ~ ~ ~ ~                                                 ",
-"                                                                              r r   ~ ~ ~ ~ ~ ~ ~ ~                                                   ",
-"                                                                            r r r     ~ ~ ~ ~ ~ ~                                                     ",
-"                                                                          r r r         ~ ~ ~ ~                                                       ",
-"                                                                        r r r             ~ ~                                                         ",
-"                                                                      r r r                                                                           ",
-"                                                                  r r r r                                                                             ",
-"                                                                r r r r                                                                               ",
-"                                                              r r r                                                                                   ",
-"                                                            r r r                                                                                     ",
-"                                                          r r r                                                                                       ",
-"                                                        r r r                                                                                         ",
-"                                                      r r r                                                                                           ",
-"                                                    s t u v w w w w w w                                                                               ",
-"                                                  x y z w w w w w w w                                                                                 ",
-"                                                A B C w w w w w w w                                                                                   ",
-"                                              D s E w w w w w w w                                                                                     ",
-"                                          F G H I w w w w w w w                                                                                       ",
-"                                        J K L M w w w w w w w                                                                                         ",
-"                                      N y O P w w w w w w w                                                                                           ",
-"                                    Q R S T w w w w w w w                                                                                             ",
-"                                    U V W w w w w w w w                                                                                               ",
-"                                  u X Y w w w w w w w                                                                                                 ",
-"                                  Z ` w w w w w w w                                                                                                   ",
-"                                   .w w w w w w w                                                                                                     ",
-"                                  ..w w w w w w                                                                                                       ",
-"                                +.@.w w w w w                                                                                                         ",
-"                                #.w w w w w                                                                                                           ",
-"                                $.w                                                                                                                   ",
-"                                                                                                                                                      ",
-"                              %.                                                                                                                      ",
-"                            &.*.                                                                                                                      ",
-"                            =.*.                                                                                                                      ",
-"                          -.;.*.*.                                                                                                                    ",
-"                          >.,.*.*.                                                                                                                    ",
-"                          '.*.*.*.                                                                                                                    ",
-"                        ).!.*.*.*.*.                                                                                                                  ",
-"                        ~.{.*.*.*.*.                                                                                                                  ",
-"                        ].%.*.*.*.*.                                                                                                                  ",
-"                      ^./.*.*.*.*.*.                                                                                                                  ",
-"                      (._.*.*.*.*.*.                                                                                                                  ",
-"                      -.].:.*.*.*.*.                                                                                                                  ",
-"                        <.{.*.*.*.*.                                                                                                                  ",
-"                        [.}.:.*.*.*.                                                                                                                  ",
-"                          |.1.*.*.                                                                                                                    ",
-"                                                                                                                                                      ",
-"                                                                                                                                                      ",
-"                                                                                                                                                      ",
-"                                                                                                                                                      ",
-"                                                                                                                                                      ",
-"                                                                                                                                                      "};
+#include "icons.h"
+#include <X11/Xutil.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/* ========== INTERNAL HELPERS ========== */
+
+/* Scale an 8-bit channel into a visual's channel mask */
+static unsigned long channel_bits(unsigned int value, unsigned long mask) {
+	if (!mask) {
+		return 0;
+	}
+	int shift = 0;
+	while (!(mask & 1)) {
+		mask >>= 1;
+		shift++;
+	}
+	return ((unsigned long)value * mask / 255) << shift;
+}
+
+/* Undo premultiplication for the opaque pixmap; the mask hides the rest */
+static unsigned int unpremultiply(uint32_t argb, int shift) {
+	unsigned int a = argb >> 24;
+	unsigned int c = (argb >> shift) & 0xFF;
+	return a ? (c * 255 + a / 2) / a : 0;
+}
+
+/* ========== LOOKUP / CREATION ========== */
+
+const IconImage *icon_find(const IconImage *icons, int count, int size) {
+	if (!icons || count <= 0) {
+		return NULL;
+	}
+	const IconImage *best = &icons[0];
+	for (int i = 1; i < count; i++) {
+		if (icons[i].width <= size && icons[i].height <= size) {
+			best = &icons[i];
+		}
+	}
+	return best;
+}
 
-/* XPM */
-char * pixelprism_icon_xpm[] = {
-"24 24 32 1",
-" 	c None",
-".	c #FFB4B4",
-"+	c #FFB0B0",
-"@	c #FF8383",
-"#	c #FF3636",
-"$	c #FFA3A3",
-"%	c #FF1B1B",
-"&	c #FF0000",
-"*	c #FFA5A5",
-"=	c #FF0909",
-"-	c #FF5050",
-";	c #FFA0A0",
-">	c #FF8585",
-",	c #FF0303",
-"'	c #FF8989",
-")	c #FF0505",
-"!	c #FFFFFF",
-"~	c #EEFFEE",
-"{	c #89FF89",
-"]	c #0EFF0E",
-"^	c #00FF00",
-"/	c #7EFF7E",
-"(	c #04FF04",
-"_	c #77FF77",
-":	c #03FF03",
-"<	c #59FF59",
-"[	c #18FF18",
-"}	c #5858FF",
-"|	c #6060FF",
-"1	c #0000FF",
-"2	c #A7A7FF",
-"3	c #6A6AFF",
-"                        ",
-"                        ",
-"                .+@#    ",
-"               +$%&&    ",
-"               *=&&&    ",
-"              +-&&&&    ",
-"             ;>,&&&     ",
-"             ')&&       ",
-"            ! &&        ",
-"           !            ",
-"          !             ",
-"         ~              ",
-"        {]^             ",
-"       /(^              ",
-"      _:^               ",
-"     <:^                ",
-"     [^                 ",
-"                        ",
-"    }                   ",
-"    |1                  ",
-"   231                  ",
-"    31                  ",
-"                        ",
-"                        "};
+Pixmap icon_create_pixmap(Display *dpy, int screen, const IconImage *icon, Pixmap *mask_out) {
+	if (mask_out) {
+		*mask_out = None;
+	}
+	if (!dpy || !icon) {
+		return None;
+	}
+	Visual *visual = DefaultVisual(dpy, screen);
+	if (visual->class != TrueColor && visual->class != DirectColor) {
+		fprintf(stderr, "Icons need a TrueColor visual\n");
+		return None;
+	}
+	unsigned int depth = (unsigned int)DefaultDepth(dpy, screen);
+	unsigned int w = (unsigned int)icon->width, h = (unsigned int)icon->height;
+	XImage *image = XCreateImage(dpy, visual, depth, ZPixmap, 0, NULL, w, h, 32, 0);
+	if (!image) {
+		return None;
+	}
+	image->data = malloc((size_t)image->bytes_per_line * h);
+	if (!image->data) {
+		XDestroyImage(image);
+		return None;
+	}
+	for (int y = 0; y < icon->height; y++) {
+		for (int x = 0; x < icon->width; x++) {
+			uint32_t p = icon->argb[y * icon->width + x];
+			unsigned long pixel = channel_bits(unpremultiply(p, 16), visual->red_mask) |
+			                      channel_bits(unpremultiply(p, 8), visual->green_mask) |
+			                      channel_bits(unpremultiply(p, 0), visual->blue_mask);
+			XPutPixel(image, x, y, pixel);
+		}
+	}
 
+	Window root = RootWindow(dpy, screen);
+	Pixmap pixmap = XCreatePixmap(dpy, root, w, h, depth);
+	GC gc = XCreateGC(dpy, pixmap, 0, NULL);
+	XPutImage(dpy, pixmap, gc, image, 0, 0, 0, 0, w, h);
+	XFreeGC(dpy, gc);
+	XDestroyImage(image);
 
+	if (mask_out) {
+		*mask_out = XCreateBitmapFromData(dpy, root, (const char *)icon->mask, w, h);
+	}
+	return pixmap;
+}
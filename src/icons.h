@@ -0,0 +1,65 @@
+#ifndef ICONS_H_
+#define ICONS_H_
+
+/* ========== EMBEDDED ICON INTERFACE ========== */
+
+/**
+ * @file icons.h
+ * @brief Application icons as pre-converted ARGB pixels and 1-bit masks
+ *
+ * The icon artwork lives in icons/ as XPM files. At build time
+ * tools/xpm2argb converts them to icons_data.c: premultiplied ARGB32 pixels
+ * plus a 1-bit mask per size, with extra box-filtered sizes for HiDPI trays.
+ * Nothing is parsed at runtime; a pixmap is created with one XPutImage.
+ *
+ * Dependencies:
+ * - X11 (Xlib)
+ *
+ * Usage:
+ *   const IconImage *icon = icon_find(pixelprism_icons, pixelprism_icon_count, tray_height);
+ *   Pixmap mask;
+ *   Pixmap pix = icon_create_pixmap(display, screen, icon, &mask);
+ *
+ * Thread safety: Not thread-safe (uses X11 APIs)
+ * Memory: Caller frees the returned pixmaps with XFreePixmap()
+ */
+
+#include <X11/Xlib.h>
+#include <stdint.h>
+
+/* ========== TYPE DEFINITIONS ========== */
+
+typedef struct {
+	int width;
+	int height;
+	const uint32_t *argb;       // Premultiplied ARGB32, row-major
+	const unsigned char *mask;  // XBM bitmap data, set where alpha >= 50%
+} IconImage;
+
+/* Available sizes in ascending order (generated icons_data.c) */
+extern const IconImage pixelprism_icons[];
+extern const int pixelprism_icon_count;
+
+/* ========== LOOKUP / CREATION ========== */
+
+/**
+ * @brief Pick the icon size for an area
+ * @param icons Icon sizes in ascending order
+ * @param count Number of entries in icons
+ * @param size Available width and height in pixels
+ * @return Largest icon that fits in size x size, or the smallest icon when
+ *         none fits
+ */
+const IconImage *icon_find(const IconImage *icons, int count, int size);
+
+/**
+ * @brief Create a pixmap (and optionally a mask bitmap) from an icon
+ * @param dpy X11 display connection
+ * @param screen Screen the pixmap is for
+ * @param icon Icon to upload
+ * @param mask_out If not NULL, receives a 1-bit mask pixmap (None on failure)
+ * @return Pixmap in the screen's default depth, or None on failure
+ */
+Pixmap icon_create_pixmap(Display *dpy, int screen, const IconImage *icon, Pixmap *mask_out);
+
+#endif /* ICONS_H_ */
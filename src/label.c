@@ -7,7 +7,15 @@
  * Internal design notes:
  * - Labels are lightweight: a single Window with optional border drawing.
  * - Text truncation uses Xft glyph extents to avoid partial characters.
- * - Theme updates simply replace cached colors and fonts.
+ * - The finished label (background, text, border) is rendered once into a
+ *   pixmap together with the key it was rendered for: text, theme and
+ *   geometry. Expose copies that pixmap with one XCopyArea; it is
+ *   re-rendered only when the key no longer matches.
+ * - Theme updates that change nothing are ignored; the font is reopened
+ *   only when its family or size changed.
+ * - Created with a compositor, the label has no window at all: it is a
+ *   compositor node whose paint callback copies the cached pixmap into the
+ *   shared back buffer.
  *
  * Features:
  * - Automatic width/height calculation from text and font
@@ -18,7 +26,6 @@
  */
 
 #include "label.h"
-#include "dbe.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -88,6 +95,17 @@ static XftFont *open_font(Display *dpy, int screen, const char *fam, int size) {
 	return f;
 }
 
+/* What the cached pixmap was rendered for */
+typedef struct {
+	char *text;
+	BaseTheme theme;
+	int width, height;
+	int padding;
+	int border_width;
+	int border_radius;
+	int border_enabled;
+} LabelCacheKey;
+
 /* Label widget internal structure */
 struct LabelContext {
 	Display *dpy;
@@ -102,7 +120,8 @@ struct LabelContext {
 	// Fonts and colors
 	XftFont *font;
 	XftColor xft_color;
-	XftDraw *draw;
+	XftDraw *draw; // Targets the cache pixmap
+	GC gc;
 
 	// Geometry
 	int x, y;
@@ -119,15 +138,23 @@ struct LabelContext {
 	int visible;
 	int color_allocated; // Track if xft_color has been allocated
 	int needs_redraw;     // Hint flag set by mutating APIs; Expose handler clears it
-	
-	// DBE support
-	DbeContext *dbe_ctx;
-	XdbeBackBuffer dbe_back_buffer;
-	int use_dbe; // 1 if DBE is available and initialized
+
+	// Rendered label, valid while cache_key matches the current state
+	Pixmap cache;
+	int cache_w, cache_h;
+	int cache_valid;
+	LabelCacheKey cache_key;
+
+	// Compositor node when drawn into a shared back buffer (win is None)
+	Compositor *comp;
+	int node;
 };
 
 /* Forward declarations */
 static void label_redraw(LabelContext *label);
+static void sync_node(LabelContext *label);
+static void render_cache(LabelContext *label);
+static void label_paint(Drawable target, int x, int y, void *user_data);
 void label_draw(LabelContext *label);
 
 /* Calculate text dimensions */
@@ -149,52 +176,64 @@ static void calculate_text_size(LabelContext *label) {
 	label->text_height = extents.height;
 }
 
-/* Initialize DBE buffers for label - recreate XftDraw atomically like entry boxes */
-static void init_label_buffers(LabelContext *label) {
-	if (!label) {
-		return;
-	}
-	
-	// CRITICAL: Destroy XftDraw BEFORE deallocating the buffer it points to
-	if (label->draw) {
-		XftDrawDestroy(label->draw);
-		label->draw = NULL;
-	}
-	
-	// Now safe to deallocate the buffer
-	if (label->dbe_back_buffer != None) {
-		dbe_deallocate_back_buffer(label->dbe_ctx, label->dbe_back_buffer);
-		label->dbe_back_buffer = None;
+static int theme_fonts_equal(const BaseTheme *a, const BaseTheme *b) {
+	return strcmp(a->font_family, b->font_family) == 0 && a->font_size == b->font_size;
+}
+
+static int theme_equal(const BaseTheme *a, const BaseTheme *b) {
+	return theme_fonts_equal(a, b) &&
+	       a->fg_r == b->fg_r && a->fg_g == b->fg_g && a->fg_b == b->fg_b && a->fg_a == b->fg_a &&
+	       a->bg_r == b->bg_r && a->bg_g == b->bg_g && a->bg_b == b->bg_b && a->bg_a == b->bg_a &&
+	       a->border_r == b->border_r && a->border_g == b->border_g && a->border_b == b->border_b && a->border_a == b->border_a;
+}
+
+/* Does the cached pixmap show the label as it is now? */
+static int cache_matches(const LabelContext *label) {
+	const LabelCacheKey *k = &label->cache_key;
+	if (!label->cache_valid) {
+		return 0;
 	}
-	
-	// Initialize DBE if available
-	if (label->dbe_ctx && dbe_is_supported(label->dbe_ctx)) {
-		label->dbe_back_buffer = dbe_allocate_back_buffer(label->dbe_ctx, label->win, XdbeUndefined);
-		label->use_dbe = (label->dbe_back_buffer != None);
-	} else {
-		label->use_dbe = 0;
+	if ((k->text == NULL) != (label->text == NULL) || (k->text && strcmp(k->text, label->text) != 0)) {
+		return 0;
 	}
-	
-	Drawable draw_target = label->use_dbe ? label->dbe_back_buffer : label->win;
-	label->draw = XftDrawCreate(label->dpy, draw_target, DefaultVisual(label->dpy, label->screen), DefaultColormap(label->dpy, label->screen));
+	return theme_equal(&k->theme, &label->theme) &&
+	       k->width == label->width && k->height == label->height &&
+	       k->padding == label->padding && k->border_width == label->border_width &&
+	       k->border_radius == label->border_radius && k->border_enabled == label->border_enabled;
+}
+
+static void store_cache_key(LabelContext *label) {
+	LabelCacheKey *k = &label->cache_key;
+	free(k->text);
+	k->text = label->text ? strdup(label->text) : NULL;
+	k->theme = label->theme;
+	k->width = label->width;
+	k->height = label->height;
+	k->padding = label->padding;
+	k->border_width = label->border_width;
+	k->border_radius = label->border_radius;
+	k->border_enabled = label->border_enabled;
+	label->cache_valid = (k->text != NULL) == (label->text != NULL);
 }
 
 /* Update font and colors; recreate DBE/Xft and cache color; mark for redraw.
  * Returns 1 if window was resized, 0 otherwise. */
-static int update_appearance(LabelContext *label) {
+static int update_appearance(LabelContext *label, int font_changed) {
 	if (!label) {
 		return 0;
 	}
-	// Free old font
-	if (label->font) {
-		XftFontClose(label->dpy, label->font);
-		label->font = NULL;
-	}
-	
-	// Load new font with size
-	label->font = open_font(label->dpy, label->screen, label->theme.font_family[0] ? label->theme.font_family : "sans", label->theme.font_size);
-	if (!label->font) {
-		label->font = open_font(label->dpy, label->screen, "sans", 14);
+	if (font_changed || !label->font) {
+		// Free old font
+		if (label->font) {
+			XftFontClose(label->dpy, label->font);
+			label->font = NULL;
+		}
+
+		// Load new font with size
+		label->font = open_font(label->dpy, label->screen, label->theme.font_family[0] ? label->theme.font_family : "sans", label->theme.font_size);
+		if (!label->font) {
+			label->font = open_font(label->dpy, label->screen, "sans", 14);
+		}
 	}
 	
 	// Auto-calculate height based on font (same as entry boxes)
@@ -210,21 +249,26 @@ static int update_appearance(LabelContext *label) {
 			XResizeWindow(label->dpy, label->win, (unsigned int)label->width, (unsigned int)label->height);
 			did_resize = 1;
 		}
+		sync_node(label);
 	}
 	
-	// Reinitialize DBE buffers - XftDraw recreated atomically inside like entry boxes
-	if (label->win) {
-		init_label_buffers(label);
+	// Xft draws into the cache pixmap; it is retargeted when that is recreated
+	if ((label->win || label->comp) && !label->draw) {
+		label->draw = XftDrawCreate(label->dpy, label->win ? label->win : label->parent, DefaultVisual(label->dpy, label->screen), DefaultColormap(label->dpy, label->screen));
 	}
-	
-	// Cache colors like entry boxes - just overwrite, no free
+
 	if (label->draw) {
+		if (label->color_allocated) {
+			XftColorFree(label->dpy, DefaultVisual(label->dpy, label->screen), DefaultColormap(label->dpy, label->screen), &label->xft_color);
+		}
 		RGBA rgba_tmp = {label->theme.fg_r, label->theme.fg_g, label->theme.fg_b, label->theme.fg_a};
 		label->xft_color = xft_from_rgba(label->dpy, label->screen, rgba_tmp);
 		label->color_allocated = 1;
 	}
 	// Recalculate text size
-	calculate_text_size(label);
+	if (font_changed) {
+		calculate_text_size(label);
+	}
 	
 	// Mark for redraw; caller decides whether Expose will come from resize
 	label->needs_redraw = 1;
@@ -233,11 +277,21 @@ static int update_appearance(LabelContext *label) {
 	return did_resize;
 }
 
-/* Create label window */
-static void create_window(LabelContext *label) {
+/* Create label window, or the compositor node that replaces it */
+static void create_window(LabelContext *label, Compositor *comp) {
 	if (!label) {
 		return;
 	}
+	if (comp) {
+		label->node = compositor_add_node(comp, label_paint, label);
+		if (label->node >= 0) {
+			label->comp = comp;
+			label->gc = XCreateGC(label->dpy, label->parent, 0, NULL);
+			label->needs_redraw = 1;
+			sync_node(label);
+			return;
+		}
+	}
 	XSetWindowAttributes attrs = {
 		0
 	};
@@ -261,6 +315,7 @@ static void create_window(LabelContext *label) {
 
 	// Store label context in window for later retrieval
 	XSaveContext(label->dpy, label->win, 1, (XPointer)label);
+	label->gc = XCreateGC(label->dpy, label->win, 0, NULL);
 
 	// Ensure first Expose will trigger a draw
 	label->needs_redraw = 1;
@@ -276,7 +331,7 @@ static void create_window(LabelContext *label) {
  * See label.h for full documentation.
  * Initializes label window with text, font, colors, and optional DBE support.
  */
-LabelContext *label_create(Display *dpy, int screen, Window parent, int x, int y, int width, int padding, int border_width, int border_radius, int border_enabled, const char *text, const BaseTheme *theme) {
+LabelContext *label_create(Display *dpy, int screen, Window parent, int x, int y, int width, int padding, int border_width, int border_radius, int border_enabled, const char *text, const BaseTheme *theme, Compositor *comp) {
 	if (!dpy || !theme) {
 		return NULL;
 	}
@@ -305,11 +360,6 @@ LabelContext *label_create(Display *dpy, int screen, Window parent, int x, int y
 		label->text = strdup(text);
 	}
 	
-	// Initialize DBE context
-	label->dbe_ctx = dbe_init(dpy, screen);
-	label->dbe_back_buffer = None;
-	label->use_dbe = 0;
-	
 	// Load font FIRST for text measurement
 	label->font = open_font(label->dpy, label->screen, label->theme.font_family[0] ? label->theme.font_family : "sans", label->theme.font_size);
 	if (!label->font) {
@@ -319,11 +369,11 @@ LabelContext *label_create(Display *dpy, int screen, Window parent, int x, int y
 	calculate_text_size(label);
 
 	// Create window with correct size
-	create_window(label);
+	create_window(label, comp);
 
 	// THEN update appearance (now we have a window)
-	update_appearance(label);
-	if (!label->win || !label->font || !label->draw) {
+	update_appearance(label, 0);
+	if ((!label->win && !label->comp) || !label->font || !label->draw) {
 		label_destroy(label);
 		return NULL;
 	}
@@ -343,12 +393,9 @@ void label_destroy(LabelContext *label) {
 	if (label->text) {
 		free(label->text);
 	}
-	// Clean up DBE resources
-	if (label->dbe_back_buffer != None) {
-		dbe_deallocate_back_buffer(label->dbe_ctx, label->dbe_back_buffer);
-	}
-	if (label->dbe_ctx) {
-		dbe_destroy(label->dbe_ctx);
+	free(label->cache_key.text);
+	if (label->comp) {
+		compositor_remove_node(label->comp, label->node);
 	}
 	// Free Xft resources in correct order per X11/Xft best practices:
 	// 1. XftColorFree FIRST (before window destruction)
@@ -363,6 +410,12 @@ void label_destroy(LabelContext *label) {
 	if (label->font) {
 		XftFontClose(label->dpy, label->font);
 	}
+	if (label->cache) {
+		XFreePixmap(label->dpy, label->cache);
+	}
+	if (label->gc) {
+		XFreeGC(label->dpy, label->gc);
+	}
 	// 4. XDestroyWindow LAST
 	if (label->win) {
 		XDestroyWindow(label->dpy, label->win);
@@ -386,6 +439,9 @@ void label_set_text(LabelContext *label, const char *text) {
 	if (!label) {
 		return;
 	}
+	if ((!text && !label->text) || (text && label->text && strcmp(text, label->text) == 0)) {
+		return; // Unchanged; the cached rendering is still valid
+	}
 	if (label->text) {
 		free(label->text);
 		label->text = NULL;
@@ -404,12 +460,18 @@ void label_set_text(LabelContext *label, const char *text) {
 		if (h == 0) {
 			h = label->text_height + 4;
 		}
-		XResizeWindow(label->dpy, label->win, (unsigned int)w, (unsigned int)h);
+		if (label->win) {
+			XResizeWindow(label->dpy, label->win, (unsigned int)w, (unsigned int)h);
+		}
 		label->width = w;
 		label->height = h;
 	}
 	// Mark for redraw
 	label->needs_redraw = 1;
+	if (label->comp) {
+		label_redraw(label); // No window, so no Expose
+		return;
+	}
 	// Request Expose
 	if (label->visible) {
 		XEvent ev = {
@@ -431,16 +493,26 @@ void label_set_theme(LabelContext *label, const BaseTheme *theme) {
 	if (!label || !theme) {
 		return;
 	}
+	if (theme_equal(&label->theme, theme)) {
+		return; // Nothing to re-render
+	}
+	int font_changed = !theme_fonts_equal(&label->theme, theme);
 	label->theme = *theme;
-	int did_resize = update_appearance(label);
+	int did_resize = update_appearance(label, font_changed);
 
 	// Update background color with theme color
-	XSetWindowAttributes attrs;
-	attrs.background_pixel = to_px(label->dpy, label->screen, (RGBA) { theme->bg_r, theme->bg_g, theme->bg_b, theme->bg_a });
-	XChangeWindowAttributes(label->dpy, label->win, CWBackPixel, &attrs);
+	if (label->win) {
+		XSetWindowAttributes attrs;
+		attrs.background_pixel = to_px(label->dpy, label->screen, (RGBA) { theme->bg_r, theme->bg_g, theme->bg_b, theme->bg_a });
+		XChangeWindowAttributes(label->dpy, label->win, CWBackPixel, &attrs);
+	}
 	
     // Expose-only drawing to avoid double renders
     label->needs_redraw = 1;
+    if (label->comp) {
+        label_redraw(label); // No window, so no Expose
+        return;
+    }
     if (label->visible && !did_resize) {
         XEvent ev = {0};
         ev.type = Expose;
@@ -464,7 +536,22 @@ void label_move(LabelContext *label, int x, int y) {
     }
     label->x = x;
     label->y = y;
-    XMoveWindow(label->dpy, label->win, x, y);
+    if (label->win) {
+        XMoveWindow(label->dpy, label->win, x, y);
+    }
+    sync_node(label);
+}
+
+/* Grow a requested size to the minimum the text needs; 0 means minimum */
+static void fit_size(const LabelContext *label, int *w, int *h) {
+	int min_width = label->text_width + (label->padding * 2);
+	int min_height = (label->font ? (label->font->ascent + label->font->descent) : label->text_height) + (label->padding * 2) + 2;
+	if (*w < min_width) {
+		*w = min_width;
+	}
+	if (*h < min_height) {
+		*h = min_height;
+	}
 }
 
 void label_resize(LabelContext *label, int width, int height) {
@@ -473,45 +560,70 @@ void label_resize(LabelContext *label, int width, int height) {
     }
     int w = width;
     int h = height;
+    fit_size(label, &w, &h);
 
-	    // Calculate minimum required size for text (match update_appearance)
-    int min_width = label->text_width + (label->padding * 2);
-    int min_height = (label->font ? (label->font->ascent + label->font->descent) : label->text_height) + (label->padding * 2) + 2;
-	// Ensure width is at least minimum required for text
-	if (w == 0) {
-		w = min_width;
-	}
-	else if (w < min_width) {
-		w = min_width;
-	}
-	// Ensure height is at least minimum required for text
-	if (h == 0) {
-		h = min_height;
-	}
-	else if (h < min_height) {
-		h = min_height;
-	}
-	    
     // Only resize if size actually changed to avoid redundant Expose
     if (w != label->width || h != label->height) {
-        XResizeWindow(label->dpy, label->win, (unsigned int)w, (unsigned int)h);
+        if (label->win) {
+            XResizeWindow(label->dpy, label->win, (unsigned int)w, (unsigned int)h);
+        }
         label->width = w;
         label->height = h;
 
-        // Reinitialize DBE buffers - this handles XftDraw destroy/create internally
-        init_label_buffers(label);
-
-        // Cache colors like entry boxes - just overwrite, no free
-        if (label->draw) {
-            RGBA rgba_tmp = {label->theme.fg_r, label->theme.fg_g, label->theme.fg_b, label->theme.fg_a};
-            label->xft_color = xft_from_rgba(label->dpy, label->screen, rgba_tmp);
-            label->color_allocated = 1;
-        }
-        // Mark for redraw
+        // Mark for redraw; the cache key no longer matches
         label->needs_redraw = 1;
+        sync_node(label);
     }
 }
 
+void label_set_bounds(LabelContext *label, int x, int y, int width) {
+	if (!label) {
+		return;
+	}
+	int w = width;
+	int h = label->height;
+	fit_size(label, &w, &h);
+
+	// One ConfigureWindow carrying only the fields that changed
+	XWindowChanges changes;
+	unsigned int mask = 0;
+	if (x != label->x) {
+		changes.x = x;
+		mask |= CWX;
+	}
+	if (y != label->y) {
+		changes.y = y;
+		mask |= CWY;
+	}
+	if (w != label->width) {
+		changes.width = w;
+		mask |= CWWidth;
+	}
+	if (h != label->height) {
+		changes.height = h;
+		mask |= CWHeight;
+	}
+	if (!mask) {
+		return;
+	}
+	if (label->win) {
+		XConfigureWindow(label->dpy, label->win, mask, &changes);
+	}
+	label->x = x;
+	label->y = y;
+	label->width = w;
+	label->height = h;
+	if (mask & (CWWidth | CWHeight)) {
+		label->needs_redraw = 1;
+	}
+	sync_node(label);
+}
+
+void label_get_size(const LabelContext *label, int *width, int *height) {
+	*width = label ? label->width : 0;
+	*height = label ? label->height : 0;
+}
+
 void label_set_geometry(LabelContext *label, int padding, int border_width, int border_radius, int border_enabled) {
 	if (!label) {
 		return;
@@ -546,10 +658,12 @@ void label_set_geometry(LabelContext *label, int padding, int border_width, int
 			}
 			if (new_h != label->height) {
 				label->height = new_h;
-				XResizeWindow(label->dpy, label->win, (unsigned int)label->width, (unsigned int)label->height);
-				init_label_buffers(label);
+				if (label->win) {
+					XResizeWindow(label->dpy, label->win, (unsigned int)label->width, (unsigned int)label->height);
+				}
 			}
 		}
+		sync_node(label);
 		// Mark for redraw to show new borders/padding
 		label->needs_redraw = 1;
 	}
@@ -561,11 +675,15 @@ Window label_get_window(LabelContext *label) {
 
 // cppcheck-suppress unusedFunction
 void label_show(LabelContext *label) {
-	if (!label || !label->win) {
+	if (!label || (!label->win && !label->comp)) {
 		return;
 	}
-	XMapWindow(label->dpy, label->win);
 	label->visible = 1;
+	if (label->comp) {
+		sync_node(label);
+		return;
+	}
+	XMapWindow(label->dpy, label->win);
 	XFlush(label->dpy); // Ensure the window is mapped immediately
 }
 // cppcheck-suppress unusedFunction
@@ -574,44 +692,56 @@ void label_hide(LabelContext *label) {
 		return;
 	}
 	if (label->visible) {
-		XUnmapWindow(label->dpy, label->win);
 		label->visible = 0;
+		if (label->comp) {
+			sync_node(label);
+			return;
+		}
+		XUnmapWindow(label->dpy, label->win);
 	}
 }
 
-/* ========== RENDERING ========== */
+/* Keep the compositor node's rectangle and visibility in step with the label */
+static void sync_node(LabelContext *label) {
+	if (!label->comp) {
+		return;
+	}
+	compositor_set_node_bounds(label->comp, label->node, label->x, label->y, label->width, label->height);
+	compositor_set_node_visible(label->comp, label->node, label->visible);
+}
 
-/* Internal draw function - like entry redraw():
- * Draw everything to the back buffer in this order and swap once:
- * 1) clear/fill background
- * 2) draw text
- * 3) draw border
- * 4) DBE swap */
-static void label_redraw(LabelContext *label) {
-	if (!label || !label->draw || !label->font) {
+/* Compositor paint callback */
+static void label_paint(Drawable target, int x, int y, void *user_data) {
+	LabelContext *label = user_data;
+	if (!label->draw || !label->font) {
 		return;
 	}
-	
-	// Determine drawing target
-	Drawable draw_target = label->use_dbe ? label->dbe_back_buffer : label->win;
-	
-	// Clear and fill background
-	if (label->use_dbe) {
-		// For DBE, clear only the back buffer using XFillRectangle
-		GC clear_gc = XCreateGC(label->dpy, label->win, 0, NULL);
-		XSetForeground(label->dpy, clear_gc, to_px(label->dpy, label->screen, (RGBA) { label->theme.bg_r, label->theme.bg_g,
-			                                                           label->theme.bg_b, label->theme.bg_a }));
-		XFillRectangle(label->dpy, draw_target, clear_gc, 0, 0, (unsigned int)label->width, (unsigned int)label->height);
-		XFreeGC(label->dpy, clear_gc);
-	} else {
-		// For non-DBE, work directly with window
-		GC clear_gc = XCreateGC(label->dpy, label->win, 0, NULL);
-		XSetForeground(label->dpy, clear_gc, to_px(label->dpy, label->screen, (RGBA) { label->theme.bg_r, label->theme.bg_g,
-			                                                           label->theme.bg_b, label->theme.bg_a }));
-		XFillRectangle(label->dpy, label->win, clear_gc, 0, 0, (unsigned int)label->width, (unsigned int)label->height);
-		XFreeGC(label->dpy, clear_gc);
+	if (!cache_matches(label)) {
+		render_cache(label);
 	}
-	
+	XCopyArea(label->dpy, label->cache, target, label->gc, 0, 0, (unsigned int)label->cache_w, (unsigned int)label->cache_h, x, y);
+}
+
+/* ========== RENDERING ========== */
+
+/* Render background, text and border into the cache pixmap */
+static void render_cache(LabelContext *label) {
+	if (!label->cache || label->cache_w != label->width || label->cache_h != label->height) {
+		if (label->cache) {
+			XFreePixmap(label->dpy, label->cache);
+		}
+		label->cache_w = label->width > 0 ? label->width : 1;
+		label->cache_h = label->height > 0 ? label->height : 1;
+		label->cache = XCreatePixmap(label->dpy, label->win ? label->win : label->parent, (unsigned int)label->cache_w, (unsigned int)label->cache_h, (unsigned int)DefaultDepth(label->dpy, label->screen));
+		XftDrawChange(label->draw, label->cache);
+	}
+	Drawable draw_target = label->cache;
+
+	// Clear and fill background
+	XSetForeground(label->dpy, label->gc, to_px(label->dpy, label->screen, (RGBA) { label->theme.bg_r, label->theme.bg_g,
+		                                                     label->theme.bg_b, label->theme.bg_a }));
+	XFillRectangle(label->dpy, draw_target, label->gc, 0, 0, (unsigned int)label->cache_w, (unsigned int)label->cache_h);
+
 	if (label->text && label->font) {
 		// Centered baseline calculation (same as entry boxes for vertical alignment)
 		int pad = label->padding;
@@ -625,13 +755,11 @@ static void label_redraw(LabelContext *label) {
 		// Horizontal text position (same as entry boxes: pad + 2)
 		int text_x = pad + 2;
 
-		// Draw text to back buffer
 		XftDrawStringUtf8(label->draw, &label->xft_color, label->font, text_x, baseline, (const FcChar8 *)label->text, (int)strlen(label->text));
 	}
 	
-	// Draw border to back buffer BEFORE swap - everything drawn to buffer first
 	if (label->border_enabled && label->border_width > 0) {
-		GC border_gc = XCreateGC(label->dpy, label->win, 0, NULL);
+		GC border_gc = label->gc;
 		XSetForeground(label->dpy, border_gc, to_px(label->dpy, label->screen, (RGBA) { label->theme.border_r, label->theme.border_g,
 		                                                           label->theme.border_b, label->theme.border_a }));
 		XSetLineAttributes(label->dpy, border_gc, (unsigned int)label->border_width, LineSolid, CapButt, JoinMiter);
@@ -642,7 +770,7 @@ static void label_redraw(LabelContext *label) {
 		int border_height = label->height - label->border_width;
 		
 		if (label->border_radius > 0) {
-			// Draw rounded rectangle border to BUFFER
+			// Draw rounded rectangle border
 			int radius = label->border_radius;
 			int diameter = radius * 2;
 			
@@ -661,18 +789,29 @@ static void label_redraw(LabelContext *label) {
 			XDrawArc(label->dpy, draw_target, border_gc, inset, inset + border_height - diameter, (unsigned int)diameter, (unsigned int)diameter, 180 * 64, 90 * 64);
 			XDrawArc(label->dpy, draw_target, border_gc, inset + border_width - diameter, inset + border_height - diameter, (unsigned int)diameter, (unsigned int)diameter, 270 * 64, 90 * 64);
 		} else {
-			// Draw simple rectangle border to BUFFER
+			// Draw simple rectangle border
 			XDrawRectangle(label->dpy, draw_target, border_gc, inset, inset, (unsigned int)border_width, (unsigned int)border_height);
 		}
-		
-		XFreeGC(label->dpy, border_gc);
 	}
-	
-	// NOW swap buffers to present everything at once
-	if (label->use_dbe) {
-		dbe_swap_buffers(label->dbe_ctx, label->win, XdbeUndefined);
+	store_cache_key(label);
+}
+
+/* Internal draw function: re-render the cache only if its key changed,
+ * then present it with a single copy */
+static void label_redraw(LabelContext *label) {
+	if (!label || !label->draw || !label->font) {
+		return;
 	}
-	
+	if (label->comp) {
+		// Painted by the compositor's next frame
+		sync_node(label);
+		compositor_damage_node(label->comp, label->node);
+		return;
+	}
+	if (!cache_matches(label)) {
+		render_cache(label);
+	}
+	XCopyArea(label->dpy, label->cache, label->win, label->gc, 0, 0, (unsigned int)label->cache_w, (unsigned int)label->cache_h, 0, 0);
 	XFlush(label->dpy);
 }
 
@@ -779,8 +918,6 @@ int label_config_write(FILE *f, const LabelConfig *label_cfg) {
 
 // cppcheck-suppress unusedFunction
 int label_is_using_dbe(const LabelContext *label) {
-	if (!label) {
-		return 0;
-	}
-	return label->use_dbe;
+	(void)label;
+	return 0; // Labels present from their cached pixmap
 }
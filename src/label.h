@@ -17,14 +17,14 @@
  * - Full Xft font rendering with antialiasing
  * - Themeable colors and rounded borders
  * - Dynamic text updates without recreation
- * - Optional double-buffer extension (DBE) for smooth rendering
+ * - Rendered once into a cached pixmap; expose is a single copy
  * - Show/hide functionality
  * - Fully portable - no application-specific dependencies
  *
  * Dependencies:
  * - X11 (Xlib)
  * - Xft (font rendering with antialiasing)
- * - dbe.h (optional double-buffering)
+ * - compositor.h (optional single-window rendering)
  *
  * Usage:
  *   1. Create label: label_create(display, screen, parent, x, y, width, ...)
@@ -40,6 +40,7 @@
 
 #include <X11/Xlib.h>
 #include <X11/Xft/Xft.h>
+#include "compositor.h"
 
 /* ========== TYPE DEFINITIONS ========== */
 
@@ -74,10 +75,14 @@ typedef struct LabelContext LabelContext;
  * @param border_enabled Whether border is enabled
  * @param text Text to display
  * @param theme Theme configuration (colors and fonts only)
+ * @param comp Compositor of parent, or NULL for a window of its own. With a
+ *             compositor no window is created: the label is a node that
+ *             appears with the compositor's next frame, and it must be
+ *             destroyed before the compositor.
  *
  * @return Label context pointer, or NULL on failure
  */
-LabelContext *label_create(Display *dpy, int screen, Window parent, int x, int y, int width, int padding, int border_width, int border_radius, int border_enabled, const char *text, const BaseTheme *theme);
+LabelContext *label_create(Display *dpy, int screen, Window parent, int x, int y, int width, int padding, int border_width, int border_radius, int border_enabled, const char *text, const BaseTheme *theme, Compositor *comp);
 
 /**
  * @brief Destroy a label widget
@@ -119,6 +124,26 @@ void label_move(LabelContext *label, int x, int y);
  */
 void label_resize(LabelContext *label, int width, int height);
 
+/**
+ * @brief Move and resize the label with a single request
+ * @param label Label context
+ * @param x New X position
+ * @param y New Y position
+ * @param width New width (grown to fit the text; 0 for auto-size)
+ *
+ * The height stays as set by label_set_geometry(). Nothing is sent when the
+ * geometry is unchanged.
+ */
+void label_set_bounds(LabelContext *label, int x, int y, int width);
+
+/**
+ * @brief Get the label's current size
+ * @param label Label context
+ * @param width Receives the width
+ * @param height Receives the height
+ */
+void label_get_size(const LabelContext *label, int *width, int *height);
+
 /**
  * @brief Update label geometry (borders and padding)
  * @param label Label context
@@ -135,7 +160,7 @@ void label_set_geometry(LabelContext *label, int padding, int border_width, int
  * @brief Get label's X11 window
  * @param label Label context
  *
- * @return X11 window ID
+ * @return X11 window ID, or None for a compositor node
  */
 Window label_get_window(LabelContext *label);
 
@@ -213,7 +238,8 @@ int label_config_write(FILE *f, const LabelConfig *label_cfg);
 /**
  * @brief Get DBE usage status for debugging
  * @param label Pointer to label context
- * @return 1 if DBE is being used, 0 otherwise
+ * @return Always 0: labels are presented from a cached pixmap, which is
+ *         flicker-free without DBE
  */
 int label_is_using_dbe(const LabelContext *label);
 
@@ -0,0 +1,149 @@
+/* layout.c - Box Layout Engine Implementation
+ *
+ * Computes widget rectangles from a tree of rows, columns and items.
+ *
+ * Internal design notes:
+ * - Nodes are stored in creation order and a child is always created after
+ *   its parent, so one backward sweep measures every box from its children
+ *   and one forward sweep places every node inside its parent.
+ * - Each box keeps a running cursor along its direction during placement;
+ *   pinned children skip the cursor.
+ */
+
+#include "layout.h"
+#include <string.h>
+
+/* ========== INTERNAL HELPERS ========== */
+
+static int add_node(Layout *layout, int parent) {
+	if (!layout || layout->count >= LAYOUT_MAX_NODES) {
+		return -1;
+	}
+	if (parent >= layout->count || (parent >= 0 && !layout->nodes[parent].is_box)) {
+		return -1;
+	}
+	int id = layout->count++;
+	memset(&layout->nodes[id], 0, sizeof(LayoutNode));
+	layout->nodes[id].parent = parent < 0 ? -1 : parent;
+	return id;
+}
+
+static int align_offset(LayoutAlign align, int space, int size) {
+	switch (align) {
+		case LAYOUT_ALIGN_CENTER:
+			return (space - size) / 2;
+		case LAYOUT_ALIGN_END:
+			return space - size;
+		default:
+			return 0;
+	}
+}
+
+/* ========== BUILDING ========== */
+
+void layout_init(Layout *layout) {
+	if (layout) {
+		layout->count = 0;
+	}
+}
+
+int layout_add_box(Layout *layout, int parent, LayoutDirection direction, int spacing, LayoutAlign align) {
+	int id = add_node(layout, parent);
+	if (id >= 0) {
+		LayoutNode *n = &layout->nodes[id];
+		n->is_box = 1;
+		n->direction = direction;
+		n->spacing = spacing > 0 ? spacing : 0;
+		n->align = align;
+	}
+	return id;
+}
+
+int layout_add_item(Layout *layout, int parent, int width, int height) {
+	int id = add_node(layout, parent);
+	if (id >= 0) {
+		layout->nodes[id].rect.width = width > 0 ? width : 0;
+		layout->nodes[id].rect.height = height > 0 ? height : 0;
+	}
+	return id;
+}
+
+void layout_pin(Layout *layout, int node, int x, int y) {
+	if (!layout || node < 0 || node >= layout->count) {
+		return;
+	}
+	layout->nodes[node].pinned = 1;
+	layout->nodes[node].pin_x = x;
+	layout->nodes[node].pin_y = y;
+}
+
+/* ========== COMPUTATION ========== */
+
+void layout_compute(Layout *layout, int x, int y) {
+	if (!layout) {
+		return;
+	}
+	int flow_count[LAYOUT_MAX_NODES] = {0};
+	int cursor[LAYOUT_MAX_NODES] = {0};
+
+	// Measure: boxes start empty and grow from their flowing children
+	for (int i = 0; i < layout->count; i++) {
+		if (layout->nodes[i].is_box) {
+			layout->nodes[i].rect.width = layout->nodes[i].rect.height = 0;
+		}
+	}
+	for (int i = layout->count - 1; i >= 0; i--) {
+		const LayoutNode *n = &layout->nodes[i];
+		if (n->parent < 0 || n->pinned) {
+			continue;
+		}
+		LayoutNode *p = &layout->nodes[n->parent];
+		int gap = flow_count[n->parent]++ > 0 ? p->spacing : 0;
+		if (p->direction == LAYOUT_ROW) {
+			p->rect.width += n->rect.width + gap;
+			if (n->rect.height > p->rect.height) {
+				p->rect.height = n->rect.height;
+			}
+		}
+		else {
+			p->rect.height += n->rect.height + gap;
+			if (n->rect.width > p->rect.width) {
+				p->rect.width = n->rect.width;
+			}
+		}
+	}
+
+	// Place: parents are final before their children are visited
+	for (int i = 0; i < layout->count; i++) {
+		LayoutNode *n = &layout->nodes[i];
+		if (n->parent < 0) {
+			n->rect.x = x + (n->pinned ? n->pin_x : 0);
+			n->rect.y = y + (n->pinned ? n->pin_y : 0);
+			continue;
+		}
+		LayoutNode *p = &layout->nodes[n->parent];
+		if (n->pinned) {
+			n->rect.x = p->rect.x + n->pin_x;
+			n->rect.y = p->rect.y + n->pin_y;
+			continue;
+		}
+		int *c = &cursor[n->parent];
+		if (p->direction == LAYOUT_ROW) {
+			n->rect.x = p->rect.x + *c;
+			n->rect.y = p->rect.y + align_offset(p->align, p->rect.height, n->rect.height);
+			*c += n->rect.width + p->spacing;
+		}
+		else {
+			n->rect.x = p->rect.x + align_offset(p->align, p->rect.width, n->rect.width);
+			n->rect.y = p->rect.y + *c;
+			*c += n->rect.height + p->spacing;
+		}
+	}
+}
+
+LayoutRect layout_get_rect(const Layout *layout, int node) {
+	if (!layout || node < 0 || node >= layout->count) {
+		return (LayoutRect){0, 0, 0, 0};
+	}
+	return layout->nodes[node].rect;
+}
@@ -0,0 +1,134 @@
+#ifndef LAYOUT_H_
+#define LAYOUT_H_
+
+/* ========== WIDGET LAYOUT INTERFACE ========== */
+
+/**
+ * @file layout.h
+ * @brief Small box layout engine (rows, columns, spacing, alignment)
+ *
+ * A layout is a tree of boxes and fixed-size items kept in one flat array.
+ * Boxes stack their children along a row or a column with a gap between
+ * them and align them on the other axis. A node can instead be pinned at an
+ * offset inside its parent, which keeps absolute positions expressible in
+ * the same tree. layout_compute() sizes and places every node in one call.
+ *
+ * The engine only does arithmetic; the caller applies the resulting
+ * rectangles to its windows.
+ *
+ * Dependencies:
+ * - None
+ *
+ * Usage:
+ *   Layout layout;
+ *   layout_init(&layout);
+ *   int root = layout_add_box(&layout, -1, LAYOUT_COLUMN, 8, LAYOUT_ALIGN_START);
+ *   int row = layout_add_box(&layout, root, LAYOUT_ROW, 13, LAYOUT_ALIGN_CENTER);
+ *   int label = layout_add_item(&layout, row, 60, 27);
+ *   int entry = layout_add_item(&layout, row, 197, 22);
+ *   layout_compute(&layout, 310, 40);
+ *   LayoutRect r = layout_get_rect(&layout, entry);
+ *
+ * Thread safety: A Layout may be used by one thread at a time
+ * Memory: No allocation; a Layout lives wherever the caller puts it
+ */
+
+/* Maximum number of boxes and items in one layout */
+#define LAYOUT_MAX_NODES 64
+
+/* ========== TYPE DEFINITIONS ========== */
+
+typedef enum {
+	LAYOUT_ROW = 0,  // Children left to right
+	LAYOUT_COLUMN    // Children top to bottom
+} LayoutDirection;
+
+/* Placement of children across the box's direction */
+typedef enum {
+	LAYOUT_ALIGN_START = 0,
+	LAYOUT_ALIGN_CENTER,
+	LAYOUT_ALIGN_END
+} LayoutAlign;
+
+typedef struct {
+	int x, y;
+	int width, height;
+} LayoutRect;
+
+typedef struct {
+	int parent;       // -1 for a root
+	int is_box;
+	LayoutDirection direction;
+	LayoutAlign align;
+	int spacing;
+	int pinned;       // Placed at (pin_x, pin_y) in the parent, outside the flow
+	int pin_x, pin_y;
+	LayoutRect rect;  // Item size on input; every node's result after compute
+} LayoutNode;
+
+typedef struct {
+	LayoutNode nodes[LAYOUT_MAX_NODES];
+	int count;
+} Layout;
+
+/* ========== BUILDING ========== */
+
+/**
+ * @brief Start an empty layout
+ * @param layout Layout to reset
+ */
+void layout_init(Layout *layout);
+
+/**
+ * @brief Add a box that stacks its children
+ * @param layout Layout
+ * @param parent Parent box, or -1 for a root
+ * @param direction LAYOUT_ROW or LAYOUT_COLUMN
+ * @param spacing Gap between consecutive children in pixels
+ * @param align Alignment of children on the other axis
+ * @return Node id, or -1 if the layout is full or parent is not a box
+ */
+int layout_add_box(Layout *layout, int parent, LayoutDirection direction, int spacing, LayoutAlign align);
+
+/**
+ * @brief Add a fixed-size item
+ * @param layout Layout
+ * @param parent Parent box, or -1 for a root
+ * @param width Item width
+ * @param height Item height
+ * @return Node id, or -1 if the layout is full or parent is not a box
+ */
+int layout_add_item(Layout *layout, int parent, int width, int height);
+
+/**
+ * @brief Pin a node at an offset inside its parent
+ * @param layout Layout
+ * @param node Node id
+ * @param x Offset from the parent's left edge (or the origin for a root)
+ * @param y Offset from the parent's top edge (or the origin for a root)
+ *
+ * A pinned node takes no space in its parent's flow.
+ */
+void layout_pin(Layout *layout, int node, int x, int y);
+
+/* ========== COMPUTATION ========== */
+
+/**
+ * @brief Size and place every node
+ * @param layout Layout
+ * @param x Origin of root nodes
+ * @param y Origin of root nodes
+ *
+ * Roots that are not pinned are placed at the origin.
+ */
+void layout_compute(Layout *layout, int x, int y);
+
+/**
+ * @brief Get a node's rectangle after layout_compute()
+ * @param layout Layout
+ * @param node Node id
+ * @return The rectangle, or an empty one for an invalid id
+ */
+LayoutRect layout_get_rect(const Layout *layout, int node);
+
+#endif /* LAYOUT_H_ */
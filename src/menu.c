@@ -16,7 +16,16 @@
  *
  * Internal design notes:
  * - Menubar and submenus are separate override-redirect windows for simplicity.
- * - Layout is computed once per theme update; positions are cached.
+ * - Layout is computed once per theme update (menubar_layout): segment
+ *   edges, title positions, dropdown sizes and item edges are stored, so no
+ *   text is measured while hovering or drawing.
+ * - Hit-testing is a binary search over stored edges. A hover change
+ *   repaints only the segments or items whose highlight changed.
+ * - Each dropdown keeps its XftDraw for the lifetime of its window.
+ * - Created with a compositor, the bar itself is a node: win is the node's
+ *   input id, paint_bar() draws into the compositor's frame at the node's
+ *   position, and redraws only damage the node. Dropdowns keep their
+ *   override-redirect windows.
  * - Event routing ensures only one submenu is active at a time.
  */
 
@@ -37,15 +46,28 @@
 #define SUBMENU_BORDER_WIDTH 1
 #define MENU_ITEM_COUNT 3
 #define SUBMENU_TEXT_OFFSET 8
+#define DROPDOWN_MAX_ITEMS 4 /* Matches the MenuConfig item arrays */
+
+/* One dropdown and its layout (menubar_layout) */
+typedef struct {
+	Window win; // Created on first show
+	XftDraw *draw; // Persistent Xft context for win
+	const char **items;
+	int count;
+	int x; // Left edge relative to the menubar
+	int width, height;
+	int item_edge[DROPDOWN_MAX_ITEMS + 1]; // Item i spans [item_edge[i], item_edge[i + 1])
+} Dropdown;
 
 struct MenuBar {
 	Display *dpy;
 	Window parent;
-	Window win;
-	Window file_menu_win;
-	Window edit_menu_win;
-	Window about_menu_win;
+	Window win; // Node input id when comp is set
+	Compositor *comp; // NULL when the bar has a window of its own
+	int node;
+	Dropdown menus[MENU_ITEM_COUNT]; // File, Edit, About
 	GC gc;
+	GC submenu_gc; // Shared by the dropdowns (same root and depth as the bar)
 	int screen;
 
 	int x, y, width;
@@ -65,12 +87,11 @@ struct MenuBar {
 	int drag_start_x;
 	int drag_start_y;
 
-	int file_menu_width;
-	int file_menu_height;
-	int edit_menu_width;
-	int edit_menu_height;
-	int about_menu_width;
-	int about_menu_height;
+	// Menubar layout: segment i spans [seg_edge[i], seg_edge[i + 1])
+	int seg_edge[MENU_ITEM_COUNT + 1];
+	int title_x[MENU_ITEM_COUNT];
+	int seg_lit[MENU_ITEM_COUNT]; // Highlight state last painted per segment
+	int root_x, root_y; // Menubar origin on the root window while a dropdown is open
 
 	unsigned long fg, bg, hover_bg, border;
 	MenuBlock style;
@@ -83,6 +104,8 @@ struct MenuBar {
 	int submenu_item_height; // dynamic height for dropdown items
 };
 
+static void menubar_paint(Drawable target, int x, int y, void *user_data);
+
 /* ========== RENDERING HELPERS ========== */
 /* Color conversion and font loading now centralized in config.c */
 
@@ -270,6 +293,84 @@ static void apply_submenu_shape(MenuBar *bar, Window win, int width, int height)
 	XFreePixmap(bar->dpy, mask);
 }
 
+/* ========== LAYOUT ========== */
+
+/* Index i with edges[i] <= pos < edges[i + 1] (edges ascending), or -1 */
+static int find_span(const int *edges, int count, int pos) {
+	if (count <= 0 || pos < edges[0] || pos >= edges[count]) {
+		return -1;
+	}
+	int lo = 0, hi = count - 1;
+	while (lo < hi) {
+		int mid = (lo + hi + 1) / 2;
+		if (edges[mid] <= pos) {
+			lo = mid;
+		}
+		else {
+			hi = mid - 1;
+		}
+	}
+	return lo;
+}
+
+static int text_advance(const MenuBar *bar, const char *text) {
+	XGlyphInfo ext;
+	XftTextExtentsUtf8(bar->dpy, bar->font, (const FcChar8 *)text, (int)strlen(text), &ext);
+	return ext.xOff;
+}
+
+/* Measure titles and dropdown items; runs on creation and theme changes */
+static void menubar_layout(MenuBar *bar) {
+	// Segments split the area inside the border evenly, leftmost ones first
+	// taking the remainder
+	int inner_x = bar->border_width > 0 ? 1 : 0;
+	int inner_w = bar->width - (bar->border_width > 0 ? 2 : 0);
+	if (inner_w < 0) {
+		inner_w = 0;
+	}
+	int base_w = inner_w / MENU_ITEM_COUNT;
+	int rem = inner_w % MENU_ITEM_COUNT;
+	bar->seg_edge[0] = inner_x;
+	for (int i = 0; i < MENU_ITEM_COUNT; i++) {
+		int seg_w = base_w + (rem > i ? 1 : 0);
+		bar->seg_edge[i + 1] = bar->seg_edge[i] + seg_w;
+		bar->title_x[i] = bar->seg_edge[i] + (seg_w - text_advance(bar, bar->items[i])) / 2;
+		bar->seg_lit[i] = -1; // Unknown until painted
+	}
+
+	const char **items[MENU_ITEM_COUNT] = {
+		bar->config.file_items, bar->config.edit_items, bar->config.about_items
+	};
+	int counts[MENU_ITEM_COUNT] = {
+		bar->config.file_count, bar->config.edit_count, bar->config.about_count
+	};
+	// Horizontal padding scales with font size
+	int h_padding = bar->font->height;
+	if (h_padding < 12) h_padding = 12;
+	for (int i = 0; i < MENU_ITEM_COUNT; i++) {
+		Dropdown *d = &bar->menus[i];
+		d->items = items[i];
+		d->count = counts[i] < 0 ? 0 : counts[i] > DROPDOWN_MAX_ITEMS ? DROPDOWN_MAX_ITEMS : counts[i];
+		// File drops from the bar's left edge, the others from their segment
+		d->x = i == 0 ? 0 : bar->seg_edge[i];
+		d->width = MENUBAR_ITEM_MIN_WIDTH;
+		for (int j = 0; j < d->count; j++) {
+			int item_width = text_advance(bar, d->items[j]) + h_padding + (bar->border_width * 2);
+			if (item_width > d->width) {
+				d->width = item_width;
+			}
+		}
+		d->height = d->count * bar->submenu_item_height + (bar->border_width * 2);
+		for (int j = 0; j <= d->count; j++) {
+			d->item_edge[j] = bar->border_width + j * bar->submenu_item_height;
+		}
+		if (d->win && d->count > 0) {
+			XResizeWindow(bar->dpy, d->win, (unsigned int)d->width, (unsigned int)d->height);
+			apply_submenu_shape(bar, d->win, d->width, d->height);
+		}
+	}
+}
+
 /* ========== MENUBAR CREATION ========== */
 
 /**
@@ -278,7 +379,7 @@ static void apply_submenu_shape(MenuBar *bar, Window win, int width, int height)
  * See menu.h for full documentation.
  * Initializes menubar window with specified menu items and theme.
  */
-MenuBar *menubar_create_with_config(Display *dpy, Window parent, const struct MenuBlock *style, int x, int y, int width, int border_width, int border_radius, int padding, const MenuConfig *config) {
+MenuBar *menubar_create_with_config(Display *dpy, Window parent, const struct MenuBlock *style, int x, int y, int width, int border_width, int border_radius, int padding, const MenuConfig *config, Compositor *comp) {
 	if (!dpy || !style) {
 		return NULL;
 	}
@@ -322,25 +423,30 @@ MenuBar *menubar_create_with_config(Display *dpy, Window parent, const struct Me
 	bar->hover_index = -1;
 	bar->active_menu = 0;
 	bar->active_submenu = -1;
-	bar->file_menu_width = 0;
-	bar->file_menu_height = 0;
-	bar->edit_menu_width = 0;
-	bar->edit_menu_height = 0;
-	bar->about_menu_width = 0;
-	bar->about_menu_height = 0;
-
-	XSetWindowAttributes attr;
-	attr.event_mask = ExposureMask | ButtonPressMask | ButtonReleaseMask | PointerMotionMask | EnterWindowMask | LeaveWindowMask;
-
-	bar->win = XCreateWindow(dpy, parent, bar->x, bar->y, (unsigned int)bar->width, (unsigned int)MENUBAR_HEIGHT, 0, CopyFromParent, InputOutput, CopyFromParent, CWEventMask, &attr);
-
-	bar->gc = XCreateGC(dpy, bar->win, 0, NULL);
-	bar->file_menu_win = 0;
-	bar->edit_menu_win = 0;
-	bar->about_menu_win = 0;
+
+	if (comp) {
+		bar->node = compositor_add_node(comp, menubar_paint, bar);
+		if (bar->node >= 0) {
+			bar->comp = comp;
+			bar->win = compositor_node_window(comp, bar->node);
+			compositor_set_node_bounds(comp, bar->node, bar->x, bar->y, bar->width, MENUBAR_HEIGHT);
+		}
+	}
+	if (!bar->comp) {
+		XSetWindowAttributes attr;
+		attr.event_mask = ExposureMask | ButtonPressMask | ButtonReleaseMask | PointerMotionMask | EnterWindowMask | LeaveWindowMask;
+
+		bar->win = XCreateWindow(dpy, parent, bar->x, bar->y, (unsigned int)bar->width, (unsigned int)MENUBAR_HEIGHT, 0, CopyFromParent, InputOutput, CopyFromParent, CWEventMask, &attr);
+	}
+
+	// A node draws with the compositor's XftDraw (see menubar_paint())
+	bar->gc = XCreateGC(dpy, bar->comp ? parent : bar->win, 0, NULL);
+	bar->submenu_gc = XCreateGC(dpy, bar->comp ? parent : bar->win, 0, NULL);
 	// Initialize Xft for menubar text rendering
 	bar->font = config_open_font(dpy, bar->screen, style->font_family, style->font_size);
-	bar->draw = XftDrawCreate(dpy, bar->win, DefaultVisual(dpy, bar->screen), DefaultColormap(dpy, bar->screen));
+	if (!bar->comp) {
+		bar->draw = XftDrawCreate(dpy, bar->win, DefaultVisual(dpy, bar->screen), DefaultColormap(dpy, bar->screen));
+	}
 	XRenderColor xr;
 	#define CLAMP_COMP(c) ((c) < 0.0 ? 0 : (c) > 1.0 ? 65535 : (unsigned short)((c) * 65535.0 + 0.5))
 	xr.red = CLAMP_COMP(style->fg.r);
@@ -355,7 +461,13 @@ MenuBar *menubar_create_with_config(Display *dpy, Window parent, const struct Me
 	int vertical_padding = (font_height * 2) / 5;  // 40% of font height
 	if (vertical_padding < 8) vertical_padding = 8;
 	bar->submenu_item_height = font_height + vertical_padding;
-	XMapWindow(dpy, bar->win);
+	menubar_layout(bar);
+	if (bar->comp) {
+		compositor_damage_node(bar->comp, bar->node);
+	}
+	else {
+		XMapWindow(dpy, bar->win);
+	}
 	return bar;
 }
 
@@ -368,13 +480,13 @@ MenuBar *menubar_create(Display *dpy, Window parent, const MiniTheme *theme) {
 	// Legacy wrapper - for backward compatibility
 	MenuConfig default_config = {
 		.file_items = { "Exit" },
-		.edit_items = { "Configuration", "Reset" },
+		.edit_items = { "Configuration", "Reset", "Find Color" },
 		.about_items = { "PixelPrism" },
 		.file_count = 1,
-		.edit_count = 2,
+		.edit_count = 3,
 		.about_count = 1
 	};
-	return menubar_create_with_config(dpy, parent, &theme->menubar, theme->menubar_widget.menubar_x, theme->menubar_widget.menubar_y, theme->menubar_widget.width, theme->menubar_widget.border_width, theme->menubar_widget.border_radius, theme->menubar_widget.padding, &default_config);
+	return menubar_create_with_config(dpy, parent, &theme->menubar, theme->menubar_widget.menubar_x, theme->menubar_widget.menubar_y, theme->menubar_widget.width, theme->menubar_widget.border_width, theme->menubar_widget.border_radius, theme->menubar_widget.padding, &default_config, NULL);
 }
 
 /**
@@ -386,23 +498,27 @@ void menubar_destroy(MenuBar *bar) {
 	if (!bar) {
 		return;
 	}
-	if (bar->file_menu_win) {
-		XDestroyWindow(bar->dpy, bar->file_menu_win);
-	}
-	if (bar->edit_menu_win) {
-		XDestroyWindow(bar->dpy, bar->edit_menu_win);
-	}
-	if (bar->about_menu_win) {
-		XDestroyWindow(bar->dpy, bar->about_menu_win);
+	for (int i = 0; i < MENU_ITEM_COUNT; i++) {
+		// XftDraw before its window
+		if (bar->menus[i].draw) {
+			XftDrawDestroy(bar->menus[i].draw);
+		}
+		if (bar->menus[i].win) {
+			XDestroyWindow(bar->dpy, bar->menus[i].win);
+		}
 	}
 	if (bar->draw) {
 		XftDrawDestroy(bar->draw);
 	}
+	if (bar->comp) {
+		compositor_remove_node(bar->comp, bar->node);
+	}
 	if (bar->font) {
 		XftFontClose(bar->dpy, bar->font);
 	}
 	XftColorFree(bar->dpy, DefaultVisual(bar->dpy, bar->screen), DefaultColormap(bar->dpy, bar->screen), &bar->xft_fg);
 	XFreeGC(bar->dpy, bar->gc);
+	XFreeGC(bar->dpy, bar->submenu_gc);
 	free(bar);
 }
 
@@ -413,14 +529,10 @@ static void menubar_hide_submenus(MenuBar *bar) {
 
     int had_active_menu = bar->active_menu != 0;
 
-    if (bar->file_menu_win) {
-        XUnmapWindow(bar->dpy, bar->file_menu_win);
-    }
-    if (bar->edit_menu_win) {
-        XUnmapWindow(bar->dpy, bar->edit_menu_win);
-    }
-    if (bar->about_menu_win) {
-        XUnmapWindow(bar->dpy, bar->about_menu_win);
+    for (int i = 0; i < MENU_ITEM_COUNT; i++) {
+        if (bar->menus[i].win) {
+            XUnmapWindow(bar->dpy, bar->menus[i].win);
+        }
     }
 
     if (had_active_menu) {
@@ -472,394 +584,299 @@ void menubar_set_theme(MenuBar *bar, const MiniTheme *theme) {
 	int vertical_padding = (font_height * 2) / 5;  // 40% of font height
 	if (vertical_padding < 8) vertical_padding = 8;
 	bar->submenu_item_height = font_height + vertical_padding;
-	// Resize menubar window to new width
-	XResizeWindow(bar->dpy, bar->win, (unsigned int)bar->width, (unsigned int)MENUBAR_HEIGHT);
+	// Resize menubar window (or node) to new width
+	if (bar->comp) {
+		compositor_set_node_bounds(bar->comp, bar->node, bar->x, bar->y, bar->width, MENUBAR_HEIGHT);
+	}
+	else {
+		XResizeWindow(bar->dpy, bar->win, (unsigned int)bar->width, (unsigned int)MENUBAR_HEIGHT);
+	}
 	// Hide any open submenus since their sizes/colors may change
 	menubar_hide_submenus(bar);
+	menubar_layout(bar);
 	bar->hover_index = -1;
 	// Redraw
 	menubar_draw(bar);
 }
 
+/* Apply bar->x and bar->y to the window or compositor node */
+static void move_bar(MenuBar *bar) {
+	if (bar->comp) {
+		compositor_set_node_bounds(bar->comp, bar->node, bar->x, bar->y, bar->width, MENUBAR_HEIGHT);
+	}
+	else {
+		XMoveWindow(bar->dpy, bar->win, bar->x, bar->y);
+	}
+}
+
 void menubar_set_position(MenuBar *bar, int x, int y) {
-	if (!bar) {
+	if (!bar || (bar->x == x && bar->y == y)) {
 		return;
 	}
 	bar->x = x;
 	bar->y = y;
-	XMoveWindow(bar->dpy, bar->win, x, y);
+	move_bar(bar);
 }
 
 /* ========== DRAWING FUNCTIONS ========== */
 
-static void menubar_draw_submenu(MenuBar *bar, Window win, const char *items[], int count, int width) {
-	GC gc = XCreateGC(bar->dpy, win, 0, NULL);
-	int menu_h = count * bar->submenu_item_height + (bar->border_width * 2);
-	XSetForeground(bar->dpy, gc, bar->bg);
-	XFillRectangle(bar->dpy, win, gc, 0, 0, (unsigned int)width, (unsigned int)menu_h);
-	
-	// Draw border only if border_width > 0
-	if (bar->border_width > 0) {
-		XSetForeground(bar->dpy, gc, bar->border);
-		XSetLineAttributes(bar->dpy, gc, (unsigned int)bar->border_width, LineSolid, CapButt, JoinMiter);
-		int inset = bar->border_width / 2;
-		draw_rounded_rect(bar->dpy, win, gc, inset, inset, width - bar->border_width, menu_h - bar->border_width, bar->border_radius);
+/* --- Dropdowns --- */
+
+/* Stroke the dropdown outline; also restores rounded corners after an
+ * item repaint */
+static void draw_dropdown_border(MenuBar *bar, const Dropdown *d) {
+	if (bar->border_width <= 0) {
+		return;
 	}
+	GC gc = bar->submenu_gc;
+	XSetForeground(bar->dpy, gc, bar->border);
+	XSetLineAttributes(bar->dpy, gc, (unsigned int)bar->border_width, LineSolid, CapButt, JoinMiter);
+	int inset = bar->border_width / 2;
+	draw_rounded_rect(bar->dpy, d->win, gc, inset, inset, d->width - bar->border_width, d->height - bar->border_width, bar->border_radius);
+	XSetLineAttributes(bar->dpy, gc, 0, LineSolid, CapButt, JoinMiter);
+}
 
+/* Paint dropdown item i over its own background */
+static void draw_dropdown_item(MenuBar *bar, const Dropdown *d, int i) {
+	GC gc = bar->submenu_gc;
+	int y_top = d->item_edge[i];
 	// Hover fills from border to border (full width minus borders)
 	int hover_x = bar->border_width;
-	int hover_width = width - (bar->border_width * 2) - 1;
-	// Items start right after border (no menu-level padding)
-	int items_top = bar->border_width;
-
-	// Xft drawing context for this submenu window
-	XftDraw *draw = XftDrawCreate(bar->dpy, win, DefaultVisual(bar->dpy, bar->screen), DefaultColormap(bar->dpy, bar->screen));
-	for (int i = 0; i < count; i++) {
-		int y_top = items_top + (i * bar->submenu_item_height);
-		if (bar->active_submenu == i) {
-			XSetForeground(bar->dpy, gc, bar->hover_bg);
-			// Determine if this is top or bottom item for selective rounding
-			int is_first = (i == 0);
-			int is_last = (i == count - 1);
-			int round_top = is_first ? 1 : 0;
-			int round_bottom = is_last ? 1 : 0;
-			// Use border radius if available
-			int hover_radius = bar->border_radius > 0 ? bar->border_radius : 0;
-			// Only adjust last item height to not overlap bottom border
-			int hover_height = is_last ? bar->submenu_item_height - 1 : bar->submenu_item_height;
-			fill_rounded_rect_selective(bar->dpy, win, gc, hover_x, y_top, hover_width, hover_height, hover_radius, round_top, round_bottom);
-		}
-		// Text has left padding within the item
-		int text_x = bar->border_width + 6;
-		// Center text vertically: baseline at middle of item height
-		int text_y = y_top + (bar->submenu_item_height + (int)bar->font->ascent - (int)bar->font->descent) / 2;
-		XftDrawStringUtf8(draw, &bar->xft_fg, bar->font, text_x, text_y, (const FcChar8 *)items[i], (int)strlen(items[i]));
+	int hover_width = d->width - (bar->border_width * 2) - 1;
+	XSetForeground(bar->dpy, gc, bar->bg);
+	XFillRectangle(bar->dpy, d->win, gc, hover_x, y_top, (unsigned int)(hover_width + 1), (unsigned int)bar->submenu_item_height);
+	if (bar->active_submenu == i) {
+		XSetForeground(bar->dpy, gc, bar->hover_bg);
+		// Determine if this is top or bottom item for selective rounding
+		int is_first = (i == 0);
+		int is_last = (i == d->count - 1);
+		int round_top = is_first ? 1 : 0;
+		int round_bottom = is_last ? 1 : 0;
+		// Use border radius if available
+		int hover_radius = bar->border_radius > 0 ? bar->border_radius : 0;
+		// Only adjust last item height to not overlap bottom border
+		int hover_height = is_last ? bar->submenu_item_height - 1 : bar->submenu_item_height;
+		fill_rounded_rect_selective(bar->dpy, d->win, gc, hover_x, y_top, hover_width, hover_height, hover_radius, round_top, round_bottom);
+	}
+	// Text has left padding within the item
+	int text_x = bar->border_width + 6;
+	// Center text vertically: baseline at middle of item height
+	int text_y = y_top + (bar->submenu_item_height + (int)bar->font->ascent - (int)bar->font->descent) / 2;
+	XftDrawStringUtf8(d->draw, &bar->xft_fg, bar->font, text_x, text_y, (const FcChar8 *)d->items[i], (int)strlen(d->items[i]));
+}
+
+static void menubar_draw_submenu(MenuBar *bar, const Dropdown *d) {
+	XSetForeground(bar->dpy, bar->submenu_gc, bar->bg);
+	XFillRectangle(bar->dpy, d->win, bar->submenu_gc, 0, 0, (unsigned int)d->width, (unsigned int)d->height);
+	for (int i = 0; i < d->count; i++) {
+		draw_dropdown_item(bar, d, i);
+	}
+	draw_dropdown_border(bar, d);
+}
+
+/* Move the dropdown hover highlight, repainting only the two items */
+static void set_submenu_hover(MenuBar *bar, int index) {
+	const Dropdown *d = &bar->menus[bar->active_menu - 1];
+	int old = bar->active_submenu;
+	if (index == old) {
+		return;
 	}
-	if (draw) {
-		XftDrawDestroy(draw);
+	bar->active_submenu = index;
+	int corners = 0;
+	if (old >= 0) {
+		draw_dropdown_item(bar, d, old);
+		corners |= old == 0 || old == d->count - 1;
+	}
+	if (index >= 0) {
+		draw_dropdown_item(bar, d, index);
+		corners |= index == 0 || index == d->count - 1;
+	}
+	if (corners) {
+		draw_dropdown_border(bar, d);
 	}
-	XFreeGC(bar->dpy, gc);
 }
 
-/* ========== SUBMENU DISPLAY ========== */
+/* --- Menubar --- */
 
-static void menubar_show_file_menu(MenuBar *bar) {
-	const char **items = bar->config.file_items;
-	int count = bar->config.file_count;
-	if (count == 0) {
-		return; // No items to show
-	}
-	if (!bar->file_menu_win) {
-		// Calculate required width using Xft extents
-		// Horizontal padding scales with font size
-		int h_padding = bar->font->height;
-		if (h_padding < 12) h_padding = 12;
-		int max_width = MENUBAR_ITEM_MIN_WIDTH;
-		for (int i = 0; i < count; i++) {
-			XGlyphInfo ext;
-			XftTextExtentsUtf8(bar->dpy, bar->font, (const FcChar8 *)items[i], (int)strlen(items[i]), &ext);
-			int item_width = ext.xOff + h_padding + (bar->border_width * 2);
-			if (item_width > max_width) {
-				max_width = item_width;
-			}
-		}
-		bar->file_menu_width = max_width;
-		bar->file_menu_height = count * bar->submenu_item_height + (bar->border_width * 2);
+static int segment_lit(const MenuBar *bar, int i) {
+	return bar->hover_index == i || bar->active_menu == i + 1;
+}
 
-		XSetWindowAttributes attr;
-		attr.override_redirect = True;
-		attr.event_mask = ExposureMask | ButtonPressMask | ButtonReleaseMask |
-		                  PointerMotionMask | FocusChangeMask | StructureNotifyMask;
-		attr.background_pixel = bar->bg;
+/* Segments are skipped when the bar is too narrow to hold them */
+static int has_segments(const MenuBar *bar) {
+	return bar->seg_edge[MENU_ITEM_COUNT] - bar->seg_edge[0] >= 2;
+}
 
-		Window root;
-		int rx, ry;
-		unsigned int rw, rh, rbw, rd;
-		XGetGeometry(bar->dpy, bar->win, &root, &rx, &ry, &rw, &rh, &rbw, &rd);
+/* Paint segment i (background, highlight, title) with the bar's origin at
+ * (ox, oy) on target */
+static void draw_bar_segment(MenuBar *bar, Drawable target, XftDraw *draw, int ox, int oy, int i) {
+	int seg_x = ox + bar->seg_edge[i];
+	int fill_y = oy + (bar->border_width > 0 ? 1 : 0);
+	int fill_h = bar->border_width > 0 ? MENUBAR_HEIGHT - 3 : MENUBAR_HEIGHT;
+	int fill_w = bar->seg_edge[i + 1] - seg_x - 1; // Reduce width by 1 to not overlap right edge
+	int lit = segment_lit(bar, i);
+	XSetForeground(bar->dpy, bar->gc, bar->bg);
+	XFillRectangle(bar->dpy, target, bar->gc, seg_x, fill_y, (unsigned int)fill_w, (unsigned int)fill_h);
+	if (lit) {
+		XSetForeground(bar->dpy, bar->gc, bar->hover_bg);
+		// Determine if this is first or last item for selective rounding
+		int round_left = (i == 0) ? 1 : 0;
+		int round_right = (i == MENU_ITEM_COUNT - 1) ? 1 : 0;
+		// Use border radius if available
+		int hover_radius = bar->border_radius > 0 ? bar->border_radius : 0;
+		fill_rounded_rect_selective_lr(bar->dpy, target, bar->gc, seg_x, fill_y, fill_w, fill_h, hover_radius, round_left, round_right);
+	}
+	int baseline = oy + (MENUBAR_HEIGHT + bar->font->ascent - bar->font->descent) / 2;
+	XftDrawStringUtf8(draw, &bar->xft_fg, bar->font, ox + bar->title_x[i], baseline, (const FcChar8 *)bar->items[i], (int)strlen(bar->items[i]));
+	bar->seg_lit[i] = lit;
+}
 
-		int menu_x, menu_y;
-		Window child;
-		// Drop straight down from left edge of File menu item
-		XTranslateCoordinates(bar->dpy, bar->win, root, 0, (int)rh, &menu_x, &menu_y, &child);
+/* Outline and the vertical borders between segments (only if border enabled) */
+static void draw_bar_lines(MenuBar *bar, Drawable target, int ox, int oy) {
+	if (bar->border_width <= 0) {
+		return;
+	}
+	XSetForeground(bar->dpy, bar->gc, bar->border);
+	XSetLineAttributes(bar->dpy, bar->gc, (unsigned int)bar->border_width, LineSolid, CapButt, JoinMiter);
+	int inset = bar->border_width / 2;
+	draw_rounded_rect(bar->dpy, target, bar->gc, ox + inset, oy + inset, bar->width - bar->border_width, MENUBAR_HEIGHT - bar->border_width, bar->border_radius);
+	XSetLineAttributes(bar->dpy, bar->gc, 0, LineSolid, CapButt, JoinMiter);
+	if (has_segments(bar)) {
+		for (int i = 1; i < MENU_ITEM_COUNT; i++) {
+			XDrawLine(bar->dpy, target, bar->gc, ox + bar->seg_edge[i], oy, ox + bar->seg_edge[i], oy + MENUBAR_HEIGHT - 1);
+		}
+	}
+}
 
-		bar->file_menu_win = XCreateWindow(bar->dpy, root, menu_x, menu_y, (unsigned int)bar->file_menu_width, (unsigned int)bar->file_menu_height, 0, CopyFromParent, InputOutput, CopyFromParent, CWOverrideRedirect | CWEventMask, &attr);
-		// Apply rounded corner shape mask
-		apply_submenu_shape(bar, bar->file_menu_win, bar->file_menu_width, bar->file_menu_height);
+/* Paint the whole bar with its origin at (ox, oy) on target */
+static void paint_bar(MenuBar *bar, Drawable target, XftDraw *draw, int ox, int oy) {
+	XSetForeground(bar->dpy, bar->gc, bar->bg);
+	XFillRectangle(bar->dpy, target, bar->gc, ox, oy, (unsigned int)bar->width, (unsigned int)MENUBAR_HEIGHT);
+	if (has_segments(bar)) {
+		for (int i = 0; i < MENU_ITEM_COUNT; i++) {
+			draw_bar_segment(bar, target, draw, ox, oy, i);
+		}
 	}
-	else {
-		// Recompute position and move existing window
-		Window root;
-		int rx, ry;
-		unsigned int rw, rh, rbw, rd;
-		XGetGeometry(bar->dpy, bar->win, &root, &rx, &ry, &rw, &rh, &rbw, &rd);
-		int menu_x, menu_y;
-		Window child;
-		XTranslateCoordinates(bar->dpy, bar->win, root, 0, (int)rh, &menu_x, &menu_y, &child);
-		XMoveWindow(bar->dpy, bar->file_menu_win, menu_x, menu_y);
-	}
-	XMapRaised(bar->dpy, bar->file_menu_win);
-	bar->active_menu = 1;
-	bar->active_submenu = -1;
+	draw_bar_lines(bar, target, ox, oy);
+}
 
-	// Grab focus to detect clicks outside the menu via FocusOut
-	XSetInputFocus(bar->dpy, bar->file_menu_win, RevertToParent, CurrentTime);
-	XGrabPointer(bar->dpy, bar->file_menu_win, False,
-	            ButtonPressMask | ButtonReleaseMask | PointerMotionMask,
-	            GrabModeAsync, GrabModeAsync,
-	            None, None, CurrentTime);
+/* Compositor paint callback */
+static void menubar_paint(Drawable target, int x, int y, void *user_data) {
+	MenuBar *bar = (MenuBar *)user_data;
+	paint_bar(bar, target, compositor_get_draw(bar->comp), x, y);
+}
 
-	menubar_draw_submenu(bar, bar->file_menu_win, items, count, bar->file_menu_width);
+static void menubar_draw_internal(MenuBar *bar) {
+	if (bar->comp) {
+		// Painted by the compositor's next frame
+		compositor_damage_node(bar->comp, bar->node);
+		return;
+	}
+	paint_bar(bar, bar->win, bar->draw, 0, 0);
 }
 
-static void menubar_show_edit_menu(MenuBar *bar) {
-	const char **items = bar->config.edit_items;
-	int count = bar->config.edit_count;
-	if (count == 0) {
-		return; // No items to show
+/* Repaint only the segments whose highlight changed since they were drawn
+ * (a compositor node is repainted whole) */
+static void menubar_update_highlight(MenuBar *bar) {
+	if (!has_segments(bar)) {
+		return;
 	}
-	if (!bar->edit_menu_win) {
-		// Calculate required width
-		// Horizontal padding scales with font size
-		int h_padding = bar->font->height;
-		if (h_padding < 12) h_padding = 12;
-		int max_width = MENUBAR_ITEM_MIN_WIDTH;
-		for (int i = 0; i < count; i++) {
-			XGlyphInfo ext;
-			XftTextExtentsUtf8(bar->dpy, bar->font, (const FcChar8 *)items[i], (int)strlen(items[i]), &ext);
-			int item_width = ext.xOff + h_padding + (bar->border_width * 2);
-			if (item_width > max_width) {
-				max_width = item_width;
+	int changed = 0;
+	for (int i = 0; i < MENU_ITEM_COUNT; i++) {
+		if (segment_lit(bar, i) != bar->seg_lit[i]) {
+			if (!bar->comp) {
+				draw_bar_segment(bar, bar->win, bar->draw, 0, 0, i);
 			}
+			changed = 1;
 		}
-		bar->edit_menu_width = max_width;
-		bar->edit_menu_height = count * bar->submenu_item_height + (bar->border_width * 2);
-
-		XSetWindowAttributes attr;
-		attr.override_redirect = True;
-		attr.event_mask = ExposureMask | ButtonPressMask | ButtonReleaseMask |
-		                  PointerMotionMask | FocusChangeMask | StructureNotifyMask;
-		// Set background to None to prevent automatic clearing during resize
-		// This is essential for flicker-free resizing - prevents X server from clearing background
-		attr.background_pixmap = None;
-		attr.bit_gravity = NorthWestGravity; // Preserve content on resize
-
-		Window root;
-		int rx, ry;
-		unsigned int rw, rh, rbw, rd;
-		XGetGeometry(bar->dpy, bar->win, &root, &rx, &ry, &rw, &rh, &rbw, &rd);
-
-		// Compute exact segment start (inner split) to align dropdown
-		int inner_x = 1;
-		int inner_w = bar->width - 2;
-		int base_w = inner_w / 3;
-		int rem = inner_w % 3;
-		int seg0 = base_w + (rem > 0 ? 1 : 0);
-		// Edit starts at end of first segment
-		int seg_start_x = inner_x + seg0;
-		int menu_x, menu_y;
-		Window child;
-		XTranslateCoordinates(bar->dpy, bar->win, root, seg_start_x, (int)rh, &menu_x, &menu_y, &child);
-
-		bar->edit_menu_win = XCreateWindow(bar->dpy, root, menu_x, menu_y, (unsigned int)bar->edit_menu_width, (unsigned int)bar->edit_menu_height, 0, CopyFromParent, InputOutput, CopyFromParent, CWOverrideRedirect | CWEventMask, &attr);
-		// Apply rounded corner shape mask
-		apply_submenu_shape(bar, bar->edit_menu_win, bar->edit_menu_width, bar->edit_menu_height);
+	}
+	if (!changed) {
+		return;
+	}
+	if (bar->comp) {
+		compositor_damage_node(bar->comp, bar->node);
 	}
 	else {
-		// Recompute position and move existing window
-		Window root;
-		int rx, ry;
-		unsigned int rw, rh, rbw, rd;
-		XGetGeometry(bar->dpy, bar->win, &root, &rx, &ry, &rw, &rh, &rbw, &rd);
-		int inner_x = 1;
-		int inner_w = bar->width - 2;
-		int base_w = inner_w / 3;
-		int rem = inner_w % 3;
-		int seg0 = base_w + (rem > 0 ? 1 : 0);
-		int seg_start_x = inner_x + seg0;
-		int menu_x, menu_y;
-		Window child;
-		XTranslateCoordinates(bar->dpy, bar->win, root, seg_start_x, (int)rh, &menu_x, &menu_y, &child);
-		XMoveWindow(bar->dpy, bar->edit_menu_win, menu_x, menu_y);
-	}
-	XMapRaised(bar->dpy, bar->edit_menu_win);
-	bar->active_menu = 2;
-	bar->active_submenu = -1;
-
-	// Grab focus to detect clicks outside the menu via FocusOut
-	XSetInputFocus(bar->dpy, bar->edit_menu_win, RevertToParent, CurrentTime);
-	XGrabPointer(bar->dpy, bar->edit_menu_win, False,
-	            ButtonPressMask | ButtonReleaseMask | PointerMotionMask,
-	            GrabModeAsync, GrabModeAsync,
-	            None, None, CurrentTime);
+		draw_bar_lines(bar, bar->win, 0, 0);
+	}
+}
 
-	menubar_draw_submenu(bar, bar->edit_menu_win, items, count, bar->edit_menu_width);
+void menubar_draw(MenuBar *bar) {
+	if (!bar) {
+		return;
+	}
+	menubar_draw_internal(bar);
+	XFlush(bar->dpy);
 }
 
-static void menubar_show_about_menu(MenuBar *bar) {
-	const char **items = bar->config.about_items;
-	int count = bar->config.about_count;
-	if (count == 0) {
+/* ========== SUBMENU DISPLAY ========== */
+
+/* Open dropdown index (0=File, 1=Edit, 2=About) below its segment */
+static void menubar_show_menu(MenuBar *bar, int index) {
+	Dropdown *d = &bar->menus[index];
+	if (d->count == 0) {
 		return; // No items to show
 	}
-	if (!bar->about_menu_win) {
-		// Calculate required width
-		// Horizontal padding scales with font size
-		int h_padding = bar->font->height;
-		if (h_padding < 12) h_padding = 12;
-		int max_width = MENUBAR_ITEM_MIN_WIDTH;
-		for (int i = 0; i < count; i++) {
-			XGlyphInfo ext;
-			XftTextExtentsUtf8(bar->dpy, bar->font, (const FcChar8 *)items[i], (int)strlen(items[i]), &ext);
-			int item_width = ext.xOff + h_padding + (bar->border_width * 2);
-			if (item_width > max_width) {
-				max_width = item_width;
-			}
-		}
-		bar->about_menu_width = max_width;
-		bar->about_menu_height = count * bar->submenu_item_height + (bar->border_width * 2);
-
+	Window root = RootWindow(bar->dpy, bar->screen);
+	int menu_x, menu_y;
+	Window child;
+	// Drop straight down from the dropdown's left edge (a node is positioned
+	// in its parent's coordinates)
+	if (bar->comp) {
+		XTranslateCoordinates(bar->dpy, bar->parent, root, bar->x + d->x, bar->y + MENUBAR_HEIGHT, &menu_x, &menu_y, &child);
+	}
+	else {
+		XTranslateCoordinates(bar->dpy, bar->win, root, d->x, MENUBAR_HEIGHT, &menu_x, &menu_y, &child);
+	}
+	bar->root_x = menu_x - d->x;
+	bar->root_y = menu_y - MENUBAR_HEIGHT;
+	if (!d->win) {
 		XSetWindowAttributes attr;
 		attr.override_redirect = True;
 		attr.event_mask = ExposureMask | ButtonPressMask | ButtonReleaseMask |
 		                  PointerMotionMask | FocusChangeMask | StructureNotifyMask;
-		// Set background to None to prevent automatic clearing during resize
-		// This is essential for flicker-free resizing - prevents X server from clearing background
-		attr.background_pixmap = None;
-		attr.bit_gravity = NorthWestGravity; // Preserve content on resize
-
-		Window root;
-		int rx, ry;
-		unsigned int rw, rh, rbw, rd;
-		XGetGeometry(bar->dpy, bar->win, &root, &rx, &ry, &rw, &rh, &rbw, &rd);
-
-		// Compute exact segment start (inner split) to align dropdown
-		int inner_x = 1;
-		int inner_w = bar->width - 2;
-		int base_w = inner_w / 3;
-		int rem = inner_w % 3;
-		int seg0 = base_w + (rem > 0 ? 1 : 0);
-		int seg1 = base_w + (rem > 1 ? 1 : 0);
-		// About starts at end of first+second segments
-		int seg_start_x = inner_x + seg0 + seg1;
-		int menu_x, menu_y;
-		Window child;
-		XTranslateCoordinates(bar->dpy, bar->win, root, seg_start_x, (int)rh, &menu_x, &menu_y, &child);
-
-		bar->about_menu_win = XCreateWindow(bar->dpy, root, menu_x, menu_y, (unsigned int)bar->about_menu_width, (unsigned int)bar->about_menu_height, 0, CopyFromParent, InputOutput, CopyFromParent, CWOverrideRedirect | CWEventMask, &attr);
+		d->win = XCreateWindow(bar->dpy, root, menu_x, menu_y, (unsigned int)d->width, (unsigned int)d->height, 0, CopyFromParent, InputOutput, CopyFromParent, CWOverrideRedirect | CWEventMask, &attr);
+		d->draw = XftDrawCreate(bar->dpy, d->win, DefaultVisual(bar->dpy, bar->screen), DefaultColormap(bar->dpy, bar->screen));
 		// Apply rounded corner shape mask
-		apply_submenu_shape(bar, bar->about_menu_win, bar->about_menu_width, bar->about_menu_height);
+		apply_submenu_shape(bar, d->win, d->width, d->height);
 	}
 	else {
-		// Recompute position and move existing window
-		Window root;
-		int rx, ry;
-		unsigned int rw, rh, rbw, rd;
-		XGetGeometry(bar->dpy, bar->win, &root, &rx, &ry, &rw, &rh, &rbw, &rd);
-		int inner_x = 1;
-		int inner_w = bar->width - 2;
-		int base_w = inner_w / 3;
-		int rem = inner_w % 3;
-		int seg0 = base_w + (rem > 0 ? 1 : 0);
-		int seg1 = base_w + (rem > 1 ? 1 : 0);
-		int seg_start_x = inner_x + seg0 + seg1;
-		int menu_x, menu_y;
-		Window child;
-		XTranslateCoordinates(bar->dpy, bar->win, root, seg_start_x, (int)rh, &menu_x, &menu_y, &child);
-		XMoveWindow(bar->dpy, bar->about_menu_win, menu_x, menu_y);
-	}
-	XMapRaised(bar->dpy, bar->about_menu_win);
-	bar->active_menu = 3;
+		XMoveWindow(bar->dpy, d->win, menu_x, menu_y);
+	}
+	XMapRaised(bar->dpy, d->win);
+	bar->active_menu = index + 1;
 	bar->active_submenu = -1;
 
 	// Grab focus to detect clicks outside the menu via FocusOut
-	XSetInputFocus(bar->dpy, bar->about_menu_win, RevertToParent, CurrentTime);
-	XGrabPointer(bar->dpy, bar->about_menu_win, False,
+	XSetInputFocus(bar->dpy, d->win, RevertToParent, CurrentTime);
+	XGrabPointer(bar->dpy, d->win, False,
 	            ButtonPressMask | ButtonReleaseMask | PointerMotionMask,
 	            GrabModeAsync, GrabModeAsync,
 	            None, None, CurrentTime);
 
-	menubar_draw_submenu(bar, bar->about_menu_win, items, count, bar->about_menu_width);
+	menubar_draw_submenu(bar, d);
 }
 
-static void menubar_draw_internal(MenuBar *bar) {
-	XSetForeground(bar->dpy, bar->gc, bar->bg);
-	XFillRectangle(bar->dpy, bar->win, bar->gc, 0, 0, (unsigned int)bar->width, (unsigned int)MENUBAR_HEIGHT);
-	
-	// Draw border only if border_width > 0
-	if (bar->border_width > 0) {
-		XSetForeground(bar->dpy, bar->gc, bar->border);
-		XSetLineAttributes(bar->dpy, bar->gc, (unsigned int)bar->border_width, LineSolid, CapButt, JoinMiter);
-		int inset = bar->border_width / 2;
-		draw_rounded_rect(bar->dpy, bar->win, bar->gc, inset, inset, bar->width - bar->border_width, MENUBAR_HEIGHT - bar->border_width, bar->border_radius);
-	}
-
-	// Compute inner area excluding border (1px if present, 0 otherwise)
-	int inner_x = bar->border_width > 0 ? 1 : 0;
-	// Prevent underflow if width is too small
-	int border_offset = bar->border_width > 0 ? 2 : 0;
-	if (bar->width < border_offset + 2) {
-		return; // Too small to draw meaningful menubar
-	}
-	int inner_w = bar->width - border_offset;
-	int base_w = inner_w / MENU_ITEM_COUNT;
-	int rem = inner_w % MENU_ITEM_COUNT;
-	int seg_w[MENU_ITEM_COUNT];
-	seg_w[0] = base_w + (rem > 0 ? 1 : 0);
-	seg_w[1] = base_w + (rem > 1 ? 1 : 0);
-	seg_w[2] = base_w;
-
-	int seg_x = inner_x;
-	for (int i = 0; i < MENU_ITEM_COUNT; i++) {
-		if (bar->hover_index == i || bar->active_menu == i + 1) {
-			XSetForeground(bar->dpy, bar->gc, bar->hover_bg);
-			int fill_y = bar->border_width > 0 ? 1 : 0;
-			int fill_h = bar->border_width > 0 ? MENUBAR_HEIGHT - 3 : MENUBAR_HEIGHT;
-			int fill_w = seg_w[i] - 1; // Reduce width by 1 to not overlap right edge
-			
-			// Determine if this is first or last item for selective rounding
-			int is_first = (i == 0);
-			int is_last = (i == MENU_ITEM_COUNT - 1);
-			int round_left = is_first ? 1 : 0;
-			int round_right = is_last ? 1 : 0;
-			
-			// Use border radius if available
-			int hover_radius = bar->border_radius > 0 ? bar->border_radius : 0;
-			
-			fill_rounded_rect_selective_lr(bar->dpy, bar->win, bar->gc, seg_x, fill_y, fill_w, fill_h, hover_radius, round_left, round_right);
-		}
-		// Use Xft to center and render text within this segment
-		XGlyphInfo ext;
-		XftTextExtentsUtf8(bar->dpy, bar->font, (const FcChar8 *)bar->items[i], (int)strlen(bar->items[i]), &ext);
-		int text_x = seg_x + (seg_w[i] - ext.xOff) / 2;
-		int baseline = (MENUBAR_HEIGHT + bar->font->ascent - bar->font->descent) / 2;
-		XftDrawStringUtf8(bar->draw, &bar->xft_fg, bar->font, text_x, baseline, (const FcChar8 *)bar->items[i], (int)strlen(bar->items[i]));
-		seg_x += seg_w[i];
-	}
-	// Draw vertical borders between menu items at exact boundaries (only if border enabled)
-	if (bar->border_width > 0) {
-		XSetForeground(bar->dpy, bar->gc, bar->border);
-		seg_x = inner_x + seg_w[0];
-		XDrawLine(bar->dpy, bar->win, bar->gc, seg_x, 0, seg_x, MENUBAR_HEIGHT - 1);
-		seg_x += seg_w[1];
-		XDrawLine(bar->dpy, bar->win, bar->gc, seg_x, 0, seg_x, MENUBAR_HEIGHT - 1);
-	}
+/* Close any open dropdown and open another one */
+static void menubar_switch_menu(MenuBar *bar, int index) {
+	menubar_hide_submenus(bar);
+	menubar_show_menu(bar, index);
+	bar->hover_index = index;
+	menubar_update_highlight(bar);
 }
 
-void menubar_draw(MenuBar *bar) {
-	if (!bar) {
-		return;
-	}
-	menubar_draw_internal(bar);
-	XFlush(bar->dpy);
+/* Close the open dropdown and clear the menubar highlight */
+static void menubar_close(MenuBar *bar) {
+	menubar_hide_submenus(bar);
+	bar->hover_index = -1;
+	menubar_update_highlight(bar);
 }
 
 void menubar_hide_all_submenus(MenuBar *bar) {
 	if (!bar) {
 		return;
 	}
-	menubar_hide_submenus(bar);
-	bar->hover_index = -1;
-	menubar_draw_internal(bar);
+	menubar_close(bar);
 	XFlush(bar->dpy);
 }
 
@@ -887,40 +904,18 @@ int menubar_handle_event(MenuBar *bar, XEvent *ev) {
 	
 	// Handle submenu events
 	if (bar->active_menu > 0) {
-		Window target_win = (bar->active_menu == 1) ? bar->file_menu_win :
-		                    (bar->active_menu == 2) ? bar->edit_menu_win :
-		                    (bar->active_menu == 3) ? bar->about_menu_win : 0;
-		// While a submenu is open, detect pointer moving over the menubar itself and switch menus
+		const Dropdown *d = &bar->menus[bar->active_menu - 1];
+		Window target_win = d->win;
+		// While a submenu is open, detect pointer moving over the menubar itself and switch menus.
+		// The bar cannot move while the dropdown holds the pointer grab, so the root
+		// position recorded when it opened is still valid.
 		if (ev->type == MotionNotify) {
-			Window root = DefaultRootWindow(bar->dpy);
-			int mb_rx = 0, mb_ry = 0;
-			Window child;
-			XTranslateCoordinates(bar->dpy, bar->win, root, 0, 0, &mb_rx, &mb_ry, &child);
-			int x_root = ev->xmotion.x_root;
-			int y_root = ev->xmotion.y_root;
-			if (x_root >= mb_rx && x_root < mb_rx + bar->width &&
-			    y_root >= mb_ry && y_root < mb_ry + MENUBAR_HEIGHT) {
-				int rel_x = x_root - mb_rx;
-				int idx = rel_x / (bar->width / 3);
-				if (idx < 0) {
-					idx = 0;
-				}
-				else if (idx > 2) {
-					idx = 2;
-				}
-				if ((idx + 1) != bar->active_menu) {
-					menubar_hide_submenus(bar);
-					if (idx == 0) {
-						menubar_show_file_menu(bar);
-					}
-					else if (idx == 1) {
-						menubar_show_edit_menu(bar);
-					}
-					else if (idx == 2) {
-						menubar_show_about_menu(bar);
-					}
-					bar->hover_index = idx;
-					menubar_draw_internal(bar);
+			int rel_x = ev->xmotion.x_root - bar->root_x;
+			int rel_y = ev->xmotion.y_root - bar->root_y;
+			if (rel_x >= 0 && rel_x < bar->width && rel_y >= 0 && rel_y < MENUBAR_HEIGHT) {
+				int idx = find_span(bar->seg_edge, MENU_ITEM_COUNT, rel_x);
+				if (idx >= 0 && (idx + 1) != bar->active_menu) {
+					menubar_switch_menu(bar, idx);
 					return -1;
 				}
 			}
@@ -928,115 +923,49 @@ int menubar_handle_event(MenuBar *bar, XEvent *ev) {
 		// Hide on focus loss
 		if (ev->type == FocusOut || ev->type == UnmapNotify) {
 			if (ev->xany.window == target_win) {
-				menubar_hide_submenus(bar);
-				bar->hover_index = -1;
-				menubar_draw_internal(bar);
+				menubar_close(bar);
 				return -1;
 			}
 		}
 		if (ev->type == MotionNotify && ev->xany.window == target_win) {
-			int items_top = bar->border_width;
-			int idx = (ev->xmotion.y - items_top) / bar->submenu_item_height;
-			int max_items = (bar->active_menu == 1) ? bar->config.file_count :
-			                (bar->active_menu == 2) ? bar->config.edit_count :
-			                (bar->active_menu == 3) ? bar->config.about_count : 0;
-			if (idx < 0 || idx >= max_items) {
-				idx = -1;
-			}
-			if (bar->active_submenu != idx) {
-				bar->active_submenu = idx;
-				if (bar->active_menu == 1) {
-					menubar_draw_submenu(bar, bar->file_menu_win, bar->config.file_items, bar->config.file_count, bar->file_menu_width);
-				}
-				else if (bar->active_menu == 2) {
-					menubar_draw_submenu(bar, bar->edit_menu_win, bar->config.edit_items, bar->config.edit_count, bar->edit_menu_width);
-				}
-				else if (bar->active_menu == 3) {
-					menubar_draw_submenu(bar, bar->about_menu_win, bar->config.about_items, bar->config.about_count, bar->about_menu_width);
-				}
-			}
+			set_submenu_hover(bar, find_span(d->item_edge, d->count, ev->xmotion.y));
 			return -1;
 		}
 		// Handle right-click anywhere while submenu is open: hide dropdown
 		if (ev->type == ButtonPress && ev->xbutton.button == Button3) {
-			menubar_hide_submenus(bar);
-			bar->hover_index = -1;
-			menubar_draw_internal(bar);
+			menubar_close(bar);
 			return -1;
 		}
 		// Handle ButtonPress - check if outside menu bounds
 		if (ev->type == ButtonPress && ev->xbutton.button == Button1) {
-			// Get menu dimensions
-			int menu_height = (bar->active_menu == 1) ? bar->file_menu_height :
-			                  (bar->active_menu == 2) ? bar->edit_menu_height :
-			                  (bar->active_menu == 3) ? bar->about_menu_height : 0;
-			int menu_width = (bar->active_menu == 1) ? bar->file_menu_width :
-			                 (bar->active_menu == 2) ? bar->edit_menu_width :
-			                 (bar->active_menu == 3) ? bar->about_menu_width : 0;
 			// Check if click is outside the submenu
 			if (ev->xany.window == target_win) {
-				if (ev->xbutton.x < 0 || ev->xbutton.x >= menu_width ||
-				    ev->xbutton.y < 0 || ev->xbutton.y >= menu_height) {
-					menubar_hide_submenus(bar);
-					bar->hover_index = -1;
-					menubar_draw_internal(bar);
+				if (ev->xbutton.x < 0 || ev->xbutton.x >= d->width ||
+				    ev->xbutton.y < 0 || ev->xbutton.y >= d->height) {
+					menubar_close(bar);
 					return -1;
 				}
 			}
 			else if (ev->xany.window != bar->win) {
 				// Click on a window that's not menubar or submenu
-				menubar_hide_submenus(bar);
-				bar->hover_index = -1;
-				menubar_draw_internal(bar);
+				menubar_close(bar);
 				return -1;
 			}
 		}
 		if (ev->type == ButtonRelease && ev->xbutton.button == Button1 && ev->xany.window == target_win) {
-			int items_top = bar->border_width;
-			int idx = (ev->xbutton.y - items_top) / bar->submenu_item_height;
-			int max_items = (bar->active_menu == 1) ? bar->config.file_count :
-			                (bar->active_menu == 2) ? bar->config.edit_count :
-			                (bar->active_menu == 3) ? bar->config.about_count : 0;
-
+			int idx = find_span(d->item_edge, d->count, ev->xbutton.y);
 			// Validate click is within bounds
-			int menu_height = (bar->active_menu == 1) ? bar->file_menu_height :
-			                  (bar->active_menu == 2) ? bar->edit_menu_height :
-			                  (bar->active_menu == 3) ? bar->about_menu_height : 0;
-			int menu_width = (bar->active_menu == 1) ? bar->file_menu_width :
-			                 (bar->active_menu == 2) ? bar->edit_menu_width :
-			                 (bar->active_menu == 3) ? bar->about_menu_width : 0;
-			if (ev->xbutton.x >= 0 && ev->xbutton.x < menu_width &&
-			    ev->xbutton.y >= 0 && ev->xbutton.y < menu_height &&
-			    idx >= 0 && idx < max_items) {
+			if (ev->xbutton.x >= 0 && ev->xbutton.x < d->width && idx >= 0) {
 				// Save active_menu before hiding (which resets it to 0)
 				int active = bar->active_menu;
-
-				menubar_hide_submenus(bar);
-				bar->hover_index = -1;
-				menubar_draw_internal(bar);
-				// Return configurable action codes
-				if (active == 1) {
-					return idx; // File items: 0, 1, 2, ...
-				}
-				if (active == 2) {
-					return 100 + idx; // Edit items: 100, 101, 102, ...
-				}
-				if (active == 3) {
-					return 200 + idx; // About items: 200, 201, 202, ...
-				}
+				menubar_close(bar);
+				// Return configurable action codes: File 0.., Edit 100.., About 200..
+				return (active - 1) * 100 + idx;
 			}
 			return -1;
 		}
 		if (ev->type == Expose && ev->xany.window == target_win) {
-			if (bar->active_menu == 1) {
-				menubar_draw_submenu(bar, bar->file_menu_win, bar->config.file_items, bar->config.file_count, bar->file_menu_width);
-			}
-			else if (bar->active_menu == 2) {
-				menubar_draw_submenu(bar, bar->edit_menu_win, bar->config.edit_items, bar->config.edit_count, bar->edit_menu_width);
-			}
-			else if (bar->active_menu == 3) {
-				menubar_draw_submenu(bar, bar->about_menu_win, bar->config.about_items, bar->config.about_count, bar->about_menu_width);
-			}
+			menubar_draw_submenu(bar, d);
 			return -1;
 		}
 	}
@@ -1055,64 +984,35 @@ int menubar_handle_event(MenuBar *bar, XEvent *ev) {
 				int dy = ev->xmotion.y_root - bar->drag_start_y;
 				bar->x += dx;
 				bar->y += dy;
-				XMoveWindow(bar->dpy, bar->win, bar->x, bar->y);
+				move_bar(bar);
 				bar->drag_start_x = ev->xmotion.x_root;
 				bar->drag_start_y = ev->xmotion.y_root;
 				return -1;
 			}
 			
-			int item_w = bar->width / MENU_ITEM_COUNT;
-			int idx = ev->xmotion.x / item_w;
-			if (idx < 0 || idx >= MENU_ITEM_COUNT) {
-				idx = -1;
-			}
+			int idx = find_span(bar->seg_edge, MENU_ITEM_COUNT, ev->xmotion.x);
 			// If a menu is already open, hovering across items should switch dropdowns
-			if (bar->active_menu > 0 && idx >= 0 && idx < MENU_ITEM_COUNT && (idx + 1) != bar->active_menu) {
-				menubar_hide_submenus(bar);
-				if (idx == 0) {
-					menubar_show_file_menu(bar);
-				}
-				else if (idx == 1) {
-					menubar_show_edit_menu(bar);
-				}
-				else {
-					menubar_show_about_menu(bar);
-				}
-				bar->hover_index = idx;
-				menubar_draw_internal(bar);
+			if (bar->active_menu > 0 && idx >= 0 && (idx + 1) != bar->active_menu) {
+				menubar_switch_menu(bar, idx);
 				return -1;
 			}
 			if (idx != bar->hover_index) {
 				bar->hover_index = idx;
-				menubar_draw_internal(bar);
+				menubar_update_highlight(bar);
 			}
 			return -1;
 		}
 		case LeaveNotify:
 			bar->hover_index = -1;
-			menubar_draw_internal(bar);
+			menubar_update_highlight(bar);
 			return -1;
 		case ButtonPress:
 			if (ev->xbutton.button == Button1) {
-				int item_w = bar->width / MENU_ITEM_COUNT;
-				int idx = ev->xbutton.x / item_w;
-				// Bounds check to prevent array out-of-bounds
-				if (idx >= 0 && idx < MENU_ITEM_COUNT) {
-					if (idx == 0) {
-						menubar_hide_submenus(bar);
-						menubar_show_file_menu(bar);
-						menubar_draw_internal(bar);
-					}
-					else if (idx == 1) {
-						menubar_hide_submenus(bar);
-						menubar_show_edit_menu(bar);
-						menubar_draw_internal(bar);
-					}
-					else {
-						menubar_hide_submenus(bar);
-						menubar_show_about_menu(bar);
-						menubar_draw_internal(bar);
-					}
+				int idx = find_span(bar->seg_edge, MENU_ITEM_COUNT, ev->xbutton.x);
+				if (idx >= 0) {
+					menubar_hide_submenus(bar);
+					menubar_show_menu(bar, idx);
+					menubar_update_highlight(bar);
 				}
 			}
 			else if (ev->xbutton.button == Button2 || ev->xbutton.button == Button3) {
@@ -1145,14 +1045,10 @@ int menubar_is_menubar_window(const MenuBar *bar, Window win) {
 	if (win == bar->win) {
 		return 1;
 	}
-	if (win == bar->file_menu_win) {
-		return 1;
-	}
-	if (win == bar->edit_menu_win) {
-		return 1;
-	}
-	if (win == bar->about_menu_win) {
-		return 1;
+	for (int i = 0; i < MENU_ITEM_COUNT; i++) {
+		if (win == bar->menus[i].win) {
+			return 1;
+		}
 	}
 	return 0;
 }
@@ -26,6 +26,7 @@
  * - X11 (Xlib, Xft for text rendering)
  * - config.h (MiniTheme for styling, color/font utilities)
  * - dbe.h (optional double-buffering)
+ * - compositor.h (optional single-window rendering)
  *
  * Usage:
  *   1. Create menu: menubar_create(display, parent, width, &theme, &config)
@@ -41,6 +42,7 @@
 
 #include <X11/Xlib.h>
 #include "config.h"
+#include "compositor.h"
 
 /* ========== TYPE DEFINITIONS ========== */
 
@@ -73,9 +75,14 @@ typedef struct {
  * @param border_radius Border radius in pixels
  * @param padding Internal padding in pixels
  * @param config Menu configuration (items per menu)
+ * @param comp Compositor of parent, or NULL for a window of its own. With a
+ *             compositor the bar is a node drawn into the shared back buffer
+ *             and gets its events through compositor_route_event(); the
+ *             dropdowns keep their own windows. Destroy it before the
+ *             compositor.
  * @return Pointer to MenuBar structure, or NULL on error
  */
-MenuBar *menubar_create_with_config(Display *dpy, Window parent, const struct MenuBlock *style, int x, int y, int width, int border_width, int border_radius, int padding, const MenuConfig *config);
+MenuBar *menubar_create_with_config(Display *dpy, Window parent, const struct MenuBlock *style, int x, int y, int width, int border_width, int border_radius, int padding, const MenuConfig *config, Compositor *comp);
 
 /**
  * Create a menubar with default configuration (for backward compatibility)
@@ -150,7 +157,7 @@ int menubar_handle_event(MenuBar *bar, XEvent *ev);
 /**
  * Get menubar window (for event matching)
  * @param menubar Pointer to MenuBar instance
- * @return Window ID of menubar
+ * @return Window ID of menubar (the node's input id for a compositor node)
  */
 Window menubar_get_window(const MenuBar *bar);
 
@@ -0,0 +1,922 @@
+/* palette.c - Palette Strip Widget Implementation
+ *
+ * Implements a scrollable grid of colour cells used for the pick history and
+ * saved palettes. The strip is a single child window; cells are plain
+ * rectangles painted into one back buffer, so the X server never sees more
+ * than one window no matter how many colours are loaded.
+ *
+ * Internal design notes:
+ * - Only rows intersecting the viewport are painted. The first visible row
+ *   and the pixel offset into it are derived from scroll_y, so a redraw with
+ *   10k colours costs the same as one with 20.
+ * - Hit-testing is pure arithmetic on the cell pitch (no per-cell search).
+ * - Rounded cells use swatch.c's rounded-rect helpers. The filled cell
+ *   shape is rendered once into a 1-bit mask and reused as the GC clip mask
+ *   for every cell; it is rebuilt only when cell size or radius changes.
+ * - The window's own rounded shape is likewise cached by geometry.
+ * - On TrueColor visuals cell pixels are computed from the visual masks, so
+ *   scrolling never round-trips to the server for XAllocColor. Other visuals
+ *   allocate each distinct colour once and keep its pixel in a hash table
+ *   until the strip is destroyed.
+ * - Drawing goes to the DBE back buffer when available, otherwise to an
+ *   off-screen pixmap that is copied to the window in one request.
+ *
+ * Features:
+ * - Most-recent-first history with move-to-front de-duplication
+ * - Mouse wheel scrolling by whole rows
+ * - Hover outline and click-to-select
+ * - Configurable cell size, spacing and corner radius
+ */
+
+#include "palette.h"
+#include "config.h"
+#include "dbe.h"
+#include "swatch.h"
+#include <X11/Xutil.h>
+#include <X11/extensions/shape.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Pixel allocated for one colour on a non-TrueColor visual */
+typedef struct {
+	uint32_t key; // 0x01RRGGBB, 0 for an empty slot
+	unsigned long pixel;
+	int allocated; // XAllocColor succeeded; the cell is freed on destroy
+} PixelCacheEntry;
+
+/* Opaque type definition */
+struct PaletteContext {
+	Display *display;
+	int screen;
+	Window parent;
+	Window palette_window;
+
+	int palette_x, palette_y;
+	int palette_width;
+	int palette_height;
+
+	// Cell layout
+	int padding;
+	int cell_size;
+	int cell_spacing;
+	int cell_radius;
+	int border_width;
+	int border_radius;
+	int columns; // Cached from width, cell_size and cell_spacing
+
+	// Colour model (display order, index 0 is drawn first)
+	RGB8 *colors;
+	size_t count;
+	size_t capacity;
+	size_t max_colors; // 0 = unlimited
+
+	// View state
+	int scroll_y; // Pixel offset of the viewport into the grid
+	long hover_index; // -1 when the pointer is not over a cell
+
+	// Theme
+	unsigned long bg_pixel;
+	unsigned long border_pixel;
+	unsigned long hover_pixel;
+
+	// Cached drawing resources
+	GC gc;
+	Pixmap cell_mask;
+	int cell_mask_size;
+	int cell_mask_radius;
+	int shape_width, shape_height, shape_radius, shape_border; // Last applied window shape
+
+	// TrueColor fast path
+	int truecolor;
+	unsigned long red_mask, green_mask, blue_mask;
+	int red_shift, green_shift, blue_shift;
+	int red_bits, green_bits, blue_bits;
+
+	// Other visuals: open-addressed cache of allocated pixels by colour
+	PixelCacheEntry *pixel_cache;
+	size_t pixel_cache_cap; // Power of two, 0 until first use
+	size_t pixel_cache_count;
+
+	// DBE support
+	DbeContext *dbe_ctx;
+	XdbeBackBuffer dbe_back_buffer;
+	int use_dbe; // 1 if DBE is available and initialized
+	Pixmap back_pixmap; // Fallback back buffer when DBE is unavailable
+};
+
+/* ========== COLOR HELPERS ========== */
+
+static void mask_shift_bits(unsigned long mask, int *shift, int *bits) {
+	int s = 0, b = 0;
+	if (mask) {
+		while (!(mask & 1UL)) {
+			mask >>= 1;
+			s++;
+		}
+		while (mask & 1UL) {
+			mask >>= 1;
+			b++;
+		}
+	}
+	*shift = s;
+	*bits = b;
+}
+
+static void init_visual_masks(PaletteContext *ctx) {
+	Visual *vis = DefaultVisual(ctx->display, ctx->screen);
+	ctx->truecolor = (vis && vis->class == TrueColor);
+	if (!ctx->truecolor) {
+		return;
+	}
+	ctx->red_mask = vis->red_mask;
+	ctx->green_mask = vis->green_mask;
+	ctx->blue_mask = vis->blue_mask;
+	mask_shift_bits(ctx->red_mask, &ctx->red_shift, &ctx->red_bits);
+	mask_shift_bits(ctx->green_mask, &ctx->green_shift, &ctx->green_bits);
+	mask_shift_bits(ctx->blue_mask, &ctx->blue_shift, &ctx->blue_bits);
+}
+
+static unsigned long scale_channel(uint8_t v, int shift, int bits) {
+	if (bits <= 0) {
+		return 0;
+	}
+	unsigned long max = (1UL << bits) - 1UL;
+	return (((unsigned long)v * max + 127UL) / 255UL) << shift;
+}
+
+static PixelCacheEntry *pixel_cache_slot(PixelCacheEntry *table, size_t cap, uint32_t key) {
+	size_t i = (key * 2654435761u) & (cap - 1);
+	while (table[i].key && table[i].key != key) {
+		i = (i + 1) & (cap - 1);
+	}
+	return &table[i];
+}
+
+/* Keep the cache at most half full; returns 0 on allocation failure */
+static int pixel_cache_reserve(PaletteContext *ctx) {
+	if ((ctx->pixel_cache_count + 1) * 2 <= ctx->pixel_cache_cap) {
+		return 1;
+	}
+	size_t cap = ctx->pixel_cache_cap ? ctx->pixel_cache_cap * 2 : 256;
+	PixelCacheEntry *table = (PixelCacheEntry *)calloc(cap, sizeof(PixelCacheEntry));
+	if (!table) {
+		return 0;
+	}
+	for (size_t i = 0; i < ctx->pixel_cache_cap; i++) {
+		if (ctx->pixel_cache[i].key) {
+			*pixel_cache_slot(table, cap, ctx->pixel_cache[i].key) = ctx->pixel_cache[i];
+		}
+	}
+	free(ctx->pixel_cache);
+	ctx->pixel_cache = table;
+	ctx->pixel_cache_cap = cap;
+	return 1;
+}
+
+/* Return every cached colormap cell to the server */
+static void pixel_cache_free(PaletteContext *ctx) {
+	Colormap cmap = DefaultColormap(ctx->display, ctx->screen);
+	for (size_t i = 0; i < ctx->pixel_cache_cap; i++) {
+		if (ctx->pixel_cache[i].key && ctx->pixel_cache[i].allocated) {
+			XFreeColors(ctx->display, cmap, &ctx->pixel_cache[i].pixel, 1, 0);
+		}
+	}
+	free(ctx->pixel_cache);
+	ctx->pixel_cache = NULL;
+	ctx->pixel_cache_cap = ctx->pixel_cache_count = 0;
+}
+
+/* Each colour costs one XAllocColor round trip the first time it is drawn */
+static unsigned long rgb8_to_pixel(PaletteContext *ctx, RGB8 c) {
+	if (ctx->truecolor) {
+		return scale_channel(c.r, ctx->red_shift, ctx->red_bits)
+			| scale_channel(c.g, ctx->green_shift, ctx->green_bits)
+			| scale_channel(c.b, ctx->blue_shift, ctx->blue_bits);
+	}
+	uint32_t key = 0x01000000u | ((uint32_t)c.r << 16) | ((uint32_t)c.g << 8) | c.b;
+	if (ctx->pixel_cache_cap) {
+		PixelCacheEntry *hit = pixel_cache_slot(ctx->pixel_cache, ctx->pixel_cache_cap, key);
+		if (hit->key) {
+			return hit->pixel;
+		}
+	}
+	XColor x = {0};
+	x.red = (unsigned short)(c.r * 257);
+	x.green = (unsigned short)(c.g * 257);
+	x.blue = (unsigned short)(c.b * 257);
+	x.flags = DoRed | DoGreen | DoBlue;
+	int allocated = XAllocColor(ctx->display, DefaultColormap(ctx->display, ctx->screen), &x) != 0;
+	if (!allocated) {
+		x.pixel = BlackPixel(ctx->display, ctx->screen); // Colormap full
+	}
+	if (pixel_cache_reserve(ctx)) {
+		PixelCacheEntry *slot = pixel_cache_slot(ctx->pixel_cache, ctx->pixel_cache_cap, key);
+		slot->key = key;
+		slot->pixel = x.pixel;
+		slot->allocated = allocated;
+		ctx->pixel_cache_count++;
+	}
+	return x.pixel;
+}
+
+/* ========== CACHED SHAPE MASKS ========== */
+
+/* Rebuild the 1-bit cell mask only when cell size or radius changed */
+static void ensure_cell_mask(PaletteContext *ctx) {
+	if (ctx->cell_mask != None && ctx->cell_mask_size == ctx->cell_size && ctx->cell_mask_radius == ctx->cell_radius) {
+		return;
+	}
+	if (ctx->cell_mask != None) {
+		XFreePixmap(ctx->display, ctx->cell_mask);
+		ctx->cell_mask = None;
+	}
+	if (ctx->cell_size <= 0) {
+		return;
+	}
+	unsigned int sz = (unsigned int)ctx->cell_size;
+	ctx->cell_mask = XCreatePixmap(ctx->display, ctx->palette_window, sz, sz, 1);
+	if (!ctx->cell_mask) {
+		return;
+	}
+	GC mask_gc = XCreateGC(ctx->display, ctx->cell_mask, 0, NULL);
+	XSetForeground(ctx->display, mask_gc, 0);
+	XFillRectangle(ctx->display, ctx->cell_mask, mask_gc, 0, 0, sz, sz);
+	XSetForeground(ctx->display, mask_gc, 1);
+	swatch_fill_rounded_rect(ctx->display, ctx->cell_mask, mask_gc, 0, 0, ctx->cell_size, ctx->cell_size, ctx->cell_radius);
+	XFreeGC(ctx->display, mask_gc);
+	ctx->cell_mask_size = ctx->cell_size;
+	ctx->cell_mask_radius = ctx->cell_radius;
+}
+
+/* Apply the rounded window shape, skipping the work if nothing changed */
+static void apply_window_shape(PaletteContext *ctx) {
+	int w = ctx->palette_width;
+	int h = ctx->palette_height;
+	if (ctx->shape_width == w && ctx->shape_height == h && ctx->shape_radius == ctx->border_radius && ctx->shape_border == ctx->border_width) {
+		return;
+	}
+	ctx->shape_width = w;
+	ctx->shape_height = h;
+	ctx->shape_radius = ctx->border_radius;
+	ctx->shape_border = ctx->border_width;
+	if (ctx->border_radius <= 0) {
+		XShapeCombineMask(ctx->display, ctx->palette_window, ShapeBounding, 0, 0, None, ShapeSet);
+		return;
+	}
+	if (w <= 0 || h <= 0) {
+		return;
+	}
+	Pixmap mask = XCreatePixmap(ctx->display, ctx->palette_window, (unsigned int)w, (unsigned int)h, 1);
+	if (!mask) {
+		return;
+	}
+	GC mask_gc = XCreateGC(ctx->display, mask, 0, NULL);
+	XSetForeground(ctx->display, mask_gc, 0);
+	XFillRectangle(ctx->display, mask, mask_gc, 0, 0, (unsigned int)w, (unsigned int)h);
+	XSetForeground(ctx->display, mask_gc, 1);
+	int inset = ctx->border_width / 2;
+	swatch_fill_rounded_rect(ctx->display, mask, mask_gc, inset, inset, w - ctx->border_width, h - ctx->border_width, ctx->border_radius);
+	XShapeCombineMask(ctx->display, ctx->palette_window, ShapeBounding, 0, 0, mask, ShapeSet);
+	XFreeGC(ctx->display, mask_gc);
+	XFreePixmap(ctx->display, mask);
+}
+
+/* ========== BUFFER MANAGEMENT ========== */
+
+static void init_palette_buffers(PaletteContext *ctx) {
+	if (ctx->dbe_back_buffer != None) {
+		dbe_deallocate_back_buffer(ctx->dbe_ctx, ctx->dbe_back_buffer);
+		ctx->dbe_back_buffer = None;
+	}
+	if (ctx->back_pixmap != None) {
+		XFreePixmap(ctx->display, ctx->back_pixmap);
+		ctx->back_pixmap = None;
+	}
+	if (ctx->dbe_ctx && dbe_is_supported(ctx->dbe_ctx)) {
+		ctx->dbe_back_buffer = dbe_allocate_back_buffer(ctx->dbe_ctx, ctx->palette_window, XdbeUndefined);
+		ctx->use_dbe = (ctx->dbe_back_buffer != None);
+	} else {
+		ctx->use_dbe = 0;
+	}
+	if (!ctx->use_dbe && ctx->palette_width > 0 && ctx->palette_height > 0) {
+		ctx->back_pixmap = XCreatePixmap(ctx->display, ctx->palette_window, (unsigned int)ctx->palette_width, (unsigned int)ctx->palette_height, (unsigned int)DefaultDepth(ctx->display, ctx->screen));
+	}
+}
+
+/* ========== LAYOUT ========== */
+
+static int cell_pitch(const PaletteContext *ctx) {
+	int pitch = ctx->cell_size + ctx->cell_spacing;
+	return pitch > 0 ? pitch : 1;
+}
+
+static void update_columns(PaletteContext *ctx) {
+	int inner = ctx->palette_width - ctx->padding * 2 + ctx->cell_spacing;
+	int cols = inner / cell_pitch(ctx);
+	ctx->columns = cols > 0 ? cols : 1;
+}
+
+static int max_scroll(const PaletteContext *ctx) {
+	size_t rows = (ctx->count + (size_t)ctx->columns - 1) / (size_t)ctx->columns;
+	long content = (long)rows * cell_pitch(ctx) - ctx->cell_spacing + ctx->padding * 2;
+	long max = content - ctx->palette_height;
+	if (max <= 0) {
+		return 0;
+	}
+	return max > 0x7fffffffL ? 0x7fffffff : (int)max;
+}
+
+static void clamp_scroll(PaletteContext *ctx) {
+	int max = max_scroll(ctx);
+	if (ctx->scroll_y > max) {
+		ctx->scroll_y = max;
+	}
+	if (ctx->scroll_y < 0) {
+		ctx->scroll_y = 0;
+	}
+}
+
+/* O(1) hit test: map window coordinates to a cell index, or -1 for gaps */
+static long palette_hit_test(const PaletteContext *ctx, int x, int y) {
+	if (y < ctx->padding || y >= ctx->palette_height - ctx->padding) {
+		return -1;
+	}
+	int lx = x - ctx->padding;
+	long ly = (long)y - ctx->padding + ctx->scroll_y;
+	if (lx < 0 || ly < 0) {
+		return -1;
+	}
+	int pitch = cell_pitch(ctx);
+	int col = lx / pitch;
+	long row = ly / pitch;
+	if (col >= ctx->columns || lx % pitch >= ctx->cell_size || ly % pitch >= ctx->cell_size) {
+		return -1;
+	}
+	long idx = row * ctx->columns + col;
+	if (idx < 0 || (size_t)idx >= ctx->count) {
+		return -1;
+	}
+	return idx;
+}
+
+/* ========== RENDERING ========== */
+
+/* Draw everything to the back buffer and present once:
+ * 1) clear background
+ * 2) fill visible cells through the cached cell mask
+ * 3) outline visible cells (hovered cell in hover colour)
+ * 4) widget border
+ * 5) swap / copy */
+static void palette_redraw(PaletteContext *ctx) {
+	if (!ctx || !ctx->gc) {
+		return;
+	}
+	Drawable target = ctx->use_dbe ? ctx->dbe_back_buffer : ctx->back_pixmap;
+	if (target == None) {
+		target = ctx->palette_window;
+	}
+	int w = ctx->palette_width;
+	int h = ctx->palette_height;
+
+	XSetForeground(ctx->display, ctx->gc, ctx->bg_pixel);
+	XFillRectangle(ctx->display, target, ctx->gc, 0, 0, (unsigned int)w, (unsigned int)h);
+
+	ensure_cell_mask(ctx);
+
+	int pitch = cell_pitch(ctx);
+	size_t first_row = (size_t)(ctx->scroll_y / pitch);
+	int y_offset = ctx->padding - (ctx->scroll_y % pitch);
+	int visible_rows = (h - y_offset) / pitch + 1;
+	size_t first = first_row * (size_t)ctx->columns;
+	size_t last = first + (size_t)visible_rows * (size_t)ctx->columns;
+	if (last > ctx->count) {
+		last = ctx->count;
+	}
+
+	// Pass 1: cell fills, clipped to the rounded cell mask
+	if (ctx->cell_mask != None) {
+		XSetClipMask(ctx->display, ctx->gc, ctx->cell_mask);
+	}
+	for (size_t i = first; i < last; i++) {
+		int col = (int)((i - first) % (size_t)ctx->columns);
+		int row = (int)((i - first) / (size_t)ctx->columns);
+		int cx = ctx->padding + col * pitch;
+		int cy = y_offset + row * pitch;
+		XSetForeground(ctx->display, ctx->gc, rgb8_to_pixel(ctx, ctx->colors[i]));
+		XSetClipOrigin(ctx->display, ctx->gc, cx, cy);
+		XFillRectangle(ctx->display, target, ctx->gc, cx, cy, (unsigned int)ctx->cell_size, (unsigned int)ctx->cell_size);
+	}
+	XSetClipMask(ctx->display, ctx->gc, None);
+
+	// Pass 2: cell outlines share one foreground, hover is drawn last on top
+	XSetLineAttributes(ctx->display, ctx->gc, 1, LineSolid, CapButt, JoinMiter);
+	XSetForeground(ctx->display, ctx->gc, ctx->border_pixel);
+	for (size_t i = first; i < last; i++) {
+		int col = (int)((i - first) % (size_t)ctx->columns);
+		int row = (int)((i - first) / (size_t)ctx->columns);
+		swatch_draw_rounded_rect(ctx->display, target, ctx->gc, ctx->padding + col * pitch, y_offset + row * pitch, ctx->cell_size, ctx->cell_size, ctx->cell_radius);
+	}
+	if (ctx->hover_index >= 0 && (size_t)ctx->hover_index >= first && (size_t)ctx->hover_index < last) {
+		size_t rel = (size_t)ctx->hover_index - first;
+		int col = (int)(rel % (size_t)ctx->columns);
+		int row = (int)(rel / (size_t)ctx->columns);
+		XSetForeground(ctx->display, ctx->gc, ctx->hover_pixel);
+		swatch_draw_rounded_rect(ctx->display, target, ctx->gc, ctx->padding + col * pitch, y_offset + row * pitch, ctx->cell_size, ctx->cell_size, ctx->cell_radius);
+	}
+
+	// Clear the padding band so partially scrolled rows don't bleed into it
+	XSetForeground(ctx->display, ctx->gc, ctx->bg_pixel);
+	if (ctx->padding > 0) {
+		XFillRectangle(ctx->display, target, ctx->gc, 0, 0, (unsigned int)w, (unsigned int)ctx->padding);
+		XFillRectangle(ctx->display, target, ctx->gc, 0, h - ctx->padding, (unsigned int)w, (unsigned int)ctx->padding);
+	}
+
+	// Widget border
+	if (ctx->border_width > 0) {
+		int inset = ctx->border_width / 2;
+		XSetForeground(ctx->display, ctx->gc, ctx->border_pixel);
+		XSetLineAttributes(ctx->display, ctx->gc, (unsigned int)ctx->border_width, LineSolid, CapButt, JoinMiter);
+		swatch_draw_rounded_rect(ctx->display, target, ctx->gc, inset, inset, w - ctx->border_width, h - ctx->border_width, ctx->border_radius);
+	}
+
+	if (ctx->use_dbe) {
+		dbe_swap_buffers(ctx->dbe_ctx, ctx->palette_window, XdbeUndefined);
+	} else if (target == ctx->back_pixmap) {
+		XCopyArea(ctx->display, ctx->back_pixmap, ctx->palette_window, ctx->gc, 0, 0, (unsigned int)w, (unsigned int)h, 0, 0);
+	}
+	XFlush(ctx->display);
+}
+
+/* ========== PUBLIC API ========== */
+
+/**
+ * @brief Create a new palette strip widget
+ *
+ * See palette.h for full documentation.
+ */
+PaletteContext *palette_create(Display *dpy, Window parent, int x, int y, int width, int height) {
+	if (!dpy || width <= 0 || height <= 0) {
+		return NULL;
+	}
+	PaletteContext *ctx = (PaletteContext *)calloc(1, sizeof(PaletteContext));
+	if (!ctx) {
+		return NULL;
+	}
+	ctx->display = dpy;
+	ctx->screen = DefaultScreen(dpy);
+	ctx->parent = parent;
+	ctx->palette_x = x;
+	ctx->palette_y = y;
+	ctx->palette_width = width;
+	ctx->palette_height = height;
+	ctx->padding = 4; // Defaults, will be overridden by config
+	ctx->cell_size = 12;
+	ctx->cell_spacing = 3;
+	ctx->cell_radius = 2;
+	ctx->border_width = 1;
+	ctx->border_radius = 4;
+	ctx->hover_index = -1;
+	ctx->bg_pixel = WhitePixel(dpy, ctx->screen);
+	ctx->border_pixel = BlackPixel(dpy, ctx->screen);
+	ctx->hover_pixel = BlackPixel(dpy, ctx->screen);
+	update_columns(ctx);
+	init_visual_masks(ctx);
+
+	// Initialize DBE context
+	ctx->dbe_ctx = dbe_init(dpy, ctx->screen);
+	ctx->dbe_back_buffer = None;
+	ctx->use_dbe = 0;
+
+	XSetWindowAttributes swa;
+	swa.event_mask = ExposureMask | ButtonPressMask | PointerMotionMask | LeaveWindowMask;
+	swa.background_pixmap = None;
+	ctx->palette_window = XCreateWindow(dpy, parent, x, y, (unsigned int)width, (unsigned int)height, 0, CopyFromParent, InputOutput, CopyFromParent, CWBackPixmap | CWEventMask, &swa);
+	if (!ctx->palette_window) {
+		if (ctx->dbe_ctx) {
+			dbe_destroy(ctx->dbe_ctx);
+		}
+		free(ctx);
+		return NULL;
+	}
+	ctx->gc = XCreateGC(dpy, ctx->palette_window, 0, NULL);
+	apply_window_shape(ctx);
+	init_palette_buffers(ctx);
+	XMapWindow(dpy, ctx->palette_window);
+	return ctx;
+}
+
+/**
+ * @brief Destroy palette widget and free resources
+ *
+ * See palette.h for full documentation.
+ */
+void palette_destroy(PaletteContext *ctx) {
+	if (!ctx) {
+		return;
+	}
+	if (ctx->dbe_back_buffer != None) {
+		dbe_deallocate_back_buffer(ctx->dbe_ctx, ctx->dbe_back_buffer);
+	}
+	if (ctx->dbe_ctx) {
+		dbe_destroy(ctx->dbe_ctx);
+	}
+	if (ctx->back_pixmap != None) {
+		XFreePixmap(ctx->display, ctx->back_pixmap);
+	}
+	if (ctx->cell_mask != None) {
+		XFreePixmap(ctx->display, ctx->cell_mask);
+	}
+	if (ctx->gc) {
+		XFreeGC(ctx->display, ctx->gc);
+	}
+	if (ctx->palette_window) {
+		XDestroyWindow(ctx->display, ctx->palette_window);
+	}
+	pixel_cache_free(ctx);
+	free(ctx->colors);
+	free(ctx);
+}
+
+Window palette_get_window(PaletteContext *ctx) {
+	return ctx ? ctx->palette_window : None;
+}
+
+/**
+ * @brief Process X11 events for palette
+ *
+ * See palette.h for full documentation.
+ * Handles Expose, wheel scrolling, hover tracking and cell clicks.
+ */
+int palette_handle_event(PaletteContext *ctx, const XEvent *ev, RGB8 *out) {
+	if (!ctx || !ev || ev->xany.window != ctx->palette_window) {
+		return 0;
+	}
+	switch (ev->type) {
+		case Expose:
+			if (ev->xexpose.count == 0) {
+				palette_redraw(ctx);
+			}
+			return 1;
+		case ButtonPress:
+			if (ev->xbutton.button == Button4 || ev->xbutton.button == Button5) {
+				int old = ctx->scroll_y;
+				ctx->scroll_y += (ev->xbutton.button == Button4) ? -cell_pitch(ctx) : cell_pitch(ctx);
+				clamp_scroll(ctx);
+				if (ctx->scroll_y != old) {
+					ctx->hover_index = palette_hit_test(ctx, ev->xbutton.x, ev->xbutton.y);
+					palette_redraw(ctx);
+				}
+				return 1;
+			}
+			if (ev->xbutton.button == Button1) {
+				long idx = palette_hit_test(ctx, ev->xbutton.x, ev->xbutton.y);
+				if (idx >= 0) {
+					if (out) {
+						*out = ctx->colors[idx];
+					}
+					return 2;
+				}
+			}
+			return 1;
+		case MotionNotify: {
+			long idx = palette_hit_test(ctx, ev->xmotion.x, ev->xmotion.y);
+			if (idx != ctx->hover_index) {
+				ctx->hover_index = idx;
+				palette_redraw(ctx);
+			}
+			return 1;
+		}
+		case LeaveNotify:
+			if (ctx->hover_index >= 0) {
+				ctx->hover_index = -1;
+				palette_redraw(ctx);
+			}
+			return 1;
+		default:
+			break;
+	}
+	return 0;
+}
+
+/* Grow colour storage geometrically so bulk appends stay amortised O(1) */
+static int ensure_capacity(PaletteContext *ctx, size_t needed) {
+	if (needed <= ctx->capacity) {
+		return 0;
+	}
+	size_t cap = ctx->capacity ? ctx->capacity : 64;
+	while (cap < needed) {
+		cap *= 2;
+	}
+	RGB8 *grown = (RGB8 *)realloc(ctx->colors, cap * sizeof(RGB8));
+	if (!grown) {
+		return -1;
+	}
+	ctx->colors = grown;
+	ctx->capacity = cap;
+	return 0;
+}
+
+static int rgb8_same(RGB8 a, RGB8 b) {
+	return a.r == b.r && a.g == b.g && a.b == b.b;
+}
+
+/**
+ * @brief Push a colour to the front of the strip
+ *
+ * See palette.h for full documentation.
+ */
+int palette_push_color(PaletteContext *ctx, RGB8 rgb) {
+	if (!ctx) {
+		return -1;
+	}
+	if (ctx->count > 0 && rgb8_same(ctx->colors[0], rgb)) {
+		return 0;
+	}
+	// Move-to-front if already present, otherwise shift everything down one
+	size_t pos = ctx->count;
+	for (size_t i = 1; i < ctx->count; i++) {
+		if (rgb8_same(ctx->colors[i], rgb)) {
+			pos = i;
+			break;
+		}
+	}
+	if (pos == ctx->count) {
+		if (ensure_capacity(ctx, ctx->count + 1) != 0) {
+			return -1;
+		}
+		ctx->count++;
+	}
+	memmove(ctx->colors + 1, ctx->colors, pos * sizeof(RGB8));
+	ctx->colors[0] = rgb;
+	if (ctx->max_colors > 0 && ctx->count > ctx->max_colors) {
+		ctx->count = ctx->max_colors;
+	}
+	ctx->scroll_y = 0;
+	ctx->hover_index = -1;
+	palette_redraw(ctx);
+	return 1;
+}
+
+/**
+ * @brief Append colours to the end of the strip
+ *
+ * See palette.h for full documentation.
+ */
+int palette_append_colors(PaletteContext *ctx, const RGB8 *colors, size_t count) {
+	if (!ctx || (!colors && count > 0)) {
+		return -1;
+	}
+	// Colours past the configured maximum are dropped
+	if (ctx->max_colors > 0) {
+		size_t room = ctx->count < ctx->max_colors ? ctx->max_colors - ctx->count : 0;
+		if (count > room) {
+			count = room;
+		}
+	}
+	if (count == 0) {
+		return 0;
+	}
+	if (ensure_capacity(ctx, ctx->count + count) != 0) {
+		return -1;
+	}
+	memcpy(ctx->colors + ctx->count, colors, count * sizeof(RGB8));
+	ctx->count += count;
+	palette_redraw(ctx);
+	return 0;
+}
+
+void palette_clear(PaletteContext *ctx) {
+	if (!ctx) {
+		return;
+	}
+	ctx->count = 0;
+	ctx->scroll_y = 0;
+	ctx->hover_index = -1;
+	palette_redraw(ctx);
+}
+
+const RGB8 *palette_get_colors(const PaletteContext *ctx, size_t *count) {
+	if (!ctx) {
+		if (count) {
+			*count = 0;
+		}
+		return NULL;
+	}
+	if (count) {
+		*count = ctx->count;
+	}
+	return ctx->colors;
+}
+
+void palette_set_max_colors(PaletteContext *ctx, size_t max_colors) {
+	if (!ctx) {
+		return;
+	}
+	ctx->max_colors = max_colors;
+	if (max_colors > 0 && ctx->count > max_colors) {
+		ctx->count = max_colors;
+		ctx->hover_index = -1;
+		clamp_scroll(ctx);
+		palette_redraw(ctx);
+	}
+}
+
+void palette_set_theme(PaletteContext *ctx, unsigned long bg_pixel, unsigned long border_pixel, unsigned long hover_pixel) {
+	if (!ctx) {
+		return;
+	}
+	ctx->bg_pixel = bg_pixel;
+	ctx->border_pixel = border_pixel;
+	ctx->hover_pixel = hover_pixel;
+	palette_redraw(ctx);
+}
+
+void palette_set_geometry(PaletteContext *ctx, int x, int y, int width, int height) {
+	if (!ctx || width <= 0 || height <= 0) {
+		return;
+	}
+	// One ConfigureWindow carrying only the fields that changed
+	XWindowChanges changes;
+	unsigned int mask = 0;
+	if (x != ctx->palette_x) {
+		changes.x = x;
+		mask |= CWX;
+	}
+	if (y != ctx->palette_y) {
+		changes.y = y;
+		mask |= CWY;
+	}
+	if (width != ctx->palette_width) {
+		changes.width = width;
+		mask |= CWWidth;
+	}
+	if (height != ctx->palette_height) {
+		changes.height = height;
+		mask |= CWHeight;
+	}
+	if (!mask) {
+		return;
+	}
+	XConfigureWindow(ctx->display, ctx->palette_window, mask, &changes);
+	ctx->palette_x = x;
+	ctx->palette_y = y;
+	if (mask & (CWWidth | CWHeight)) {
+		ctx->palette_width = width;
+		ctx->palette_height = height;
+		update_columns(ctx);
+		clamp_scroll(ctx);
+		apply_window_shape(ctx);
+		init_palette_buffers(ctx);
+		palette_redraw(ctx);
+	}
+}
+
+void palette_set_cell_style(PaletteContext *ctx, int padding, int cell_size, int cell_spacing, int cell_radius, int border_width, int border_radius) {
+	if (!ctx) {
+		return;
+	}
+	ctx->padding = padding > 0 ? padding : 0;
+	ctx->cell_size = cell_size > 0 ? cell_size : 1;
+	ctx->cell_spacing = cell_spacing > 0 ? cell_spacing : 0;
+	ctx->cell_radius = cell_radius > 0 ? cell_radius : 0;
+	ctx->border_width = border_width > 0 ? border_width : 0;
+	ctx->border_radius = border_radius > 0 ? border_radius : 0;
+	update_columns(ctx);
+	clamp_scroll(ctx);
+	apply_window_shape(ctx);
+	palette_redraw(ctx);
+}
+
+/* ========== CONFIGURATION MANAGEMENT ========== */
+
+void palette_config_init_defaults(Config *cfg) {
+	if (!cfg) {
+		return;
+	}
+	cfg->palette.bg = (ConfigColor){
+		0.965, 0.961, 0.957, 1.0
+	}; // #F6F5F4
+	cfg->palette.border = (ConfigColor){
+		0.804, 0.780, 0.761, 1.0
+	}; // #CDC7C2
+	cfg->palette.hover_border = (ConfigColor){
+		0.208, 0.518, 0.894, 1.0
+	}; // #3584E4 GTK accent blue
+}
+
+void palette_config_parse(Config *cfg, const char *key, const char *value) {
+	if (!cfg || !key || !value) {
+		return;
+	}
+	// Alphabetized styling keys only - colors
+	if (strcmp(key, "background") == 0) {
+		cfg->palette.bg = parse_color(value);
+	}
+	else if (strcmp(key, "border") == 0) {
+		cfg->palette.border = parse_color(value);
+	}
+	else if (strcmp(key, "hover-border") == 0) {
+		cfg->palette.hover_border = parse_color(value);
+	}
+}
+
+void palette_config_write(FILE *f, const Config *cfg) {
+	if (!f || !cfg) {
+		return;
+	}
+	// Alphabetized styling keys only - colors
+	fprintf(f, "[palette]\n");
+	fprintf(f, "background = #%02X%02X%02X\n",
+		(int)(cfg->palette.bg.r * 255),
+		(int)(cfg->palette.bg.g * 255),
+		(int)(cfg->palette.bg.b * 255));
+	fprintf(f, "border = #%02X%02X%02X\n",
+		(int)(cfg->palette.border.r * 255),
+		(int)(cfg->palette.border.g * 255),
+		(int)(cfg->palette.border.b * 255));
+	fprintf(f, "hover-border = #%02X%02X%02X\n\n",
+		(int)(cfg->palette.hover_border.r * 255),
+		(int)(cfg->palette.hover_border.g * 255),
+		(int)(cfg->palette.hover_border.b * 255));
+}
+
+/* ========== PALETTE WIDGET GEOMETRY (palette-widget section) ========== */
+
+void palette_widget_config_init_defaults(Config *cfg) {
+	if (!cfg) {
+		return;
+	}
+	// Fills the gap between the swatch and the Pick Color button
+	cfg->palette_widget.palette_x = 392;
+	cfg->palette_widget.palette_y = 215;
+	cfg->palette_widget.width = 92;
+	cfg->palette_widget.height = 74;
+	cfg->palette_widget.padding = 4;
+	cfg->palette_widget.cell_size = 12;
+	cfg->palette_widget.cell_spacing = 3;
+	cfg->palette_widget.cell_radius = 2;
+	cfg->palette_widget.border_width = 1;
+	cfg->palette_widget.border_radius = 4;
+	cfg->palette_widget.max_colors = 1024;
+}
+
+void palette_widget_config_parse(Config *cfg, const char *key, const char *value) {
+	if (!cfg || !key || !value) {
+		return;
+	}
+
+	// Alphabetized geometry keys only
+	if (strcmp(key, "border-radius") == 0) {
+		cfg->palette_widget.border_radius = atoi(value);
+	}
+	else if (strcmp(key, "border-width") == 0) {
+		cfg->palette_widget.border_width = atoi(value);
+	}
+	else if (strcmp(key, "cell-radius") == 0) {
+		cfg->palette_widget.cell_radius = atoi(value);
+	}
+	else if (strcmp(key, "cell-size") == 0) {
+		cfg->palette_widget.cell_size = atoi(value);
+	}
+	else if (strcmp(key, "cell-spacing") == 0) {
+		cfg->palette_widget.cell_spacing = atoi(value);
+	}
+	else if (strcmp(key, "height") == 0) {
+		cfg->palette_widget.height = atoi(value);
+	}
+	else if (strcmp(key, "max-colors") == 0) {
+		cfg->palette_widget.max_colors = atoi(value);
+	}
+	else if (strcmp(key, "padding") == 0) {
+		cfg->palette_widget.padding = atoi(value);
+	}
+	else if (strcmp(key, "palette-x") == 0) {
+		cfg->palette_widget.palette_x = atoi(value);
+	}
+	else if (strcmp(key, "palette-y") == 0) {
+		cfg->palette_widget.palette_y = atoi(value);
+	}
+	else if (strcmp(key, "width") == 0) {
+		cfg->palette_widget.width = atoi(value);
+	}
+}
+
+void palette_widget_config_write(FILE *f, const Config *cfg) {
+	if (!f || !cfg) {
+		return;
+	}
+
+	// Alphabetized geometry keys only
+	fprintf(f, "[palette-widget]\n");
+	fprintf(f, "border-radius = %d\n", cfg->palette_widget.border_radius);
+	fprintf(f, "border-width = %d\n", cfg->palette_widget.border_width);
+	fprintf(f, "cell-radius = %d\n", cfg->palette_widget.cell_radius);
+	fprintf(f, "cell-size = %d\n", cfg->palette_widget.cell_size);
+	fprintf(f, "cell-spacing = %d\n", cfg->palette_widget.cell_spacing);
+	fprintf(f, "height = %d\n", cfg->palette_widget.height);
+	fprintf(f, "max-colors = %d\n", cfg->palette_widget.max_colors);
+	fprintf(f, "padding = %d\n", cfg->palette_widget.padding);
+	fprintf(f, "palette-x = %d\n", cfg->palette_widget.palette_x);
+	fprintf(f, "palette-y = %d\n", cfg->palette_widget.palette_y);
+	fprintf(f, "width = %d\n\n", cfg->palette_widget.width);
+}
@@ -0,0 +1,230 @@
+#ifndef PALETTE_H_
+#define PALETTE_H_
+
+/* ========== PALETTE STRIP WIDGET INTERFACE ========== */
+
+/**
+ * @file palette.h
+ * @brief Scrollable palette/history strip widget interface for X11
+ *
+ * Grid of colour cells showing recent picks and saved palettes. The whole
+ * grid lives in a single child window: cells are not windows, only the rows
+ * inside the viewport are painted, and every frame is composed in one back
+ * buffer before being presented. The palette widget is completely
+ * self-contained and can be used independently in other applications.
+ *
+ * Features:
+ * - Virtualised rendering - cost depends on visible cells, not colour count
+ * - Mouse wheel scrolling by whole rows
+ * - O(1) arithmetic hit-testing for hover and click
+ * - Rounded cells clipped through one cached 1-bit shape mask
+ * - Optional double-buffer extension (DBE), pixmap fallback otherwise
+ * - Most-recent-first history with move-to-front de-duplication
+ *
+ * Dependencies:
+ * - X11 (Xlib, XShape)
+ * - dbe.h (optional double-buffering)
+ * - swatch.h (shared rounded-rect drawing)
+ * - colormath.h (RGB8 colour type)
+ *
+ * Usage:
+ *   1. Create palette: palette_create(display, parent, x, y, width, height)
+ *   2. Add colours: palette_push_color() for picks, palette_append_colors()
+ *      for saved palettes
+ *   3. Handle events: palette_handle_event(palette, &event, &rgb)
+ *      - Returns 2 when a cell was clicked and fills rgb
+ *   4. Cleanup: palette_destroy(palette)
+ *
+ * Thread safety: Not thread-safe (uses X11 APIs)
+ * Memory: Caller must call palette_destroy() to free resources
+ */
+
+#include <stddef.h>
+#include <X11/Xlib.h>
+#include "colormath.h"
+
+/* ========== PALETTE CONTEXT TYPE ========== */
+
+/**
+ * PaletteContext - Opaque palette strip widget context
+ *
+ * The internal structure is hidden to maintain widget independence.
+ * Users interact with the palette through the provided API functions.
+ */
+typedef struct PaletteContext PaletteContext;
+
+/* ========== LIFECYCLE MANAGEMENT ========== */
+
+/**
+ * @brief Create a new palette strip widget
+ * @param dpy X11 display connection
+ * @param parent Parent window that will contain the strip
+ * @param x X position inside parent
+ * @param y Y position inside parent
+ * @param width Width of the strip in pixels
+ * @param height Height of the strip in pixels
+ *
+ * @return Pointer to new palette context, or NULL on failure
+ */
+PaletteContext *palette_create(Display *dpy, Window parent, int x, int y, int width, int height);
+
+/**
+ * @brief Destroy a palette widget and free its resources
+ * @param ctx Palette context to destroy
+ */
+void palette_destroy(PaletteContext *ctx);
+
+/* ========== WINDOW MANAGEMENT ========== */
+
+/**
+ * @brief Get the X11 window handle for a palette
+ * @param ctx Palette context
+ *
+ * @return X11 Window ID of the palette widget
+ */
+Window palette_get_window(PaletteContext *ctx);
+
+/* ========== EVENT HANDLING ========== */
+
+/**
+ * @brief Process an X11 event for the palette
+ * @param ctx Palette context
+ * @param ev X11 event to process
+ * @param out Receives the clicked colour when 2 is returned (may be NULL)
+ *
+ * @return 2 if a cell was clicked, 1 if the event was otherwise handled,
+ *         0 if the event was not for this widget
+ */
+int palette_handle_event(PaletteContext *ctx, const XEvent *ev, RGB8 *out);
+
+/* ========== COLOR MANAGEMENT ========== */
+
+/**
+ * @brief Push a colour to the front of the strip
+ * @param ctx Palette context
+ * @param rgb Colour to add
+ *
+ * An existing identical cell is moved to the front instead of duplicated.
+ * Cells beyond the configured maximum drop off the end.
+ *
+ * @return 1 if the strip changed, 0 if rgb was already first, -1 on error
+ */
+int palette_push_color(PaletteContext *ctx, RGB8 rgb);
+
+/**
+ * @brief Append colours to the end of the strip
+ * @param ctx Palette context
+ * @param colors Colours to append in display order
+ * @param count Number of colours
+ *
+ * Colours that would take the strip past its maximum are dropped.
+ *
+ * @return 0 on success, -1 on allocation failure
+ */
+int palette_append_colors(PaletteContext *ctx, const RGB8 *colors, size_t count);
+
+/**
+ * @brief Remove every colour from the strip
+ * @param ctx Palette context
+ */
+void palette_clear(PaletteContext *ctx);
+
+/**
+ * @brief Get the colours currently held by the strip
+ * @param ctx Palette context
+ * @param count Receives the number of colours
+ *
+ * @return Pointer to the colours in display order (owned by the widget)
+ */
+const RGB8 *palette_get_colors(const PaletteContext *ctx, size_t *count);
+
+/**
+ * @brief Set the maximum number of cells the strip keeps
+ * @param ctx Palette context
+ * @param max_colors Maximum cell count (0 for unlimited)
+ *
+ * Lowering the maximum drops the cells past it.
+ */
+void palette_set_max_colors(PaletteContext *ctx, size_t max_colors);
+
+/* ========== THEME & GEOMETRY MANAGEMENT ========== */
+
+/**
+ * @brief Set palette colours
+ * @param ctx Palette context
+ * @param bg_pixel Background behind the cells
+ * @param border_pixel Cell and widget outline colour
+ * @param hover_pixel Outline colour of the cell under the pointer
+ */
+void palette_set_theme(PaletteContext *ctx, unsigned long bg_pixel, unsigned long border_pixel, unsigned long hover_pixel);
+
+/**
+ * @brief Move and resize the palette widget
+ * @param ctx Palette context
+ * @param x New X coordinate
+ * @param y New Y coordinate
+ * @param width New width in pixels
+ * @param height New height in pixels
+ */
+void palette_set_geometry(PaletteContext *ctx, int x, int y, int width, int height);
+
+/**
+ * @brief Set cell layout and border styling
+ * @param ctx Palette context
+ * @param padding Inner padding around the grid
+ * @param cell_size Cell edge length in pixels
+ * @param cell_spacing Gap between cells in pixels
+ * @param cell_radius Cell corner radius in pixels
+ * @param border_width Widget border thickness in pixels
+ * @param border_radius Widget corner radius in pixels
+ */
+void palette_set_cell_style(PaletteContext *ctx, int padding, int cell_size, int cell_spacing, int cell_radius, int border_width, int border_radius);
+
+/* ========== CONFIGURATION MANAGEMENT ========== */
+
+#include <stdio.h>
+#include "config.h"
+
+/**
+ * @brief Initialize palette configuration with default values
+ * @param cfg Configuration structure to initialize
+ */
+void palette_config_init_defaults(Config *cfg);
+
+/**
+ * @brief Parse a palette configuration key-value pair
+ * @param cfg Configuration structure to update
+ * @param key Configuration key
+ * @param value Configuration value
+ */
+void palette_config_parse(Config *cfg, const char *key, const char *value);
+
+/**
+ * @brief Write palette configuration to file
+ * @param f File handle to write to
+ * @param cfg Configuration structure to write from
+ */
+void palette_config_write(FILE *f, const Config *cfg);
+
+/**
+ * @brief Initialize palette widget geometry defaults
+ * @param cfg Pointer to main Config struct
+ */
+void palette_widget_config_init_defaults(Config *cfg);
+
+/**
+ * @brief Parse palette widget geometry configuration from key-value pair
+ * @param cfg Pointer to main Config struct
+ * @param key Configuration key
+ * @param value Configuration value as string
+ */
+void palette_widget_config_parse(Config *cfg, const char *key, const char *value);
+
+/**
+ * @brief Write palette widget geometry configuration to file
+ * @param f File pointer to write to
+ * @param cfg Pointer to main Config struct
+ */
+void palette_widget_config_write(FILE *f, const Config *cfg);
+
+#endif /* PALETTE_H_ */
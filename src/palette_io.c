@@ -0,0 +1,756 @@
+/* palette_io.c - Palette Import/Export Implementation
+ *
+ * Streaming parsers and a buffered writer for GIMP, ASE, CSS, JSON and plain
+ * hex palette files.
+ *
+ * Internal design notes:
+ * - Input files are mmapped read-only and scanned once, front to back. Each
+ *   parser works on a (cursor, end) pair and never copies the input, so a
+ *   100k-entry library costs one mapping and no heap traffic.
+ * - Names are handed to the sink as (pointer, length) slices into the
+ *   mapping; ASE UTF-16 names are narrowed into a small stack buffer.
+ * - Exporters share one PaletteWriter with a fixed buffer; output is flushed
+ *   with write(2) only when the buffer fills or at the end.
+ */
+
+#include "palette_io.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <stdint.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/* ========== FORMAT HELPERS ========== */
+
+PaletteFormat palette_format_from_path(const char *path) {
+	if (!path) {
+		return PALETTE_FORMAT_AUTO;
+	}
+	const char *dot = strrchr(path, '.');
+	const char *slash = strrchr(path, '/');
+	if (!dot || (slash && dot < slash)) {
+		return PALETTE_FORMAT_AUTO;
+	}
+	return palette_format_from_name(dot + 1);
+}
+
+PaletteFormat palette_format_from_name(const char *name) {
+	if (!name) {
+		return PALETTE_FORMAT_AUTO;
+	}
+	if (strcasecmp(name, "gpl") == 0) {
+		return PALETTE_FORMAT_GPL;
+	}
+	if (strcasecmp(name, "ase") == 0) {
+		return PALETTE_FORMAT_ASE;
+	}
+	if (strcasecmp(name, "css") == 0) {
+		return PALETTE_FORMAT_CSS;
+	}
+	if (strcasecmp(name, "json") == 0) {
+		return PALETTE_FORMAT_JSON;
+	}
+	if (strcasecmp(name, "hex") == 0 || strcasecmp(name, "txt") == 0) {
+		return PALETTE_FORMAT_HEX;
+	}
+	return PALETTE_FORMAT_AUTO;
+}
+
+/* Content sniffing for files whose extension told us nothing */
+static PaletteFormat sniff_format(const char *p, const char *end) {
+	if (end - p >= 4 && memcmp(p, "ASEF", 4) == 0) {
+		return PALETTE_FORMAT_ASE;
+	}
+	while (p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')) {
+		p++;
+	}
+	if (end - p >= 12 && memcmp(p, "GIMP Palette", 12) == 0) {
+		return PALETTE_FORMAT_GPL;
+	}
+	if (p < end && (*p == '{' || *p == '[')) {
+		return PALETTE_FORMAT_JSON;
+	}
+	if (end - p >= 2 && (memcmp(p, ":r", 2) == 0 || memcmp(p, "--", 2) == 0 || memcmp(p, "/*", 2) == 0)) {
+		return PALETTE_FORMAT_CSS;
+	}
+	return PALETTE_FORMAT_HEX;
+}
+
+/* ========== SCANNING HELPERS ========== */
+
+static int hex_digit(int c) {
+	if (c >= '0' && c <= '9') {
+		return c - '0';
+	}
+	if (c >= 'a' && c <= 'f') {
+		return c - 'a' + 10;
+	}
+	if (c >= 'A' && c <= 'F') {
+		return c - 'A' + 10;
+	}
+	return -1;
+}
+
+/* Parse "#RRGGBB", "#RGB" (or bare "RRGGBB" when allow_bare is set).
+ * Returns number of bytes consumed, 0 if no colour starts at p. */
+static size_t scan_hex_color(const char *p, const char *end, int allow_bare, RGB8 *out) {
+	const char *s = p;
+	int bare = 0;
+	if (s < end && *s == '#') {
+		s++;
+	}
+	else if (!allow_bare) {
+		return 0;
+	}
+	else {
+		bare = 1;
+	}
+	int digits[6];
+	int n = 0;
+	while (s + n < end && n < 6 && (digits[n] = hex_digit((unsigned char)s[n])) >= 0) {
+		n++;
+	}
+	// Reject longer runs (e.g. #RRGGBBAA is not handled as RGB)
+	if (s + n < end && hex_digit((unsigned char)s[n]) >= 0) {
+		return 0;
+	}
+	if (n == 6) {
+		out->r = (uint8_t)(digits[0] * 16 + digits[1]);
+		out->g = (uint8_t)(digits[2] * 16 + digits[3]);
+		out->b = (uint8_t)(digits[4] * 16 + digits[5]);
+		return (size_t)(s + 6 - p);
+	}
+	// Bare three-digit runs are too easily words ("bad", "fed")
+	if (n == 3 && !bare) {
+		out->r = (uint8_t)(digits[0] * 17);
+		out->g = (uint8_t)(digits[1] * 17);
+		out->b = (uint8_t)(digits[2] * 17);
+		return (size_t)(s + 3 - p);
+	}
+	return 0;
+}
+
+static const char *skip_space(const char *p, const char *end) {
+	while (p < end && (*p == ' ' || *p == '\t' || *p == '\r')) {
+		p++;
+	}
+	return p;
+}
+
+static const char *line_end(const char *p, const char *end) {
+	const char *nl = memchr(p, '\n', (size_t)(end - p));
+	return nl ? nl : end;
+}
+
+/* Parse a decimal integer in [0, 255]; returns pointer past it or NULL */
+static const char *scan_byte(const char *p, const char *end, int *out) {
+	int v = 0, n = 0;
+	while (p < end && *p >= '0' && *p <= '9' && n < 4) {
+		v = v * 10 + (*p - '0');
+		p++;
+		n++;
+	}
+	if (n == 0 || v > 255) {
+		return NULL;
+	}
+	*out = v;
+	return p;
+}
+
+/* Parse "rgb(r, g, b)" / "rgba(r, g, b, a)" with integer channels */
+static size_t scan_rgb_func(const char *p, const char *end, RGB8 *out) {
+	const char *s = p;
+	if (end - s >= 4 && memcmp(s, "rgb(", 4) == 0) {
+		s += 4;
+	}
+	else if (end - s >= 5 && memcmp(s, "rgba(", 5) == 0) {
+		s += 5;
+	}
+	else {
+		return 0;
+	}
+	int ch[3];
+	for (int i = 0; i < 3; i++) {
+		s = skip_space(s, end);
+		s = scan_byte(s, end, &ch[i]);
+		if (!s) {
+			return 0;
+		}
+		s = skip_space(s, end);
+		if (i < 2) {
+			if (s >= end || (*s != ',' && *s != ' ')) {
+				return 0;
+			}
+			s++;
+		}
+	}
+	const char *close = s;
+	while (close < end && *close != ')' && *close != '\n') {
+		close++;
+	}
+	if (close >= end || *close != ')') {
+		return 0;
+	}
+	out->r = (uint8_t)ch[0];
+	out->g = (uint8_t)ch[1];
+	out->b = (uint8_t)ch[2];
+	return (size_t)(close + 1 - p);
+}
+
+/* ========== TEXT FORMAT PARSERS ========== */
+
+/* GIMP palette: "R G B<ws>name" lines after the header */
+static long parse_gpl(const char *p, const char *end, PaletteColorSink sink, void *user_data) {
+	long count = 0;
+	while (p < end) {
+		const char *eol = line_end(p, end);
+		const char *s = skip_space(p, eol);
+		if (s < eol && *s >= '0' && *s <= '9') {
+			int r, g, b;
+			s = scan_byte(s, eol, &r);
+			if (s) {
+				s = scan_byte(skip_space(s, eol), eol, &g);
+			}
+			if (s) {
+				s = scan_byte(skip_space(s, eol), eol, &b);
+			}
+			if (s) {
+				const char *name = skip_space(s, eol);
+				const char *name_end = eol;
+				while (name_end > name && (name_end[-1] == '\r' || name_end[-1] == ' ' || name_end[-1] == '\t')) {
+					name_end--;
+				}
+				RGB8 c = {(uint8_t)r, (uint8_t)g, (uint8_t)b};
+				count++;
+				if (sink(c, name_end > name ? name : NULL, (size_t)(name_end - name), user_data)) {
+					break;
+				}
+			}
+		}
+		p = eol + 1;
+	}
+	return count;
+}
+
+/* Plain hex list: one colour per line, '#' optional, other lines ignored */
+static long parse_hex_list(const char *p, const char *end, PaletteColorSink sink, void *user_data) {
+	long count = 0;
+	while (p < end) {
+		const char *eol = line_end(p, end);
+		const char *s = skip_space(p, eol);
+		RGB8 c;
+		size_t n = scan_hex_color(s, eol, 1, &c);
+		if (n > 0) {
+			const char *after = skip_space(s + n, eol);
+			// Anything after the colour must be a comment or nothing
+			if (after >= eol || *after == '#' || *after == ';' || (eol - after >= 2 && after[0] == '/' && after[1] == '/')) {
+				count++;
+				if (sink(c, NULL, 0, user_data)) {
+					break;
+				}
+			}
+		}
+		p = eol + 1;
+	}
+	return count;
+}
+
+/* CSS custom properties: "--name: <hex | rgb()>;" anywhere in the file */
+static long parse_css(const char *p, const char *end, PaletteColorSink sink, void *user_data) {
+	long count = 0;
+	while (p < end) {
+		const char *dash = memchr(p, '-', (size_t)(end - p));
+		if (!dash || end - dash < 2) {
+			break;
+		}
+		if (dash[1] != '-' || (dash > p && (dash[-1] == '-' || (dash[-1] >= 'a' && dash[-1] <= 'z')))) {
+			p = dash + 1;
+			continue;
+		}
+		const char *name = dash + 2;
+		const char *s = name;
+		while (s < end && *s != ':' && *s != ';' && *s != '}' && *s != '\n' && *s != ' ') {
+			s++;
+		}
+		const char *name_end = s;
+		while (s < end && (*s == ' ' || *s == '\t')) {
+			s++;
+		}
+		if (s >= end || *s != ':') {
+			p = s;
+			continue;
+		}
+		s++;
+		while (s < end && (*s == ' ' || *s == '\t' || *s == '\n' || *s == '\r')) {
+			s++;
+		}
+		RGB8 c;
+		size_t n = scan_hex_color(s, end, 0, &c);
+		if (n == 0) {
+			n = scan_rgb_func(s, end, &c);
+		}
+		if (n > 0) {
+			count++;
+			if (sink(c, name, (size_t)(name_end - name), user_data)) {
+				break;
+			}
+			s += n;
+		}
+		p = s;
+	}
+	return count;
+}
+
+/* JSON: every string value that is exactly a "#RRGGBB"/"#RGB" colour is
+ * emitted. The most recent "name" string in the enclosing object is used as
+ * the entry name, so both ["#..."] arrays and [{"name":..,"hex":..}] work. */
+static long parse_json(const char *p, const char *end, PaletteColorSink sink, void *user_data) {
+	long count = 0;
+	const char *obj_name = NULL;
+	size_t obj_name_len = 0;
+	int last_key_is_name = 0;
+	int expecting_value = 0;
+	while (p < end) {
+		char ch = *p;
+		if (ch == '{') {
+			obj_name = NULL;
+			obj_name_len = 0;
+			expecting_value = 0;
+			p++;
+			continue;
+		}
+		if (ch == ':') {
+			expecting_value = 1;
+			p++;
+			continue;
+		}
+		if (ch == '}') {
+			obj_name = NULL;
+			obj_name_len = 0;
+		}
+		if (ch == ',' || ch == '[' || ch == ']' || ch == '}') {
+			expecting_value = 0;
+			last_key_is_name = 0;
+			p++;
+			continue;
+		}
+		if (ch != '"') {
+			p++;
+			continue;
+		}
+		// String token
+		const char *str = ++p;
+		while (p < end && *p != '"') {
+			if (*p == '\\' && p + 1 < end) {
+				p++;
+			}
+			p++;
+		}
+		const char *str_end = p;
+		if (p < end) {
+			p++;
+		}
+		size_t len = (size_t)(str_end - str);
+		const char *after = p;
+		while (after < end && (*after == ' ' || *after == '\t' || *after == '\r' || *after == '\n')) {
+			after++;
+		}
+		if (!expecting_value && after < end && *after == ':') {
+			// Object key
+			last_key_is_name = (len == 4 && memcmp(str, "name", 4) == 0);
+			continue;
+		}
+		if (last_key_is_name) {
+			obj_name = str;
+			obj_name_len = len;
+			last_key_is_name = 0;
+			continue;
+		}
+		RGB8 c;
+		if (len > 0 && scan_hex_color(str, str_end, 0, &c) == len) {
+			count++;
+			if (sink(c, obj_name, obj_name_len, user_data)) {
+				break;
+			}
+		}
+	}
+	return count;
+}
+
+/* ========== ADOBE SWATCH EXCHANGE ========== */
+
+static uint16_t be16(const unsigned char *b) {
+	return (uint16_t)((b[0] << 8) | b[1]);
+}
+
+static uint32_t be32(const unsigned char *b) {
+	return ((uint32_t)b[0] << 24) | ((uint32_t)b[1] << 16) | ((uint32_t)b[2] << 8) | (uint32_t)b[3];
+}
+
+static float bef32(const unsigned char *b) {
+	uint32_t u = be32(b);
+	float f;
+	memcpy(&f, &u, sizeof(f));
+	return f;
+}
+
+static uint8_t unit_to_byte(float v) {
+	if (!(v > 0.0f)) {
+		return 0;
+	}
+	if (v >= 1.0f) {
+		return 255;
+	}
+	return (uint8_t)(v * 255.0f + 0.5f);
+}
+
+/* ASE: "ASEF", u16 major, u16 minor, u32 block count, then blocks of
+ * (u16 type, u32 length, payload). Colour entries (0x0001) carry a UTF-16BE
+ * name, a 4-char model and big-endian floats. RGB, CMYK and Gray are
+ * converted; LAB entries are skipped. */
+static long parse_ase(const char *data, const char *end, PaletteColorSink sink, void *user_data) {
+	const unsigned char *p = (const unsigned char *)data;
+	const unsigned char *e = (const unsigned char *)end;
+	if (e - p < 12 || memcmp(p, "ASEF", 4) != 0) {
+		fprintf(stderr, "Palette: not an ASE file\n");
+		return -1;
+	}
+	uint32_t blocks = be32(p + 8);
+	p += 12;
+	long count = 0;
+	for (uint32_t i = 0; i < blocks && e - p >= 6; i++) {
+		uint16_t type = be16(p);
+		uint32_t len = be32(p + 2);
+		p += 6;
+		if ((size_t)(e - p) < len) {
+			break;
+		}
+		const unsigned char *blk = p;
+		const unsigned char *blk_end = p + len;
+		p = blk_end;
+		if (type != 0x0001 || blk_end - blk < 2) {
+			continue;
+		}
+		uint16_t name_chars = be16(blk);
+		blk += 2;
+		if ((size_t)(blk_end - blk) < (size_t)name_chars * 2 + 4) {
+			continue;
+		}
+		// Narrow the UTF-16BE name to ASCII-ish bytes on the stack
+		char name[64];
+		size_t name_len = 0;
+		for (uint16_t k = 0; k < name_chars; k++) {
+			uint16_t u = be16(blk + k * 2);
+			if (u == 0) {
+				break;
+			}
+			if (name_len < sizeof(name)) {
+				name[name_len++] = (u < 0x80) ? (char)u : '?';
+			}
+		}
+		blk += (size_t)name_chars * 2;
+		const unsigned char *model = blk;
+		blk += 4;
+		RGB8 c;
+		if (memcmp(model, "RGB ", 4) == 0 && blk_end - blk >= 12) {
+			c.r = unit_to_byte(bef32(blk));
+			c.g = unit_to_byte(bef32(blk + 4));
+			c.b = unit_to_byte(bef32(blk + 8));
+		}
+		else if (memcmp(model, "CMYK", 4) == 0 && blk_end - blk >= 16) {
+			float k = bef32(blk + 12);
+			c.r = unit_to_byte((1.0f - bef32(blk)) * (1.0f - k));
+			c.g = unit_to_byte((1.0f - bef32(blk + 4)) * (1.0f - k));
+			c.b = unit_to_byte((1.0f - bef32(blk + 8)) * (1.0f - k));
+		}
+		else if (memcmp(model, "Gray", 4) == 0 && blk_end - blk >= 4) {
+			c.r = c.g = c.b = unit_to_byte(bef32(blk));
+		}
+		else {
+			continue;
+		}
+		count++;
+		if (sink(c, name_len ? name : NULL, name_len, user_data)) {
+			break;
+		}
+	}
+	return count;
+}
+
+/* ========== IMPORT ========== */
+
+long palette_io_import(const char *path, PaletteFormat format, PaletteColorSink sink, void *user_data) {
+	if (!path || !sink) {
+		return -1;
+	}
+	int fd = open(path, O_RDONLY);
+	if (fd < 0) {
+		fprintf(stderr, "Palette: cannot open %s: %s\n", path, strerror(errno));
+		return -1;
+	}
+	struct stat st;
+	if (fstat(fd, &st) != 0) {
+		close(fd);
+		return -1;
+	}
+	if (st.st_size == 0) {
+		close(fd);
+		return 0;
+	}
+	size_t size = (size_t)st.st_size;
+	void *map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (map == MAP_FAILED) {
+		fprintf(stderr, "Palette: cannot map %s: %s\n", path, strerror(errno));
+		return -1;
+	}
+	madvise(map, size, MADV_SEQUENTIAL);
+	const char *p = (const char *)map;
+	const char *end = p + size;
+
+	if (format == PALETTE_FORMAT_AUTO) {
+		format = palette_format_from_path(path);
+	}
+	if (format == PALETTE_FORMAT_AUTO) {
+		format = sniff_format(p, end);
+	}
+	long count;
+	switch (format) {
+		case PALETTE_FORMAT_GPL:
+			count = parse_gpl(p, end, sink, user_data);
+			break;
+		case PALETTE_FORMAT_ASE:
+			count = parse_ase(p, end, sink, user_data);
+			break;
+		case PALETTE_FORMAT_CSS:
+			count = parse_css(p, end, sink, user_data);
+			break;
+		case PALETTE_FORMAT_JSON:
+			count = parse_json(p, end, sink, user_data);
+			break;
+		case PALETTE_FORMAT_HEX:
+		default:
+			count = parse_hex_list(p, end, sink, user_data);
+			break;
+	}
+	munmap(map, size);
+	return count;
+}
+
+/* ========== BUFFERED WRITER ========== */
+
+#define PALETTE_WRITER_SIZE 65536
+
+typedef struct {
+	int fd;
+	size_t len;
+	int failed;
+	char buf[PALETTE_WRITER_SIZE];
+} PaletteWriter;
+
+static void writer_flush(PaletteWriter *w) {
+	size_t off = 0;
+	while (!w->failed && off < w->len) {
+		ssize_t n = write(w->fd, w->buf + off, w->len - off);
+		if (n < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			w->failed = 1;
+			break;
+		}
+		off += (size_t)n;
+	}
+	w->len = 0;
+}
+
+static void writer_put(PaletteWriter *w, const void *data, size_t n) {
+	const char *s = (const char *)data;
+	while (n > 0) {
+		if (w->len == PALETTE_WRITER_SIZE) {
+			writer_flush(w);
+		}
+		size_t room = PALETTE_WRITER_SIZE - w->len;
+		size_t chunk = n < room ? n : room;
+		memcpy(w->buf + w->len, s, chunk);
+		w->len += chunk;
+		s += chunk;
+		n -= chunk;
+	}
+}
+
+static void writer_str(PaletteWriter *w, const char *s) {
+	writer_put(w, s, strlen(s));
+}
+
+static void writer_hex(PaletteWriter *w, RGB8 c) {
+	char hex[8];
+	rgb8_to_hex(c, hex);
+	writer_put(w, hex, 7);
+}
+
+static void writer_uint(PaletteWriter *w, size_t v, int width) {
+	char tmp[24];
+	int n = snprintf(tmp, sizeof(tmp), "%*zu", width, v);
+	if (n > 0) {
+		writer_put(w, tmp, (size_t)n);
+	}
+}
+
+static void writer_be16(PaletteWriter *w, uint16_t v) {
+	unsigned char b[2] = {(unsigned char)(v >> 8), (unsigned char)v};
+	writer_put(w, b, 2);
+}
+
+static void writer_be32(PaletteWriter *w, uint32_t v) {
+	unsigned char b[4] = {(unsigned char)(v >> 24), (unsigned char)(v >> 16), (unsigned char)(v >> 8), (unsigned char)v};
+	writer_put(w, b, 4);
+}
+
+static void writer_bef32(PaletteWriter *w, float f) {
+	uint32_t u;
+	memcpy(&u, &f, sizeof(u));
+	writer_be32(w, u);
+}
+
+/* Write name with anything outside [A-Za-z0-9 _-] replaced, for JSON/GPL */
+static void writer_safe_name(PaletteWriter *w, const char *name) {
+	for (const char *s = name; *s; s++) {
+		char ch = *s;
+		if (!((ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z') || (ch >= '0' && ch <= '9') || ch == ' ' || ch == '_' || ch == '-')) {
+			ch = '_';
+		}
+		writer_put(w, &ch, 1);
+	}
+}
+
+/* ========== EXPORT ========== */
+
+static void export_gpl(PaletteWriter *w, const RGB8 *colors, size_t count, const char *name) {
+	writer_str(w, "GIMP Palette\nName: ");
+	writer_safe_name(w, name);
+	writer_str(w, "\nColumns: 8\n#\n");
+	for (size_t i = 0; i < count; i++) {
+		writer_uint(w, colors[i].r, 3);
+		writer_put(w, " ", 1);
+		writer_uint(w, colors[i].g, 3);
+		writer_put(w, " ", 1);
+		writer_uint(w, colors[i].b, 3);
+		writer_put(w, "\t", 1);
+		writer_hex(w, colors[i]);
+		writer_put(w, "\n", 1);
+	}
+}
+
+static void export_hex(PaletteWriter *w, const RGB8 *colors, size_t count) {
+	for (size_t i = 0; i < count; i++) {
+		writer_hex(w, colors[i]);
+		writer_put(w, "\n", 1);
+	}
+}
+
+static void export_css(PaletteWriter *w, const RGB8 *colors, size_t count) {
+	writer_str(w, ":root {\n");
+	for (size_t i = 0; i < count; i++) {
+		writer_str(w, "\t--color-");
+		writer_uint(w, i + 1, 0);
+		writer_str(w, ": ");
+		writer_hex(w, colors[i]);
+		writer_str(w, ";\n");
+	}
+	writer_str(w, "}\n");
+}
+
+static void export_json(PaletteWriter *w, const RGB8 *colors, size_t count, const char *name) {
+	writer_str(w, "{\n\t\"name\": \"");
+	writer_safe_name(w, name);
+	writer_str(w, "\",\n\t\"colors\": [");
+	for (size_t i = 0; i < count; i++) {
+		writer_str(w, i ? ",\n\t\t\"" : "\n\t\t\"");
+		writer_hex(w, colors[i]);
+		writer_put(w, "\"", 1);
+	}
+	writer_str(w, count ? "\n\t]\n}\n" : "]\n}\n");
+}
+
+static void export_ase(PaletteWriter *w, const RGB8 *colors, size_t count) {
+	writer_put(w, "ASEF", 4);
+	writer_be16(w, 1);
+	writer_be16(w, 0);
+	writer_be32(w, (uint32_t)count);
+	for (size_t i = 0; i < count; i++) {
+		char hex[8];
+		rgb8_to_hex(colors[i], hex);
+		// Block: name length (u16) + name (8 UTF-16 units incl. NUL) + model + 3 floats + type
+		writer_be16(w, 0x0001);
+		writer_be32(w, 2 + 8 * 2 + 4 + 12 + 2);
+		writer_be16(w, 8);
+		for (int k = 0; k < 8; k++) {
+			writer_be16(w, (uint16_t)(unsigned char)hex[k]);
+		}
+		writer_put(w, "RGB ", 4);
+		writer_bef32(w, (float)colors[i].r / 255.0f);
+		writer_bef32(w, (float)colors[i].g / 255.0f);
+		writer_bef32(w, (float)colors[i].b / 255.0f);
+		writer_be16(w, 2); // Normal (non-global, non-spot) colour
+	}
+}
+
+int palette_io_export(const char *path, PaletteFormat format, const RGB8 *colors, size_t count, const char *name) {
+	if (!path || (!colors && count > 0)) {
+		return -1;
+	}
+	if (format == PALETTE_FORMAT_AUTO) {
+		format = palette_format_from_path(path);
+	}
+	if (!name || !*name) {
+		name = "PixelPrism";
+	}
+	PaletteWriter *w = malloc(sizeof(PaletteWriter));
+	if (!w) {
+		return -1;
+	}
+	w->fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	w->len = 0;
+	w->failed = 0;
+	if (w->fd < 0) {
+		fprintf(stderr, "Palette: cannot create %s: %s\n", path, strerror(errno));
+		free(w);
+		return -1;
+	}
+	switch (format) {
+		case PALETTE_FORMAT_GPL:
+			export_gpl(w, colors, count, name);
+			break;
+		case PALETTE_FORMAT_ASE:
+			export_ase(w, colors, count);
+			break;
+		case PALETTE_FORMAT_CSS:
+			export_css(w, colors, count);
+			break;
+		case PALETTE_FORMAT_JSON:
+			export_json(w, colors, count, name);
+			break;
+		case PALETTE_FORMAT_HEX:
+		case PALETTE_FORMAT_AUTO:
+		default:
+			export_hex(w, colors, count);
+			break;
+	}
+	writer_flush(w);
+	int failed = w->failed;
+	if (close(w->fd) != 0) {
+		failed = 1;
+	}
+	free(w);
+	if (failed) {
+		fprintf(stderr, "Palette: write to %s failed\n", path);
+		return -1;
+	}
+	return 0;
+}
@@ -0,0 +1,102 @@
+#ifndef PALETTE_IO_H_
+#define PALETTE_IO_H_
+
+/* ========== PALETTE FILE I/O INTERFACE ========== */
+
+/**
+ * @file palette_io.h
+ * @brief Palette import/export for common palette file formats
+ *
+ * Reads and writes colour palettes in the formats other design tools use:
+ *
+ * - GIMP palette (.gpl)
+ * - Adobe Swatch Exchange (.ase)
+ * - CSS custom properties (.css)
+ * - JSON (.json)
+ * - Plain hex lists, one colour per line (.hex, .txt)
+ *
+ * Importers map the file read-only and stream over it, handing each colour to
+ * a caller-supplied sink as soon as it is parsed. Nothing is copied or
+ * allocated per entry, so memory use is bounded no matter how large the
+ * library is. Exporters write through a single fixed-size buffered writer and
+ * issue one write(2) per buffer-full.
+ *
+ * Dependencies:
+ * - colormath.h (RGB8 type, hex helpers)
+ * - POSIX mmap/open/write
+ *
+ * Usage:
+ *   Import: palette_io_import(path, PALETTE_FORMAT_AUTO, sink, user_data)
+ *   Export: palette_io_export(path, PALETTE_FORMAT_AUTO, colors, count, name)
+ *
+ * Thread safety: Reentrant (no global state)
+ * This module has no X11 dependency and can be used headless.
+ */
+
+#include <stddef.h>
+#include "colormath.h"
+
+/* ========== TYPE DEFINITIONS ========== */
+
+/* Supported palette file formats */
+typedef enum {
+	PALETTE_FORMAT_AUTO = 0, /* Detect from extension, then from content */
+	PALETTE_FORMAT_GPL,
+	PALETTE_FORMAT_ASE,
+	PALETTE_FORMAT_CSS,
+	PALETTE_FORMAT_JSON,
+	PALETTE_FORMAT_HEX
+} PaletteFormat;
+
+/* Colour sink called once per imported colour
+ *
+ * @param color     Parsed colour
+ * @param name      Entry name if the format carries one (NOT NUL-terminated,
+ *                  may be NULL), valid only for the duration of the call
+ * @param name_len  Length of name in bytes
+ * @param user_data Caller context passed to palette_io_import()
+ * @return 0 to continue, non-zero to stop the import early
+ */
+typedef int (*PaletteColorSink)(RGB8 color, const char *name, size_t name_len, void *user_data);
+
+/* ========== FORMAT HELPERS ========== */
+
+/**
+ * @brief Guess a palette format from a file name extension
+ * @param path File path
+ * @return Detected format, or PALETTE_FORMAT_AUTO if the extension is unknown
+ */
+PaletteFormat palette_format_from_path(const char *path);
+
+/**
+ * @brief Parse a format name ("gpl", "ase", "css", "json", "hex")
+ * @param name Format name (case-insensitive)
+ * @return Matching format, or PALETTE_FORMAT_AUTO if unknown
+ */
+PaletteFormat palette_format_from_name(const char *name);
+
+/* ========== IMPORT / EXPORT ========== */
+
+/**
+ * @brief Stream colours from a palette file into a sink
+ * @param path Palette file to read
+ * @param format File format, or PALETTE_FORMAT_AUTO to detect
+ * @param sink Callback receiving each colour in file order
+ * @param user_data Passed through to sink
+ * @return Number of colours delivered, or -1 on error
+ */
+long palette_io_import(const char *path, PaletteFormat format, PaletteColorSink sink, void *user_data);
+
+/**
+ * @brief Write colours to a palette file
+ * @param path Destination file (created or truncated)
+ * @param format File format, or PALETTE_FORMAT_AUTO to pick from extension
+ *               (plain hex list if the extension is unknown)
+ * @param colors Colours to write in order
+ * @param count Number of colours
+ * @param name Palette name for formats that store one (may be NULL)
+ * @return 0 on success, -1 on error
+ */
+int palette_io_export(const char *path, PaletteFormat format, const RGB8 *colors, size_t count, const char *name);
+
+#endif /* PALETTE_IO_H_ */
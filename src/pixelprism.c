@@ -7,6 +7,10 @@
  *
  * Features:
  * - Real-time color picking with magnified zoom
+ * - Dominant color extraction from a dragged screen region
+ * - On-screen search for the current color
+ * - Live statistics of a Shift+dragged screen region
+ * - Screen analysis on background worker threads
  * - Multiple color format displays (RGB, HSV, HSL, Hex)
  * - Live color format conversions
  * - Configuration file watching and hot-reloading
@@ -21,6 +25,8 @@
 
 #include "pixelprism.h"
 #include "swatch.h"
+#include "palette.h"
+#include "palette_io.h"
 #include "button.h"
 #include "entry.h"
 #include "config.h"
@@ -29,6 +35,16 @@
 #include "label.h"
 #include "tray.h"
 #include "dbe.h"
+#include "control.h"
+#include "headless.h"
+#include "compositor.h"
+#include "icons.h"
+#include "quantize.h"
+#include "colorfind.h"
+#include "highlight.h"
+#include "regionstats.h"
+#include "statspanel.h"
+#include "workpool.h"
 #include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -36,6 +52,7 @@
 #include <strings.h>
 #include <ctype.h>
 #include <errno.h>
+#include <fcntl.h>
 #include <limits.h>
 #include <sys/stat.h>
 #include <sys/inotify.h>
@@ -46,7 +63,6 @@
 #include <signal.h>
 #include <fontconfig/fontconfig.h>
 #include <X11/Xatom.h>
-#include <X11/xpm.h>
 #include <time.h>
 #include <sys/time.h>
 
@@ -257,6 +273,72 @@ int state_save_last_color(const char *hex) {
 	return 0;
 }
 
+/*
+ * Pick history lives in its own file (~/.config/pixelprism/history.dat), one
+ * #RRGGBB per line, most recent first, so it can grow to thousands of
+ * entries without bloating window.dat.
+ */
+int state_load_history(RGB8 **colors_out, size_t *count_out) {
+	if (!colors_out || !count_out) {
+		return -1;
+	}
+	*colors_out = NULL;
+	*count_out = 0;
+	const char *home = getenv("HOME");
+	if (!home) {
+		home = ".";
+	}
+	char path[PATH_MAX];
+	snprintf(path, sizeof(path), "%s/.config/pixelprism/history.dat", home);
+	FILE *f = fopen(path, "r");
+	if (!f) {
+		return -1;
+	}
+	RGB8 *colors = NULL;
+	size_t count = 0, capacity = 0;
+	char line[64];
+	while (fgets(line, sizeof(line), f)) {
+		RGB8 rgb;
+		if (line[0] == '#' && hex_to_rgb8(line, &rgb)) {
+			if (count == capacity) {
+				size_t cap = capacity ? capacity * 2 : 64;
+				RGB8 *grown = realloc(colors, cap * sizeof(RGB8));
+				if (!grown) {
+					break;
+				}
+				colors = grown;
+				capacity = cap;
+			}
+			colors[count++] = rgb;
+		}
+	}
+	fclose(f);
+	*colors_out = colors;
+	*count_out = count;
+	return 0;
+}
+
+int state_save_history(const RGB8 *colors, size_t count) {
+	state_ensure_dir();
+	const char *home = getenv("HOME");
+	if (!home) {
+		home = ".";
+	}
+	char path[PATH_MAX];
+	snprintf(path, sizeof(path), "%s/.config/pixelprism/history.dat", home);
+	FILE *f = fopen(path, "w");
+	if (!f) {
+		return -1;
+	}
+	char hex[8];
+	for (size_t i = 0; i < count; i++) {
+		rgb8_to_hex(colors[i], hex);
+		fprintf(f, "%s\n", hex);
+	}
+	fclose(f);
+	return 0;
+}
+
 /* Global X resources */
 Display *display;
 Screen *screen;
@@ -311,8 +393,10 @@ static LabelContext *label_hsl = NULL;
 static LabelContext *label_rgbf = NULL;
 static LabelContext *label_rgbi = NULL;
 static LabelContext *label_hex = NULL;
+static Compositor *compositor = NULL; /* Only with single-window = true */
 
 SwatchContext *swatch_ctx = NULL;
+static PaletteContext *palette_ctx = NULL; /* Pick history strip */
 static ButtonContext *button_ctx = NULL;
 static MenuBar *menubar = NULL;
 
@@ -320,10 +404,14 @@ static MenuBar *menubar = NULL;
 static AboutWindow *about_win = NULL; /* About dialog window context */
 static ZoomContext *zoom_ctx = NULL; /* Zoom/magnifier context */
 static TrayContext *tray_ctx = NULL; /* System tray icon context */
+static ControlServer *control_server = NULL; /* Scripting socket (NULL if unavailable) */
+static WorkPool *work_pool = NULL; /* Background jobs; results applied from the main loop */
+static ControlReplyTo *pick_waiters = NULL; /* Control clients waiting for a pick result */
+static size_t pick_waiter_count = 0;
+static size_t pick_waiter_cap = 0;
 
-/* Icon XPM data (defined in icons.c) */
-extern char *pixelprism_xpm[];
-extern char *pixelprism_icon_xpm[];
+/* Icon shown in the about window */
+#define ABOUT_ICON_SIZE 75
 
 /* ========== CONFIGURATION & STATE DATA ========== */
 
@@ -334,6 +422,18 @@ static int watch_fd = -1; /* Watch descriptor for config directory */
 
 /* State management to prevent infinite loops */
 static int updating_from_callback = 0; /* Flag to prevent callback cascades */
+static int suppress_auto_copy = 0; /* Set while restoring a copy-history entry */
+
+/* Live preview while typing: the newest valid text of the entry being edited
+ * is shown in the swatch and the other entries once typing pauses for
+ * LIVE_PREVIEW_DELAY_MS. Nothing is committed until the entry's change
+ * callback runs (Enter or focus loss). */
+#define LIVE_PREVIEW_DELAY_MS 30
+static MiniEntry *live_source = NULL; /* Entry being edited, never rewritten by the preview */
+static RGBf live_rgbf; /* Pending preview color */
+static long long live_deadline_ms = 0; /* When the pending preview is due, 0 if none */
+static int live_shown = 0; /* Widgets show a preview instead of the current color */
+static int writing_preview = 0; /* Entry writes are a preview or its revert: keep them out of undo */
 
 /* Current color state - tracks the application's active color */
 static RGB8 current_rgb8 = {
@@ -358,6 +458,8 @@ static int rgb8_equal(RGB8 a, RGB8 b) {
 static void format_and_update_entries_from_rgbf(RGBf rgbf);
 static void reload_theme(void);
 static void refresh_entry_from_current(const MiniEntry *e);
+static void end_live_edit(void);
+static void revert_live_preview(const MiniEntry *keep);
 
 /* --- Zoom Activation Callback --- */
 static void on_zoom_activated(ZoomContext *zoom, void *user_data) {
@@ -396,6 +498,7 @@ static void validate_entry_flash_invalid_and_restore(MiniEntry *e) {
 	
 	// Restore text immediately
 	refresh_entry_from_current(e);
+	revert_live_preview(e);
 }
 
 static void update_validation_timers(void) {
@@ -437,6 +540,17 @@ static void update_validation_timers(void) {
  *
  * @param e Entry to refresh
  */
+/* Set and draw an entry's text; preview writes are not recorded for undo */
+static void show_entry_text(MiniEntry *e, const char *text) {
+	if (writing_preview) {
+		entry_set_text_no_undo(e, text);
+		entry_draw(e);
+	}
+	else {
+		entry_set_text(e, text);
+	}
+}
+
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wformat-nonliteral"
 static void refresh_entry_from_current(const MiniEntry *e) {
@@ -449,7 +563,7 @@ static void refresh_entry_from_current(const MiniEntry *e) {
 		HSV hsv = rgb_to_hsv(current_rgbf);
 		snprintf(buf, sizeof(buf), FORMAT_HSV_HSL, hsv.H, hsv.S * 100.0, hsv.V * 100.0);
 		buf[sizeof(buf) - 1] = '\0';
-		entry_set_text(entry_hsv, buf);
+		show_entry_text(entry_hsv, buf);
 		return;
 	}
 	// Update HSL entry
@@ -457,14 +571,14 @@ static void refresh_entry_from_current(const MiniEntry *e) {
 		HSL hsl = rgb_to_hsl(current_rgbf);
 		snprintf(buf, sizeof(buf), FORMAT_HSV_HSL, hsl.H, hsl.S * 100.0, hsl.L * 100.0);
 		buf[sizeof(buf) - 1] = '\0';
-		entry_set_text(entry_hsl, buf);
+		show_entry_text(entry_hsl, buf);
 		return;
 	}
 	// Update RGB float entry
 	if (e == entry_rgbf) {
 		snprintf(buf, sizeof(buf), FORMAT_RGBF, current_rgbf.r, current_rgbf.g, current_rgbf.b);
 		buf[sizeof(buf) - 1] = '\0';
-		entry_set_text(entry_rgbf, buf);
+		show_entry_text(entry_rgbf, buf);
 		return;
 	}
 	// Update RGB integer entry
@@ -472,13 +586,13 @@ static void refresh_entry_from_current(const MiniEntry *e) {
 		RGB8 rgb8 = rgbf_to_rgb8(current_rgbf);
 		snprintf(buf, sizeof(buf), FORMAT_RGBI, rgb8.r, rgb8.g, rgb8.b);
 		buf[sizeof(buf) - 1] = '\0';
-		entry_set_text(entry_rgbi, buf);
+		show_entry_text(entry_rgbi, buf);
 		return;
 	}
 	// Update hex entry
 	if (e == entry_hex) {
 		format_hex(current_rgb8, buf, current_theme.hex_uppercase);
-		entry_set_text(entry_hex, buf);
+		show_entry_text(entry_hex, buf);
 		return;
 	}
 }
@@ -565,20 +679,11 @@ AboutWindow *about_create(Display *dpy, Window parent, const MiniTheme *theme) {
 	strncpy(win->browser_path, theme->browser_path, sizeof(win->browser_path) - 1);
 	win->browser_path[sizeof(win->browser_path) - 1] = '\0';
 
-	// Load icon from XPM data
-	win->icon_pixmap = None;
-	win->icon_mask = None;
-	win->icon_width = 0;
-	win->icon_height = 0;
-
-	XpmAttributes xpm_attrs;
-	xpm_attrs.valuemask = XpmReturnPixels | XpmReturnExtensions;
-	int xpm_result = XpmCreatePixmapFromData(dpy, parent, pixelprism_xpm, &win->icon_pixmap, &win->icon_mask, &xpm_attrs);
-	if (xpm_result == XpmSuccess) {
-		win->icon_width = (int)xpm_attrs.width;
-		win->icon_height = (int)xpm_attrs.height;
-		XpmFreeAttributes(&xpm_attrs);
-	}
+	// Upload the pre-converted icon
+	const IconImage *icon = icon_find(pixelprism_icons, pixelprism_icon_count, ABOUT_ICON_SIZE);
+	win->icon_pixmap = icon_create_pixmap(dpy, win->screen, icon, &win->icon_mask);
+	win->icon_width = win->icon_pixmap != None ? icon->width : 0;
+	win->icon_height = win->icon_pixmap != None ? icon->height : 0;
 	return win;
 }
 
@@ -975,6 +1080,181 @@ static void open_configuration(void) {
 	}
 }
 
+/* --- Palette Import/Export --- */
+static const char *pending_import_path = NULL; /* --import-palette, applied once the strip exists */
+static int pick_on_start = 0; /* --pick: begin a pick as soon as the window is up */
+static PaletteFormat cli_palette_format = PALETTE_FORMAT_AUTO; /* --palette-format override */
+
+/* Imported colours are batched so the strip grows (and redraws) once per
+ * chunk rather than once per entry. */
+#define PALETTE_IMPORT_CHUNK 4096
+
+typedef struct {
+	RGB8 colors[PALETTE_IMPORT_CHUNK];
+	size_t count;
+} PaletteImportBatch;
+
+static int palette_import_sink(RGB8 color, const char *name, size_t name_len, void *user_data) {
+	(void)name;
+	(void)name_len;
+	PaletteImportBatch *batch = user_data;
+	batch->colors[batch->count++] = color;
+	if (batch->count == PALETTE_IMPORT_CHUNK) {
+		if (palette_append_colors(palette_ctx, batch->colors, batch->count) != 0) {
+			return 1;
+		}
+		batch->count = 0;
+	}
+	return 0;
+}
+
+/* Append every colour of a palette file to the history strip.
+ * Returns the number of colours imported, or -1 on error. */
+static long import_palette(const char *path, PaletteFormat format) {
+	if (!palette_ctx || !path || !*path) {
+		return -1;
+	}
+	PaletteImportBatch *batch = malloc(sizeof(*batch));
+	if (!batch) {
+		return -1;
+	}
+	batch->count = 0;
+	long imported = palette_io_import(path, format, palette_import_sink, batch);
+	if (batch->count > 0) {
+		palette_append_colors(palette_ctx, batch->colors, batch->count);
+	}
+	free(batch);
+	if (imported >= 0) {
+		fprintf(stderr, "Imported %ld colors from %s\n", imported, path);
+	}
+	return imported;
+}
+
+/* Write the history strip to a palette file */
+static void export_palette(const char *path, PaletteFormat format) {
+	if (!palette_ctx || !path || !*path) {
+		return;
+	}
+	size_t count = 0;
+	const RGB8 *colors = palette_get_colors(palette_ctx, &count);
+	if (palette_io_export(path, format, colors, count, "PixelPrism") == 0) {
+		fprintf(stderr, "Exported %zu colors to %s\n", count, path);
+	}
+}
+
+/* The file chooser (zenity or kdialog) runs as a child process whose stdout
+ * pipe is watched by the main loop, so the window keeps redrawing and
+ * answering the control socket while the dialog is open. */
+static pid_t chooser_pid = -1; /* Running chooser, -1 once reaped */
+static int chooser_fd = -1; /* Read end of its stdout, -1 once it hit EOF */
+static int chooser_save = 0; /* Export (1) or import (0) */
+static char chooser_out[PATH_MAX];
+static size_t chooser_len = 0;
+
+/* Import from or export to the chosen path */
+static void apply_palette_path(int save, const char *path) {
+	if (save) {
+		export_palette(path, PALETTE_FORMAT_AUTO);
+	}
+	else {
+		import_palette(path, PALETTE_FORMAT_AUTO);
+	}
+}
+
+/* Used when neither zenity nor kdialog could be started */
+static void apply_fallback_palette_path(int save) {
+	char path[PATH_MAX];
+	const char *home = getenv("HOME");
+	if (!home) {
+		home = ".";
+	}
+	snprintf(path, sizeof(path), "%s/.config/pixelprism/palette.gpl", home);
+	fprintf(stderr, "No file chooser found (install zenity or kdialog), using %s\n", path);
+	if (save) {
+		state_ensure_dir();
+	}
+	apply_palette_path(save, path);
+}
+
+/* Start asking the desktop for a palette file name. The answer is applied
+ * by poll_palette_chooser() once the dialog closes; a cancelled dialog does
+ * nothing. */
+static void start_palette_chooser(int save) {
+	if (chooser_pid > 0) {
+		return; // A dialog is already open
+	}
+	int fds[2];
+	if (pipe(fds) != 0) {
+		perror("pipe");
+		return;
+	}
+	pid_t pid = fork();
+	if (pid == 0) {
+		// Child process: the dialog prints the chosen path on stdout
+		close(fds[0]);
+		dup2(fds[1], STDOUT_FILENO);
+		close(fds[1]);
+		if (!freopen("/dev/null", "w", stderr)) {
+			_exit(127);
+		}
+		if (save) {
+			execlp("zenity", "zenity", "--file-selection", "--save", "--confirm-overwrite", "--title=Export Palette", (char *)NULL);
+			execlp("kdialog", "kdialog", "--getsavefilename", ".", (char *)NULL);
+		}
+		else {
+			execlp("zenity", "zenity", "--file-selection", "--title=Import Palette", (char *)NULL);
+			execlp("kdialog", "kdialog", "--getopenfilename", ".", (char *)NULL);
+		}
+		_exit(127); // Neither chooser is installed
+	}
+	close(fds[1]);
+	if (pid < 0) {
+		perror("fork");
+		close(fds[0]);
+		return;
+	}
+	fcntl(fds[0], F_SETFD, FD_CLOEXEC); // Keep it out of editors and browsers started later
+	chooser_pid = pid;
+	chooser_fd = fds[0];
+	chooser_save = save;
+	chooser_len = 0;
+}
+
+/* Main loop hook: reads the chooser's output when readable is set, and
+ * reaps it and applies the chosen path once it has finished */
+static void poll_palette_chooser(int readable) {
+	if (chooser_fd >= 0 && readable) {
+		ssize_t n = read(chooser_fd, chooser_out + chooser_len, sizeof(chooser_out) - 1 - chooser_len);
+		if (n > 0) {
+			chooser_len += (size_t)n;
+			if (chooser_len < sizeof(chooser_out) - 1) {
+				return;
+			}
+		}
+		else if (n < 0 && errno == EINTR) {
+			return;
+		}
+		close(chooser_fd);
+		chooser_fd = -1;
+	}
+	if (chooser_fd >= 0 || chooser_pid <= 0) {
+		return;
+	}
+	int status = 0;
+	if (waitpid(chooser_pid, &status, WNOHANG) == 0) {
+		return; // Output closed but not exited yet; try again next iteration
+	}
+	chooser_pid = -1;
+	chooser_out[chooser_len] = '\0';
+	chooser_out[strcspn(chooser_out, "\n")] = '\0';
+	if (WIFEXITED(status) && WEXITSTATUS(status) == 127) {
+		apply_fallback_palette_path(chooser_save);
+	}
+	else if (chooser_out[0]) {
+		apply_palette_path(chooser_save, chooser_out);
+	}
+}
+
 /* --- Color Format Parsers --- */
 /* Parse and validate each format */
 static int parse_hsv(const char *text, double *h, double *s, double *v) {
@@ -1098,6 +1378,22 @@ static int parse_hex(const char *text, RGB8 *out) {
 }
 
 /* --- Color Conversion & Auto-Copy --- */
+/* Mirror the newest copy-history entries into the tray menu */
+static void sync_tray_recent(void) {
+	if (!tray_ctx || !clipboard_ctx) {
+		return;
+	}
+	RGB8 colors[TRAY_MAX_RECENT];
+	const char *labels[TRAY_MAX_RECENT];
+	int count = 0;
+	size_t available = clipboard_history_count(clipboard_ctx);
+	while (count < TRAY_MAX_RECENT && (size_t)count < available) {
+		labels[count] = clipboard_history_get(clipboard_ctx, (size_t)count, &colors[count]);
+		count++;
+	}
+	tray_set_recent_colors(tray_ctx, colors, labels, count);
+}
+
 /**
  * auto_copy_color - Auto-copy color to clipboard in configured format
  * @rgb8: RGB color in 8-bit format
@@ -1110,7 +1406,7 @@ static int parse_hex(const char *text, RGB8 *out) {
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wformat-nonliteral"
 static void auto_copy_color(RGB8 rgb8, RGBf rgbf, HSV hsv, HSL hsl) {
-	if (!current_theme.auto_copy || !clipboard_ctx) {
+	if (!current_theme.auto_copy || !clipboard_ctx || suppress_auto_copy) {
 		return;
 	}
 	char buf[256];
@@ -1119,28 +1415,29 @@ static void auto_copy_color(RGB8 rgb8, RGBf rgbf, HSV hsv, HSL hsl) {
 		format_hex(rgb8, buf, current_theme.hex_uppercase);
 		// Remove # prefix if disabled
 		if (!current_theme.hex_prefix && buf[0] == '#') {
-			clipboard_set_text(clipboard_ctx, main_window, buf + 1, SELECTION_CLIPBOARD);
+			clipboard_set_color(clipboard_ctx, main_window, buf + 1, rgb8, SELECTION_CLIPBOARD);
 		}
 		else {
-			clipboard_set_text(clipboard_ctx, main_window, buf, SELECTION_CLIPBOARD);
+			clipboard_set_color(clipboard_ctx, main_window, buf, rgb8, SELECTION_CLIPBOARD);
 		}
 	}
 	else if (strcmp(format, "hsv") == 0) {
 		snprintf(buf, sizeof(buf), FORMAT_HSV_HSL, hsv.H, hsv.S * 100.0, hsv.V * 100.0);
-		clipboard_set_text(clipboard_ctx, main_window, buf, SELECTION_CLIPBOARD);
+		clipboard_set_color(clipboard_ctx, main_window, buf, rgb8, SELECTION_CLIPBOARD);
 	}
 	else if (strcmp(format, "hsl") == 0) {
 		snprintf(buf, sizeof(buf), FORMAT_HSV_HSL, hsl.H, hsl.S * 100.0, hsl.L * 100.0);
-		clipboard_set_text(clipboard_ctx, main_window, buf, SELECTION_CLIPBOARD);
+		clipboard_set_color(clipboard_ctx, main_window, buf, rgb8, SELECTION_CLIPBOARD);
 	}
 	else if (strcmp(format, "rgb") == 0) {
 		snprintf(buf, sizeof(buf), FORMAT_RGBF, rgbf.r, rgbf.g, rgbf.b);
-		clipboard_set_text(clipboard_ctx, main_window, buf, SELECTION_CLIPBOARD);
+		clipboard_set_color(clipboard_ctx, main_window, buf, rgb8, SELECTION_CLIPBOARD);
 	}
 	else if (strcmp(format, "rgbi") == 0) {
 		snprintf(buf, sizeof(buf), FORMAT_RGBI, rgb8.r, rgb8.g, rgb8.b);
-		clipboard_set_text(clipboard_ctx, main_window, buf, SELECTION_CLIPBOARD);
+		clipboard_set_color(clipboard_ctx, main_window, buf, rgb8, SELECTION_CLIPBOARD);
 	}
+	sync_tray_recent();
 }
 
 #pragma GCC diagnostic pop
@@ -1153,6 +1450,8 @@ static void format_and_update_entries(RGB8 rgb8) {
 		return;
 	}
 	current_rgb8 = rgb8;
+	end_live_edit(); // A pick or command supersedes a pending preview
+	live_shown = 0; // Every widget is rewritten below
 	RGBf rgbf = rgb8_to_rgbf(rgb8);
 	current_rgbf = rgbf;
 	HSV hsv = rgb_to_hsv(rgbf);
@@ -1202,6 +1501,19 @@ static void format_and_update_entries(RGB8 rgb8) {
 
 #pragma GCC diagnostic pop
 
+/* Set an entry's text unless the user is typing in it */
+static void update_entry_text(MiniEntry *e, const char *text) {
+	if (e == live_source) {
+		return;
+	}
+	if (writing_preview) {
+		entry_set_text_no_undo(e, text);
+	}
+	else {
+		entry_set_text_no_draw(e, text);
+	}
+}
+
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wformat-nonliteral"
 static void format_and_update_entries_from_rgbf(RGBf rgbf) {
@@ -1210,6 +1522,7 @@ static void format_and_update_entries_from_rgbf(RGBf rgbf) {
 		return;
 	}
 	current_rgbf = rgbf;
+	live_shown = 0; // Every widget is rewritten below
 	// Mark config as changed when color is updated (but not during initialization)
 	if (!updating_from_callback) {
 		config_mark_changed(&current_theme);
@@ -1223,19 +1536,19 @@ static void format_and_update_entries_from_rgbf(RGBf rgbf) {
 
 	// Batch update all entries without drawing (preserves validation state)
 	snprintf(buf, sizeof(buf), FORMAT_HSV_HSL, hsv.H, hsv.S * 100.0, hsv.V * 100.0);
-	entry_set_text_no_draw(entry_hsv, buf);
+	update_entry_text(entry_hsv, buf);
 
 	snprintf(buf, sizeof(buf), FORMAT_HSV_HSL, hsl.H, hsl.S * 100.0, hsl.L * 100.0);
-	entry_set_text_no_draw(entry_hsl, buf);
+	update_entry_text(entry_hsl, buf);
 
 	snprintf(buf, sizeof(buf), FORMAT_RGBF, rgbf.r, rgbf.g, rgbf.b);
-	entry_set_text_no_draw(entry_rgbf, buf);
+	update_entry_text(entry_rgbf, buf);
 
 	snprintf(buf, sizeof(buf), FORMAT_RGBI, rgb8.r, rgb8.g, rgb8.b);
-	entry_set_text_no_draw(entry_rgbi, buf);
+	update_entry_text(entry_rgbi, buf);
 
 	format_hex(rgb8, buf, current_theme.hex_uppercase);
-	entry_set_text_no_draw(entry_hex, buf);
+	update_entry_text(entry_hex, buf);
 	
 	// Draw all entries once
 	entry_draw(entry_hsv);
@@ -1261,6 +1574,20 @@ static void format_and_update_entries_from_rgbf(RGBf rgbf) {
 
 /* --- Entry Focus Management --- */
 /* Explicitly unfocus all entries and trigger validation */
+/* Put copy-history entry index back on the clipboard exactly as it was
+ * copied, and make its colour current. */
+static void reown_history_entry(size_t index) {
+	RGB8 rgb8;
+	if (!clipboard_ctx || !clipboard_history_get(clipboard_ctx, index, &rgb8)) {
+		return;
+	}
+	clipboard_history_reown(clipboard_ctx, main_window, index, SELECTION_CLIPBOARD);
+	suppress_auto_copy = 1;
+	format_and_update_entries(rgb8);
+	suppress_auto_copy = 0;
+	sync_tray_recent();
+}
+
 static void unfocus_all_entries(void) {
 	MiniEntry *entries[] = {entry_hsv, entry_hsl, entry_rgbf, entry_rgbi, entry_hex};
 	for (int i = 0; i < 5; i++) {
@@ -1311,6 +1638,7 @@ static void entry_hsv_changed(MiniEntry *e, void *userdata) {
 	if (updating_from_callback) {
 		return;
 	}
+	end_live_edit();
 	const char *text = entry_get_text(e);
 	if (!text || !*text) {
 		validate_entry_flash_invalid_and_restore(e);
@@ -1333,7 +1661,10 @@ static void entry_hsv_changed(MiniEntry *e, void *userdata) {
 		format_and_update_entries_from_rgbf(rgbf);
 		updating_from_callback = 0;
 	}
-	// Valid but unchanged - no flash
+	else {
+		// Valid but unchanged - no flash; drop any preview of other text
+		revert_live_preview(e);
+	}
 }
 
 static void entry_hsl_changed(MiniEntry *e, void *userdata) {
@@ -1341,6 +1672,7 @@ static void entry_hsl_changed(MiniEntry *e, void *userdata) {
 	if (updating_from_callback) {
 		return;
 	}
+	end_live_edit();
 	const char *text = entry_get_text(e);
 	if (!text || !*text) {
 		validate_entry_flash_invalid_and_restore(e);
@@ -1363,7 +1695,10 @@ static void entry_hsl_changed(MiniEntry *e, void *userdata) {
 		format_and_update_entries_from_rgbf(rgbf);
 		updating_from_callback = 0;
 	}
-	// Valid but unchanged - no flash
+	else {
+		// Valid but unchanged - no flash; drop any preview of other text
+		revert_live_preview(e);
+	}
 }
 
 static void entry_rgbf_changed(MiniEntry *e, void *userdata) {
@@ -1371,6 +1706,7 @@ static void entry_rgbf_changed(MiniEntry *e, void *userdata) {
 	if (updating_from_callback) {
 		return;
 	}
+	end_live_edit();
 	const char *text = entry_get_text(e);
 	if (!text || !*text) {
 		validate_entry_flash_invalid_and_restore(e);
@@ -1396,7 +1732,10 @@ static void entry_rgbf_changed(MiniEntry *e, void *userdata) {
 		format_and_update_entries_from_rgbf(rgbf);
 		updating_from_callback = 0;
 	}
-	// Valid but unchanged - no flash
+	else {
+		// Valid but unchanged - no flash; drop any preview of other text
+		revert_live_preview(e);
+	}
 }
 
 static void entry_rgbi_changed(MiniEntry *e, void *userdata) {
@@ -1404,6 +1743,7 @@ static void entry_rgbi_changed(MiniEntry *e, void *userdata) {
 	if (updating_from_callback) {
 		return;
 	}
+	end_live_edit();
 	const char *text = entry_get_text(e);
 	if (!text || !*text) {
 		validate_entry_flash_invalid_and_restore(e);
@@ -1423,7 +1763,10 @@ static void entry_rgbi_changed(MiniEntry *e, void *userdata) {
 		format_and_update_entries(rgb8);
 		updating_from_callback = 0;
 	}
-	// Valid but unchanged - no flash
+	else {
+		// Valid but unchanged - no flash; drop any preview of other text
+		revert_live_preview(e);
+	}
 }
 
 static void entry_hex_changed(MiniEntry *e, void *userdata) {
@@ -1431,6 +1774,7 @@ static void entry_hex_changed(MiniEntry *e, void *userdata) {
 	if (updating_from_callback) {
 		return;
 	}
+	end_live_edit();
 	const char *text = entry_get_text(e);
 	if (!text || !*text) {
 		validate_entry_flash_invalid_and_restore(e);
@@ -1447,7 +1791,133 @@ static void entry_hex_changed(MiniEntry *e, void *userdata) {
 		format_and_update_entries(rgb8);
 		updating_from_callback = 0;
 	}
-	// Valid but unchanged - no flash
+	else {
+		// Valid but unchanged - no flash; drop any preview of other text
+		revert_live_preview(e);
+	}
+}
+
+/* --- Live Preview --- */
+/* Parse an entry's text the same way its change callback does. The parsers
+ * work on a stack copy of the text, so nothing is allocated per keystroke. */
+static int parse_entry_color(const MiniEntry *e, const char *text, RGBf *out) {
+	double a, b, c;
+	if (e == entry_hsv && parse_hsv(text, &a, &b, &c)) {
+		*out = hsv_to_rgb((HSV){a, b, c});
+		return 1;
+	}
+	if (e == entry_hsl && parse_hsl(text, &a, &b, &c)) {
+		*out = hsl_to_rgb((HSL){a, b, c});
+		return 1;
+	}
+	if (e == entry_rgbf && parse_rgbf(text, &a, &b, &c)) {
+		*out = (RGBf){a, b, c};
+		return 1;
+	}
+	int r, g, bl;
+	if (e == entry_rgbi && parse_rgbi(text, &r, &g, &bl)) {
+		*out = rgb8_to_rgbf((RGB8){(uint8_t)r, (uint8_t)g, (uint8_t)bl});
+		return 1;
+	}
+	RGB8 rgb8;
+	if (e == entry_hex) {
+		// hex_to_rgb8() accepts a short last channel; wait for all six digits
+		int digits = 0;
+		for (const char *p = text; *p; p++) {
+			digits += isxdigit((unsigned char)*p) ? 1 : 0;
+		}
+		if (digits == 6 && parse_hex(text, &rgb8)) {
+			*out = rgb8_to_rgbf(rgb8);
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/* on_edit callback shared by all entries: remember the newest valid color
+ * and (re)arm the debounce timer. Invalid partial input keeps the last
+ * preview on screen. */
+static void entry_live_edit(MiniEntry *e, void *userdata) {
+	(void)userdata;
+	RGBf rgbf;
+	if (updating_from_callback || !parse_entry_color(e, entry_get_text(e), &rgbf)) {
+		return;
+	}
+	live_source = e;
+	live_rgbf = rgbf;
+	live_deadline_ms = get_time_ms() + LIVE_PREVIEW_DELAY_MS;
+}
+
+/* Show the pending preview once per typing burst. The current color is left
+ * untouched so the change callback still commits (and auto-copies) it. */
+static void flush_live_preview(void) {
+	if (!live_deadline_ms || get_time_ms() < live_deadline_ms) {
+		return;
+	}
+	live_deadline_ms = 0;
+	if (rgbf_equal_eps(live_rgbf, current_rgbf, 1e-6)) {
+		revert_live_preview(live_source);
+		return;
+	}
+	RGB8 committed_rgb8 = current_rgb8;
+	RGBf committed_rgbf = current_rgbf;
+	updating_from_callback = 1;
+	suppress_auto_copy = 1;
+	writing_preview = 1;
+	format_and_update_entries_from_rgbf(live_rgbf);
+	writing_preview = 0;
+	suppress_auto_copy = 0;
+	updating_from_callback = 0;
+	current_rgb8 = committed_rgb8;
+	current_rgbf = committed_rgbf;
+	live_shown = 1;
+}
+
+/* Milliseconds until the pending preview is due, -1 if none */
+static long long live_preview_wait_ms(void) {
+	if (!live_deadline_ms) {
+		return -1;
+	}
+	long long wait = live_deadline_ms - get_time_ms();
+	return wait > 0 ? wait : 0;
+}
+
+/* The user committed the entry (Enter or focus loss): forget the pending
+ * preview so the change callback may rewrite every entry. A preview on
+ * screen is taken down first, so the undo steps the rewrite records start
+ * from the committed text rather than from preview text. */
+static void end_live_edit(void) {
+	if (live_shown) {
+		revert_live_preview(live_source);
+	}
+	live_deadline_ms = 0;
+	live_source = NULL;
+}
+
+/* Put the current color back on every widget showing a preview, except
+ * keep (the entry whose text is left as typed) */
+static void revert_live_preview(const MiniEntry *keep) {
+	live_deadline_ms = 0;
+	if (live_shown) {
+		live_shown = 0;
+		MiniEntry *entries[] = {entry_hsv, entry_hsl, entry_rgbf, entry_rgbi, entry_hex};
+		writing_preview = 1;
+		for (int i = 0; i < 5; i++) {
+			if (entries[i] != keep) {
+				refresh_entry_from_current(entries[i]);
+			}
+		}
+		writing_preview = 0;
+		XColor color = {0};
+		Colormap cmap = DefaultColormap(display, DefaultScreen(display));
+		color.red = (unsigned short)(current_rgb8.r * 257);
+		color.green = (unsigned short)(current_rgb8.g * 257);
+		color.blue = (unsigned short)(current_rgb8.b * 257);
+		color.flags = DoRed | DoGreen | DoBlue;
+		XAllocColor(display, cmap, &color);
+		swatch_set_color(swatch_ctx, color.pixel);
+	}
+	live_source = NULL;
 }
 
 /* --- Color Picker Event Handlers --- */
@@ -1470,8 +1940,13 @@ static void convert_pixel_color(void) {
 	format_and_update_entries(rgb8);
 	updating_from_callback = 0;
 
+	// Record the pick at the front of the history strip
+	palette_push_color(palette_ctx, rgb8);
+
 	Window swatch_win = swatch_get_window(swatch_ctx);
-	XClearWindow(display, swatch_win);
+	if (swatch_win != None) {
+		XClearWindow(display, swatch_win);
+	}
 
 	// Save zoom image when color is picked
 	const char *home = getenv("HOME");
@@ -1483,11 +1958,354 @@ static void convert_pixel_color(void) {
 	zoom_save_image(zoom_ctx, zoom_path);
 }
 
+/* --- Screen Capture --- */
+
+/* A root window area as 32-bit pixels with 8-bit channels */
+typedef struct {
+	XImage *image;
+	uint32_t *packed;  // Repacked copy when the image cannot be read in place
+	const uint32_t *pixels;
+	int width, height, stride;
+	int red_shift, green_shift, blue_shift;
+} ScreenCapture;
+
+/* Shift of a channel mask, and whether the channel is exactly 8 bits wide */
+static int channel_shift(unsigned long mask, int *is_byte) {
+	int shift = 0;
+	while (mask && !(mask & 1)) {
+		mask >>= 1;
+		shift++;
+	}
+	*is_byte = mask == 0xFF;
+	return shift;
+}
+
+/* Scale a channel of any width to 0..255 */
+static uint32_t channel_byte(unsigned long pixel, unsigned long mask, int shift) {
+	unsigned long max = mask >> shift;
+	return max ? (uint32_t)(((pixel & mask) >> shift) * 255 / max) : 0;
+}
+
+static void release_screen_capture(ScreenCapture *cap) {
+	free(cap->packed);
+	if (cap->image) {
+		XDestroyImage(cap->image);
+	}
+	memset(cap, 0, sizeof(*cap));
+}
+
+/* Read the whole default colormap in one round trip, as 0x00RRGGBB
+ * indexed by pixel value. Returns the entry count, 0 on failure. */
+static int fetch_colormap(uint32_t **table) {
+	Visual *visual = DefaultVisual(display, DefaultScreen(display));
+	int n = visual->map_entries;
+	if (n <= 0 || n > 4096) {
+		return 0;
+	}
+	XColor *cells = malloc((size_t)n * sizeof(XColor));
+	*table = malloc((size_t)n * sizeof(uint32_t));
+	if (!cells || !*table) {
+		free(cells);
+		free(*table);
+		*table = NULL;
+		return 0;
+	}
+	for (int i = 0; i < n; i++) {
+		cells[i].pixel = (unsigned long)i;
+	}
+	XQueryColors(display, DefaultColormap(display, DefaultScreen(display)), cells, n);
+	for (int i = 0; i < n; i++) {
+		(*table)[i] = (uint32_t)(cells[i].red >> 8) << 16 | (uint32_t)(cells[i].green >> 8) << 8 | (uint32_t)(cells[i].blue >> 8);
+	}
+	free(cells);
+	return n;
+}
+
+/* Capture an area of the root window with one XGetImage.
+ * 32bpp images in host byte order are read in place; anything else is
+ * repacked to 0x00RRGGBB, through the channel masks or, on colormapped
+ * visuals, through one snapshot of the colormap. Returns 0 on success,
+ * -1 on failure. */
+static int capture_screen_area(int x, int y, int w, int h, ScreenCapture *cap) {
+	memset(cap, 0, sizeof(*cap));
+	cap->image = XGetImage(display, RootWindow(display, DefaultScreen(display)), x, y, (unsigned int)w, (unsigned int)h, AllPlanes, ZPixmap);
+	if (!cap->image) {
+		fprintf(stderr, "Failed to capture screen area %dx%d+%d+%d\n", w, h, x, y);
+		return -1;
+	}
+	XImage *img = cap->image;
+	const int host_order = (*(const unsigned char *)&(uint16_t){1}) ? LSBFirst : MSBFirst;
+	int r_byte, g_byte, b_byte;
+	int rs = channel_shift(img->red_mask, &r_byte);
+	int gs = channel_shift(img->green_mask, &g_byte);
+	int bs = channel_shift(img->blue_mask, &b_byte);
+	cap->width = w;
+	cap->height = h;
+	if (img->bits_per_pixel == 32 && img->byte_order == host_order && r_byte && g_byte && b_byte) {
+		cap->pixels = (const uint32_t *)img->data;
+		cap->stride = img->bytes_per_line / 4;
+		cap->red_shift = rs;
+		cap->green_shift = gs;
+		cap->blue_shift = bs;
+		return 0;
+	}
+	cap->packed = malloc((size_t)w * (size_t)h * sizeof(uint32_t));
+	if (!cap->packed) {
+		release_screen_capture(cap);
+		return -1;
+	}
+	uint32_t *cmap = NULL;
+	int cmap_size = 0;
+	if (!img->red_mask || !img->green_mask || !img->blue_mask) {
+		cmap_size = fetch_colormap(&cmap);
+	}
+	for (int py = 0; py < h; py++) {
+		for (int px = 0; px < w; px++) {
+			unsigned long pixel = XGetPixel(img, px, py);
+			uint32_t rgb;
+			if (cmap) {
+				rgb = pixel < (unsigned long)cmap_size ? cmap[pixel] : 0;
+			}
+			else {
+				rgb = channel_byte(pixel, img->red_mask, rs) << 16 | channel_byte(pixel, img->green_mask, gs) << 8 | channel_byte(pixel, img->blue_mask, bs);
+			}
+			cap->packed[(size_t)py * (size_t)w + (size_t)px] = rgb;
+		}
+	}
+	free(cmap);
+	cap->pixels = cap->packed;
+	cap->stride = w;
+	cap->red_shift = 16;
+	cap->green_shift = 8;
+	cap->blue_shift = 0;
+	return 0;
+}
+
+/* Run a job on the worker pool, or inline when it cannot be queued */
+static void run_in_background(WorkFunc work, WorkDoneFunc done, void *arg) {
+	if (workpool_submit(work_pool, work, done, arg) != 0) {
+		work(arg);
+		done(arg);
+	}
+}
+
+/* --- Dominant Colors --- */
+
+/* Send the same reply to a list of control clients */
+static void reply_to_clients(const ControlReplyTo *clients, size_t count, int ok, const char *message) {
+	for (size_t i = 0; i < count; i++) {
+		control_reply_later(control_server, clients[i], ok, message);
+	}
+}
+
+/* A captured region on its way through the worker pool */
+typedef struct {
+	ScreenCapture cap;
+	int max_colors;
+	int count;
+	QuantizeColor colors[QUANTIZE_MAX_COLORS];
+	ControlReplyTo *waiters; // "pick" clients answered with the dominant color
+	size_t waiter_count;
+} RegionColorsJob;
+
+static void region_colors_work(void *arg) {
+	RegionColorsJob *job = arg;
+	QuantizeFormat fmt = {job->cap.red_shift, job->cap.green_shift, job->cap.blue_shift};
+	job->count = quantize_dominant(work_pool, job->cap.pixels, job->cap.width, job->cap.height, job->cap.stride, &fmt, job->max_colors, job->colors);
+}
+
+static void region_colors_done(void *arg) {
+	RegionColorsJob *job = arg;
+	release_screen_capture(&job->cap);
+	if (job->count <= 0) {
+		fprintf(stderr, "Dominant color extraction failed\n");
+		reply_to_clients(job->waiters, job->waiter_count, 0, "dominant color extraction failed");
+		free(job->waiters);
+		free(job);
+		return;
+	}
+
+	// Push least common first so the dominant color ends up in front
+	for (int i = job->count - 1; i >= 0; i--) {
+		palette_push_color(palette_ctx, job->colors[i].color);
+	}
+	updating_from_callback = 1;
+	format_and_update_entries(job->colors[0].color);
+	updating_from_callback = 0;
+	char hex[8];
+	format_hex(job->colors[0].color, hex, current_theme.hex_uppercase);
+	reply_to_clients(job->waiters, job->waiter_count, 1, hex);
+	free(job->waiters);
+	free(job);
+}
+
+/* Capture a screen region and push its dominant colors onto the history
+ * strip, most common color first. The capture happens here; clustering
+ * runs on the worker pool. */
+static void extract_region_colors(void) {
+	int x, y, w, h;
+	if (zoom_get_region_ctx(zoom_ctx, &x, &y, &w, &h) != 0) {
+		return;
+	}
+	RegionColorsJob *job = calloc(1, sizeof(RegionColorsJob));
+	if (!job) {
+		return;
+	}
+	if (capture_screen_area(x, y, w, h, &job->cap) != 0) {
+		free(job);
+		return;
+	}
+	job->max_colors = current_theme.zoom_widget.region_colors;
+	// The pick is over; its clients wait for the job instead, so a new
+	// pick can start before the job finishes
+	job->waiters = pick_waiters;
+	job->waiter_count = pick_waiter_count;
+	pick_waiters = NULL;
+	pick_waiter_count = 0;
+	pick_waiter_cap = 0;
+	run_in_background(region_colors_work, region_colors_done, job);
+}
+
 /* css_to_pixel is now a wrapper for config_color_to_pixel */
 static unsigned long css_to_pixel(ConfigColor c) {
 	return config_color_to_pixel(display, DefaultScreen(display), c);
 }
 
+/* --- Color Search --- */
+#define FIND_MAX_BOXES 256
+
+static HighlightOverlay *find_overlay = NULL; /* Outlines around search matches */
+
+/* A screen search on its way through the worker pool */
+typedef struct {
+	ScreenCapture cap;
+	RGB8 target;
+	double tolerance;
+	int own_x, own_y, own_w, own_h; /* Main window at capture time */
+	int count;                       /* Boxes kept, -1 on failure */
+	unsigned long matches;
+	ColorFindBox boxes[FIND_MAX_BOXES];
+	int has_client;                  /* Reply to a control client when done */
+	ControlReplyTo client;
+} FindJob;
+
+/* Scan the capture and drop the boxes inside PixelPrism's own window (the
+ * swatch, the strip), which always match */
+static void find_work(void *arg) {
+	FindJob *job = arg;
+	ColorFindFormat fmt = {job->cap.red_shift, job->cap.green_shift, job->cap.blue_shift};
+	int n = colorfind_scan(work_pool, job->cap.pixels, job->cap.width, job->cap.height, job->cap.stride, &fmt, job->target, job->tolerance, job->boxes, FIND_MAX_BOXES, &job->matches);
+	job->count = n < 0 ? -1 : 0;
+	for (int i = 0; i < n; i++) {
+		const ColorFindBox *b = &job->boxes[i];
+		if (b->x >= job->own_x && b->y >= job->own_y && b->x + b->width <= job->own_x + job->own_w && b->y + b->height <= job->own_y + job->own_h) {
+			job->matches -= b->matches;
+			continue;
+		}
+		job->boxes[job->count++] = *b;
+	}
+}
+
+static void find_done(void *arg) {
+	FindJob *job = arg;
+	release_screen_capture(&job->cap);
+	char buf[64];
+	if (job->count < 0) {
+		snprintf(buf, sizeof(buf), "color search failed");
+	}
+	else {
+		XRectangle rects[FIND_MAX_BOXES];
+		for (int i = 0; i < job->count; i++) {
+			const ColorFindBox *b = &job->boxes[i];
+			rects[i] = (XRectangle){(short)b->x, (short)b->y, (unsigned short)b->width, (unsigned short)b->height};
+		}
+		highlight_show(find_overlay, rects, job->count, css_to_pixel(current_theme.square_color), 2, current_theme.find_highlight_ms);
+		snprintf(buf, sizeof(buf), "matches=%lu regions=%d", job->matches, job->count);
+	}
+	if (job->has_client) {
+		control_reply_later(control_server, job->client, job->count >= 0, buf);
+	}
+	free(job);
+}
+
+/* Search the whole screen for the current color and outline the matches.
+ * tolerance is in ΔEOK. The screen is captured here and scanned on the
+ * worker pool; when client_id is given, that control client gets
+ * "matches=N regions=M" once the outlines are up. Returns 0 if the search
+ * started, -1 if the capture failed. */
+static int find_color_on_screen(double tolerance, const unsigned int *client_id) {
+	// The previous outlines must not end up in the capture
+	highlight_hide(find_overlay);
+	XSync(display, False);
+
+	FindJob *job = calloc(1, sizeof(FindJob));
+	if (!job) {
+		return -1;
+	}
+	Screen *scr = DefaultScreenOfDisplay(display);
+	if (capture_screen_area(0, 0, WidthOfScreen(scr), HeightOfScreen(scr), &job->cap) != 0) {
+		free(job);
+		return -1;
+	}
+	job->target = current_rgb8;
+	job->tolerance = tolerance;
+	if (client_id) {
+		job->has_client = 1;
+		job->client = control_reply_to(control_server, *client_id);
+	}
+
+	// Own window in root coordinates, if it is on screen
+	XWindowAttributes attrs;
+	Window child;
+	if (XGetWindowAttributes(display, main_window, &attrs) && attrs.map_state == IsViewable &&
+	    XTranslateCoordinates(display, main_window, RootWindowOfScreen(scr), 0, 0, &job->own_x, &job->own_y, &child)) {
+		job->own_w = attrs.width;
+		job->own_h = attrs.height;
+	}
+	run_in_background(find_work, find_done, job);
+	return 0;
+}
+
+/* --- Region Statistics --- */
+static RegionStatsContext *region_stats = NULL; /* Reused distinct-color bitmap */
+static StatsPanel *stats_panel = NULL;          /* Statistics of the Shift+dragged region */
+static ScreenCapture stats_frame;               /* Screen as it was when the drag started */
+static int stats_frame_valid = 0;
+
+/* Capture the whole screen once when a statistics drag starts. Every
+ * rectangle of the drag is measured from this frame, so neither the rubber
+ * band nor the panel itself ends up in the numbers. */
+static void begin_region_stats(void) {
+	if (stats_frame_valid) {
+		return;
+	}
+	highlight_hide(find_overlay);
+	XSync(display, False);
+	Screen *scr = DefaultScreenOfDisplay(display);
+	stats_frame_valid = capture_screen_area(0, 0, WidthOfScreen(scr), HeightOfScreen(scr), &stats_frame) == 0;
+}
+
+/* Measure the latest drag rectangle, at most once per main loop iteration,
+ * and drop the frame once the drag is over */
+static void update_region_stats(void) {
+	if (!stats_frame_valid) {
+		return;
+	}
+	int x, y, w, h;
+	if (zoom_get_stats_region_ctx(zoom_ctx, &x, &y, &w, &h) == 0 && x + w <= stats_frame.width && y + h <= stats_frame.height) {
+		RegionStatsFormat fmt = {stats_frame.red_shift, stats_frame.green_shift, stats_frame.blue_shift};
+		RegionStats stats;
+		const uint32_t *origin = stats_frame.pixels + (size_t)y * (size_t)stats_frame.stride + (size_t)x;
+		if (region_stats_compute(region_stats, origin, w, h, stats_frame.stride, &fmt, &stats) == 0) {
+			statspanel_update(stats_panel, &stats, x, y, w, h);
+		}
+	}
+	if (!zoom_stats_dragging_ctx(zoom_ctx)) {
+		release_screen_capture(&stats_frame);
+		stats_frame_valid = 0;
+	}
+}
+
 /* --- Window Visibility Management --- */
 /**
  * hide_main_window - Hide main window (minimize to tray)
@@ -1527,8 +2345,9 @@ static void init_entries(const MiniTheme *theme) {
 	cfg.border_radius = theme->entry_positions.entry_hsv_border_radius;
 	cfg.max_length = theme->max_length.text;
 	cfg.on_change = entry_hsv_changed;
+	cfg.on_edit = entry_live_edit;
 	cfg.user_data = NULL;
-	entry_hsv = entry_create(display, DefaultScreen(display), main_window, theme, &cfg, clipboard_ctx);
+	entry_hsv = entry_create(display, DefaultScreen(display), main_window, theme, &cfg, clipboard_ctx, compositor);
 	
 	// HSL Entry
 	cfg.x_pos = theme->entry_positions.entry_hsl_x;
@@ -1538,7 +2357,7 @@ static void init_entries(const MiniTheme *theme) {
 	cfg.border_width = theme->entry_positions.entry_hsl_border_width;
 	cfg.border_radius = theme->entry_positions.entry_hsl_border_radius;
 	cfg.on_change = entry_hsl_changed;
-	entry_hsl = entry_create(display, DefaultScreen(display), main_window, theme, &cfg, clipboard_ctx);
+	entry_hsl = entry_create(display, DefaultScreen(display), main_window, theme, &cfg, clipboard_ctx, compositor);
 	
 	// RGB Float Entry
 	cfg.kind = ENTRY_FLOAT;
@@ -1550,7 +2369,7 @@ static void init_entries(const MiniTheme *theme) {
 	cfg.border_radius = theme->entry_positions.entry_rgbf_border_radius;
 	cfg.max_length = theme->max_length.floating;
 	cfg.on_change = entry_rgbf_changed;
-	entry_rgbf = entry_create(display, DefaultScreen(display), main_window, theme, &cfg, clipboard_ctx);
+	entry_rgbf = entry_create(display, DefaultScreen(display), main_window, theme, &cfg, clipboard_ctx, compositor);
 	
 	// RGB Integer Entry
 	cfg.kind = ENTRY_INT;
@@ -1562,7 +2381,7 @@ static void init_entries(const MiniTheme *theme) {
 	cfg.border_radius = theme->entry_positions.entry_rgbi_border_radius;
 	cfg.max_length = theme->max_length.integer;
 	cfg.on_change = entry_rgbi_changed;
-	entry_rgbi = entry_create(display, DefaultScreen(display), main_window, theme, &cfg, clipboard_ctx);
+	entry_rgbi = entry_create(display, DefaultScreen(display), main_window, theme, &cfg, clipboard_ctx, compositor);
 	
 	// Hex Entry
 	cfg.kind = ENTRY_HEX;
@@ -1574,7 +2393,7 @@ static void init_entries(const MiniTheme *theme) {
 	cfg.border_radius = theme->entry_positions.entry_hex_border_radius;
 	cfg.max_length = theme->max_length.hex;
 	cfg.on_change = entry_hex_changed;
-	entry_hex = entry_create(display, DefaultScreen(display), main_window, theme, &cfg, clipboard_ctx);
+	entry_hex = entry_create(display, DefaultScreen(display), main_window, theme, &cfg, clipboard_ctx, compositor);
 }
 
 static void init_labels(const MiniTheme *theme) {
@@ -1595,45 +2414,193 @@ static void init_labels(const MiniTheme *theme) {
 	label_theme.border_b = theme->label.border.b;
 	label_theme.border_a = theme->label.border.a;
 	
-	label_hsv = label_create(display, DefaultScreen(display), main_window, theme->label_positions.label_hsv_x, theme->label_positions.label_hsv_y, theme->label_positions.label_hsv_width, theme->label_positions.label_hsv_padding, theme->label_positions.label_hsv_border_width, theme->label_positions.label_hsv_border_radius, theme->label_positions.label_hsv_border_enabled, "HSV", &label_theme);
-	label_hsl = label_create(display, DefaultScreen(display), main_window, theme->label_positions.label_hsl_x, theme->label_positions.label_hsl_y, theme->label_positions.label_hsl_width, theme->label_positions.label_hsl_padding, theme->label_positions.label_hsl_border_width, theme->label_positions.label_hsl_border_radius, theme->label_positions.label_hsl_border_enabled, "HSL", &label_theme);
-	label_rgbf = label_create(display, DefaultScreen(display), main_window, theme->label_positions.label_rgbf_x, theme->label_positions.label_rgbf_y, theme->label_positions.label_rgbf_width, theme->label_positions.label_rgbf_padding, theme->label_positions.label_rgbf_border_width, theme->label_positions.label_rgbf_border_radius, theme->label_positions.label_rgbf_border_enabled, "0-1", &label_theme);
-	label_rgbi = label_create(display, DefaultScreen(display), main_window, theme->label_positions.label_rgbi_x, theme->label_positions.label_rgbi_y, theme->label_positions.label_rgbi_width, theme->label_positions.label_rgbi_padding, theme->label_positions.label_rgbi_border_width, theme->label_positions.label_rgbi_border_radius, theme->label_positions.label_rgbi_border_enabled, "0-255", &label_theme);
-	label_hex = label_create(display, DefaultScreen(display), main_window, theme->label_positions.label_hex_x, theme->label_positions.label_hex_y, theme->label_positions.label_hex_width, theme->label_positions.label_hex_padding, theme->label_positions.label_hex_border_width, theme->label_positions.label_hex_border_radius, theme->label_positions.label_hex_border_enabled, "Hex", &label_theme);
+	label_hsv = label_create(display, DefaultScreen(display), main_window, theme->label_positions.label_hsv_x, theme->label_positions.label_hsv_y, theme->label_positions.label_hsv_width, theme->label_positions.label_hsv_padding, theme->label_positions.label_hsv_border_width, theme->label_positions.label_hsv_border_radius, theme->label_positions.label_hsv_border_enabled, "HSV", &label_theme, compositor);
+	label_hsl = label_create(display, DefaultScreen(display), main_window, theme->label_positions.label_hsl_x, theme->label_positions.label_hsl_y, theme->label_positions.label_hsl_width, theme->label_positions.label_hsl_padding, theme->label_positions.label_hsl_border_width, theme->label_positions.label_hsl_border_radius, theme->label_positions.label_hsl_border_enabled, "HSL", &label_theme, compositor);
+	label_rgbf = label_create(display, DefaultScreen(display), main_window, theme->label_positions.label_rgbf_x, theme->label_positions.label_rgbf_y, theme->label_positions.label_rgbf_width, theme->label_positions.label_rgbf_padding, theme->label_positions.label_rgbf_border_width, theme->label_positions.label_rgbf_border_radius, theme->label_positions.label_rgbf_border_enabled, "0-1", &label_theme, compositor);
+	label_rgbi = label_create(display, DefaultScreen(display), main_window, theme->label_positions.label_rgbi_x, theme->label_positions.label_rgbi_y, theme->label_positions.label_rgbi_width, theme->label_positions.label_rgbi_padding, theme->label_positions.label_rgbi_border_width, theme->label_positions.label_rgbi_border_radius, theme->label_positions.label_rgbi_border_enabled, "0-255", &label_theme, compositor);
+	label_hex = label_create(display, DefaultScreen(display), main_window, theme->label_positions.label_hex_x, theme->label_positions.label_hex_y, theme->label_positions.label_hex_width, theme->label_positions.label_hex_padding, theme->label_positions.label_hex_border_width, theme->label_positions.label_hex_border_radius, theme->label_positions.label_hex_border_enabled, "Hex", &label_theme, compositor);
 }
 
 static void init_ui_widgets(const MiniTheme *theme) {
 	// Create swatch
-	swatch_ctx = swatch_create(display, main_window, theme->swatch_widget.width, theme->swatch_widget.height);
+	swatch_ctx = swatch_create(display, main_window, theme->swatch_widget.width, theme->swatch_widget.height, compositor);
 	swatch_set_position(swatch_ctx, theme->swatch_widget.swatch_x, theme->swatch_widget.swatch_y);
 	swatch_set_background(swatch_ctx, css_to_pixel(theme->main.background));
 	swatch_set_border(swatch_ctx, theme->swatch_widget.border_width, theme->swatch_widget.border_radius);
 	
+	// Create palette strip and restore pick history
+	palette_ctx = palette_create(display, main_window, theme->palette_widget.palette_x, theme->palette_widget.palette_y, theme->palette_widget.width, theme->palette_widget.height);
+	if (palette_ctx) {
+		palette_set_max_colors(palette_ctx, theme->palette_widget.max_colors > 0 ? (size_t)theme->palette_widget.max_colors : 0);
+		palette_set_cell_style(palette_ctx, theme->palette_widget.padding, theme->palette_widget.cell_size, theme->palette_widget.cell_spacing, theme->palette_widget.cell_radius, theme->palette_widget.border_width, theme->palette_widget.border_radius);
+		palette_set_theme(palette_ctx, css_to_pixel(theme->palette.bg), css_to_pixel(theme->palette.border), css_to_pixel(theme->palette.hover_border));
+		RGB8 *history = NULL;
+		size_t history_count = 0;
+		if (state_load_history(&history, &history_count) == 0) {
+			palette_append_colors(palette_ctx, history, history_count);
+			free(history);
+		}
+		if (pending_import_path) {
+			import_palette(pending_import_path, cli_palette_format);
+			pending_import_path = NULL;
+		}
+	}
+	
 	// Create button
-	button_ctx = button_create(display, main_window, &theme->button, theme->button_widget.width, theme->button_widget.height, theme->button_widget.padding, theme->button_widget.border_width, theme->button_widget.hover_border_width, theme->button_widget.active_border_width, theme->button_widget.border_radius);
+	button_ctx = button_create(display, main_window, &theme->button, theme->button_widget.width, theme->button_widget.height, theme->button_widget.padding, theme->button_widget.border_width, theme->button_widget.hover_border_width, theme->button_widget.active_border_width, theme->button_widget.border_radius, compositor);
 	button_set_position(button_ctx, theme->button_widget.button_x, theme->button_widget.button_y);
 	button_set_label(button_ctx, "Pick Color");
 	
 	// Create menubar
 	MenuConfig menu_config = {
-		.file_items = { "Exit" },
-		.edit_items = { "Configuration", "Reset" },
+		.file_items = { "Import Palette...", "Export Palette...", "Exit" },
+		.edit_items = { "Configuration", "Reset", "Find Color" },
 		.about_items = { "PixelPrism" },
-		.file_count = 1,
-		.edit_count = 2,
+		.file_count = 3,
+		.edit_count = 3,
 		.about_count = 1
 	};
-	menubar = menubar_create_with_config(display, main_window, &theme->menubar, theme->menubar_widget.menubar_x, theme->menubar_widget.menubar_y, theme->menubar_widget.width, theme->menubar_widget.border_width, theme->menubar_widget.border_radius, theme->menubar_widget.padding, &menu_config);
+	menubar = menubar_create_with_config(display, main_window, &theme->menubar, theme->menubar_widget.menubar_x, theme->menubar_widget.menubar_y, theme->menubar_widget.width, theme->menubar_widget.border_width, theme->menubar_widget.border_radius, theme->menubar_widget.padding, &menu_config, compositor);
 	menubar_draw(menubar);
 	
 	// Create about window
 	about_win = about_create(display, main_window, theme);
+
+	// Create region statistics panel
+	region_stats = region_stats_create(work_pool);
+	stats_panel = statspanel_create(display, main_window, theme);
+}
+
+/* Create the main window's compositor; init_all_widgets() then makes the
+ * entries, labels, button, swatch and menubar nodes of it instead of windows */
+static void init_compositor(const MiniTheme *theme) {
+	compositor = compositor_create(display, DefaultScreen(display), main_window, css_to_pixel(theme->main.background));
+	if (!compositor) {
+		fprintf(stderr, "Warning: Could not create compositor, using widget windows\n");
+	}
+}
+
+/* --- Widget Layout --- */
+
+/* Label/entry rows: HSV, HSL, RGB float, RGB int, hex */
+#define FORMAT_ROWS 5
+
+/* Widgets placed by apply_layout() */
+enum {
+	SLOT_LABEL = 0,
+	SLOT_ENTRY = SLOT_LABEL + FORMAT_ROWS,
+	SLOT_SWATCH = SLOT_ENTRY + FORMAT_ROWS,
+	SLOT_PALETTE,
+	SLOT_BUTTON,
+	SLOT_MENUBAR,
+	SLOT_COUNT
+};
+
+static LayoutRect widget_geometry[SLOT_COUNT]; /* Geometry last applied to each slot */
+static int widget_geometry_valid = 0;
+
+/* Add a widget's item; without a parent it is pinned at its configured spot */
+static int add_slot(Layout *layout, int parent, int x, int y, int width, int height) {
+	int node = layout_add_item(layout, parent, width, height);
+	if (parent < 0) {
+		layout_pin(layout, node, x, y);
+	}
+	return node;
+}
+
+/* Compute every widget rectangle from the config in one pass */
+static void compute_layout(const MiniTheme *theme, LayoutRect out[SLOT_COUNT]) {
+	LabelContext *labels[FORMAT_ROWS] = {label_hsv, label_hsl, label_rgbf, label_rgbi, label_hex};
+	MiniEntry *entries[FORMAT_ROWS] = {entry_hsv, entry_hsl, entry_rgbf, entry_rgbi, entry_hex};
+	const int label_pos[FORMAT_ROWS][3] = {
+		{theme->label_positions.label_hsv_x, theme->label_positions.label_hsv_y, theme->label_positions.label_hsv_width},
+		{theme->label_positions.label_hsl_x, theme->label_positions.label_hsl_y, theme->label_positions.label_hsl_width},
+		{theme->label_positions.label_rgbf_x, theme->label_positions.label_rgbf_y, theme->label_positions.label_rgbf_width},
+		{theme->label_positions.label_rgbi_x, theme->label_positions.label_rgbi_y, theme->label_positions.label_rgbi_width},
+		{theme->label_positions.label_hex_x, theme->label_positions.label_hex_y, theme->label_positions.label_hex_width},
+	};
+	const int entry_pos[FORMAT_ROWS][3] = {
+		{theme->entry_positions.entry_hsv_x, theme->entry_positions.entry_hsv_y, theme->entry_positions.entry_hsv_width},
+		{theme->entry_positions.entry_hsl_x, theme->entry_positions.entry_hsl_y, theme->entry_positions.entry_hsl_width},
+		{theme->entry_positions.entry_rgbf_x, theme->entry_positions.entry_rgbf_y, theme->entry_positions.entry_rgbf_width},
+		{theme->entry_positions.entry_rgbi_x, theme->entry_positions.entry_rgbi_y, theme->entry_positions.entry_rgbi_width},
+		{theme->entry_positions.entry_hex_x, theme->entry_positions.entry_hex_y, theme->entry_positions.entry_hex_width},
+	};
+	int autolayout = theme->widget_layout.mode == LAYOUT_MODE_AUTO;
+	int node[SLOT_COUNT];
+	Layout layout;
+	layout_init(&layout);
+
+	// Auto: a column of label/entry rows followed by the tool row
+	int form = -1;
+	if (autolayout) {
+		form = layout_add_box(&layout, -1, LAYOUT_COLUMN, theme->widget_layout.row_spacing, LAYOUT_ALIGN_START);
+		layout_pin(&layout, form, theme->widget_layout.origin_x, theme->widget_layout.origin_y);
+	}
+	for (int i = 0; i < FORMAT_ROWS; i++) {
+		int w, label_h, entry_h;
+		label_get_size(labels[i], &w, &label_h);
+		entry_get_size(entries[i], &w, &entry_h);
+		int row = autolayout ? layout_add_box(&layout, form, LAYOUT_ROW, theme->widget_layout.column_spacing, theme->widget_layout.row_align) : -1;
+		node[SLOT_LABEL + i] = add_slot(&layout, row, label_pos[i][0], label_pos[i][1], label_pos[i][2], label_h);
+		node[SLOT_ENTRY + i] = add_slot(&layout, row, entry_pos[i][0], entry_pos[i][1], entry_pos[i][2], entry_h);
+	}
+	int tools = autolayout ? layout_add_box(&layout, form, LAYOUT_ROW, theme->widget_layout.tool_spacing, theme->widget_layout.tool_align) : -1;
+	node[SLOT_SWATCH] = add_slot(&layout, tools, theme->swatch_widget.swatch_x, theme->swatch_widget.swatch_y, theme->swatch_widget.width, theme->swatch_widget.height);
+	node[SLOT_PALETTE] = add_slot(&layout, tools, theme->palette_widget.palette_x, theme->palette_widget.palette_y, theme->palette_widget.width, theme->palette_widget.height);
+	node[SLOT_BUTTON] = add_slot(&layout, tools, theme->button_widget.button_x, theme->button_widget.button_y, theme->button_widget.width, theme->button_widget.height);
+
+	// The menubar is window chrome and always stays where it is configured
+	node[SLOT_MENUBAR] = add_slot(&layout, -1, theme->menubar_widget.menubar_x, theme->menubar_widget.menubar_y, theme->menubar_widget.width, 0);
+
+	layout_compute(&layout, 0, 0);
+	for (int i = 0; i < SLOT_COUNT; i++) {
+		out[i] = layout_get_rect(&layout, node[i]);
+	}
+}
+
+/* Move and resize the widgets whose rectangle changed since the last call.
+ * Each widget sends at most one ConfigureWindow; nothing is flushed here. */
+static void apply_layout(const MiniTheme *theme) {
+	LabelContext *labels[FORMAT_ROWS] = {label_hsv, label_hsl, label_rgbf, label_rgbi, label_hex};
+	MiniEntry *entries[FORMAT_ROWS] = {entry_hsv, entry_hsl, entry_rgbf, entry_rgbi, entry_hex};
+	LayoutRect rects[SLOT_COUNT];
+	compute_layout(theme, rects);
+	for (int i = 0; i < SLOT_COUNT; i++) {
+		const LayoutRect *r = &rects[i];
+		if (widget_geometry_valid && memcmp(r, &widget_geometry[i], sizeof(*r)) == 0) {
+			continue;
+		}
+		widget_geometry[i] = *r;
+		if (i < SLOT_ENTRY) {
+			label_set_bounds(labels[i - SLOT_LABEL], r->x, r->y, r->width);
+		}
+		else if (i < SLOT_SWATCH) {
+			if (entries[i - SLOT_ENTRY]) {
+				entry_set_bounds_noflush(entries[i - SLOT_ENTRY], r->x, r->y, r->width, 0);
+			}
+		}
+		else if (i == SLOT_SWATCH) {
+			swatch_set_bounds(swatch_ctx, r->x, r->y, r->width, r->height);
+		}
+		else if (i == SLOT_PALETTE) {
+			palette_set_geometry(palette_ctx, r->x, r->y, r->width, r->height);
+		}
+		else if (i == SLOT_BUTTON) {
+			button_set_position(button_ctx, r->x, r->y);
+		}
+		else {
+			menubar_set_position(menubar, r->x, r->y);
+		}
+	}
+	widget_geometry_valid = 1;
 }
 
 static void init_all_widgets(const MiniTheme *theme) {
 	init_ui_widgets(theme);
 	init_entries(theme);
 	init_labels(theme);
+	apply_layout(theme);
 }
 
 static void setup_config_watching(void) {
@@ -1709,6 +2676,9 @@ static void apply_window_theme(void) {
 	XResizeWindow(display, main_window, (unsigned)current_theme.main.main_width, (unsigned)current_theme.main.main_height);
 	XSetWindowBackground(display, main_window, css_to_pixel(current_theme.main.background));
 	XClearWindow(display, main_window);
+	compositor_resize(compositor, current_theme.main.main_width, current_theme.main.main_height);
+	compositor_set_background(compositor, css_to_pixel(current_theme.main.background));
+	compositor_damage_rect(compositor, 0, 0, current_theme.main.main_width, current_theme.main.main_height);
 	
 	// Apply or remove always-on-top state
 	Atom wm_state = XInternAtom(display, "_NET_WM_STATE", False);
@@ -1729,36 +2699,49 @@ static void apply_window_theme(void) {
 }
 
 static void apply_widget_themes(void) {
+	if (clipboard_ctx) {
+		clipboard_history_set_budget(clipboard_ctx, (size_t)current_theme.clipboard_history_size);
+		sync_tray_recent();
+	}
 	// Update swatch
 	if (swatch_ctx) {
 		swatch_set_background(swatch_ctx, css_to_pixel(current_theme.main.background));
-		swatch_resize(swatch_ctx, current_theme.swatch_widget.width, current_theme.swatch_widget.height);
-		swatch_set_position(swatch_ctx, current_theme.swatch_widget.swatch_x, current_theme.swatch_widget.swatch_y);
 		swatch_set_border(swatch_ctx, current_theme.swatch_widget.border_width, current_theme.swatch_widget.border_radius);
 	}
 	
+	// Update palette strip
+	if (palette_ctx) {
+		palette_set_max_colors(palette_ctx, current_theme.palette_widget.max_colors > 0 ? (size_t)current_theme.palette_widget.max_colors : 0);
+		palette_set_cell_style(palette_ctx, current_theme.palette_widget.padding, current_theme.palette_widget.cell_size, current_theme.palette_widget.cell_spacing, current_theme.palette_widget.cell_radius, current_theme.palette_widget.border_width, current_theme.palette_widget.border_radius);
+		palette_set_theme(palette_ctx, css_to_pixel(current_theme.palette.bg), css_to_pixel(current_theme.palette.border), css_to_pixel(current_theme.palette.hover_border));
+	}
+	
 	// Update button
 	if (button_ctx) {
 		button_set_theme(button_ctx, &current_theme.button);
-		button_set_position(button_ctx, current_theme.button_widget.button_x, current_theme.button_widget.button_y);
 	}
 	
 	// Update zoom
 	if (zoom_ctx) {
 		zoom_set_colors(zoom_ctx, config_color_to_pixel(display, DefaultScreen(display), current_theme.crosshair_color), config_color_to_pixel(display, DefaultScreen(display), current_theme.square_color));
 		zoom_set_visibility(zoom_ctx, current_theme.zoom_widget.crosshair_show, current_theme.zoom_widget.square_show, current_theme.zoom_widget.crosshair_show_after_pick, current_theme.zoom_widget.square_show_after_pick);
+		zoom_set_capture_thread(zoom_ctx, current_theme.zoom_widget.capture_thread);
 	}
 	
 	// Update menubar
 	if (menubar) {
 		menubar_set_theme(menubar, &current_theme);
-		menubar_set_position(menubar, current_theme.menubar_widget.menubar_x, current_theme.menubar_widget.menubar_y);
 	}
 	
 	// Update about window
 	if (about_win) {
 		about_set_theme(about_win, &current_theme);
 	}
+
+	// Update statistics panel
+	if (stats_panel) {
+		statspanel_set_theme(stats_panel, &current_theme);
+	}
 	
 	// Update tray menu
 	if (tray_ctx) {
@@ -1768,29 +2751,19 @@ static void apply_widget_themes(void) {
 
 static void apply_entry_themes(void) {
 	if (entry_hsv) {
-		entry_resize_noflush(entry_hsv, current_theme.entry_positions.entry_hsv_width, 22);
 		entry_set_theme_noflush(entry_hsv, &current_theme);
-		entry_move_noflush(entry_hsv, current_theme.entry_positions.entry_hsv_x, current_theme.entry_positions.entry_hsv_y);
 	}
 	if (entry_hsl) {
-		entry_resize_noflush(entry_hsl, current_theme.entry_positions.entry_hsl_width, 22);
 		entry_set_theme_noflush(entry_hsl, &current_theme);
-		entry_move_noflush(entry_hsl, current_theme.entry_positions.entry_hsl_x, current_theme.entry_positions.entry_hsl_y);
 	}
 	if (entry_rgbf) {
-		entry_resize_noflush(entry_rgbf, current_theme.entry_positions.entry_rgbf_width, 22);
 		entry_set_theme_noflush(entry_rgbf, &current_theme);
-		entry_move_noflush(entry_rgbf, current_theme.entry_positions.entry_rgbf_x, current_theme.entry_positions.entry_rgbf_y);
 	}
 	if (entry_rgbi) {
-		entry_resize_noflush(entry_rgbi, current_theme.entry_positions.entry_rgbi_width, 22);
 		entry_set_theme_noflush(entry_rgbi, &current_theme);
-		entry_move_noflush(entry_rgbi, current_theme.entry_positions.entry_rgbi_x, current_theme.entry_positions.entry_rgbi_y);
 	}
 	if (entry_hex) {
-		entry_resize_noflush(entry_hex, current_theme.entry_positions.entry_hex_width, 22);
 		entry_set_theme_noflush(entry_hex, &current_theme);
-		entry_move_noflush(entry_hex, current_theme.entry_positions.entry_hex_x, current_theme.entry_positions.entry_hex_y);
 		// Live-update hex case when hex_uppercase changes
 		refresh_entry_from_current(entry_hex);
 	}
@@ -1817,32 +2790,22 @@ static void apply_label_themes(void) {
 	
 	if (label_hsv) {
 		label_set_theme(label_hsv, &label_theme_reload);
-		label_move(label_hsv, current_theme.label_positions.label_hsv_x, current_theme.label_positions.label_hsv_y);
-		label_resize(label_hsv, current_theme.label_positions.label_hsv_width, 0);
 		label_set_geometry(label_hsv, current_theme.label_positions.label_hsv_padding, current_theme.label_positions.label_hsv_border_width, current_theme.label_positions.label_hsv_border_radius, current_theme.label_positions.label_hsv_border_enabled);
 	}
 	if (label_hsl) {
 		label_set_theme(label_hsl, &label_theme_reload);
-		label_move(label_hsl, current_theme.label_positions.label_hsl_x, current_theme.label_positions.label_hsl_y);
-		label_resize(label_hsl, current_theme.label_positions.label_hsl_width, 0);
 		label_set_geometry(label_hsl, current_theme.label_positions.label_hsl_padding, current_theme.label_positions.label_hsl_border_width, current_theme.label_positions.label_hsl_border_radius, current_theme.label_positions.label_hsl_border_enabled);
 	}
 	if (label_rgbf) {
 		label_set_theme(label_rgbf, &label_theme_reload);
-		label_move(label_rgbf, current_theme.label_positions.label_rgbf_x, current_theme.label_positions.label_rgbf_y);
-		label_resize(label_rgbf, current_theme.label_positions.label_rgbf_width, 0);
 		label_set_geometry(label_rgbf, current_theme.label_positions.label_rgbf_padding, current_theme.label_positions.label_rgbf_border_width, current_theme.label_positions.label_rgbf_border_radius, current_theme.label_positions.label_rgbf_border_enabled);
 	}
 	if (label_rgbi) {
 		label_set_theme(label_rgbi, &label_theme_reload);
-		label_move(label_rgbi, current_theme.label_positions.label_rgbi_x, current_theme.label_positions.label_rgbi_y);
-		label_resize(label_rgbi, current_theme.label_positions.label_rgbi_width, 0);
 		label_set_geometry(label_rgbi, current_theme.label_positions.label_rgbi_padding, current_theme.label_positions.label_rgbi_border_width, current_theme.label_positions.label_rgbi_border_radius, current_theme.label_positions.label_rgbi_border_enabled);
 	}
 	if (label_hex) {
 		label_set_theme(label_hex, &label_theme_reload);
-		label_move(label_hex, current_theme.label_positions.label_hex_x, current_theme.label_positions.label_hex_y);
-		label_resize(label_hex, current_theme.label_positions.label_hex_width, 0);
 		label_set_geometry(label_hex, current_theme.label_positions.label_hex_padding, current_theme.label_positions.label_hex_border_width, current_theme.label_positions.label_hex_border_radius, current_theme.label_positions.label_hex_border_enabled);
 	}
 }
@@ -1863,15 +2826,13 @@ static void reload_theme(void) {
 	apply_window_theme();
 	apply_widget_themes();
 	apply_entry_themes();
-	
-	// Critical: Sync and flush for atomic presentation
-	XSync(display, False);
-	XFlush(display);
-	
 	apply_label_themes();
 	
+	// Styling may have changed widget heights, so place everything last
+	apply_layout(&current_theme);
+	
 	// Trigger swatch redraw
-	if (swatch_ctx) {
+	if (swatch_ctx && swatch_get_window(swatch_ctx) != None) {
 		Window swatch_win = swatch_get_window(swatch_ctx);
 		XEvent ev = {0};
 		ev.type = Expose;
@@ -1882,6 +2843,221 @@ static void reload_theme(void) {
 	XFlush(display);
 }
 
+/* --- Control Socket --- */
+
+/* Format rgb8 as "hex", "rgb", "rgbf", "hsv", "hsl" or "json".
+ * Returns 0 on success, -1 for an unknown format name. */
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wformat-nonliteral"
+static int format_color_as(RGB8 rgb8, const char *format, char *out, size_t size) {
+	RGBf rgbf = rgb8_to_rgbf(rgb8);
+	if (strcmp(format, "hex") == 0) {
+		char hex[8];
+		format_hex(rgb8, hex, current_theme.hex_uppercase);
+		snprintf(out, size, "%s", hex);
+	}
+	else if (strcmp(format, "rgb") == 0) {
+		snprintf(out, size, FORMAT_RGBI, rgb8.r, rgb8.g, rgb8.b);
+	}
+	else if (strcmp(format, "rgbf") == 0) {
+		snprintf(out, size, FORMAT_RGBF, rgbf.r, rgbf.g, rgbf.b);
+	}
+	else if (strcmp(format, "hsv") == 0) {
+		HSV hsv = rgb_to_hsv(rgbf);
+		snprintf(out, size, FORMAT_HSV_HSL, hsv.H, hsv.S * 100.0, hsv.V * 100.0);
+	}
+	else if (strcmp(format, "hsl") == 0) {
+		HSL hsl = rgb_to_hsl(rgbf);
+		snprintf(out, size, FORMAT_HSV_HSL, hsl.H, hsl.S * 100.0, hsl.L * 100.0);
+	}
+	else if (strcmp(format, "json") == 0) {
+		char hex[8];
+		format_hex(rgb8, hex, current_theme.hex_uppercase);
+		snprintf(out, size, "{\"hex\": \"%s\", \"r\": %d, \"g\": %d, \"b\": %d}", hex, rgb8.r, rgb8.g, rgb8.b);
+	}
+	else {
+		return -1;
+	}
+	return 0;
+}
+#pragma GCC diagnostic pop
+
+/* Answer every client waiting on "pick" with the picked colour, or an
+ * error if the pick was cancelled. */
+static void finish_control_picks(int picked) {
+	char hex[8];
+	format_hex(current_rgb8, hex, current_theme.hex_uppercase);
+	reply_to_clients(pick_waiters, pick_waiter_count, picked, picked ? hex : "pick cancelled");
+	pick_waiter_count = 0;
+}
+
+/* Raise the window and start an interactive pick */
+static void begin_pick(void) {
+	show_main_window();
+	// Keyboard focus must be ours so arrows/Enter reach zoom_handle_event
+	XSetInputFocus(display, main_window, RevertToParent, CurrentTime);
+	zoom_begin_selection_ctx(zoom_ctx);
+}
+
+/* Start an interactive pick on behalf of a control client; the reply is
+ * sent from the main loop once the pick completes. */
+static void control_pick(unsigned int client_id) {
+	if (pick_waiter_count == pick_waiter_cap) {
+		size_t cap = pick_waiter_cap ? pick_waiter_cap * 2 : 8;
+		ControlReplyTo *grown = realloc(pick_waiters, cap * sizeof(*grown));
+		if (!grown) {
+			control_reply(control_server, client_id, 0, "out of memory");
+			return;
+		}
+		pick_waiters = grown;
+		pick_waiter_cap = cap;
+	}
+	pick_waiters[pick_waiter_count++] = control_reply_to(control_server, client_id);
+	if (pick_waiter_count > 1) {
+		return; // Pick already running - share its result
+	}
+	begin_pick();
+}
+
+/* Apply "set <color>": accepts #RRGGBB / #RGB or "r, g, b" */
+static void control_set(unsigned int client_id, int argc, char **argv) {
+	char text[256] = "";
+	for (int i = 1; i < argc; i++) {
+		strncat(text, argv[i], sizeof(text) - strlen(text) - 2);
+		strcat(text, " ");
+	}
+	RGB8 rgb8;
+	int r, g, b;
+	if (parse_rgbi(text, &r, &g, &b)) {
+		rgb8 = (RGB8){(uint8_t)r, (uint8_t)g, (uint8_t)b};
+	}
+	else if (!parse_hex(text, &rgb8)) {
+		control_reply(control_server, client_id, 0, "invalid color");
+		return;
+	}
+	updating_from_callback = 1;
+	format_and_update_entries(rgb8);
+	updating_from_callback = 0;
+	palette_push_color(palette_ctx, rgb8);
+
+	char hex[8];
+	format_hex(rgb8, hex, current_theme.hex_uppercase);
+	control_reply(control_server, client_id, 1, hex);
+}
+
+/* Reply with the newest N colours of the pick history, space separated */
+static void control_history(unsigned int client_id, int argc, char **argv) {
+	size_t want = 10;
+	if (argc > 1) {
+		char *end;
+		long n = strtol(argv[1], &end, 10);
+		if (*end || n < 0) {
+			control_reply(control_server, client_id, 0, "usage: history N");
+			return;
+		}
+		want = (size_t)n;
+	}
+	size_t count = 0;
+	const RGB8 *colors = palette_get_colors(palette_ctx, &count);
+	if (want > count) {
+		want = count;
+	}
+	char *text = malloc(want * 8 + 1);
+	if (!text) {
+		control_reply(control_server, client_id, 0, "out of memory");
+		return;
+	}
+	size_t len = 0;
+	for (size_t i = 0; i < want; i++) {
+		format_hex(colors[i], text + len, current_theme.hex_uppercase);
+		len += strlen(text + len);
+		text[len++] = ' ';
+	}
+	text[len ? len - 1 : 0] = '\0';
+	control_reply(control_server, client_id, 1, text);
+	free(text);
+}
+
+/* Control socket command dispatcher */
+static void handle_control_command(ControlServer *server, unsigned int client_id, int argc, char **argv, void *user_data) {
+	(void)user_data;
+	char buf[256];
+	const char *cmd = argv[0];
+	if (strcmp(cmd, "get") == 0) {
+		if (format_color_as(current_rgb8, argc > 1 ? argv[1] : "hex", buf, sizeof(buf)) != 0) {
+			control_reply(server, client_id, 0, "unknown format (hex, rgb, rgbf, hsv, hsl, json)");
+			return;
+		}
+		control_reply(server, client_id, 1, buf);
+	}
+	else if (strcmp(cmd, "set") == 0) {
+		if (argc < 2) {
+			control_reply(server, client_id, 0, "usage: set <color>");
+			return;
+		}
+		control_set(client_id, argc, argv);
+	}
+	else if (strcmp(cmd, "pick") == 0) {
+		control_pick(client_id);
+	}
+	else if (strcmp(cmd, "show") == 0) {
+		show_main_window();
+		control_reply(server, client_id, 1, "shown");
+	}
+	else if (strcmp(cmd, "import") == 0) {
+		PaletteFormat format = argc > 2 ? palette_format_from_name(argv[2]) : PALETTE_FORMAT_AUTO;
+		long imported = argc > 1 ? import_palette(argv[1], format) : -1;
+		if (imported < 0) {
+			control_reply(server, client_id, 0, argc > 1 ? "import failed" : "usage: import <file> [format]");
+			return;
+		}
+		snprintf(buf, sizeof(buf), "%ld", imported);
+		control_reply(server, client_id, 1, buf);
+	}
+	else if (strcmp(cmd, "history") == 0) {
+		control_history(client_id, argc, argv);
+	}
+	else if (strcmp(cmd, "zoom") == 0) {
+		if (argc > 1) {
+			char *end;
+			long mag = strtol(argv[1], &end, 10);
+			if (*end || mag <= 0 || mag > INT_MAX) {
+				control_reply(server, client_id, 0, "usage: zoom <magnification>");
+				return;
+			}
+			zoom_set_magnification_ctx(zoom_ctx, (int)mag);
+		}
+		snprintf(buf, sizeof(buf), "%d", zoom_get_magnification_ctx(zoom_ctx));
+		control_reply(server, client_id, 1, buf);
+	}
+	else if (strcmp(cmd, "stats") == 0) {
+		ControlStats stats;
+		control_get_stats(server, &stats);
+		size_t history = 0;
+		palette_get_colors(palette_ctx, &history);
+		snprintf(buf, sizeof(buf), "commands=%lu errors=%lu connections=%lu clients=%d avg_us=%.1f max_us=%.1f uptime_s=%.0f history=%zu", stats.commands, stats.errors, stats.connections, stats.clients, stats.avg_service_us, stats.max_service_us, stats.uptime_s, history);
+		control_reply(server, client_id, 1, buf);
+	}
+	else if (strcmp(cmd, "find") == 0) {
+		double tolerance = current_theme.find_tolerance;
+		if (argc > 1) {
+			char *end;
+			tolerance = strtod(argv[1], &end);
+			if (*end || tolerance < 0.0) {
+				control_reply(server, client_id, 0, "usage: find [tolerance]");
+				return;
+			}
+		}
+		// Answered from find_done() once the scan is finished
+		if (find_color_on_screen(tolerance / 100.0, &client_id) != 0) {
+			control_reply(server, client_id, 0, "screen capture failed");
+		}
+	}
+	else {
+		control_reply(server, client_id, 0, "unknown command (pick, show, get, set, history, import, zoom, stats, find)");
+	}
+}
+
 void pixelprism(void) {
 	/* Zero-initialize event structure to clear all padding bytes */
 	XEvent event = {0};
@@ -1925,6 +3101,7 @@ void pixelprism(void) {
 	if (!config_load(&theme, config_path)) {
 		// Config loaded successfully (either from file or defaults)
 		current_theme = theme;
+		clipboard_history_set_budget(clipboard_ctx, (size_t)theme.clipboard_history_size);
 		// Try to load window position from state file if remember-position is enabled
 		if (theme.remember_position && state_load_window_position(&xpos, &ypos) == 0) {
 			// Successfully loaded saved position
@@ -1977,6 +3154,11 @@ void pixelprism(void) {
 	/* Zero-initialize XSetWindowAttributes to clear padding bytes */
 	memset(&xsmwa, 0, sizeof(xsmwa));
 	xsmwa.event_mask = KeyPressMask | KeyReleaseMask | ButtonPressMask | VisibilityChangeMask | FocusChangeMask | StructureNotifyMask;
+	if (theme.single_window) {
+		// The compositor repaints the main window and hit-tests its pointer
+		// events for the widget nodes
+		xsmwa.event_mask |= ExposureMask | ButtonReleaseMask | PointerMotionMask | EnterWindowMask | LeaveWindowMask;
+	}
 	xsmwa.background_pixel = css_to_pixel(theme.main.background);
 	xsmwa.bit_gravity = NorthWestGravity;
 	xsmwa.backing_store = WhenMapped;
@@ -1997,11 +3179,13 @@ void pixelprism(void) {
 	XFree(sizehint);
 
 	zoom_ctx = zoom_create(display, main_window, 0, 0, 300, 300);
+	find_overlay = highlight_create(display, DefaultScreen(display));
 	zoom_window = zoom_get_window(zoom_ctx);
 	// Set zoom overlay colors from config
 	zoom_set_colors(zoom_ctx, config_color_to_pixel(display, DefaultScreen(display), theme.crosshair_color), config_color_to_pixel(display, DefaultScreen(display), theme.square_color));
 	// Set zoom overlay visibility from config
 	zoom_set_visibility(zoom_ctx, theme.zoom_widget.crosshair_show, theme.zoom_widget.square_show, theme.zoom_widget.crosshair_show_after_pick, theme.zoom_widget.square_show_after_pick);
+	zoom_set_capture_thread(zoom_ctx, theme.zoom_widget.capture_thread);
 	// Set zoom activation callback for button visual feedback
 	zoom_set_activation_callback(zoom_ctx, on_zoom_activated, button_ctx);
 	// Restore zoom magnification from state if available
@@ -2013,7 +3197,7 @@ void pixelprism(void) {
 	XStoreName(display, main_window, "PixelPrism");
 	// Create system tray icon with theme if enabled
 	if (theme.show_tray_icon) {
-		tray_ctx = tray_create(display, DefaultScreen(display), (const char **)pixelprism_icon_xpm, &theme.tray_menu, main_window);
+		tray_ctx = tray_create(display, DefaultScreen(display), pixelprism_icons, pixelprism_icon_count, &theme.tray_menu, main_window);
 		if (!tray_ctx) {
 			fprintf(stderr, "Warning: Could not create system tray icon\n");
 		}
@@ -2027,7 +3211,16 @@ void pixelprism(void) {
 		XChangeProperty(display, main_window, wm_state, XA_ATOM, 32, PropModeReplace, (unsigned char *)&wm_state_above, 1);
 	}
 	
-	// Create all widgets
+	// Without a pool, background jobs run inline; widgets may keep it for parallel passes
+	work_pool = workpool_create(0);
+	if (!work_pool) {
+		fprintf(stderr, "Warning: Worker threads unavailable\n");
+	}
+
+	// Create all widgets (as compositor nodes in single-window mode)
+	if (theme.single_window) {
+		init_compositor(&theme);
+	}
 	init_all_widgets(&theme);
 
 	// Initialize to saved color (or black if first run)
@@ -2037,25 +3230,70 @@ void pixelprism(void) {
 	wm_protocols = XInternAtom(display, "WM_PROTOCOLS", False);
 	XSetWMProtocols(display, main_window, &wm_delete_window, 1);
 
+	// Accept commands from scripts on the control socket
+	control_server = control_create(NULL, handle_control_command, NULL);
+	if (!control_server) {
+		fprintf(stderr, "Warning: Control socket unavailable\n");
+	}
+
+	if (pick_on_start) {
+		begin_pick();
+	}
+
 	int x11_fd = ConnectionNumber(display);
+	int control_fd = control_get_fd(control_server);
+	int pool_fd = workpool_get_fd(work_pool);
 	while (running) {
-		// Handle config file changes
-		if (inotify_fd >= 0) {
+		// The capture thread can be switched on or off by a config reload
+		int capture_fd = zoom_get_capture_fd(zoom_ctx);
+		int chooser_ready = 0;
+		// Handle config file changes, control socket commands, finished jobs,
+		// magnifier frames and file chooser output
+		if (inotify_fd >= 0 || control_fd >= 0 || pool_fd >= 0 || capture_fd >= 0 || chooser_fd >= 0) {
 			fd_set read_fds;
 			struct timeval timeout;
 			FD_ZERO(&read_fds);
 			FD_SET(x11_fd, &read_fds);
-			FD_SET(inotify_fd, &read_fds);
-			int max_fd = (x11_fd > inotify_fd) ? x11_fd : inotify_fd;
+			int max_fd = x11_fd;
+			if (inotify_fd >= 0) {
+				FD_SET(inotify_fd, &read_fds);
+				max_fd = (inotify_fd > max_fd) ? inotify_fd : max_fd;
+			}
+			if (control_fd >= 0) {
+				FD_SET(control_fd, &read_fds);
+				max_fd = (control_fd > max_fd) ? control_fd : max_fd;
+			}
+			if (pool_fd >= 0) {
+				FD_SET(pool_fd, &read_fds);
+				max_fd = (pool_fd > max_fd) ? pool_fd : max_fd;
+			}
+			if (capture_fd >= 0) {
+				FD_SET(capture_fd, &read_fds);
+				max_fd = (capture_fd > max_fd) ? capture_fd : max_fd;
+			}
+			if (chooser_fd >= 0) {
+				FD_SET(chooser_fd, &read_fds);
+				max_fd = (chooser_fd > max_fd) ? chooser_fd : max_fd;
+			}
+			// Wake up in time for a pending live preview
+			long long wait_ms = live_preview_wait_ms();
 			timeout.tv_sec = 0;
-			timeout.tv_usec = 50000;
+			timeout.tv_usec = (wait_ms >= 0 && wait_ms < 50) ? (suseconds_t)(wait_ms * 1000) : 50000;
 			int ret = select(max_fd + 1, &read_fds, NULL, NULL, &timeout);
-			if (ret > 0 && FD_ISSET(inotify_fd, &read_fds)) {
+			if (ret > 0 && inotify_fd >= 0 && FD_ISSET(inotify_fd, &read_fds)) {
 				handle_inotify_events();
 			}
+			if (ret > 0 && control_fd >= 0 && FD_ISSET(control_fd, &read_fds)) {
+				control_dispatch(control_server);
+			}
+			chooser_ready = (ret > 0 && chooser_fd >= 0 && FD_ISSET(chooser_fd, &read_fds));
 		}
+		poll_palette_chooser(chooser_ready);
+		workpool_dispatch(work_pool);
 		while (XPending(display)) {
 			XNextEvent(display, &event);
+			// Retarget main-window pointer events to the compositor node under the pointer
+			compositor_route_event(compositor, &event);
 			// Handle clipboard events first
 			if (clipboard_handle_event(clipboard_ctx, &event)) {
 				continue;
@@ -2098,17 +3336,27 @@ void pixelprism(void) {
 					format_hex(current_rgb8, hex_str, current_theme.hex_uppercase);
 					// Remove # prefix if disabled
 					if (!current_theme.hex_prefix && hex_str[0] == '#') {
-						clipboard_set_text(clipboard_ctx, main_window, hex_str + 1, SELECTION_CLIPBOARD);
+						clipboard_set_color(clipboard_ctx, main_window, hex_str + 1, current_rgb8, SELECTION_CLIPBOARD);
 					}
 					else {
-						clipboard_set_text(clipboard_ctx, main_window, hex_str, SELECTION_CLIPBOARD);
+						clipboard_set_color(clipboard_ctx, main_window, hex_str, current_rgb8, SELECTION_CLIPBOARD);
 					}
+					sync_tray_recent();
 					continue;
 				}
 				else if (tray_result == 5) {
 					// Exit menu item
 					exit(0);
 				}
+				else if (tray_result >= TRAY_RESULT_RECENT) {
+					// Recent colour - re-own it exactly as it was copied
+					reown_history_entry((size_t)(tray_result - TRAY_RESULT_RECENT));
+					continue;
+				}
+			}
+			// Handle statistics panel events
+			if (statspanel_handle_event(stats_panel, &event)) {
+				continue;
 			}
 			// Handle about window events
 			if (about_is_visible(about_win)) {
@@ -2116,19 +3364,43 @@ void pixelprism(void) {
 					continue;
 				}
 			}
+			int was_stats_drag = zoom_stats_dragging_ctx(zoom_ctx);
 			zoom_handle_event(zoom_ctx, &event);
+			if (zoom_stats_dragging_ctx(zoom_ctx)) {
+				begin_region_stats();
+			}
+			else if (was_stats_drag) {
+				// A statistics drag ends the pick without choosing a color
+				reply_to_clients(pick_waiters, pick_waiter_count, 0, "no color picked (statistics drag)");
+				pick_waiter_count = 0;
+			}
 			if (zoom_color_picked_ctx(zoom_ctx)) {
 				convert_pixel_color();
 				button_press = False;
 				button_reset(button_ctx);
+				finish_control_picks(1);
+			}
+			if (zoom_region_picked_ctx(zoom_ctx)) {
+				extract_region_colors();
+				button_press = False;
+				button_reset(button_ctx);
 			}
 			if (zoom_was_cancelled_ctx(zoom_ctx)) {
 				button_press = False;
 				button_reset(button_ctx);
+				finish_control_picks(0);
 			}
 			// Handle menubar events
 			int menubar_action = menubar_handle_event(menubar, &event);
 			if (menubar_action == 0) {
+				// File > Import Palette
+				start_palette_chooser(0);
+			}
+			else if (menubar_action == 1) {
+				// File > Export Palette
+				start_palette_chooser(1);
+			}
+			else if (menubar_action == 2) {
 				// File > Exit
 				exit(0);
 			}
@@ -2141,12 +3413,19 @@ void pixelprism(void) {
 				reset_to_black();
 				initialize_color_state();
 			}
+			else if (menubar_action == 102) {
+				// Edit > Find Color
+				find_color_on_screen(current_theme.find_tolerance / 100.0, NULL);
+			}
 			else if (menubar_action == 200) {
 				// About > PixelPrism
 				about_show(about_win);
 			}
 			switch (event.type) {
 				case Expose:
+					if (compositor_handle_expose(compositor, &event.xexpose)) {
+						break;
+					}
 					// Handle label expose events (initial display and window expose)
 					if (label_hsv && event.xexpose.window == label_get_window(label_hsv)) {
 						label_handle_expose(label_hsv, &event.xexpose);
@@ -2182,6 +3461,10 @@ void pixelprism(void) {
 			if (ks == XK_Escape) {
 				exit(0);
 			}
+			else if ((event.xkey.state & ControlMask) && ks >= XK_1 && ks <= XK_9) {
+				// Ctrl+1..9 - re-own the Nth most recent copied colour
+				reown_history_entry((size_t)(ks - XK_1));
+			}
 			else if (ks == XK_Tab || ks == XK_ISO_Left_Tab) {
 				// Tab or Shift+Tab to cycle focus between entries
 				int forward = !(event.xkey.state & ShiftMask);
@@ -2227,6 +3510,12 @@ void pixelprism(void) {
 			// Menu widget now handles auto-hiding internally
 			swatch_handle_event(swatch_ctx, &event, main_window);
 
+			// Clicking a history cell makes it the current color
+			RGB8 palette_rgb;
+			if (palette_handle_event(palette_ctx, &event, &palette_rgb) == 2) {
+				format_and_update_entries(palette_rgb);
+			}
+
 			// Track if any entry handled the event (to know if we clicked an entry)
 			int entry_handled = 0;
 			entry_handled |= entry_handle_event(entry_hsv, &event);
@@ -2242,6 +3531,12 @@ void pixelprism(void) {
 			}
 		}
 		update_all_entry_blinks();
+		highlight_tick(find_overlay);
+		zoom_present_frame(zoom_ctx);
+		update_region_stats();
+		flush_live_preview();
+		compositor_present(compositor);
+		clipboard_process_timeouts(clipboard_ctx);
 	}
 }
 
@@ -2253,6 +3548,9 @@ void pixelprism(void) {
  * for all created widgets. Also auto-saves config if there are unsaved changes.
  */
 static void cleanup_all_widgets(void) {
+	// Finish background jobs first; their completions still use the widgets
+	workpool_destroy(work_pool);
+	work_pool = NULL;
 	// Save window position if remember-position is enabled
 	if (current_theme.remember_position && main_window) {
 		// Query the parent (frame) window position
@@ -2336,12 +3634,36 @@ static void cleanup_all_widgets(void) {
 	if (swatch_ctx) {
 		swatch_destroy(swatch_ctx);
 	}
+	// The widgets above were its nodes in single-window mode
+	compositor_destroy(compositor);
+	compositor = NULL;
+	// Persist pick history and destroy palette strip
+	if (palette_ctx) {
+		size_t history_count = 0;
+		const RGB8 *history = palette_get_colors(palette_ctx, &history_count);
+		state_save_history(history, history_count);
+		palette_destroy(palette_ctx);
+	}
 	// Destroy zoom widget
 	if (zoom_ctx) {
 		int zoom_mag = zoom_get_magnification_ctx(zoom_ctx);
 		state_save_zoom_mag(zoom_mag);
 		zoom_destroy(zoom_ctx);
 	}
+	// Destroy statistics panel
+	if (stats_panel) {
+		statspanel_destroy(stats_panel);
+		stats_panel = NULL;
+	}
+	release_screen_capture(&stats_frame);
+	stats_frame_valid = 0;
+	region_stats_destroy(region_stats);
+	region_stats = NULL;
+	// Destroy search outlines
+	if (find_overlay) {
+		highlight_destroy(find_overlay);
+		find_overlay = NULL;
+	}
 	// Destroy about window
 	if (about_win) {
 		about_destroy(about_win);
@@ -2355,6 +3677,13 @@ static void cleanup_all_widgets(void) {
 	if (tray_ctx) {
 		tray_destroy(tray_ctx);
 	}
+	// Close the control socket (removes the socket file)
+	if (control_server) {
+		control_destroy(control_server);
+		control_server = NULL;
+	}
+	free(pick_waiters);
+	pick_waiters = NULL;
 	// Close inotify file descriptors
 	if (inotify_fd >= 0) {
 		close(inotify_fd);
@@ -2698,6 +4027,52 @@ static int menubar_widget_section_parse(PixelPrismConfig *cfg, const char *key,
 
 // menubar-widget section functions called directly (not via registry)
 
+/* --- Palette Section Handlers --- */
+static void palette_section_init(PixelPrismConfig *cfg) {
+	if (cfg) {
+		palette_config_init_defaults(cfg);
+	}
+}
+
+static int palette_section_parse(PixelPrismConfig *cfg, const char *key, const char *value) {
+	if (!cfg) {
+		return 0;
+	}
+	palette_config_parse(cfg, key, value);
+	return 1;
+}
+
+static void palette_section_write(FILE *f, const PixelPrismConfig *cfg) {
+	if (!cfg || !f) {
+		return;
+	}
+	palette_config_write(f, cfg);
+}
+
+static const ConfigSectionHandler palette_section_handler = {
+	.section = "palette",
+	.init_defaults = palette_section_init,
+	.parse = palette_section_parse,
+	.write = palette_section_write,
+};
+
+/* --- Palette Widget Section Handlers --- */
+static void palette_widget_section_init(PixelPrismConfig *cfg) {
+	if (cfg) {
+		palette_widget_config_init_defaults(cfg);
+	}
+}
+
+static int palette_widget_section_parse(PixelPrismConfig *cfg, const char *key, const char *value) {
+	if (!cfg) {
+		return 0;
+	}
+	palette_widget_config_parse(cfg, key, value);
+	return 1;
+}
+
+// palette-widget section functions called directly (not via registry)
+
 /* --- Swatch Section Handlers --- */
 static void swatch_section_init(PixelPrismConfig *cfg) {
 	if (cfg) {
@@ -2790,6 +4165,8 @@ static void zoom_widget_section_init(PixelPrismConfig *cfg) {
 	cfg->zoom_widget.square_show = 1;
 	cfg->zoom_widget.crosshair_show_after_pick = 0;
 	cfg->zoom_widget.square_show_after_pick = 1;
+	cfg->zoom_widget.region_colors = 8;
+	cfg->zoom_widget.capture_thread = 0;
 }
 
 static int zoom_section_parse(PixelPrismConfig *cfg, const char *key, const char *value) {
@@ -2827,6 +4204,15 @@ static int zoom_widget_section_parse(PixelPrismConfig *cfg, const char *key, con
 		cfg->zoom_widget.square_show_after_pick = (strcmp(value, "true") == 0 || strcmp(value, "1") == 0);
 		return 1;
 	}
+	if (strcmp(key, "region-colors") == 0) {
+		int n = atoi(value);
+		cfg->zoom_widget.region_colors = n < 1 ? 1 : (n > QUANTIZE_MAX_COLORS ? QUANTIZE_MAX_COLORS : n);
+		return 1;
+	}
+	if (strcmp(key, "capture-thread") == 0) {
+		cfg->zoom_widget.capture_thread = (strcmp(value, "true") == 0 || strcmp(value, "1") == 0);
+		return 1;
+	}
 	return 0;
 }
 
@@ -2898,7 +4284,7 @@ static const ConfigSectionHandler label_section_handler = {
 static void config_register_builtin_sections(void) {
 	config_registry_reset();
 	// Register ONLY styling sections (top half) - widget sections are manually written at bottom
-	// Alphabetical order: button, context-menu, entry-*, label, menubar, swatch, tray-menu, zoom
+	// Alphabetical order: button, context-menu, entry-*, label, menubar, palette, swatch, tray-menu, zoom
 	config_registry_register(&button_section_handler);
 	config_registry_register(&menu_section_handler);        // [context-menu]
 	config_registry_register(&entry_float_handler);
@@ -2907,6 +4293,7 @@ static void config_register_builtin_sections(void) {
 	config_registry_register(&entry_text_handler);
 	config_registry_register(&label_section_handler);
 	config_registry_register(&menubar_section_handler);
+	config_registry_register(&palette_section_handler);
 	config_registry_register(&swatch_section_handler);
 	config_registry_register(&tray_section_handler);
 	config_registry_register(&zoom_section_handler);
@@ -2955,6 +4342,7 @@ void config_init_defaults(PixelPrismConfig *cfg) {
 	// Manually initialize widget sections (not in registry - written at bottom of config)
 	button_widget_section_init(cfg);
 	menubar_widget_section_init(cfg);
+	palette_widget_section_init(cfg);
 	swatch_widget_section_init(cfg);
 	zoom_widget_section_init(cfg);
 
@@ -3043,13 +4431,19 @@ void config_init_defaults(PixelPrismConfig *cfg) {
 	cfg->remember_position = 1;
 	cfg->always_on_top = 1;
 	cfg->show_tray_icon = 1;
+	cfg->single_window = 0;
 	cfg->minimize_to_tray = 1;
 
+// Color search defaults
+	cfg->find_tolerance = 2.0;
+	cfg->find_highlight_ms = 3000;
+
 // Clipboard defaults
 	cfg->auto_copy = 0;
 	strncpy(cfg->auto_copy_format, "hex", 7); // Options: hex, hsv, hsl, rgb, rgbi
 	cfg->hex_prefix = 1; // Include # symbol when copying hex
 	cfg->auto_copy_primary = 1; // Auto-copy selection to PRIMARY (X11 native behavior)
+	cfg->clipboard_history_size = 16384; // Copy history budget in bytes
 
 // Zoom defaults - colors and visibility
 	cfg->crosshair_color = (ConfigColor) {
@@ -3062,6 +4456,8 @@ void config_init_defaults(PixelPrismConfig *cfg) {
 	cfg->zoom_widget.square_show = 1;
 	cfg->zoom_widget.crosshair_show_after_pick = 0;
 	cfg->zoom_widget.square_show_after_pick = 1;
+	cfg->zoom_widget.region_colors = 8;
+	cfg->zoom_widget.capture_thread = 0;
 
 // Entry instance geometry (5 visual entries)
 	cfg->entry_positions.entry_hsv_x = 383;
@@ -3132,6 +4528,16 @@ void config_init_defaults(PixelPrismConfig *cfg) {
 	cfg->label_positions.label_hex_border_radius = 0;
 	cfg->label_positions.label_hex_border_enabled = 0;
 
+// Widget placement (fixed keeps the per-widget x/y keys)
+	cfg->widget_layout.mode = LAYOUT_MODE_FIXED;
+	cfg->widget_layout.origin_x = 310;
+	cfg->widget_layout.origin_y = 40;
+	cfg->widget_layout.row_spacing = 8;
+	cfg->widget_layout.column_spacing = 13;
+	cfg->widget_layout.tool_spacing = 8;
+	cfg->widget_layout.row_align = LAYOUT_ALIGN_CENTER;
+	cfg->widget_layout.tool_align = LAYOUT_ALIGN_END;
+
 // Window dimensions now in main struct
 	cfg->main.main_width = 590;
 	cfg->main.main_height = 300;
@@ -3190,6 +4596,15 @@ int config_write_defaults(const char *path) {
 	return result ? 0 : -1;
 }
 
+/* Config spelling of a layout alignment */
+static const char *align_name(LayoutAlign align) {
+	switch (align) {
+		case LAYOUT_ALIGN_CENTER: return "center";
+		case LAYOUT_ALIGN_END: return "end";
+		default: return "start";
+	}
+}
+
 /*
  * Emit a configuration file using the current values inside cfg. Only the
  * non-derived sections are written; widget sections are delegated through
@@ -3207,7 +4622,7 @@ int config_write_defaults_with_values(FILE *f, PixelPrismConfig *cfg) {
 	fprintf(f, "# Sections and keys within each section are alphabetically ordered.\n");
 	fprintf(f, "# ============================================================================\n\n");
 
-	// Write all styling sections via registry (button, entries, label, menu, menubar, swatch, tray-menu, zoom)
+	// Write all styling sections via registry (button, entries, label, menu, menubar, palette, swatch, tray-menu, zoom)
 	struct ConfigWriteContext ctx = {
 		.f = f,
 		.cfg = cfg,
@@ -3227,10 +4642,13 @@ int config_write_defaults_with_values(FILE *f, PixelPrismConfig *cfg) {
 	fprintf(f, "cursor-blink-ms = %d\n", cfg->cursor_blink_ms);
 	fprintf(f, "cursor-color = #%02X%02X%02X\n", (int)(cfg->cursor_color.r * 255), (int)(cfg->cursor_color.g * 255), (int)(cfg->cursor_color.b * 255));
 	fprintf(f, "cursor-width = %d\n", cfg->cursor_thickness);
+	fprintf(f, "find-highlight-ms = %d\n", cfg->find_highlight_ms);
+	fprintf(f, "find-tolerance = %g\n", cfg->find_tolerance);
 	fprintf(f, "hex-case = %s\n", cfg->hex_uppercase ? "upper" : "lower");
 	fprintf(f, "minimize-to-tray = %s\n", cfg->minimize_to_tray ? "true" : "false");
 	fprintf(f, "remember-position = %s\n", cfg->remember_position ? "true" : "false");
 	fprintf(f, "show-tray-icon = %s\n", cfg->show_tray_icon ? "true" : "false");
+	fprintf(f, "single-window = %s\n", cfg->single_window ? "true" : "false");
 	fprintf(f, "undo-depth = %d\n\n", cfg->undo_depth);
 
 	// ========== [button-widget] ==========
@@ -3251,7 +4669,8 @@ int config_write_defaults_with_values(FILE *f, PixelPrismConfig *cfg) {
 	fprintf(f, "# Options: hex, hsv, hsl, rgb, rgbi\n");
 	fprintf(f, "auto-copy-format = %s\n", cfg->auto_copy_format);
 	fprintf(f, "auto-copy-primary = %s\n", cfg->auto_copy_primary ? "true" : "false");
-	fprintf(f, "hex-prefix = %s\n\n", cfg->hex_prefix ? "true" : "false");
+	fprintf(f, "hex-prefix = %s\n", cfg->hex_prefix ? "true" : "false");
+	fprintf(f, "history-size = %d\n\n", cfg->clipboard_history_size);
 
 	// ========== Entry widget instances (alphabetical: hex, hsl, hsv, rgbf, rgbi) ==========
 	fprintf(f, "[entry-widget-hex]\nborder-radius = %d\nborder-width = %d\nentry-hex-x = %d\nentry-hex-y = %d\npadding = %d\nwidth = %d\n\n", cfg->entry_positions.entry_hex_border_radius, cfg->entry_positions.entry_hex_border_width, cfg->entry_positions.entry_hex_x, cfg->entry_positions.entry_hex_y, cfg->entry_positions.entry_hex_padding, cfg->entry_positions.entry_hex_width);
@@ -3267,6 +4686,18 @@ int config_write_defaults_with_values(FILE *f, PixelPrismConfig *cfg) {
 	fprintf(f, "[label-widget-rgbf]\nborder-enabled = %s\nborder-radius = %d\nborder-width = %d\nlabel-rgbf-x = %d\nlabel-rgbf-y = %d\npadding = %d\nwidth = %d\n\n", cfg->label_positions.label_rgbf_border_enabled ? "true" : "false", cfg->label_positions.label_rgbf_border_radius, cfg->label_positions.label_rgbf_border_width, cfg->label_positions.label_rgbf_x, cfg->label_positions.label_rgbf_y, cfg->label_positions.label_rgbf_padding, cfg->label_positions.label_rgbf_width);
 	fprintf(f, "[label-widget-rgbi]\nborder-enabled = %s\nborder-radius = %d\nborder-width = %d\nlabel-rgbi-x = %d\nlabel-rgbi-y = %d\npadding = %d\nwidth = %d\n\n", cfg->label_positions.label_rgbi_border_enabled ? "true" : "false", cfg->label_positions.label_rgbi_border_radius, cfg->label_positions.label_rgbi_border_width, cfg->label_positions.label_rgbi_x, cfg->label_positions.label_rgbi_y, cfg->label_positions.label_rgbi_padding, cfg->label_positions.label_rgbi_width);
 
+	// ========== [layout] ==========
+	fprintf(f, "[layout]\n");
+	fprintf(f, "column-spacing = %d\n", cfg->widget_layout.column_spacing);
+	fprintf(f, "# fixed: widgets use the x/y keys of their sections; auto: rows below\n");
+	fprintf(f, "mode = %s\n", cfg->widget_layout.mode == LAYOUT_MODE_AUTO ? "auto" : "fixed");
+	fprintf(f, "origin-x = %d\n", cfg->widget_layout.origin_x);
+	fprintf(f, "origin-y = %d\n", cfg->widget_layout.origin_y);
+	fprintf(f, "row-align = %s\n", align_name(cfg->widget_layout.row_align));
+	fprintf(f, "row-spacing = %d\n", cfg->widget_layout.row_spacing);
+	fprintf(f, "tool-align = %s\n", align_name(cfg->widget_layout.tool_align));
+	fprintf(f, "tool-spacing = %d\n\n", cfg->widget_layout.tool_spacing);
+
 	// ========== [main] ==========
 	fprintf(f, "[main]\n");
 	fprintf(f, "about-height = %d\n", cfg->main.about_height);
@@ -3289,6 +4720,9 @@ int config_write_defaults_with_values(FILE *f, PixelPrismConfig *cfg) {
 	fprintf(f, "padding = %d\n", cfg->menubar_widget.padding);
 	fprintf(f, "width = %d\n\n", cfg->menubar_widget.width);
 
+	// ========== [palette-widget] ==========
+	palette_widget_config_write(f, cfg);
+
 	// ========== [paths] ==========
 	fprintf(f, "[paths]\n");
 	fprintf(f, "browser = %s\n", cfg->browser_path);
@@ -3318,8 +4752,10 @@ int config_write_defaults_with_values(FILE *f, PixelPrismConfig *cfg) {
 
 	// ========== [zoom-widget] ==========
 	fprintf(f, "[zoom-widget]\n");
+	fprintf(f, "capture-thread = %s\n", cfg->zoom_widget.capture_thread ? "true" : "false");
 	fprintf(f, "crosshair-show = %s\n", cfg->zoom_widget.crosshair_show ? "true" : "false");
 	fprintf(f, "crosshair-show-after-pick = %s\n", cfg->zoom_widget.crosshair_show_after_pick ? "true" : "false");
+	fprintf(f, "region-colors = %d\n", cfg->zoom_widget.region_colors);
 	fprintf(f, "square-show = %s\n", cfg->zoom_widget.square_show ? "true" : "false");
 	fprintf(f, "square-show-after-pick = %s\n\n", cfg->zoom_widget.square_show_after_pick ? "true" : "false");
 
@@ -3335,6 +4771,17 @@ static int parse_bool(const char *value) {
 	return (strcmp(value, "true") == 0 || strcmp(value, "1") == 0 || strcmp(value, "yes") == 0);
 }
 
+/* Parse a layout alignment: start, center or end */
+static LayoutAlign parse_align(const char *value) {
+	if (strcmp(value, "center") == 0) {
+		return LAYOUT_ALIGN_CENTER;
+	}
+	if (strcmp(value, "end") == 0) {
+		return LAYOUT_ALIGN_END;
+	}
+	return LAYOUT_ALIGN_START;
+}
+
 /* Parse label widget position section - reduces duplication */
 static void parse_label_widget_section(const char *section, const char *key, const char *value, PixelPrismConfig *cfg) {
 	int *border_enabled = NULL, *border_radius = NULL, *border_width = NULL;
@@ -3660,6 +5107,32 @@ int config_load(PixelPrismConfig *cfg, const char *path) {
 				cfg->menu.hover_bg = parse_color(value);
 			}
 		}
+		else if (strcmp(section, "layout") == 0) {
+			if (strcmp(key, "column-spacing") == 0) {
+				cfg->widget_layout.column_spacing = atoi(value);
+			}
+			else if (strcmp(key, "mode") == 0) {
+				cfg->widget_layout.mode = strcmp(value, "auto") == 0 ? LAYOUT_MODE_AUTO : LAYOUT_MODE_FIXED;
+			}
+			else if (strcmp(key, "origin-x") == 0) {
+				cfg->widget_layout.origin_x = atoi(value);
+			}
+			else if (strcmp(key, "origin-y") == 0) {
+				cfg->widget_layout.origin_y = atoi(value);
+			}
+			else if (strcmp(key, "row-align") == 0) {
+				cfg->widget_layout.row_align = parse_align(value);
+			}
+			else if (strcmp(key, "row-spacing") == 0) {
+				cfg->widget_layout.row_spacing = atoi(value);
+			}
+			else if (strcmp(key, "tool-align") == 0) {
+				cfg->widget_layout.tool_align = parse_align(value);
+			}
+			else if (strcmp(key, "tool-spacing") == 0) {
+				cfg->widget_layout.tool_spacing = atoi(value);
+			}
+		}
 		else if (strcmp(section, "main") == 0) {
 			if (strcmp(key, "about-height") == 0) {
 				cfg->main.about_height = atoi(value);
@@ -3721,6 +5194,9 @@ int config_load(PixelPrismConfig *cfg, const char *path) {
 		else if (strcmp(section, "menubar-widget") == 0) {
 			menubar_widget_section_parse(cfg, key, value);
 		}
+		else if (strcmp(section, "palette-widget") == 0) {
+			palette_widget_section_parse(cfg, key, value);
+		}
 		else if (strcmp(section, "paths") == 0) {
 			if (strcmp(key, "browser") == 0) {
 				strncpy(cfg->browser_path, value, sizeof(cfg->browser_path) - 1);
@@ -3769,6 +5245,13 @@ int config_load(PixelPrismConfig *cfg, const char *path) {
 			else if (strcmp(key, "cursor-width") == 0) {
 				cfg->cursor_thickness = atoi(value);
 			}
+			else if (strcmp(key, "find-highlight-ms") == 0) {
+				cfg->find_highlight_ms = atoi(value) < 0 ? 0 : atoi(value);
+			}
+			else if (strcmp(key, "find-tolerance") == 0) {
+				double tolerance = atof(value);
+				cfg->find_tolerance = tolerance < 0.0 ? 0.0 : tolerance;
+			}
 			else if (strcmp(key, "hex-case") == 0) {
 				cfg->hex_uppercase = (strcmp(value, "upper") == 0 || strcmp(value, "1") == 0);
 			}
@@ -3781,6 +5264,9 @@ int config_load(PixelPrismConfig *cfg, const char *path) {
 			else if (strcmp(key, "show-tray-icon") == 0) {
 				cfg->show_tray_icon = parse_bool(value);
 			}
+			else if (strcmp(key, "single-window") == 0) {
+				cfg->single_window = parse_bool(value);
+			}
 			else if (strcmp(key, "undo-depth") == 0) {
 				cfg->undo_depth = atoi(value);
 			}
@@ -3801,6 +5287,12 @@ int config_load(PixelPrismConfig *cfg, const char *path) {
 			else if (strcmp(key, "hex-prefix") == 0) {
 				cfg->hex_prefix = parse_bool(value);
 			}
+			else if (strcmp(key, "history-size") == 0) {
+				cfg->clipboard_history_size = atoi(value);
+				if (cfg->clipboard_history_size < 0) {
+					cfg->clipboard_history_size = 0;
+				}
+			}
 		}
 		else if (strcmp(section, "tray-menu") == 0) {
 			if (strcmp(key, "font") == 0 || strcmp(key, "font-family") == 0) {
@@ -3866,9 +5358,147 @@ int config_has_unsaved_changes(PixelPrismConfig *cfg) {
 	return cfg ? cfg->config_changed : 0;
 }
 
+static void print_usage(const char *prog) {
+	fprintf(stderr, "Usage: %s [--pick] [--new-instance] [--import-palette FILE] [--export-palette FILE] [--palette-format FMT]\n", prog);
+	fprintf(stderr, "       %s --pick X,Y[,W,H] [--pick ...] [--average] [--format FMT]\n", prog);
+	fprintf(stderr, "       %s --sample-file FILE [--average] [--format FMT]\n", prog);
+	fprintf(stderr, "       %s --convert COLOR --to FMT\n", prog);
+	fprintf(stderr, "  --pick                 Start picking immediately (in the running instance if there is one)\n");
+	fprintf(stderr, "  --pick X,Y[,W,H]       Print the color of screen pixel X,Y (or area) and exit (no window)\n");
+	fprintf(stderr, "  --sample-file FILE     Print the color at every X,Y[,W,H] listed in FILE (- for stdin) and exit\n");
+	fprintf(stderr, "  --average              Report the mean color of each W,H area instead of its center pixel\n");
+	fprintf(stderr, "  --convert COLOR        Print COLOR (#hex, r,g,b, rgb(), hsl(), hsv()) in another format and exit (no X needed)\n");
+	fprintf(stderr, "  --format/--to FMT      hex, rgb, rgbf, hsv, hsl, css or json (default: hex)\n");
+	fprintf(stderr, "  --new-instance         Start a separate instance instead of handing off to the running one\n");
+	fprintf(stderr, "  --import-palette FILE  Append the colors in FILE to the history strip on startup\n");
+	fprintf(stderr, "  --export-palette FILE  Write the saved pick history to FILE and exit (no X needed)\n");
+	fprintf(stderr, "  --palette-format FMT   gpl, ase, css, json or hex (default: from file extension)\n");
+}
+
+/* Hand this launch's request to the running instance.
+ * Returns the process exit status. */
+static int forward_to_instance(const char *socket_path) {
+	char reply[256];
+	if (pending_import_path) {
+		// The running instance has its own working directory
+		char abs_path[PATH_MAX];
+		const char *import_path = realpath(pending_import_path, abs_path) ? abs_path : pending_import_path;
+		const char *args[3] = {"import", import_path, NULL};
+		int argn = 2;
+		if (cli_palette_format != PALETTE_FORMAT_AUTO) {
+			static const char *const names[] = {"auto", "gpl", "ase", "css", "json", "hex"};
+			args[argn++] = names[cli_palette_format];
+		}
+		int rc = control_send(socket_path, argn, args, reply, sizeof(reply), 2000);
+		if (rc == 0) {
+			fprintf(stderr, "Import failed: %s\n", reply);
+		}
+		if (rc < 0) {
+			goto unreachable;
+		}
+	}
+	// A pick only answers once the user has clicked - do not wait for it
+	const char *command = pick_on_start ? "pick" : "show";
+	if (control_send(socket_path, 1, &command, pick_on_start ? NULL : reply, sizeof(reply), 2000) < 0) {
+		goto unreachable;
+	}
+	return 0;
+
+unreachable:
+	fprintf(stderr, "PixelPrism is already running but not answering on %s (use --new-instance to start another)\n", socket_path);
+	return 1;
+}
+
+/* True if text looks like an "X,Y" coordinate rather than another option */
+static int is_coordinate_arg(const char *text) {
+	return isdigit((unsigned char)text[0]) && strchr(text, ',') != NULL;
+}
+
 int main(int argc, char **argv) {
-	(void)argc;
-	(void)argv;
+	const char *export_path = NULL;
+	int new_instance = 0;
+	const char *pick_coords[argc];
+	size_t pick_coord_count = 0;
+	const char *sample_file = NULL;
+	const char *convert_color = NULL;
+	const char *output_format = "hex";
+	int average_areas = 0;
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--pick") == 0) {
+			if (i + 1 < argc && is_coordinate_arg(argv[i + 1])) {
+				pick_coords[pick_coord_count++] = argv[++i];
+			}
+			else {
+				pick_on_start = 1;
+			}
+		}
+		else if (strcmp(argv[i], "--average") == 0) {
+			average_areas = 1;
+		}
+		else if (strcmp(argv[i], "--sample-file") == 0 && i + 1 < argc) {
+			sample_file = argv[++i];
+		}
+		else if (strcmp(argv[i], "--convert") == 0 && i + 1 < argc) {
+			convert_color = argv[++i];
+		}
+		else if ((strcmp(argv[i], "--format") == 0 || strcmp(argv[i], "--to") == 0) && i + 1 < argc) {
+			output_format = argv[++i];
+		}
+		else if (strcmp(argv[i], "--new-instance") == 0) {
+			new_instance = 1;
+		}
+		else if (strcmp(argv[i], "--import-palette") == 0 && i + 1 < argc) {
+			pending_import_path = argv[++i];
+		}
+		else if (strcmp(argv[i], "--export-palette") == 0 && i + 1 < argc) {
+			export_path = argv[++i];
+		}
+		else if (strcmp(argv[i], "--palette-format") == 0 && i + 1 < argc) {
+			cli_palette_format = palette_format_from_name(argv[++i]);
+			if (cli_palette_format == PALETTE_FORMAT_AUTO) {
+				fprintf(stderr, "Unknown palette format: %s\n", argv[i]);
+				return 1;
+			}
+		}
+		else {
+			print_usage(argv[0]);
+			return strcmp(argv[i], "--help") == 0 ? 0 : 1;
+		}
+	}
+
+	// Headless modes: print and exit without building any UI
+	if (convert_color) {
+		return headless_convert(convert_color, output_format);
+	}
+	if (pick_coord_count > 0) {
+		return headless_pick(pick_coords, pick_coord_count, output_format, average_areas);
+	}
+	if (sample_file) {
+		return headless_sample_file(sample_file, output_format, average_areas);
+	}
+
+	// Headless export: write the persisted history without touching X
+	if (export_path) {
+		RGB8 *history = NULL;
+		size_t history_count = 0;
+		state_load_history(&history, &history_count);
+		int rc = palette_io_export(export_path, cli_palette_format, history, history_count, "PixelPrism");
+		free(history);
+		if (rc != 0) {
+			return 1;
+		}
+		fprintf(stderr, "Exported %zu colors to %s\n", history_count, export_path);
+		return 0;
+	}
+
+	// Single instance: if another instance holds the lock, hand off to it
+	// and exit before opening the display or loading fonts
+	char socket_path[PATH_MAX];
+	if (!new_instance && control_default_path(socket_path, sizeof(socket_path)) == 0) {
+		if (control_lock_instance(socket_path) == -1) {
+			return forward_to_instance(socket_path);
+		}
+	}
 
 	// Register signal handlers for proper cleanup
 	signal(SIGTERM, signal_handler);
@@ -138,5 +138,7 @@ int state_load_zoom_mag(int *zoom_mag_out);
 int state_save_zoom_mag(int zoom_mag);
 int state_load_last_color(char hex_out[8]);
 int state_save_last_color(const char *hex);
+int state_load_history(RGB8 **colors_out, size_t *count_out);
+int state_save_history(const RGB8 *colors, size_t count);
 
 #endif /* PIXELPRISM_H_ */
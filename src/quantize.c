@@ -0,0 +1,323 @@
+/* quantize.c - Dominant Color Extraction Implementation
+ *
+ * Reduces an image to a handful of representative colors: a threaded
+ * 15-bit histogram pass followed by weighted k-means in OKLab.
+ *
+ * Internal design notes:
+ * - Each histogram worker owns a private 32768-bin table for a band of rows,
+ *   so the hot loop has no sharing; tables are summed afterwards. Bins keep
+ *   channel sums, so a bin's color is the true mean of its pixels and the
+ *   5-bit bucketing does not shift hues.
+ * - k-means runs on the occupied bins (at most 32768 points) instead of the
+ *   pixels. Points are stored as separate L/a/b/weight float arrays so the
+ *   distance loop is plain contiguous arithmetic the compiler can vectorize.
+ * - Seeds are chosen greedily: the heaviest bin first, then repeatedly the
+ *   bin with the largest weight * squared distance to its nearest seed.
+ *   This is k-means++ without the randomness, so results are reproducible.
+ * - Each pass is split into slices run with workpool_parallel(), so
+ *   extraction started from a pool job uses the pool's existing workers
+ *   instead of creating threads of its own.
+ */
+
+#include "quantize.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* ========== INTERNAL CONSTANTS ========== */
+
+#define HIST_BITS 5
+#define HIST_SIZE (1 << (3 * HIST_BITS))
+#define MAX_ITERATIONS 24
+#define MIN_ROWS_PER_THREAD 32    // Below this a histogram band is not worth a thread
+#define MIN_POINTS_PER_THREAD 2048
+
+/* ========== TYPE DEFINITIONS ========== */
+
+typedef struct {
+	uint32_t count;
+	uint64_t r, g, b; // Channel sums of the pixels in this bin
+} Bin;
+
+typedef struct {
+	const uint32_t *pixels;
+	int width;
+	int stride;
+	int y0, y1;
+	QuantizeFormat format;
+	Bin *bins;
+} HistJob;
+
+/* Occupied bins as OKLab points */
+typedef struct {
+	float *L, *a, *b;
+	float *weight;
+	int count;
+} Points;
+
+typedef struct {
+	const Points *points;
+	int begin, end;
+	const float (*centers)[3];
+	int k;
+	int *assign;
+	int changed;
+	double sum[QUANTIZE_MAX_COLORS][3];
+	double weight[QUANTIZE_MAX_COLORS];
+} AssignJob;
+
+/* ========== HISTOGRAM ========== */
+
+static void hist_worker(void *arg) {
+	HistJob *job = arg;
+	const int rs = job->format.red_shift, gs = job->format.green_shift, bs = job->format.blue_shift;
+	for (int y = job->y0; y < job->y1; y++) {
+		const uint32_t *row = job->pixels + (size_t)y * (size_t)job->stride;
+		for (int x = 0; x < job->width; x++) {
+			uint32_t p = row[x];
+			uint32_t r = (p >> rs) & 0xFF, g = (p >> gs) & 0xFF, b = (p >> bs) & 0xFF;
+			Bin *bin = &job->bins[((r >> 3) << 10) | ((g >> 3) << 5) | (b >> 3)];
+			bin->count++;
+			bin->r += r;
+			bin->g += g;
+			bin->b += b;
+		}
+	}
+}
+
+/* Build the merged histogram into a new HIST_SIZE table */
+static Bin *build_histogram(WorkPool *pool, const uint32_t *pixels, int width, int height, int stride, const QuantizeFormat *format) {
+	int threads = workpool_size(pool);
+	if (threads > height / MIN_ROWS_PER_THREAD) {
+		threads = height / MIN_ROWS_PER_THREAD > 0 ? height / MIN_ROWS_PER_THREAD : 1;
+	}
+	Bin *tables = calloc((size_t)threads * HIST_SIZE, sizeof(Bin));
+	if (!tables) {
+		return NULL;
+	}
+	HistJob jobs[WORKPOOL_MAX_WORKERS];
+	for (int i = 0; i < threads; i++) {
+		jobs[i] = (HistJob){pixels, width, stride, height * i / threads, height * (i + 1) / threads, *format, tables + (size_t)i * HIST_SIZE};
+	}
+	workpool_parallel(pool, hist_worker, jobs, sizeof(HistJob), threads);
+
+	for (int t = 1; t < threads; t++) {
+		const Bin *src = tables + (size_t)t * HIST_SIZE;
+		for (int i = 0; i < HIST_SIZE; i++) {
+			if (src[i].count) {
+				tables[i].count += src[i].count;
+				tables[i].r += src[i].r;
+				tables[i].g += src[i].g;
+				tables[i].b += src[i].b;
+			}
+		}
+	}
+	return tables; // First table holds the sum
+}
+
+/* Convert occupied bins to OKLab points; returns -1 on allocation failure */
+static int histogram_to_points(const Bin *bins, Points *pts) {
+	int n = 0;
+	for (int i = 0; i < HIST_SIZE; i++) {
+		n += bins[i].count != 0;
+	}
+	float *mem = malloc((size_t)(n > 0 ? n : 1) * 4 * sizeof(float));
+	if (!mem) {
+		return -1;
+	}
+	pts->L = mem;
+	pts->a = mem + n;
+	pts->b = mem + 2 * n;
+	pts->weight = mem + 3 * n;
+	pts->count = 0;
+	for (int i = 0; i < HIST_SIZE; i++) {
+		if (!bins[i].count) {
+			continue;
+		}
+		double c = (double)bins[i].count * 255.0;
+		OKLab lab = rgb_to_oklab((RGBf){(double)bins[i].r / c, (double)bins[i].g / c, (double)bins[i].b / c});
+		int j = pts->count++;
+		pts->L[j] = (float)lab.L;
+		pts->a[j] = (float)lab.a;
+		pts->b[j] = (float)lab.b;
+		pts->weight[j] = (float)bins[i].count;
+	}
+	return 0;
+}
+
+/* ========== K-MEANS ========== */
+
+static float dist2(const Points *pts, int i, const float c[3]) {
+	float dl = pts->L[i] - c[0], da = pts->a[i] - c[1], db = pts->b[i] - c[2];
+	return dl * dl + da * da + db * db;
+}
+
+/* Greedy weighted seeding; returns the number of distinct seeds found */
+static int seed_centers(const Points *pts, int k, float centers[][3], float *nearest) {
+	int first = 0;
+	for (int i = 1; i < pts->count; i++) {
+		if (pts->weight[i] > pts->weight[first]) {
+			first = i;
+		}
+	}
+	centers[0][0] = pts->L[first];
+	centers[0][1] = pts->a[first];
+	centers[0][2] = pts->b[first];
+	for (int i = 0; i < pts->count; i++) {
+		nearest[i] = dist2(pts, i, centers[0]);
+	}
+	for (int c = 1; c < k; c++) {
+		int best = -1;
+		float best_score = 0.0f;
+		for (int i = 0; i < pts->count; i++) {
+			float score = pts->weight[i] * nearest[i];
+			if (score > best_score) {
+				best_score = score;
+				best = i;
+			}
+		}
+		if (best < 0) {
+			return c; // Every point already coincides with a seed
+		}
+		centers[c][0] = pts->L[best];
+		centers[c][1] = pts->a[best];
+		centers[c][2] = pts->b[best];
+		for (int i = 0; i < pts->count; i++) {
+			float d = dist2(pts, i, centers[c]);
+			if (d < nearest[i]) {
+				nearest[i] = d;
+			}
+		}
+	}
+	return k;
+}
+
+static void assign_worker(void *arg) {
+	AssignJob *job = arg;
+	const Points *pts = job->points;
+	memset(job->sum, 0, sizeof(job->sum));
+	memset(job->weight, 0, sizeof(job->weight));
+	job->changed = 0;
+	for (int i = job->begin; i < job->end; i++) {
+		int best = 0;
+		float best_d = dist2(pts, i, job->centers[0]);
+		for (int c = 1; c < job->k; c++) {
+			float d = dist2(pts, i, job->centers[c]);
+			if (d < best_d) {
+				best_d = d;
+				best = c;
+			}
+		}
+		if (job->assign[i] != best) {
+			job->assign[i] = best;
+			job->changed++;
+		}
+		double w = pts->weight[i];
+		job->sum[best][0] += w * pts->L[i];
+		job->sum[best][1] += w * pts->a[i];
+		job->sum[best][2] += w * pts->b[i];
+		job->weight[best] += w;
+	}
+}
+
+/* Cluster the points; fills centers and per-cluster weights, returns k used */
+static int kmeans(WorkPool *pool, const Points *pts, int k, float centers[][3], double weights[], AssignJob *jobs) {
+	float *nearest = malloc((size_t)pts->count * sizeof(float));
+	int *assign = malloc((size_t)pts->count * sizeof(int));
+	if (!nearest || !assign) {
+		free(nearest);
+		free(assign);
+		return -1;
+	}
+	k = seed_centers(pts, k, centers, nearest);
+	free(nearest);
+	for (int i = 0; i < pts->count; i++) {
+		assign[i] = -1;
+	}
+
+	int threads = pts->count / MIN_POINTS_PER_THREAD;
+	int cpus = workpool_size(pool);
+	threads = threads < 1 ? 1 : (threads > cpus ? cpus : threads);
+	for (int t = 0; t < threads; t++) {
+		jobs[t].points = pts;
+		jobs[t].begin = pts->count * t / threads;
+		jobs[t].end = pts->count * (t + 1) / threads;
+		jobs[t].centers = (const float (*)[3])centers;
+		jobs[t].k = k;
+		jobs[t].assign = assign;
+	}
+
+	for (int iter = 0; iter < MAX_ITERATIONS; iter++) {
+		workpool_parallel(pool, assign_worker, jobs, sizeof(AssignJob), threads);
+		int changed = 0;
+		for (int c = 0; c < k; c++) {
+			double s[3] = {0.0, 0.0, 0.0};
+			weights[c] = 0.0;
+			for (int t = 0; t < threads; t++) {
+				s[0] += jobs[t].sum[c][0];
+				s[1] += jobs[t].sum[c][1];
+				s[2] += jobs[t].sum[c][2];
+				weights[c] += jobs[t].weight[c];
+			}
+			if (weights[c] > 0.0) {
+				centers[c][0] = (float)(s[0] / weights[c]);
+				centers[c][1] = (float)(s[1] / weights[c]);
+				centers[c][2] = (float)(s[2] / weights[c]);
+			}
+		}
+		for (int t = 0; t < threads; t++) {
+			changed += jobs[t].changed;
+		}
+		if (!changed) {
+			break;
+		}
+	}
+	free(assign);
+	return k;
+}
+
+/* ========== EXTRACTION ========== */
+
+int quantize_dominant(WorkPool *pool, const uint32_t *pixels, int width, int height, int stride, const QuantizeFormat *format, int max_colors, QuantizeColor *out) {
+	if (!pixels || !format || !out || width <= 0 || height <= 0 || stride < width ||
+	    max_colors < 1 || max_colors > QUANTIZE_MAX_COLORS) {
+		return -1;
+	}
+	Bin *bins = build_histogram(pool, pixels, width, height, stride, format);
+	if (!bins) {
+		return -1;
+	}
+	Points pts;
+	int rc = histogram_to_points(bins, &pts);
+	free(bins);
+	if (rc != 0) {
+		return -1;
+	}
+
+	float centers[QUANTIZE_MAX_COLORS][3];
+	double weights[QUANTIZE_MAX_COLORS];
+	AssignJob *jobs = malloc(WORKPOOL_MAX_WORKERS * sizeof(AssignJob));
+	int k = jobs ? kmeans(pool, &pts, max_colors < pts.count ? max_colors : pts.count, centers, weights, jobs) : -1;
+	free(jobs);
+	free(pts.L);
+	if (k < 0) {
+		return -1;
+	}
+
+	// Emit non-empty clusters, most common first
+	double total = (double)width * (double)height;
+	int n = 0;
+	for (int c = 0; c < k; c++) {
+		if (weights[c] <= 0.0) {
+			continue;
+		}
+		OKLab lab = {centers[c][0], centers[c][1], centers[c][2]};
+		QuantizeColor qc = {rgbf_to_rgb8(oklab_to_rgb(lab)), weights[c] / total};
+		int j = n++;
+		while (j > 0 && out[j - 1].weight < qc.weight) {
+			out[j] = out[j - 1];
+			j--;
+		}
+		out[j] = qc;
+	}
+	return n;
+}
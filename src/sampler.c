@@ -0,0 +1,354 @@
+/* sampler.c - Screen Sampler Implementation
+ *
+ * Captures the bounding box of a set of areas and reads every sample from
+ * the captured pixels.
+ *
+ * Internal design notes:
+ * - One capture buffer of at most SAMPLER_TILE x SAMPLER_TILE pixels is
+ *   allocated and reused for every tile. Edge tiles are captured with their
+ *   origin pulled back inside the bounding box so the buffer size never
+ *   changes; only the part belonging to the tile is read.
+ * - Each area keeps running channel sums, so an area spanning several
+ *   tiles is averaged correctly without keeping earlier tiles around.
+ * - MIT-SHM attach can fail asynchronously (BadAccess on a remote server),
+ *   so it is attempted under a temporary error handler and XSync, and the
+ *   XGetImage/XGetSubImage path is used if anything goes wrong.
+ * - TrueColor pixels are decoded with the visual's channel masks; palette
+ *   visuals use a lookup table filled by one XQueryColors call.
+ */
+
+#include "sampler.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#include <X11/Xutil.h>
+#include <X11/extensions/XShm.h>
+
+/* Edge length of one capture tile (4 MiB at 32 bpp) */
+#define SAMPLER_TILE 1024
+
+/* One reusable capture buffer */
+typedef struct {
+	XImage *image;
+	XShmSegmentInfo shm;
+	int use_shm;
+} Capture;
+
+/* Pixel value to RGB8 conversion for the default visual */
+typedef struct {
+	int truecolor;
+	int shift[3];
+	unsigned long max[3];
+	RGB8 *lut; // Palette visuals: one entry per pixel value
+	unsigned long lut_size;
+} PixelDecoder;
+
+/* Running channel sums of one area */
+typedef struct {
+	uint64_t r, g, b;
+	uint64_t n;
+} Accum;
+
+/* ========== INTERNAL HELPERS ========== */
+
+static int shm_error = 0;
+
+static int shm_error_handler(Display *dpy, XErrorEvent *ev) {
+	(void)dpy;
+	(void)ev;
+	shm_error = 1;
+	return 0;
+}
+
+static void release_capture(Display *dpy, Capture *cap) {
+	if (cap->use_shm) {
+		XShmDetach(dpy, &cap->shm);
+		XSync(dpy, False);
+	}
+	if (cap->image) {
+		XDestroyImage(cap->image);
+		cap->image = NULL;
+	}
+	if (cap->use_shm) {
+		shmdt(cap->shm.shmaddr);
+		cap->use_shm = 0;
+	}
+}
+
+/* Set up a shared memory buffer and capture into it; returns 0 on success */
+static int create_shm_capture(Display *dpy, int screen, int x, int y, unsigned int w, unsigned int h, Capture *cap) {
+	if (!XShmQueryExtension(dpy)) {
+		return -1;
+	}
+	Visual *visual = DefaultVisual(dpy, screen);
+	unsigned int depth = (unsigned int)DefaultDepth(dpy, screen);
+	XImage *image = XShmCreateImage(dpy, visual, depth, ZPixmap, NULL, &cap->shm, w, h);
+	if (!image) {
+		return -1;
+	}
+	cap->shm.shmid = shmget(IPC_PRIVATE, (size_t)image->bytes_per_line * h, IPC_CREAT | 0600);
+	if (cap->shm.shmid < 0) {
+		XDestroyImage(image);
+		return -1;
+	}
+	cap->shm.shmaddr = image->data = shmat(cap->shm.shmid, NULL, 0);
+	// Mark for removal now; the segment lives until the last detach
+	shmctl(cap->shm.shmid, IPC_RMID, NULL);
+	if (cap->shm.shmaddr == (char *)-1) {
+		image->data = NULL;
+		XDestroyImage(image);
+		return -1;
+	}
+	cap->shm.readOnly = False;
+
+	shm_error = 0;
+	int (*old_handler)(Display *, XErrorEvent *) = XSetErrorHandler(shm_error_handler);
+	int attached = XShmAttach(dpy, &cap->shm) != 0;
+	XSync(dpy, False);
+	attached = attached && !shm_error;
+	int ok = attached && XShmGetImage(dpy, RootWindow(dpy, screen), image, x, y, AllPlanes);
+	XSync(dpy, False);
+	ok = ok && !shm_error;
+	XSetErrorHandler(old_handler);
+
+	cap->image = image;
+	cap->use_shm = 1;
+	if (!attached) {
+		// Never attached on the server side - just free locally
+		XDestroyImage(image);
+		shmdt(cap->shm.shmaddr);
+		cap->image = NULL;
+		cap->use_shm = 0;
+		return -1;
+	}
+	if (!ok) {
+		release_capture(dpy, cap);
+		return -1;
+	}
+	return 0;
+}
+
+/* Capture a w x h region at x,y, creating the buffer on first use */
+static int capture_tile(Display *dpy, int screen, int x, int y, unsigned int w, unsigned int h, Capture *cap) {
+	Window root = RootWindow(dpy, screen);
+	if (!cap->image) {
+		if (create_shm_capture(dpy, screen, x, y, w, h, cap) == 0) {
+			return 0;
+		}
+		cap->image = XGetImage(dpy, root, x, y, w, h, AllPlanes, ZPixmap);
+	}
+	else if (cap->use_shm) {
+		if (!XShmGetImage(dpy, root, cap->image, x, y, AllPlanes)) {
+			return -1;
+		}
+	}
+	else if (!XGetSubImage(dpy, root, x, y, w, h, AllPlanes, ZPixmap, cap->image, 0, 0)) {
+		return -1;
+	}
+	if (!cap->image) {
+		fprintf(stderr, "sampler: failed to capture %ux%u+%d+%d\n", w, h, x, y);
+		return -1;
+	}
+	return 0;
+}
+
+static int init_decoder(Display *dpy, int screen, PixelDecoder *dec) {
+	Visual *visual = DefaultVisual(dpy, screen);
+	memset(dec, 0, sizeof(*dec));
+	if (visual->class == TrueColor || visual->class == DirectColor) {
+		unsigned long masks[3] = {visual->red_mask, visual->green_mask, visual->blue_mask};
+		dec->truecolor = 1;
+		for (int c = 0; c < 3; c++) {
+			unsigned long mask = masks[c];
+			while (mask && !(mask & 1UL)) {
+				mask >>= 1;
+				dec->shift[c]++;
+			}
+			dec->max[c] = mask ? mask : 1;
+		}
+		return 0;
+	}
+	int depth = DefaultDepth(dpy, screen);
+	if (depth > 12) {
+		fprintf(stderr, "sampler: unsupported %d-bit palette visual\n", depth);
+		return -1;
+	}
+	dec->lut_size = 1UL << depth;
+	XColor *colors = calloc(dec->lut_size, sizeof(XColor));
+	dec->lut = calloc(dec->lut_size, sizeof(RGB8));
+	if (!colors || !dec->lut) {
+		free(colors);
+		free(dec->lut);
+		dec->lut = NULL;
+		return -1;
+	}
+	for (unsigned long i = 0; i < dec->lut_size; i++) {
+		colors[i].pixel = i;
+	}
+	XQueryColors(dpy, DefaultColormap(dpy, screen), colors, (int)dec->lut_size);
+	for (unsigned long i = 0; i < dec->lut_size; i++) {
+		dec->lut[i] = (RGB8){(uint8_t)(colors[i].red >> 8), (uint8_t)(colors[i].green >> 8), (uint8_t)(colors[i].blue >> 8)};
+	}
+	free(colors);
+	return 0;
+}
+
+static unsigned int decode_channel(unsigned long pixel, int shift, unsigned long max) {
+	return (unsigned int)((((pixel >> shift) & max) * 255UL + max / 2) / max);
+}
+
+/* Add the pixels of image area [x0,x1) x [y0,y1) to an accumulator */
+static void accumulate(const XImage *image, const PixelDecoder *dec, int x0, int y0, int x1, int y1, Accum *acc) {
+	uint16_t probe = 1;
+	int native = (*(uint8_t *)&probe ? LSBFirst : MSBFirst) == image->byte_order;
+	int direct = native && image->bits_per_pixel == 32;
+	for (int y = y0; y < y1; y++) {
+		const uint32_t *row = (const uint32_t *)(const void *)(image->data + (long)y * image->bytes_per_line);
+		for (int x = x0; x < x1; x++) {
+			unsigned long pixel = direct ? row[x] : XGetPixel((XImage *)image, x, y);
+			if (dec->truecolor) {
+				acc->r += decode_channel(pixel, dec->shift[0], dec->max[0]);
+				acc->g += decode_channel(pixel, dec->shift[1], dec->max[1]);
+				acc->b += decode_channel(pixel, dec->shift[2], dec->max[2]);
+			}
+			else {
+				RGB8 c = dec->lut[pixel < dec->lut_size ? pixel : 0];
+				acc->r += c.r;
+				acc->g += c.g;
+				acc->b += c.b;
+			}
+		}
+	}
+	acc->n += (uint64_t)(x1 - x0) * (uint64_t)(y1 - y0);
+}
+
+/* ========== PUBLIC API ========== */
+
+int sampler_sample_rects(Display *dpy, int screen, const SampleRect *rects, size_t count, int flags, SampleSink sink, void *user_data) {
+	if (!dpy || !rects || !sink) {
+		return -1;
+	}
+	if (count == 0) {
+		return 0;
+	}
+	int screen_w = DisplayWidth(dpy, screen);
+	int screen_h = DisplayHeight(dpy, screen);
+	SampleRect *areas = malloc(count * sizeof(SampleRect));
+	Accum *acc = calloc(count, sizeof(Accum));
+	PixelDecoder dec = {0};
+	Capture cap = {0};
+	int grabbed = 0;
+	int rc = -1;
+	if (!areas || !acc || init_decoder(dpy, screen, &dec) != 0) {
+		goto out;
+	}
+
+	// Clip every area to the screen and find the bounding box
+	int bx0 = screen_w, by0 = screen_h, bx1 = 0, by1 = 0;
+	for (size_t i = 0; i < count; i++) {
+		SampleRect r = rects[i];
+		r.width = r.width > 0 ? r.width : 1;
+		r.height = r.height > 0 ? r.height : 1;
+		if (!(flags & SAMPLER_AVERAGE)) {
+			r = (SampleRect){r.x + r.width / 2, r.y + r.height / 2, 1, 1};
+		}
+		int x0 = r.x < 0 ? 0 : r.x;
+		int y0 = r.y < 0 ? 0 : r.y;
+		int x1 = r.x + r.width > screen_w ? screen_w : r.x + r.width;
+		int y1 = r.y + r.height > screen_h ? screen_h : r.y + r.height;
+		if (x0 >= x1 || y0 >= y1) {
+			fprintf(stderr, "sampler: area %dx%d+%d+%d is off screen (%dx%d)\n", rects[i].width, rects[i].height, rects[i].x, rects[i].y, screen_w, screen_h);
+			goto out;
+		}
+		areas[i] = (SampleRect){x0, y0, x1 - x0, y1 - y0};
+		bx0 = x0 < bx0 ? x0 : bx0;
+		by0 = y0 < by0 ? y0 : by0;
+		bx1 = x1 > bx1 ? x1 : bx1;
+		by1 = y1 > by1 ? y1 : by1;
+	}
+
+	int tile_w = bx1 - bx0 < SAMPLER_TILE ? bx1 - bx0 : SAMPLER_TILE;
+	int tile_h = by1 - by0 < SAMPLER_TILE ? by1 - by0 : SAMPLER_TILE;
+	if (tile_w < bx1 - bx0 || tile_h < by1 - by0) {
+		// Several tiles: keep the screen still until the last one is read
+		XGrabServer(dpy);
+		grabbed = 1;
+	}
+	for (int ty = by0; ty < by1; ty += tile_h) {
+		int ty1 = ty + tile_h < by1 ? ty + tile_h : by1;
+		for (int tx = bx0; tx < bx1; tx += tile_w) {
+			int tx1 = tx + tile_w < bx1 ? tx + tile_w : bx1;
+			// Capture origin, pulled back so the full buffer stays in the box
+			int cx = tx + tile_w > bx1 ? bx1 - tile_w : tx;
+			int cy = ty + tile_h > by1 ? by1 - tile_h : ty;
+			int captured = 0;
+			for (size_t i = 0; i < count; i++) {
+				const SampleRect *a = &areas[i];
+				int x0 = a->x > tx ? a->x : tx;
+				int y0 = a->y > ty ? a->y : ty;
+				int x1 = a->x + a->width < tx1 ? a->x + a->width : tx1;
+				int y1 = a->y + a->height < ty1 ? a->y + a->height : ty1;
+				if (x0 >= x1 || y0 >= y1) {
+					continue;
+				}
+				if (!captured) {
+					if (capture_tile(dpy, screen, cx, cy, (unsigned int)tile_w, (unsigned int)tile_h, &cap) != 0) {
+						goto out;
+					}
+					captured = 1;
+				}
+				accumulate(cap.image, &dec, x0 - cx, y0 - cy, x1 - cx, y1 - cy, &acc[i]);
+			}
+		}
+	}
+	if (grabbed) {
+		XUngrabServer(dpy);
+		XFlush(dpy);
+		grabbed = 0;
+	}
+	release_capture(dpy, &cap);
+
+	for (size_t i = 0; i < count; i++) {
+		uint64_t n = acc[i].n ? acc[i].n : 1;
+		RGB8 color = {(uint8_t)((acc[i].r + n / 2) / n), (uint8_t)((acc[i].g + n / 2) / n), (uint8_t)((acc[i].b + n / 2) / n)};
+		if (sink(i, &rects[i], color, user_data) != 0) {
+			break;
+		}
+	}
+	rc = 0;
+out:
+	if (grabbed) {
+		XUngrabServer(dpy);
+		XFlush(dpy);
+	}
+	release_capture(dpy, &cap);
+	free(dec.lut);
+	free(areas);
+	free(acc);
+	return rc;
+}
+
+static int store_sample(size_t index, const SampleRect *rect, RGB8 color, void *user_data) {
+	(void)rect;
+	((RGB8 *)user_data)[index] = color;
+	return 0;
+}
+
+int sampler_sample_points(Display *dpy, int screen, const SamplePoint *points, size_t count, RGB8 *out) {
+	if (!points || !out) {
+		return -1;
+	}
+	SampleRect *rects = malloc((count ? count : 1) * sizeof(SampleRect));
+	if (!rects) {
+		return -1;
+	}
+	for (size_t i = 0; i < count; i++) {
+		rects[i] = (SampleRect){points[i].x, points[i].y, 1, 1};
+	}
+	int rc = sampler_sample_rects(dpy, screen, rects, count, 0, store_sample, out);
+	free(rects);
+	return rc;
+}
@@ -0,0 +1,99 @@
+#ifndef SAMPLER_H_
+#define SAMPLER_H_
+
+/* ========== SCREEN SAMPLER INTERFACE ========== */
+
+/**
+ * @file sampler.h
+ * @brief Read the colors of many screen points or areas from a single capture
+ *
+ * Fetching pixels one XGetImage(1x1) at a time costs a server round trip per
+ * point, and the points are not sampled at the same instant. The sampler
+ * instead captures the bounding box of all requested points and rectangles
+ * once and reads every sample from that image.
+ *
+ * The capture uses the MIT-SHM extension when the server offers it (the
+ * image is written straight into shared memory instead of being copied
+ * through the socket) and falls back to XGetImage otherwise, e.g. on remote
+ * displays. Bounding boxes larger than one tile are captured tile by tile
+ * into a single reused buffer while the server is grabbed, so memory stays
+ * bounded and all tiles still show the same instant. Tiles that contain no
+ * requested area are not captured at all.
+ *
+ * Dependencies:
+ * - X11, XShm (libXext)
+ * - colormath.h (RGB8 type)
+ *
+ * Usage:
+ *   SampleRect areas[] = {{10, 20, 1, 1}, {300, 40, 16, 16}};
+ *   sampler_sample_rects(display, DefaultScreen(display), areas, 2,
+ *                        SAMPLER_AVERAGE, sink, user_data);
+ *
+ * Thread safety: Not thread-safe (uses the caller's Display)
+ */
+
+#include <stddef.h>
+#include <X11/Xlib.h>
+#include "colormath.h"
+
+/* ========== TYPE DEFINITIONS ========== */
+
+/* Screen coordinate in root window space */
+typedef struct {
+	int x;
+	int y;
+} SamplePoint;
+
+/* Screen area in root window space (a point is a 1x1 area) */
+typedef struct {
+	int x;
+	int y;
+	int width;
+	int height;
+} SampleRect;
+
+/* Flags for sampler_sample_rects() */
+#define SAMPLER_AVERAGE 0x1 /* Mean color of each area instead of its center pixel */
+
+/**
+ * Result callback, called once per requested area in input order
+ * @param index Index of the area in the input array
+ * @param rect The area as requested
+ * @param color Sampled color
+ * @param user_data User data passed to sampler_sample_rects()
+ * @return 0 to continue, non-zero to stop early
+ */
+typedef int (*SampleSink)(size_t index, const SampleRect *rect, RGB8 color, void *user_data);
+
+/* ========== SAMPLING ========== */
+
+/**
+ * @brief Sample a set of screen areas from one capture
+ * @param dpy X11 display connection
+ * @param screen Screen number
+ * @param rects Areas to sample (root window coordinates); areas partly off
+ *              screen are clipped
+ * @param count Number of areas
+ * @param flags SAMPLER_AVERAGE or 0
+ * @param sink Receives each result; called after the capture has finished
+ *             and the server grab has been released
+ * @param user_data Passed to sink
+ *
+ * @return 0 on success, -1 if an area lies entirely off screen or the
+ *         capture fails
+ */
+int sampler_sample_rects(Display *dpy, int screen, const SampleRect *rects, size_t count, int flags, SampleSink sink, void *user_data);
+
+/**
+ * @brief Sample a set of screen points from one capture
+ * @param dpy X11 display connection
+ * @param screen Screen number
+ * @param points Points to sample (root window coordinates)
+ * @param count Number of points
+ * @param out Receives one color per point, in input order
+ *
+ * @return 0 on success, -1 if a point lies off screen or the capture fails
+ */
+int sampler_sample_points(Display *dpy, int screen, const SamplePoint *points, size_t count, RGB8 *out);
+
+#endif /* SAMPLER_H_ */
@@ -0,0 +1,343 @@
+/* statspanel.c - Region Statistics Panel Implementation
+ *
+ * Floating window listing the statistics of a dragged screen region, with
+ * luma and hue histograms.
+ *
+ * Internal design notes:
+ * - The window, its back pixmap and the GC are created once and reused;
+ *   a theme change only resizes them. Exposes copy the back pixmap.
+ * - An update redraws the text into the back pixmap and copies the
+ *   histogram pixmap under it. The histogram pixmap is only repainted when
+ *   the bins differ from the last ones drawn, so dragging across a flat
+ *   area re-renders nothing but the numbers.
+ * - Luma bars share one XFillRectangles call. Hue bars are filled in the
+ *   color of their bin, whose pixels are allocated once at creation.
+ * - The panel is positioned beside the parent window when it is mapped and
+ *   then left alone, so it does not jump around during a drag.
+ */
+
+#include "statspanel.h"
+#include "colormath.h"
+#include <X11/Xft/Xft.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* ========== INTERNAL CONSTANTS ========== */
+
+#define PANEL_PADDING 10
+#define PANEL_GAP 8          // Distance from the parent window
+#define COLUMN_GAP 12
+#define LUMA_BAR_WIDTH 4
+#define HUE_BAR_WIDTH 7
+#define HIST_WIDTH (REGION_STATS_LUMA_BINS * LUMA_BAR_WIDTH)
+#define HIST_HEIGHT 40
+#define TEXT_ROWS 6          // Geometry, totals, header, R, G, B
+
+/* ========== INTERNAL STRUCTURE ========== */
+
+struct StatsPanel {
+	Display *dpy;
+	int screen;
+	Window parent;
+	Window win;
+	Pixmap buffer;       // Whole panel
+	Pixmap hist;         // Both histograms, HIST_WIDTH x 2 * HIST_HEIGHT
+	GC gc;
+	XftDraw *draw;
+	XftFont *font;
+	XftColor xft_fg;
+	unsigned long bg_pixel;
+	unsigned long fg_pixel;
+	unsigned long hue_pixels[REGION_STATS_HUE_BINS];
+	int width, height;
+	int line_height;
+	int label_width;     // "R", "G", "B" column
+	int column_width;    // Each numeric column
+	int visible;
+	int hist_valid;
+	unsigned long drawn_luma[REGION_STATS_LUMA_BINS];
+	unsigned long drawn_hue[REGION_STATS_HUE_BINS];
+};
+
+/* ========== INTERNAL HELPERS ========== */
+
+static unsigned short comp(double v) {
+	int iv = (int)(v * 65535.0);
+	if (iv < 0) iv = 0;
+	if (iv > 65535) iv = 65535;
+	return (unsigned short)iv;
+}
+
+static int text_width(const StatsPanel *panel, const char *s) {
+	XGlyphInfo extents;
+	XftTextExtentsUtf8(panel->dpy, panel->font, (const FcChar8 *)s, (int)strlen(s), &extents);
+	return extents.xOff;
+}
+
+static void draw_text(StatsPanel *panel, int x, int row_y, const char *s) {
+	XftDrawStringUtf8(panel->draw, &panel->xft_fg, panel->font, x, row_y + panel->font->ascent, (const FcChar8 *)s, (int)strlen(s));
+}
+
+/* Right-align s in numeric column col */
+static void draw_cell(StatsPanel *panel, int col, int row_y, const char *s) {
+	int right = PANEL_PADDING + panel->label_width + (col + 1) * (panel->column_width + COLUMN_GAP);
+	draw_text(panel, right - text_width(panel, s), row_y, s);
+}
+
+/* Vertical offset of the histogram block inside the panel */
+static int hist_top(const StatsPanel *panel) {
+	return PANEL_PADDING + (TEXT_ROWS + 1) * panel->line_height;
+}
+
+/* Release theme-dependent resources */
+static void release_theme(StatsPanel *panel) {
+	if (panel->draw) {
+		XftDrawDestroy(panel->draw);
+		panel->draw = NULL;
+	}
+	if (panel->buffer) {
+		XFreePixmap(panel->dpy, panel->buffer);
+		panel->buffer = None;
+	}
+	if (panel->font) {
+		XftFontClose(panel->dpy, panel->font);
+		panel->font = NULL;
+		XftColorFree(panel->dpy, DefaultVisual(panel->dpy, panel->screen), DefaultColormap(panel->dpy, panel->screen), &panel->xft_fg);
+	}
+}
+
+/* Load font and colors and size the panel from them */
+static void apply_theme(StatsPanel *panel, const MiniTheme *theme) {
+	release_theme(panel);
+	panel->bg_pixel = config_color_to_pixel(panel->dpy, panel->screen, theme->main.background);
+	panel->fg_pixel = config_color_to_pixel(panel->dpy, panel->screen, theme->main.text_color);
+	panel->font = config_open_font(panel->dpy, panel->screen, theme->main.font_family, theme->main.font_size);
+	XRenderColor xr;
+	xr.red = comp(theme->main.text_color.r);
+	xr.green = comp(theme->main.text_color.g);
+	xr.blue = comp(theme->main.text_color.b);
+	xr.alpha = comp(theme->main.text_color.a);
+	XftColorAllocValue(panel->dpy, DefaultVisual(panel->dpy, panel->screen), DefaultColormap(panel->dpy, panel->screen), &xr, &panel->xft_fg);
+
+	panel->line_height = panel->font->ascent + panel->font->descent + 4;
+	panel->label_width = text_width(panel, "G");
+	int w1 = text_width(panel, "Std dev"), w2 = text_width(panel, "255.00");
+	panel->column_width = w1 > w2 ? w1 : w2;
+	int text_w = panel->label_width + 4 * (panel->column_width + COLUMN_GAP);
+	panel->width = 2 * PANEL_PADDING + (text_w > HIST_WIDTH ? text_w : HIST_WIDTH);
+	panel->height = hist_top(panel) + 2 * HIST_HEIGHT + panel->line_height + PANEL_PADDING;
+
+	XResizeWindow(panel->dpy, panel->win, (unsigned int)panel->width, (unsigned int)panel->height);
+	XSetWindowBackground(panel->dpy, panel->win, panel->bg_pixel);
+	XSetWindowBorder(panel->dpy, panel->win, panel->fg_pixel);
+	panel->buffer = XCreatePixmap(panel->dpy, panel->win, (unsigned int)panel->width, (unsigned int)panel->height, (unsigned int)DefaultDepth(panel->dpy, panel->screen));
+	panel->draw = XftDrawCreate(panel->dpy, panel->buffer, DefaultVisual(panel->dpy, panel->screen), DefaultColormap(panel->dpy, panel->screen));
+	XSetForeground(panel->dpy, panel->gc, panel->bg_pixel);
+	XFillRectangle(panel->dpy, panel->buffer, panel->gc, 0, 0, (unsigned int)panel->width, (unsigned int)panel->height);
+	panel->hist_valid = 0;
+}
+
+/* Bar height for a bin, at least one pixel when the bin is not empty */
+static unsigned short bar_height(unsigned long count, unsigned long peak) {
+	if (!count || !peak) {
+		return 0;
+	}
+	unsigned long h = count * HIST_HEIGHT / peak;
+	return (unsigned short)(h > 0 ? h : 1);
+}
+
+static void render_histograms(StatsPanel *panel, const RegionStats *stats) {
+	XSetForeground(panel->dpy, panel->gc, panel->bg_pixel);
+	XFillRectangle(panel->dpy, panel->hist, panel->gc, 0, 0, HIST_WIDTH, 2 * HIST_HEIGHT);
+
+	unsigned long peak = 0;
+	for (int i = 0; i < REGION_STATS_LUMA_BINS; i++) {
+		peak = stats->luma[i] > peak ? stats->luma[i] : peak;
+	}
+	XRectangle bars[REGION_STATS_LUMA_BINS];
+	int n = 0;
+	for (int i = 0; i < REGION_STATS_LUMA_BINS; i++) {
+		unsigned short h = bar_height(stats->luma[i], peak);
+		if (h) {
+			bars[n++] = (XRectangle){(short)(i * LUMA_BAR_WIDTH), (short)(HIST_HEIGHT - h), LUMA_BAR_WIDTH, h};
+		}
+	}
+	XSetForeground(panel->dpy, panel->gc, panel->fg_pixel);
+	XFillRectangles(panel->dpy, panel->hist, panel->gc, bars, n);
+
+	peak = 0;
+	for (int i = 0; i < REGION_STATS_HUE_BINS; i++) {
+		peak = stats->hue[i] > peak ? stats->hue[i] : peak;
+	}
+	for (int i = 0; i < REGION_STATS_HUE_BINS; i++) {
+		unsigned short h = bar_height(stats->hue[i], peak);
+		if (h) {
+			XSetForeground(panel->dpy, panel->gc, panel->hue_pixels[i]);
+			XFillRectangle(panel->dpy, panel->hist, panel->gc, i * HUE_BAR_WIDTH, 2 * HIST_HEIGHT - h, HUE_BAR_WIDTH, h);
+		}
+	}
+	memcpy(panel->drawn_luma, stats->luma, sizeof(panel->drawn_luma));
+	memcpy(panel->drawn_hue, stats->hue, sizeof(panel->drawn_hue));
+	panel->hist_valid = 1;
+}
+
+/* Place the panel beside the parent, on whichever side has room */
+static void place_beside_parent(StatsPanel *panel) {
+	XWindowAttributes attrs;
+	Window child;
+	int px = 0, py = 0;
+	if (!XGetWindowAttributes(panel->dpy, panel->parent, &attrs) ||
+	    !XTranslateCoordinates(panel->dpy, panel->parent, RootWindow(panel->dpy, panel->screen), 0, 0, &px, &py, &child)) {
+		return;
+	}
+	int x = px + attrs.width + PANEL_GAP;
+	if (x + panel->width > DisplayWidth(panel->dpy, panel->screen)) {
+		x = px - panel->width - PANEL_GAP;
+	}
+	int y = py;
+	if (y + panel->height > DisplayHeight(panel->dpy, panel->screen)) {
+		y = DisplayHeight(panel->dpy, panel->screen) - panel->height;
+	}
+	XMoveWindow(panel->dpy, panel->win, x > 0 ? x : 0, y > 0 ? y : 0);
+}
+
+/* ========== LIFECYCLE MANAGEMENT ========== */
+
+StatsPanel *statspanel_create(Display *dpy, Window parent, const MiniTheme *theme) {
+	if (!dpy || !theme) {
+		return NULL;
+	}
+	StatsPanel *panel = calloc(1, sizeof(StatsPanel));
+	if (!panel) {
+		return NULL;
+	}
+	panel->dpy = dpy;
+	panel->screen = DefaultScreen(dpy);
+	panel->parent = parent;
+
+	XSetWindowAttributes attrs;
+	attrs.override_redirect = True;
+	attrs.event_mask = ExposureMask | ButtonPressMask;
+	panel->win = XCreateWindow(dpy, RootWindow(dpy, panel->screen), 0, 0, 1, 1, 1, CopyFromParent, InputOutput, CopyFromParent, CWOverrideRedirect | CWEventMask, &attrs);
+	panel->gc = XCreateGC(dpy, panel->win, 0, NULL);
+	panel->hist = XCreatePixmap(dpy, panel->win, HIST_WIDTH, 2 * HIST_HEIGHT, (unsigned int)DefaultDepth(dpy, panel->screen));
+
+	// Bin colors: fully saturated hue at the middle of each bin
+	for (int i = 0; i < REGION_STATS_HUE_BINS; i++) {
+		RGBf rgb = hsv_to_rgb((HSV){(i + 0.5) * 360.0 / REGION_STATS_HUE_BINS, 1.0, 1.0});
+		panel->hue_pixels[i] = config_color_to_pixel(dpy, panel->screen, (ConfigColor){rgb.r, rgb.g, rgb.b, 1.0});
+	}
+	apply_theme(panel, theme);
+	return panel;
+}
+
+void statspanel_destroy(StatsPanel *panel) {
+	if (!panel) {
+		return;
+	}
+	release_theme(panel);
+	XFreePixmap(panel->dpy, panel->hist);
+	XFreeGC(panel->dpy, panel->gc);
+	XDestroyWindow(panel->dpy, panel->win);
+	free(panel);
+}
+
+void statspanel_set_theme(StatsPanel *panel, const MiniTheme *theme) {
+	if (!panel || !theme) {
+		return;
+	}
+	apply_theme(panel, theme);
+	if (panel->visible) {
+		// Numbers are gone with the old buffer; close rather than show a blank panel
+		statspanel_hide(panel);
+	}
+}
+
+/* ========== DISPLAY ========== */
+
+void statspanel_update(StatsPanel *panel, const RegionStats *stats, int x, int y, int width, int height) {
+	if (!panel || !stats) {
+		return;
+	}
+	XSetForeground(panel->dpy, panel->gc, panel->bg_pixel);
+	XFillRectangle(panel->dpy, panel->buffer, panel->gc, 0, 0, (unsigned int)panel->width, (unsigned int)panel->height);
+
+	char buf[96];
+	int row = PANEL_PADDING;
+	snprintf(buf, sizeof(buf), "%d x %d at %d, %d", width, height, x, y);
+	draw_text(panel, PANEL_PADDING, row, buf);
+	row += panel->line_height;
+	snprintf(buf, sizeof(buf), "%lu pixels, %lu colors", stats->pixels, stats->unique_colors);
+	draw_text(panel, PANEL_PADDING, row, buf);
+	row += panel->line_height;
+
+	static const char *headers[] = {"Mean", "Min", "Max", "Std dev"};
+	for (int col = 0; col < 4; col++) {
+		draw_cell(panel, col, row, headers[col]);
+	}
+	row += panel->line_height;
+	static const char *channels[] = {"R", "G", "B"};
+	for (int c = 0; c < 3; c++) {
+		draw_text(panel, PANEL_PADDING, row, channels[c]);
+		snprintf(buf, sizeof(buf), "%.2f", stats->mean[c]);
+		draw_cell(panel, 0, row, buf);
+		snprintf(buf, sizeof(buf), "%u", stats->min[c]);
+		draw_cell(panel, 1, row, buf);
+		snprintf(buf, sizeof(buf), "%u", stats->max[c]);
+		draw_cell(panel, 2, row, buf);
+		snprintf(buf, sizeof(buf), "%.2f", stats->stddev[c]);
+		draw_cell(panel, 3, row, buf);
+		row += panel->line_height;
+	}
+
+	// Histograms: luma, then a caption line, then hue
+	if (!panel->hist_valid || memcmp(panel->drawn_luma, stats->luma, sizeof(panel->drawn_luma)) != 0 || memcmp(panel->drawn_hue, stats->hue, sizeof(panel->drawn_hue)) != 0) {
+		render_histograms(panel, stats);
+	}
+	int top = hist_top(panel);
+	draw_text(panel, PANEL_PADDING, top - panel->line_height, "Luminance");
+	XCopyArea(panel->dpy, panel->hist, panel->buffer, panel->gc, 0, 0, HIST_WIDTH, HIST_HEIGHT, PANEL_PADDING, top);
+	snprintf(buf, sizeof(buf), "Hue (%.0f%% neutral)", stats->pixels ? 100.0 * (double)stats->neutral / (double)stats->pixels : 0.0);
+	draw_text(panel, PANEL_PADDING, top + HIST_HEIGHT, buf);
+	XCopyArea(panel->dpy, panel->hist, panel->buffer, panel->gc, 0, HIST_HEIGHT, HIST_WIDTH, HIST_HEIGHT, PANEL_PADDING, top + HIST_HEIGHT + panel->line_height);
+
+	if (!panel->visible) {
+		place_beside_parent(panel);
+		XMapRaised(panel->dpy, panel->win);
+		panel->visible = 1;
+	}
+	XCopyArea(panel->dpy, panel->buffer, panel->win, panel->gc, 0, 0, (unsigned int)panel->width, (unsigned int)panel->height, 0, 0);
+	XFlush(panel->dpy);
+}
+
+void statspanel_hide(StatsPanel *panel) {
+	if (!panel || !panel->visible) {
+		return;
+	}
+	XUnmapWindow(panel->dpy, panel->win);
+	panel->visible = 0;
+}
+
+int statspanel_is_visible(const StatsPanel *panel) {
+	return panel ? panel->visible : 0;
+}
+
+/* ========== EVENT HANDLING ========== */
+
+int statspanel_handle_event(StatsPanel *panel, XEvent *ev) {
+	if (!panel || ev->xany.window != panel->win) {
+		return 0;
+	}
+	switch (ev->type) {
+		case Expose:
+			if (ev->xexpose.count == 0) {
+				XCopyArea(panel->dpy, panel->buffer, panel->win, panel->gc, 0, 0, (unsigned int)panel->width, (unsigned int)panel->height, 0, 0);
+			}
+			return 1;
+		case ButtonPress:
+			statspanel_hide(panel);
+			return 1;
+	}
+	return 1;
+}
@@ -0,0 +1,102 @@
+#ifndef STATSPANEL_H_
+#define STATSPANEL_H_
+
+/* ========== REGION STATISTICS PANEL INTERFACE ========== */
+
+/**
+ * @file statspanel.h
+ * @brief Floating panel showing the statistics of a screen region
+ *
+ * An override-redirect window placed beside the main window. It lists the
+ * region's geometry, per-channel mean/min/max/standard deviation and
+ * distinct color count above a luma histogram and a hue histogram. The
+ * whole panel is rendered into a back pixmap when the statistics change,
+ * so exposes are a single copy and repeated updates during a drag do not
+ * flicker. Clicking the panel closes it.
+ *
+ * Dependencies:
+ * - X11 (Xlib, Xft)
+ * - config.h (theme colors and fonts)
+ * - regionstats.h (RegionStats)
+ *
+ * Usage:
+ *   StatsPanel *panel = statspanel_create(display, main_window, &theme);
+ *   statspanel_update(panel, &stats, x, y, width, height);
+ *   ...
+ *   if (statspanel_handle_event(panel, &event)) continue;
+ *   statspanel_destroy(panel);
+ *
+ * Thread safety: Not thread-safe (uses X11 APIs)
+ * Memory: Caller must call statspanel_destroy() to free resources
+ */
+
+#include <X11/Xlib.h>
+#include "config.h"
+#include "regionstats.h"
+
+/* ========== TYPE DEFINITIONS ========== */
+
+typedef struct StatsPanel StatsPanel;
+
+/* ========== LIFECYCLE MANAGEMENT ========== */
+
+/**
+ * @brief Create a hidden statistics panel
+ * @param dpy X11 display connection
+ * @param parent Window the panel is placed beside
+ * @param theme Theme providing the [main] colors and font
+ *
+ * @return New panel, or NULL on failure
+ */
+StatsPanel *statspanel_create(Display *dpy, Window parent, const MiniTheme *theme);
+
+/**
+ * @brief Destroy the panel and free its resources
+ * @param panel Panel (may be NULL)
+ */
+void statspanel_destroy(StatsPanel *panel);
+
+/**
+ * @brief Apply a new theme
+ * @param panel Panel
+ * @param theme Theme providing the [main] colors and font
+ */
+void statspanel_set_theme(StatsPanel *panel, const MiniTheme *theme);
+
+/* ========== DISPLAY ========== */
+
+/**
+ * @brief Show statistics, mapping the panel if it is hidden
+ * @param panel Panel
+ * @param stats Statistics to display
+ * @param x Region left edge in root coordinates
+ * @param y Region top edge in root coordinates
+ * @param width Region width
+ * @param height Region height
+ */
+void statspanel_update(StatsPanel *panel, const RegionStats *stats, int x, int y, int width, int height);
+
+/**
+ * @brief Hide the panel
+ * @param panel Panel
+ */
+void statspanel_hide(StatsPanel *panel);
+
+/**
+ * @brief Check whether the panel is on screen
+ * @param panel Panel
+ * @return 1 if visible, 0 otherwise
+ */
+int statspanel_is_visible(const StatsPanel *panel);
+
+/* ========== EVENT HANDLING ========== */
+
+/**
+ * @brief Process an X event for the panel
+ * @param panel Panel
+ * @param ev Event
+ * @return 1 if the event belonged to the panel, 0 otherwise
+ */
+int statspanel_handle_event(StatsPanel *panel, XEvent *ev);
+
+#endif /* STATSPANEL_H_ */
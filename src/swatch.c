@@ -8,6 +8,17 @@
  * - Swatch is a child window with its own GC to avoid flickering.
  * - Checkerboard background is precomputed into a Pixmap for reuse.
  * - Border mode changes trigger a redraw but no geometry changes.
+ * - The fill and border GCs live as long as the widget, and the size comes
+ *   from the stored geometry rather than XGetWindowAttributes.
+ * - The shape mask is rebuilt only when (width, height, radius, border)
+ *   changes, and the harmony border pixel (which needs XQueryColor and
+ *   XAllocColor round trips) only when the swatch color, main background or
+ *   border mode changes. A color change costs a fill, an outline and a swap.
+ * - Created with a compositor, the docked swatch has no window: it is a
+ *   node painted into the shared back buffer (its rounded corners need no
+ *   shape there) and presses arrive on the node's input id. Tearing it off
+ *   hides the node and floats a temporary shaped window under the pointer
+ *   until the button is released.
  *
  * Features:
  * - Automatic contrast-based border selection
@@ -49,13 +60,36 @@ struct SwatchContext {
 
 	int border_width;
 	int border_radius;
+
+	// Compositor node when docked in a shared back buffer. swatch_window is
+	// then None except while dragging; input_win is what presses arrive on.
+	Compositor *comp;
+	int node;
+	Window input_win;
 	
 	// DBE support
 	DbeContext *dbe_ctx;
 	XdbeBackBuffer dbe_back_buffer;
 	int use_dbe; // 1 if DBE is available and initialized
+
+	// Persistent drawing state
+	GC fill_gc;
+	GC border_gc;
+
+	// Shape mask currently applied to the window
+	int shape_valid;
+	int shape_w, shape_h, shape_radius, shape_border;
+
+	// Cached harmony border pixel and the inputs it was computed from
+	int border_valid;
+	unsigned long border_px;
+	unsigned long border_for_pixel;
+	unsigned long border_for_bg;
+	BorderMode border_for_mode;
 };
 
+static void swatch_paint(Drawable target, int x, int y, void *user_data);
+
 /* ========== CURSOR HELPERS ========== */
 
 static void cursor_invisible(SwatchContext *ctx) {
@@ -183,7 +217,7 @@ static unsigned long enhanced_border_color(Display *dpy, int screen, unsigned lo
 
 /* ========== ROUNDED RECTANGLE DRAWING ========== */
 
-static void draw_rounded_rect(Display *dpy, Drawable d, GC gc, int x, int y, int w, int h, int radius) {
+void swatch_draw_rounded_rect(Display *dpy, Drawable d, GC gc, int x, int y, int w, int h, int radius) {
 	if (radius <= 0 || radius * 2 > w || radius * 2 > h) {
 		XDrawRectangle(dpy, d, gc, x, y, (unsigned int)(w - 1), (unsigned int)(h - 1));
 		return;
@@ -205,7 +239,7 @@ static void draw_rounded_rect(Display *dpy, Drawable d, GC gc, int x, int y, int
 
 /* ========== FILLED ROUNDED RECTANGLE FOR SHAPE MASK ========== */
 
-static void fill_rounded_rect(Display *dpy, Drawable d, GC gc, int x, int y, int w, int h, int radius) {
+void swatch_fill_rounded_rect(Display *dpy, Drawable d, GC gc, int x, int y, int w, int h, int radius) {
 	if (radius <= 0 || radius * 2 > w || radius * 2 > h) {
 		XFillRectangle(dpy, d, gc, x, y, (unsigned int)w, (unsigned int)h);
 		return;
@@ -215,17 +249,17 @@ static void fill_rounded_rect(Display *dpy, Drawable d, GC gc, int x, int y, int
 	if (w > 2 && h > 2) {
 		XFillRectangle(dpy, d, gc, x + 1, y + 1, (unsigned int)(w - 2), (unsigned int)(h - 2));
 	}
-	// Draw the EXACT same outline as draw_rounded_rect using XDrawArc and XDrawLine
+	// Draw the EXACT same outline as swatch_draw_rounded_rect() using XDrawArc and XDrawLine
 	// This ensures the shape mask includes precisely the pixels the border touches
 	XSetLineAttributes(dpy, gc, 1, LineSolid, CapButt, JoinMiter);
 
-	// Draw four arcs for corners - IDENTICAL to draw_rounded_rect
+	// Draw four arcs for corners - IDENTICAL to swatch_draw_rounded_rect()
 	XDrawArc(dpy, d, gc, x, y, (unsigned int)diameter, (unsigned int)diameter, 90 * 64, 90 * 64);
 	XDrawArc(dpy, d, gc, x + w - diameter - 1, y, (unsigned int)diameter, (unsigned int)diameter, 0, 90 * 64);
 	XDrawArc(dpy, d, gc, x, y + h - diameter - 1, (unsigned int)diameter, (unsigned int)diameter, 180 * 64, 90 * 64);
 	XDrawArc(dpy, d, gc, x + w - diameter - 1, y + h - diameter - 1, (unsigned int)diameter, (unsigned int)diameter, 270 * 64, 90 * 64);
 
-	// Draw four lines connecting the arcs - IDENTICAL to draw_rounded_rect
+	// Draw four lines connecting the arcs - IDENTICAL to swatch_draw_rounded_rect()
 	XDrawLine(dpy, d, gc, x + radius, y, x + w - radius - 1, y);
 	XDrawLine(dpy, d, gc, x + w - 1, y + radius, x + w - 1, y + h - radius - 1);
 	XDrawLine(dpy, d, gc, x + w - radius - 1, y + h - 1, x + radius, y + h - 1);
@@ -235,7 +269,13 @@ static void fill_rounded_rect(Display *dpy, Drawable d, GC gc, int x, int y, int
 /* ========== APPLY ROUNDED CORNER SHAPE TO WINDOW ========== */
 
 static void apply_window_shape(SwatchContext *ctx) {
-	if (!ctx) {
+	if (!ctx || !ctx->swatch_window) {
+		return;
+	}
+	int w = ctx->swatch_width;
+	int h = ctx->swatch_height;
+	// The window keeps its shape; only rebuild it when the key changes
+	if (ctx->shape_valid && ctx->shape_w == w && ctx->shape_h == h && ctx->shape_radius == ctx->border_radius && ctx->shape_border == ctx->border_width) {
 		return;
 	}
 	if (ctx->border_radius <= 0) {
@@ -243,12 +283,10 @@ static void apply_window_shape(SwatchContext *ctx) {
 		if (ctx->border_radius == 0) {
 			XShapeCombineMask(ctx->display, ctx->swatch_window, ShapeBounding, 0, 0, None, ShapeSet);
 		}
+		// The old mask is gone, so a later return to the same radius must rebuild it
+		ctx->shape_valid = 0;
 		return;
 	}
-	XWindowAttributes wa;
-	XGetWindowAttributes(ctx->display, ctx->swatch_window, &wa);
-	int w = (wa.width > 0) ? wa.width : ctx->swatch_width;
-	int h = (wa.height > 0) ? wa.height : ctx->swatch_height;
 	if (w <= 0 || h <= 0) {
 		return;
 	}
@@ -269,56 +307,85 @@ static void apply_window_shape(SwatchContext *ctx) {
 	// Fill the rounded rectangle area matching where the border is drawn
 	// Border is drawn at (inset, inset) with dimensions (w - border_width, h - border_width)
 	int inset = ctx->border_width / 2;
-	fill_rounded_rect(ctx->display, mask, mask_gc, inset, inset, w - ctx->border_width, h - ctx->border_width, ctx->border_radius);
+	swatch_fill_rounded_rect(ctx->display, mask, mask_gc, inset, inset, w - ctx->border_width, h - ctx->border_width, ctx->border_radius);
 
 	// Apply the shape mask to the window
 	XShapeCombineMask(ctx->display, ctx->swatch_window, ShapeBounding, 0, 0, mask, ShapeSet);
 
 	XFreeGC(ctx->display, mask_gc);
 	XFreePixmap(ctx->display, mask);
+
+	ctx->shape_valid = 1;
+	ctx->shape_w = w;
+	ctx->shape_h = h;
+	ctx->shape_radius = ctx->border_radius;
+	ctx->shape_border = ctx->border_width;
 }
 
 /* ========== BORDER DRAWING ========== */
 
+/* Border pixel for the current state; recomputed only when its inputs change */
+static unsigned long border_pixel(SwatchContext *ctx) {
+	if (!ctx->attached) {
+		return ctx->last_pixel;
+	}
+	BorderMode mode = config_get_border_mode();
+	if (!ctx->border_valid || ctx->border_for_pixel != ctx->last_pixel || ctx->border_for_bg != ctx->main_bg_pixel || ctx->border_for_mode != mode) {
+		ctx->border_px = enhanced_border_color(ctx->display, ctx->screen, ctx->last_pixel, ctx->main_bg_pixel);
+		ctx->border_for_pixel = ctx->last_pixel;
+		ctx->border_for_bg = ctx->main_bg_pixel;
+		ctx->border_for_mode = mode;
+		ctx->border_valid = 1;
+	}
+	return ctx->border_px;
+}
+
+/* Fill and outline the swatch with its origin at (ox, oy) */
+static void render(SwatchContext *ctx, Drawable draw_target, int ox, int oy) {
+	int w = ctx->swatch_width;
+	int h = ctx->swatch_height;
+	int inset = ctx->border_width / 2;
+
+	// Fill background with the swatch color first
+	XSetForeground(ctx->display, ctx->fill_gc, ctx->last_pixel);
+	swatch_fill_rounded_rect(ctx->display, draw_target, ctx->fill_gc, ox + inset, oy + inset, w - ctx->border_width, h - ctx->border_width, ctx->border_radius);
+
+	// Then draw the border
+	XSetForeground(ctx->display, ctx->border_gc, border_pixel(ctx));
+	XSetLineAttributes(ctx->display, ctx->border_gc, (unsigned int)ctx->border_width, LineSolid, CapButt, JoinMiter);
+	swatch_draw_rounded_rect(ctx->display, draw_target, ctx->border_gc, ox + inset, oy + inset, w - ctx->border_width, h - ctx->border_width, ctx->border_radius);
+}
+
+/* Compositor paint callback */
+static void swatch_paint(Drawable target, int x, int y, void *user_data) {
+	SwatchContext *ctx = user_data;
+	if (ctx->swatch_width > 0 && ctx->swatch_height > 0) {
+		render(ctx, target, x, y);
+	}
+}
+
 static void swatch_draw_border(SwatchContext *ctx) {
 	if (!ctx) {
 		return;
 	}
-	unsigned long border_px;
-	if (ctx->attached) {
-		border_px = enhanced_border_color(ctx->display, ctx->screen, ctx->last_pixel, ctx->main_bg_pixel);
+	int w = ctx->swatch_width;
+	int h = ctx->swatch_height;
+	if (w <= 0 || h <= 0) {
+		return;
 	}
-	else {
-		border_px = ctx->last_pixel;
-	}
-	GC gc = XCreateGC(ctx->display, ctx->swatch_window, 0, NULL);
-	XSetForeground(ctx->display, gc, border_px);
-	XSetLineAttributes(ctx->display, gc, (unsigned int)ctx->border_width, LineSolid, CapButt, JoinMiter);
-
-	XWindowAttributes wa;
-	XGetWindowAttributes(ctx->display, ctx->swatch_window, &wa);
-	int w = (wa.width > 0) ? wa.width : ctx->swatch_width;
-	int h = (wa.height > 0) ? wa.height : ctx->swatch_height;
-	if (w > 0 && h > 0) {
-		// Draw border to appropriate target
-		Drawable draw_target = ctx->use_dbe ? ctx->dbe_back_buffer : ctx->swatch_window;
-		int inset = ctx->border_width / 2;
-		
-		// Fill background with the swatch color first
-		GC fill_gc = XCreateGC(ctx->display, ctx->swatch_window, 0, NULL);
-		XSetForeground(ctx->display, fill_gc, ctx->last_pixel);
-		fill_rounded_rect(ctx->display, draw_target, fill_gc, inset, inset, w - ctx->border_width, h - ctx->border_width, ctx->border_radius);
-		XFreeGC(ctx->display, fill_gc);
-		
-		// Then draw the border
-		draw_rounded_rect(ctx->display, draw_target, gc, inset, inset, w - ctx->border_width, h - ctx->border_width, ctx->border_radius);
-		
-		// If using DBE, swap buffers to present
-		if (ctx->use_dbe) {
-			dbe_swap_buffers(ctx->dbe_ctx, ctx->swatch_window, XdbeUndefined);
-		}
+	if (!ctx->swatch_window) {
+		// Docked compositor node: painted by the compositor's next frame
+		compositor_damage_node(ctx->comp, ctx->node);
+		return;
+	}
+	// Draw border to appropriate target
+	Drawable draw_target = ctx->use_dbe ? ctx->dbe_back_buffer : ctx->swatch_window;
+	render(ctx, draw_target, 0, 0);
+
+	// If using DBE, swap buffers to present
+	if (ctx->use_dbe) {
+		dbe_swap_buffers(ctx->dbe_ctx, ctx->swatch_window, XdbeUndefined);
 	}
-	XFreeGC(ctx->display, gc);
 }
 
 /* ========== PUBLIC API ========== */
@@ -329,7 +396,16 @@ static void swatch_draw_border(SwatchContext *ctx) {
  * See swatch.h for full documentation.
  * Initializes swatch window with configurable dimensions and border mode support.
  */
-SwatchContext *swatch_create(Display *dpy, Window parent, int width, int height) {
+/* Create the swatch's window (override-redirect, so it can float on the root) */
+static Window create_window(SwatchContext *ctx, Window parent, int x, int y) {
+	XSetWindowAttributes swa;
+	swa.event_mask = ExposureMask | ButtonPressMask | ButtonReleaseMask | PointerMotionMask;
+	swa.override_redirect = True;
+	swa.background_pixmap = None;
+	return XCreateWindow(ctx->display, parent, x, y, (unsigned int)ctx->swatch_width, (unsigned int)ctx->swatch_height, 0, CopyFromParent, InputOutput, CopyFromParent, CWBackPixmap | CWOverrideRedirect | CWEventMask, &swa);
+}
+
+SwatchContext *swatch_create(Display *dpy, Window parent, int width, int height, Compositor *comp) {
 	if (!dpy) {
 		return NULL;
 	}
@@ -355,29 +431,42 @@ SwatchContext *swatch_create(Display *dpy, Window parent, int width, int height)
 	ctx->dbe_back_buffer = None;
 	ctx->use_dbe = 0;
 
-	XSetWindowAttributes swa;
-	swa.event_mask = ExposureMask | ButtonPressMask | ButtonReleaseMask | PointerMotionMask;
-	swa.override_redirect = True;
-	swa.background_pixmap = None;
-
-	ctx->swatch_window = XCreateWindow(
-		dpy, parent, 0, 0, (unsigned int)width, (unsigned int)height, 0, CopyFromParent, InputOutput, CopyFromParent, CWBackPixmap | CWOverrideRedirect | CWEventMask, &swa);
-	if (!ctx->swatch_window) {
-		free(ctx);
-		return NULL;
+	if (comp) {
+		ctx->node = compositor_add_node(comp, swatch_paint, ctx);
+		if (ctx->node >= 0) {
+			ctx->comp = comp;
+			ctx->input_win = compositor_node_window(comp, ctx->node);
+			compositor_set_node_bounds(comp, ctx->node, 0, 0, width, height);
+		}
+	}
+	if (!ctx->comp) {
+		ctx->swatch_window = create_window(ctx, parent, 0, 0);
+		if (!ctx->swatch_window) {
+			if (ctx->dbe_ctx) {
+				dbe_destroy(ctx->dbe_ctx);
+			}
+			free(ctx);
+			return NULL;
+		}
+		ctx->input_win = ctx->swatch_window;
 	}
+	ctx->fill_gc = XCreateGC(dpy, ctx->comp ? parent : ctx->swatch_window, 0, NULL);
+	ctx->border_gc = XCreateGC(dpy, ctx->comp ? parent : ctx->swatch_window, 0, NULL);
+
 	// Apply rounded corner shape to the window
 	apply_window_shape(ctx);
 	
 	// Initialize DBE buffers after window creation
-	if (ctx->dbe_ctx && dbe_is_supported(ctx->dbe_ctx)) {
+	if (ctx->swatch_window && ctx->dbe_ctx && dbe_is_supported(ctx->dbe_ctx)) {
 		ctx->dbe_back_buffer = dbe_allocate_back_buffer(ctx->dbe_ctx, ctx->swatch_window, XdbeUndefined);
 		ctx->use_dbe = (ctx->dbe_back_buffer != None);
 	} else {
 		ctx->use_dbe = 0;
 	}
 
-	XMapWindow(dpy, ctx->swatch_window);
+	if (ctx->swatch_window) {
+		XMapWindow(dpy, ctx->swatch_window);
+	}
 	
 	// Initial draw to show the color
 	swatch_draw_border(ctx);
@@ -401,9 +490,18 @@ void swatch_destroy(SwatchContext *ctx) {
 	if (ctx->dbe_ctx) {
 		dbe_destroy(ctx->dbe_ctx);
 	}
+	if (ctx->fill_gc) {
+		XFreeGC(ctx->display, ctx->fill_gc);
+	}
+	if (ctx->border_gc) {
+		XFreeGC(ctx->display, ctx->border_gc);
+	}
 	if (ctx->swatch_window) {
 		XDestroyWindow(ctx->display, ctx->swatch_window);
 	}
+	if (ctx->comp) {
+		compositor_remove_node(ctx->comp, ctx->node);
+	}
 	free(ctx);
 }
 
@@ -435,10 +533,22 @@ int swatch_handle_event(SwatchContext *ctx, const XEvent *ev, Window main_window
 		XMoveWindow(ctx->display, ctx->swatch_window, ctx->swatch_x - ctx->swatch_width / 2, ctx->swatch_y - ctx->swatch_height / 2);
 		return 1;
 	}
-	if (ev->type == ButtonPress && ev->xbutton.button == Button1 && ev->xany.window == ctx->swatch_window) {
+	if (ev->type == ButtonPress && ev->xbutton.button == Button1 && ev->xany.window == ctx->input_win) {
 		XQueryPointer(ctx->display, DefaultRootWindow(ctx->display), &root, &child, &ctx->root_x, &ctx->root_y, &ctx->swatch_x, &ctx->swatch_y, &mask);
-		XUnmapWindow(ctx->display, ctx->swatch_window);
-		XReparentWindow(ctx->display, ctx->swatch_window, DefaultRootWindow(ctx->display), ctx->root_x - ctx->swatch_width / 2, ctx->root_y - ctx->swatch_height / 2);
+		if (ctx->comp) {
+			// Float a temporary window in place of the node
+			ctx->swatch_window = create_window(ctx, DefaultRootWindow(ctx->display), ctx->root_x - ctx->swatch_width / 2, ctx->root_y - ctx->swatch_height / 2);
+			if (!ctx->swatch_window) {
+				return 1;
+			}
+			ctx->shape_valid = 0;
+			apply_window_shape(ctx);
+			compositor_set_node_visible(ctx->comp, ctx->node, 0);
+		}
+		else {
+			XUnmapWindow(ctx->display, ctx->swatch_window);
+			XReparentWindow(ctx->display, ctx->swatch_window, DefaultRootWindow(ctx->display), ctx->root_x - ctx->swatch_width / 2, ctx->root_y - ctx->swatch_height / 2);
+		}
 		XMapRaised(ctx->display, ctx->swatch_window);
 		ctx->attached = 0;
 		cursor_invisible(ctx);
@@ -447,6 +557,16 @@ int swatch_handle_event(SwatchContext *ctx, const XEvent *ev, Window main_window
 		ctx->moving = 1;
 		return 1;
 	}
+	if (ev->type == ButtonRelease && ev->xbutton.button == Button1 && ctx->moving && ev->xany.window == ctx->swatch_window && ctx->comp) {
+		XUngrabPointer(ctx->display, CurrentTime);
+		XDestroyWindow(ctx->display, ctx->swatch_window);
+		ctx->swatch_window = None;
+		ctx->attached = 1;
+		ctx->moving = 0;
+		compositor_set_node_visible(ctx->comp, ctx->node, 1);
+		swatch_draw_border(ctx);
+		return 1;
+	}
 	if (ev->type == ButtonRelease && ev->xbutton.button == Button1 && ev->xany.window == ctx->swatch_window) {
 		XUnmapWindow(ctx->display, ctx->swatch_window);
 		XReparentWindow(ctx->display, ctx->swatch_window, ctx->parent, ctx->initial_x, ctx->initial_y);
@@ -471,17 +591,12 @@ void swatch_set_color(SwatchContext *ctx, unsigned long pixel) {
 	if (!ctx) {
 		return;
 	}
+	if (pixel == ctx->last_pixel) {
+		return;
+	}
 	ctx->last_pixel = pixel;
-
-	XSetWindowBackground(ctx->display, ctx->swatch_window, pixel);
-	XClearWindow(ctx->display, ctx->swatch_window);
-
-	XEvent ev;
-	memset(&ev, 0, sizeof(ev));
-	ev.type = Expose;
-	ev.xexpose.window = ctx->swatch_window;
-	ev.xexpose.count = 0;
-	XSendEvent(ctx->display, ctx->swatch_window, False, ExposureMask, &ev);
+	// Repaint in place: no window clear and no Expose round trip
+	swatch_draw_border(ctx);
 	XFlush(ctx->display);
 }
 
@@ -489,13 +604,11 @@ void swatch_set_background(SwatchContext *ctx, unsigned long bg_pixel) {
 	if (!ctx) {
 		return;
 	}
+	if (bg_pixel == ctx->main_bg_pixel) {
+		return;
+	}
 	ctx->main_bg_pixel = bg_pixel;
-	XEvent ev;
-	memset(&ev, 0, sizeof(ev));
-	ev.type = Expose;
-	ev.xexpose.window = ctx->swatch_window;
-	ev.xexpose.count = 0;
-	XSendEvent(ctx->display, ctx->swatch_window, False, ExposureMask, &ev);
+	swatch_draw_border(ctx);
 	XFlush(ctx->display);
 }
 
@@ -508,7 +621,12 @@ void swatch_set_position(SwatchContext *ctx, int x, int y) {
 	if (!ctx) {
 		return;
 	}
-	XMoveWindow(ctx->display, ctx->swatch_window, x, y);
+	if (ctx->comp) {
+		compositor_set_node_bounds(ctx->comp, ctx->node, x, y, ctx->swatch_width, ctx->swatch_height);
+	}
+	else {
+		XMoveWindow(ctx->display, ctx->swatch_window, x, y);
+	}
 	ctx->initial_x = x;
 	ctx->initial_y = y;
 }
@@ -524,7 +642,9 @@ void swatch_set_border(SwatchContext *ctx, int border_width, int border_radius)
 	apply_window_shape(ctx);
 
 	// Clear the window to remove old border pixels
-	XClearWindow(ctx->display, ctx->swatch_window);
+	if (ctx->swatch_window) {
+		XClearWindow(ctx->display, ctx->swatch_window);
+	}
 
 	// Force immediate redraw of border
 	swatch_draw_border(ctx);
@@ -532,16 +652,15 @@ void swatch_set_border(SwatchContext *ctx, int border_width, int border_radius)
 	XFlush(ctx->display);
 }
 
-void swatch_resize(SwatchContext *ctx, int width, int height) {
-	if (!ctx || width <= 0 || height <= 0) {
+/* Rebuild size-dependent state after the window was resized */
+static void swatch_resized(SwatchContext *ctx) {
+	if (ctx->comp) {
+		// No back buffer of its own; a floating window is drawn directly
+		compositor_set_node_bounds(ctx->comp, ctx->node, ctx->initial_x, ctx->initial_y, ctx->swatch_width, ctx->swatch_height);
+		apply_window_shape(ctx);
+		swatch_draw_border(ctx);
 		return;
 	}
-	ctx->swatch_width = width;
-	ctx->swatch_height = height;
-
-	// Resize the window
-	XResizeWindow(ctx->display, ctx->swatch_window, (unsigned int)width, (unsigned int)height);
-
 	// Reinitialize DBE buffers for new window size
 	if (ctx->dbe_back_buffer != None) {
 		dbe_deallocate_back_buffer(ctx->dbe_ctx, ctx->dbe_back_buffer);
@@ -557,44 +676,71 @@ void swatch_resize(SwatchContext *ctx, int width, int height) {
 	// Update window shape with new dimensions
 	apply_window_shape(ctx);
 
-	// Draw using double buffering to eliminate flicker
-	if (ctx->use_dbe && ctx->dbe_back_buffer != None) {
-		// Draw everything to back buffer first, then swap atomically
-		unsigned long border_px;
-		if (ctx->attached) {
-			border_px = enhanced_border_color(ctx->display, ctx->screen, ctx->last_pixel, ctx->main_bg_pixel);
-		}
-		else {
-			border_px = ctx->last_pixel;
-		}
-		
-		// Fill background with the swatch color first
-		GC fill_gc = XCreateGC(ctx->display, ctx->swatch_window, 0, NULL);
-		XSetForeground(ctx->display, fill_gc, ctx->last_pixel);
-		int inset = ctx->border_width / 2;
-		fill_rounded_rect(ctx->display, ctx->dbe_back_buffer, fill_gc, inset, inset, 
-		                  width - ctx->border_width, height - ctx->border_width, ctx->border_radius);
-		XFreeGC(ctx->display, fill_gc);
-		
-		// Then draw the border
-		GC border_gc = XCreateGC(ctx->display, ctx->swatch_window, 0, NULL);
-		XSetForeground(ctx->display, border_gc, border_px);
-		XSetLineAttributes(ctx->display, border_gc, (unsigned int)ctx->border_width, LineSolid, CapButt, JoinMiter);
-		draw_rounded_rect(ctx->display, ctx->dbe_back_buffer, border_gc, inset, inset, 
-		                  width - ctx->border_width, height - ctx->border_width, ctx->border_radius);
-		XFreeGC(ctx->display, border_gc);
-		
-		// Swap buffers atomically to present without flicker
-		dbe_swap_buffers(ctx->dbe_ctx, ctx->swatch_window, XdbeUndefined);
-	} else {
-		// Fallback for non-DBE: clear window and draw directly
+	// With DBE the frame is drawn off-screen and swapped in without flicker
+	if (!ctx->use_dbe) {
 		XClearWindow(ctx->display, ctx->swatch_window);
-		swatch_draw_border(ctx);
 	}
+	swatch_draw_border(ctx);
+}
+
+void swatch_resize(SwatchContext *ctx, int width, int height) {
+	if (!ctx || width <= 0 || height <= 0) {
+		return;
+	}
+	ctx->swatch_width = width;
+	ctx->swatch_height = height;
+
+	// Resize the window
+	if (ctx->swatch_window) {
+		XResizeWindow(ctx->display, ctx->swatch_window, (unsigned int)width, (unsigned int)height);
+	}
+	swatch_resized(ctx);
 
 	XFlush(ctx->display);
 }
 
+void swatch_set_bounds(SwatchContext *ctx, int x, int y, int width, int height) {
+	if (!ctx || width <= 0 || height <= 0) {
+		return;
+	}
+	XWindowChanges changes;
+	unsigned int mask = 0;
+	if (x != ctx->initial_x) {
+		changes.x = x;
+		mask |= CWX;
+	}
+	if (y != ctx->initial_y) {
+		changes.y = y;
+		mask |= CWY;
+	}
+	if (width != ctx->swatch_width) {
+		changes.width = width;
+		mask |= CWWidth;
+	}
+	if (height != ctx->swatch_height) {
+		changes.height = height;
+		mask |= CWHeight;
+	}
+	if (!mask) {
+		return;
+	}
+	ctx->initial_x = x;
+	ctx->initial_y = y;
+	ctx->swatch_width = width;
+	ctx->swatch_height = height;
+	if (ctx->comp) {
+		if (ctx->swatch_window) {
+			XResizeWindow(ctx->display, ctx->swatch_window, (unsigned int)width, (unsigned int)height);
+		}
+		swatch_resized(ctx);
+		return;
+	}
+	XConfigureWindow(ctx->display, ctx->swatch_window, mask, &changes);
+	if (mask & (CWWidth | CWHeight)) {
+		swatch_resized(ctx);
+	}
+}
+
 /* ========== CONFIGURATION MANAGEMENT ========== */
 
 void swatch_config_init_defaults(Config *cfg) {
@@ -24,9 +24,10 @@
  * - X11 (Xlib)
  * - config.h (BorderMode and color utilities)
  * - colormath.h (HSV/luminance calculations)
+ * - compositor.h (optional single-window rendering)
  *
  * Usage:
- *   1. Create swatch: swatch_create(display, parent_window, width, height)
+ *   1. Create swatch: swatch_create(display, parent_window, width, height, NULL)
  *   2. Set color: swatch_set_color(swatch, r, g, b)
  *   3. Handle events: swatch_handle_event(swatch, &event, main_window)
  *      - Returns 1 when clicked
@@ -38,6 +39,7 @@
  */
 
 #include <X11/Xlib.h>
+#include "compositor.h"
 
 /* ========== SWATCH DIMENSIONS ========== */
 
@@ -65,10 +67,14 @@ typedef struct SwatchContext SwatchContext;
  * @param parent Parent window that will contain the swatch
  * @param width Width of swatch widget in pixels
  * @param height Height of swatch widget in pixels
+ * @param comp Compositor of parent, or NULL for a window of its own. With a
+ *             compositor the docked swatch is a node drawn into the shared
+ *             back buffer (a window exists only while it is dragged); it
+ *             must be destroyed before the compositor.
  *
  * @return Pointer to new swatch context, or NULL on failure
  */
-SwatchContext *swatch_create(Display *dpy, Window parent, int width, int height);
+SwatchContext *swatch_create(Display *dpy, Window parent, int width, int height, Compositor *comp);
 
 /**
  * @brief Destroy a swatch widget and free its resources
@@ -82,7 +88,8 @@ void swatch_destroy(SwatchContext *ctx);
  * @brief Get the X11 window handle for a swatch
  * @param swatch_context Swatch context
  *
- * @return X11 Window ID of the swatch widget
+ * @return X11 Window ID of the swatch widget, or None for a docked
+ *         compositor node
  */
 Window swatch_get_window(SwatchContext *ctx);
 
@@ -143,6 +150,48 @@ void swatch_set_border(SwatchContext *ctx, int border_width, int border_radius);
  */
 void swatch_resize(SwatchContext *ctx, int width, int height);
 
+/**
+ * @brief Move and resize the swatch with a single request
+ * @param swatch_context Swatch context
+ * @param x New X coordinate
+ * @param y New Y coordinate
+ * @param width New width in pixels
+ * @param height New height in pixels
+ *
+ * Nothing is sent when the geometry is unchanged; buffers and the shape are
+ * only rebuilt when the size changes.
+ */
+void swatch_set_bounds(SwatchContext *ctx, int x, int y, int width, int height);
+
+/* ========== DRAWING HELPERS ========== */
+
+/**
+ * @brief Outline a rectangle with rounded corners (shared with palette.c)
+ * @param dpy X11 display connection
+ * @param d Drawable to draw into
+ * @param gc GC providing foreground and line attributes
+ * @param x X position
+ * @param y Y position
+ * @param w Width
+ * @param h Height
+ * @param radius Corner radius; a plain rectangle if it does not fit
+ */
+void swatch_draw_rounded_rect(Display *dpy, Drawable d, GC gc, int x, int y, int w, int h, int radius);
+
+/**
+ * @brief Fill a rectangle with rounded corners, covering exactly the pixels
+ *        swatch_draw_rounded_rect() outlines (suitable for shape masks)
+ * @param dpy X11 display connection
+ * @param d Drawable to draw into
+ * @param gc GC providing the foreground; its line attributes are reset
+ * @param x X position
+ * @param y Y position
+ * @param w Width
+ * @param h Height
+ * @param radius Corner radius; a plain rectangle if it does not fit
+ */
+void swatch_fill_rounded_rect(Display *dpy, Drawable d, GC gc, int x, int y, int w, int h, int radius);
+
 /* ========== CONFIGURATION MANAGEMENT ========== */
 
 #include <stdio.h>
@@ -7,16 +7,24 @@
  * - Watches for _NET_SYSTEM_TRAY_Sn selection owners and re-docks when needed.
  * - Uses a small custom menu via context.c for tray interactions.
  * - Embedding logic is isolated so main window code only toggles visibility.
+ * - Menu pixels, the menu GC and the shape mask are prepared once per theme,
+ *   size or recent-color change; hover redraws make no round trips.
+ * - The icon comes pre-converted from icons_data.c in several sizes. The
+ *   size that fits the icon window is uploaded on ConfigureNotify, centered,
+ *   and the window is shaped to its mask.
+ * - Menu layout (item tops and width) is computed by update_menu_size()
+ *   only when the font or recent colors change; hit-testing is a binary search over the item tops
+ *   and a hover change repaints only the old and new items.
  */
 
 #include "tray.h"
 #include "context.h"
 #include "config.h"
+#include "icons.h"
 #include <X11/Xlib.h>
 #include <X11/Xutil.h>
 #include <X11/Xatom.h>
 #include <X11/Xft/Xft.h>
-#include <X11/xpm.h>
 #include <X11/extensions/shape.h>
 #include <stdlib.h>
 #include <stdio.h>
@@ -48,6 +56,13 @@
 
 /* Menu layout constants */
 #define MENU_ITEM_HEIGHT 24
+#define MENU_MIN_WIDTH 150
+#define MENU_SEPARATOR_HEIGHT 5
+#define MENU_FIXED_ITEMS 3 /* Pick Color, Show/Hide, Copy as Hex (Exit follows the separator) */
+#define MENU_MAX_ITEMS (MENU_FIXED_ITEMS + TRAY_MAX_RECENT + 1)
+
+/* Icon window size requested before the tray assigns one */
+#define TRAY_DEFAULT_ICON_SIZE 24
 
 /* ========== RENDERING HELPERS ========== */
 
@@ -187,10 +202,16 @@ struct TrayContext {
 	Atom xa_tray_opcode;
 	Atom xa_xembed;
 	Atom xa_xembed_info;
+	const IconImage *icons;  // Available icon sizes, ascending
+	int icon_count;
+	const IconImage *icon;   // Size currently uploaded to icon_pixmap
 	Pixmap icon_pixmap;
 	Pixmap icon_mask;
+	GC icon_gc;
 	int icon_width;
 	int icon_height;
+	int icon_win_width;      // Icon window size as assigned by the tray
+	int icon_win_height;
 	int menu_visible;
 	int menu_x;
 	int menu_y;
@@ -202,9 +223,21 @@ struct TrayContext {
 	XftColor menu_fg;
 	XftColor menu_bg;
 	XftColor menu_hover_bg;
+	unsigned long menu_border_px;
+	GC menu_gc;
+	const char *window_action; // Show/minimize item text, set when the menu opens
+	int shape_valid; // Shape mask applied for shape_w x shape_h at shape_radius
+	int shape_w, shape_h, shape_radius;
 	int menu_hover;
 	TrayMenuBlock theme;
 	Time last_button_time;
+	RGB8 recent_colors[TRAY_MAX_RECENT]; // Recently copied colours shown in the menu
+	unsigned long recent_pixels[TRAY_MAX_RECENT];
+	char recent_labels[TRAY_MAX_RECENT][48];
+	int recent_count;
+
+	// Item tops in window coordinates (ascending), set by update_menu_size()
+	int item_top[MENU_MAX_ITEMS];
 };
 
 /* ========== INTERNAL HELPERS ========== */
@@ -263,6 +296,133 @@ static void set_xembed_info(TrayContext *ctx) {
 	XChangeProperty(ctx->dpy, ctx->tray_icon, ctx->xa_xembed_info, ctx->xa_xembed_info, 32, PropModeReplace, (unsigned char *)info, 2);
 }
 
+/* ========== ICON ========== */
+
+/**
+ * load_icon - Upload the icon size that fits the icon window
+ * @ctx Tray context
+ *
+ * Does nothing when that size is already uploaded.
+ * Return: 0 on success, -1 on failure (previous icon kept)
+ */
+static int load_icon(TrayContext *ctx) {
+	int size = ctx->icon_win_width < ctx->icon_win_height ? ctx->icon_win_width : ctx->icon_win_height;
+	const IconImage *icon = icon_find(ctx->icons, ctx->icon_count, size);
+	if (!icon) {
+		return -1;
+	}
+	if (icon == ctx->icon) {
+		return 0;
+	}
+	Pixmap mask;
+	Pixmap pixmap = icon_create_pixmap(ctx->dpy, ctx->screen, icon, &mask);
+	if (pixmap == None) {
+		return -1;
+	}
+	if (ctx->icon_pixmap) {
+		XFreePixmap(ctx->dpy, ctx->icon_pixmap);
+	}
+	if (ctx->icon_mask) {
+		XFreePixmap(ctx->dpy, ctx->icon_mask);
+	}
+	ctx->icon = icon;
+	ctx->icon_pixmap = pixmap;
+	ctx->icon_mask = mask;
+	ctx->icon_width = icon->width;
+	ctx->icon_height = icon->height;
+	return 0;
+}
+
+/* Top-left corner of the icon, centered in the icon window */
+static void icon_origin(const TrayContext *ctx, int *x, int *y) {
+	*x = (ctx->icon_win_width - ctx->icon_width) / 2;
+	*y = (ctx->icon_win_height - ctx->icon_height) / 2;
+}
+
+/* Let the tray show through the icon's transparent pixels */
+static void apply_icon_shape(TrayContext *ctx) {
+	if (!ctx->tray_icon || ctx->icon_mask == None) {
+		return;
+	}
+	int x, y;
+	icon_origin(ctx, &x, &y);
+	XShapeCombineMask(ctx->dpy, ctx->tray_icon, ShapeBounding, x, y, ctx->icon_mask, ShapeSet);
+}
+
+static void draw_icon(TrayContext *ctx) {
+	if (!ctx->icon_pixmap || !ctx->tray_icon) {
+		return;
+	}
+	int x, y;
+	icon_origin(ctx, &x, &y);
+	XCopyArea(ctx->dpy, ctx->icon_pixmap, ctx->tray_icon, ctx->icon_gc, 0, 0, (unsigned int)ctx->icon_width, (unsigned int)ctx->icon_height, x, y);
+}
+
+/* ========== MENU LAYOUT ========== */
+
+/* Items are: fixed items, recent colours, separator, Exit */
+static int menu_item_count(const TrayContext *ctx) {
+	return MENU_FIXED_ITEMS + ctx->recent_count + 1;
+}
+
+/* Top edge of item i (0-based) relative to the menu window */
+static int menu_item_y(const TrayContext *ctx, int i) {
+	return ctx->item_top[i];
+}
+
+/* 1-based item under window-relative y, or 0 for borders and separator */
+static int menu_item_at(const TrayContext *ctx, int y) {
+	int count = menu_item_count(ctx);
+	// Last item whose top is at or above y
+	int lo = 0, hi = count - 1, found = -1;
+	while (lo <= hi) {
+		int mid = (lo + hi) / 2;
+		if (ctx->item_top[mid] <= y) {
+			found = mid;
+			lo = mid + 1;
+		}
+		else {
+			hi = mid - 1;
+		}
+	}
+	if (found < 0 || y >= ctx->item_top[found] + ctx->menu_item_height) {
+		return 0;
+	}
+	return found + 1;
+}
+
+/* Allocate the pixel for a color given in 16-bit channels */
+static unsigned long alloc_pixel(TrayContext *ctx, unsigned short r, unsigned short g, unsigned short b) {
+	XColor xc = {0};
+	xc.red = r;
+	xc.green = g;
+	xc.blue = b;
+	xc.flags = DoRed | DoGreen | DoBlue;
+	XAllocColor(ctx->dpy, DefaultColormap(ctx->dpy, ctx->screen), &xc);
+	return xc.pixel;
+}
+
+/* Recompute menu size for the current font and recent colours */
+static void update_menu_size(TrayContext *ctx) {
+	int count = menu_item_count(ctx);
+	for (int i = 0; i < count; i++) {
+		int y = ctx->theme.border_width + i * ctx->menu_item_height;
+		// The separator sits in the gap before the last item (Exit)
+		ctx->item_top[i] = (i == count - 1) ? y + MENU_SEPARATOR_HEIGHT : y;
+	}
+	ctx->menu_height = (ctx->theme.border_width * 2) + (ctx->menu_item_height * count) + MENU_SEPARATOR_HEIGHT;
+	ctx->menu_width = MENU_MIN_WIDTH;
+	int chip = ctx->menu_item_height - 8;
+	for (int i = 0; i < ctx->recent_count; i++) {
+		XGlyphInfo extents;
+		XftTextExtentsUtf8(ctx->dpy, ctx->menu_font, (const FcChar8 *)ctx->recent_labels[i], (int)strlen(ctx->recent_labels[i]), &extents);
+		int needed = ctx->theme.border_width * 2 + 6 + chip + 6 + extents.xOff + 10;
+		if (needed > ctx->menu_width) {
+			ctx->menu_width = needed;
+		}
+	}
+}
+
 /**
  * create_context_menu - Create the popup context menu window
  * @ctx Tray context
@@ -284,9 +444,8 @@ static void create_context_menu(TrayContext *ctx) {
 	if (vertical_padding < 8) vertical_padding = 8;
 	ctx->menu_item_height = font_height + vertical_padding;
 
-	// Menu dimensions - 4 items + separator + border on both sides (no menu-level padding)
-	ctx->menu_width = 150;
-	ctx->menu_height = (ctx->theme.border_width * 2) + (ctx->menu_item_height * 4) + 5; // border + 4 items + 5px separator
+	// Menu dimensions - items + separator + border on both sides (no menu-level padding)
+	update_menu_size(ctx);
 
 	// Convert theme colors to X pixels
 	xc_bg.red = (unsigned short)(ctx->theme.bg.r * 65535);
@@ -310,9 +469,11 @@ static void create_context_menu(TrayContext *ctx) {
 	                   LeaveWindowMask;
 	attrs.background_pixel = xc_bg.pixel;
 	attrs.border_pixel = xc_border.pixel;
+	ctx->menu_border_px = xc_border.pixel;
 
 	ctx->menu_window = XCreateWindow(ctx->dpy, RootWindow(ctx->dpy, ctx->screen), 0, 0, (unsigned int)ctx->menu_width, (unsigned int)ctx->menu_height, 1, CopyFromParent, InputOutput, CopyFromParent, CWOverrideRedirect | CWEventMask |
 		CWBackPixel | CWBorderPixel, &attrs);
+	ctx->menu_gc = XCreateGC(ctx->dpy, ctx->menu_window, 0, NULL);
 
 	// Create Xft draw context
 	ctx->menu_draw = XftDrawCreate(ctx->dpy, ctx->menu_window, DefaultVisual(ctx->dpy, ctx->screen), colormap);
@@ -348,16 +509,21 @@ static void apply_menu_shape(TrayContext *ctx) {
 	if (!ctx) {
 		return;
 	}
+	int w = ctx->menu_width;
+	int h = ctx->menu_height;
+	// The mask covers the whole window, so the border width does not affect it
+	if (ctx->shape_valid && ctx->shape_w == w && ctx->shape_h == h && ctx->shape_radius == ctx->theme.border_radius) {
+		return;
+	}
 	if (ctx->theme.border_radius <= 0) {
 		// If no radius, remove any shape mask to make window rectangular
 		if (ctx->theme.border_radius == 0) {
 			XShapeCombineMask(ctx->dpy, ctx->menu_window, ShapeBounding, 0, 0, None, ShapeSet);
 		}
+		// The old mask is gone, so a later return to the same radius must rebuild it
+		ctx->shape_valid = 0;
 		return;
 	}
-	
-	int w = ctx->menu_width;
-	int h = ctx->menu_height;
 	if (w <= 0 || h <= 0) {
 		return;
 	}
@@ -385,104 +551,132 @@ static void apply_menu_shape(TrayContext *ctx) {
 
 	XFreeGC(ctx->dpy, mask_gc);
 	XFreePixmap(ctx->dpy, mask);
+
+	ctx->shape_valid = 1;
+	ctx->shape_w = w;
+	ctx->shape_h = h;
+	ctx->shape_radius = ctx->theme.border_radius;
+}
+
+/* Stroke the menu outline; also used to restore rounded corners that an
+ * item repaint covered */
+static void draw_menu_border(TrayContext *ctx) {
+	if (ctx->theme.border_width <= 0) {
+		return;
+	}
+	GC gc = ctx->menu_gc;
+	XSetForeground(ctx->dpy, gc, ctx->menu_border_px);
+	XSetLineAttributes(ctx->dpy, gc, (unsigned int)ctx->theme.border_width, LineSolid, CapButt, JoinMiter);
+	int inset = ctx->theme.border_width / 2;
+	draw_rounded_rect(ctx->dpy, ctx->menu_window, gc, inset, inset, ctx->menu_width - ctx->theme.border_width, ctx->menu_height - ctx->theme.border_width, ctx->theme.border_radius);
+	XSetLineAttributes(ctx->dpy, gc, 0, LineSolid, CapButt, JoinMiter);
 }
 
 /**
- * draw_context_menu - Redraw the context menu
+ * draw_menu_item - Paint one item (0-based) over its background
  * @ctx Tray context
+ * @i Item index
  */
-static void draw_context_menu(TrayContext *ctx) {
-	// Check if main window is visible to determine menu text
-	const char *window_action = "Show Window";
-	if (ctx->main_window) {
-		XWindowAttributes attrs;
-		if (XGetWindowAttributes(ctx->dpy, ctx->main_window, &attrs)) {
-			if (attrs.map_state == IsViewable) {
-				window_action = "Minimize";
-			}
-			else {
-				window_action = "Maximize";
-			}
-		}
-	}
-	
-	const char *items[] = {
-		"Pick Color", window_action, "Copy as Hex", "Exit"
+static void draw_menu_item(TrayContext *ctx, int i) {
+	const char *fixed_items[MENU_FIXED_ITEMS] = {
+		"Pick Color", ctx->window_action ? ctx->window_action : "Show Window", "Copy as Hex"
 	};
-	// Items start right after border (no menu-level padding)
-	int items_top = ctx->theme.border_width;
-	int separator_y = items_top + ctx->menu_item_height * 3 + 2;
-	XColor xc_bg = {0}, xc_hover = {0}, xc_border = {0};
-	Colormap cmap = DefaultColormap(ctx->dpy, ctx->screen);
+	int item_count = menu_item_count(ctx);
+	int y_pos = menu_item_y(ctx, i);
+	GC gc = ctx->menu_gc;
 
-	// Convert theme colors
-	xc_bg.red = (unsigned short)(ctx->theme.bg.r * 65535);
-	xc_bg.green = (unsigned short)(ctx->theme.bg.g * 65535);
-	xc_bg.blue = (unsigned short)(ctx->theme.bg.b * 65535);
-	xc_bg.flags = DoRed | DoGreen | DoBlue;
-	XAllocColor(ctx->dpy, cmap, &xc_bg);
+	// Hover fills from border to border (full width minus borders)
+	int hover_x = ctx->theme.border_width;
+	int hover_width = ctx->menu_width - (ctx->theme.border_width * 2) - 1;
 
-	xc_hover.red = (unsigned short)(ctx->theme.hover_bg.r * 65535);
-	xc_hover.green = (unsigned short)(ctx->theme.hover_bg.g * 65535);
-	xc_hover.blue = (unsigned short)(ctx->theme.hover_bg.b * 65535);
-	xc_hover.flags = DoRed | DoGreen | DoBlue;
-	XAllocColor(ctx->dpy, cmap, &xc_hover);
+	// Clear the item so it can be repainted on its own
+	XSetForeground(ctx->dpy, gc, ctx->menu_bg.pixel);
+	XFillRectangle(ctx->dpy, ctx->menu_window, gc, hover_x, y_pos, (unsigned int)(hover_width + 1), (unsigned int)ctx->menu_item_height);
+
+	// Highlight if hovering
+	if (ctx->menu_hover == i + 1) {
+		XSetForeground(ctx->dpy, gc, ctx->menu_hover_bg.pixel);
+		// Determine if this is top or bottom item for selective rounding
+		int is_first = (i == 0);
+		int is_last = (i == item_count - 1); // Last visual item (Exit)
+		int round_top = is_first ? 1 : 0;
+		int round_bottom = is_last ? 1 : 0;
+		// Use border radius if available
+		int hover_radius = ctx->theme.border_radius > 0 ? ctx->theme.border_radius : 0;
+		// Only adjust last item height to not overlap bottom border
+		int hover_height = is_last ? ctx->menu_item_height - 1 : ctx->menu_item_height;
+		fill_rounded_rect_selective(ctx->dpy, ctx->menu_window, gc, hover_x, y_pos, hover_width, hover_height, hover_radius, round_top, round_bottom);
+	}
+	// Draw text with left padding within the item
+	int text_x = ctx->theme.border_width + 6;
+	// Center text vertically: baseline at middle of item height
+	int text_y = y_pos + (ctx->menu_item_height + (int)ctx->menu_font->ascent - (int)ctx->menu_font->descent) / 2;
 
-	xc_border.red = (unsigned short)(ctx->theme.border.r * 65535);
-	xc_border.green = (unsigned short)(ctx->theme.border.g * 65535);
-	xc_border.blue = (unsigned short)(ctx->theme.border.b * 65535);
-	xc_border.flags = DoRed | DoGreen | DoBlue;
-	XAllocColor(ctx->dpy, cmap, &xc_border);
+	if (i < MENU_FIXED_ITEMS) {
+		XftDrawString8(ctx->menu_draw, &ctx->menu_fg, ctx->menu_font, text_x, text_y, (const FcChar8 *)fixed_items[i], (int)strlen(fixed_items[i]));
+	}
+	else if (i < MENU_FIXED_ITEMS + ctx->recent_count) {
+		// Recent colour: chip followed by the copied text
+		const int r = i - MENU_FIXED_ITEMS;
+		const int chip = ctx->menu_item_height - 8;
+		XSetForeground(ctx->dpy, gc, ctx->recent_pixels[r]);
+		XFillRectangle(ctx->dpy, ctx->menu_window, gc, text_x, y_pos + 4, (unsigned int)chip, (unsigned int)chip);
+		XSetForeground(ctx->dpy, gc, ctx->menu_border_px);
+		XDrawRectangle(ctx->dpy, ctx->menu_window, gc, text_x, y_pos + 4, (unsigned int)chip - 1, (unsigned int)chip - 1);
+		const char *label = ctx->recent_labels[r];
+		XftDrawStringUtf8(ctx->menu_draw, &ctx->menu_fg, ctx->menu_font, text_x + chip + 6, text_y, (const FcChar8 *)label, (int)strlen(label));
+	}
+	else {
+		XftDrawString8(ctx->menu_draw, &ctx->menu_fg, ctx->menu_font, text_x, text_y, (const FcChar8 *)"Exit", 4);
+	}
+}
+
+/**
+ * draw_context_menu - Redraw the context menu
+ * @ctx Tray context
+ */
+static void draw_context_menu(TrayContext *ctx) {
+	int item_count = menu_item_count(ctx);
+	// Separator sits in the gap before the last item (Exit)
+	int separator_y = menu_item_y(ctx, item_count - 1) - MENU_SEPARATOR_HEIGHT + 2;
+	GC gc = ctx->menu_gc;
 
 	// Clear background
-	XSetForeground(ctx->dpy, DefaultGC(ctx->dpy, ctx->screen), xc_bg.pixel);
-	XFillRectangle(ctx->dpy, ctx->menu_window, DefaultGC(ctx->dpy, ctx->screen), 0, 0, (unsigned int)ctx->menu_width, (unsigned int)ctx->menu_height);
-	
-	// Draw border only if border_width > 0
-	if (ctx->theme.border_width > 0) {
-		GC gc = XCreateGC(ctx->dpy, ctx->menu_window, 0, NULL);
-		XSetForeground(ctx->dpy, gc, xc_border.pixel);
-		XSetLineAttributes(ctx->dpy, gc, (unsigned int)ctx->theme.border_width, LineSolid, CapButt, JoinMiter);
-		int inset = ctx->theme.border_width / 2;
-		draw_rounded_rect(ctx->dpy, ctx->menu_window, gc, inset, inset, ctx->menu_width - ctx->theme.border_width, ctx->menu_height - ctx->theme.border_width, ctx->theme.border_radius);
-		XFreeGC(ctx->dpy, gc);
+	XSetForeground(ctx->dpy, gc, ctx->menu_bg.pixel);
+	XFillRectangle(ctx->dpy, ctx->menu_window, gc, 0, 0, (unsigned int)ctx->menu_width, (unsigned int)ctx->menu_height);
+	for (int i = 0; i < item_count; i++) {
+		draw_menu_item(ctx, i);
 	}
-	
-	// Hover fills from border to border (full width minus borders)
-	int hover_x = ctx->theme.border_width;
-	int hover_width = ctx->menu_width - (ctx->theme.border_width * 2) - 1;
-	
-	// Draw each menu item
-	for (int i = 0; i < 4; i++) {
-		int y_pos = items_top + (i * ctx->menu_item_height);
-		// Adjust for separator
-		if (i == 3) {
-			y_pos += 5;
-		}
-		// Highlight if hovering
-		if (ctx->menu_hover == i + 1) {
-			XSetForeground(ctx->dpy, DefaultGC(ctx->dpy, ctx->screen), xc_hover.pixel);
-			// Determine if this is top or bottom item for selective rounding
-			int is_first = (i == 0);
-			int is_last = (i == 3); // Last visual item (Exit)
-			int round_top = is_first ? 1 : 0;
-			int round_bottom = is_last ? 1 : 0;
-			// Use border radius if available
-			int hover_radius = ctx->theme.border_radius > 0 ? ctx->theme.border_radius : 0;
-			// Only adjust last item height to not overlap bottom border
-			int hover_height = is_last ? ctx->menu_item_height - 1 : ctx->menu_item_height;
-			fill_rounded_rect_selective(ctx->dpy, ctx->menu_window, DefaultGC(ctx->dpy, ctx->screen), hover_x, y_pos, hover_width, hover_height, hover_radius, round_top, round_bottom);
-		}
-		// Draw text with left padding within the item
-		int text_x = ctx->theme.border_width + 6;
-		// Center text vertically: baseline at middle of item height
-		int text_y = y_pos + (ctx->menu_item_height + (int)ctx->menu_font->ascent - (int)ctx->menu_font->descent) / 2;
+	draw_menu_border(ctx);
+	// Draw separator line
+	XSetForeground(ctx->dpy, gc, ctx->menu_border_px);
+	XDrawLine(ctx->dpy, ctx->menu_window, gc, 5, separator_y, ctx->menu_width - 5, separator_y);
+}
 
-		XftDrawString8(ctx->menu_draw, &ctx->menu_fg, ctx->menu_font, text_x, text_y, (const FcChar8 *)items[i], (int)strlen(items[i]));
+/**
+ * set_menu_hover - Move the hover highlight, repainting only the two items
+ * @ctx Tray context
+ * @hover New 1-based hover item, 0 for none
+ */
+static void set_menu_hover(TrayContext *ctx, int hover) {
+	int old_hover = ctx->menu_hover;
+	if (hover == old_hover) {
+		return;
+	}
+	ctx->menu_hover = hover;
+	int last = menu_item_count(ctx);
+	int corners = 0;
+	if (old_hover > 0) {
+		draw_menu_item(ctx, old_hover - 1);
+		corners |= old_hover == 1 || old_hover == last;
+	}
+	if (hover > 0) {
+		draw_menu_item(ctx, hover - 1);
+		corners |= hover == 1 || hover == last;
+	}
+	if (corners) {
+		draw_menu_border(ctx);
 	}
-	// Draw separator line
-	XSetForeground(ctx->dpy, DefaultGC(ctx->dpy, ctx->screen), xc_border.pixel);
-	XDrawLine(ctx->dpy, ctx->menu_window, DefaultGC(ctx->dpy, ctx->screen), 5, separator_y, ctx->menu_width - 5, separator_y);
 }
 
 /**
@@ -492,6 +686,15 @@ static void draw_context_menu(TrayContext *ctx) {
  * @y Screen Y coordinate
  */
 static void show_context_menu(TrayContext *ctx, int x, int y) {
+	// The main window cannot change state while the menu is open, so query it
+	// once here instead of on every hover redraw
+	ctx->window_action = "Show Window";
+	if (ctx->main_window) {
+		XWindowAttributes attrs;
+		if (XGetWindowAttributes(ctx->dpy, ctx->main_window, &attrs)) {
+			ctx->window_action = attrs.map_state == IsViewable ? "Minimize" : "Maximize";
+		}
+	}
 	// Get screen dimensions
 	int screen_width = DisplayWidth(ctx->dpy, ctx->screen);
 	int screen_height = DisplayHeight(ctx->dpy, ctx->screen);
@@ -576,12 +779,10 @@ int tray_is_available(Display *dpy, int screen) {
  * See tray.h for full documentation.
  * Embeds icon into system tray using XEMBED protocol.
  */
-TrayContext *tray_create(Display *dpy, int screen, const char **icon_xpm, const void *menu_theme, Window main_window) {
+TrayContext *tray_create(Display *dpy, int screen, const IconImage *icons, int icon_count, const void *menu_theme, Window main_window) {
 	TrayContext *ctx;
 	char atom_name[32];
 	XSetWindowAttributes attrs;
-	XpmAttributes xpm_attrs;
-	int status;
 
 	// Check if tray is available - but continue anyway for FluxBox compatibility
 	// FluxBox 1.3.x may not properly advertise the selection owner but still works
@@ -630,53 +831,22 @@ TrayContext *tray_create(Display *dpy, int screen, const char **icon_xpm, const
 		free(ctx);
 		return NULL;
 	}
-	// Load icon from XPM
-	xpm_attrs.valuemask = 0;
-	status = XpmCreatePixmapFromData(dpy, RootWindow(dpy, screen), (char **)icon_xpm, &ctx->icon_pixmap, &ctx->icon_mask, &xpm_attrs);
-	if (status != XpmSuccess) {
-		fprintf(stderr, "Failed to create tray icon pixmap: %d\n", status);
-		free(ctx);
-		return NULL;
-	}
-	
-	// Validate the created pixmap immediately
-	if (ctx->icon_pixmap == None) {
-		fprintf(stderr, "Tray icon pixmap is None after creation\n");
-		if (ctx->icon_mask != None) {
-			XFreePixmap(dpy, ctx->icon_mask);
-		}
-		free(ctx);
-		return NULL;
-	}
-	
-	// Test pixmap validity by checking geometry
-	unsigned int width, height, depth, border_width;
-	Window root_return;
-	int x_return, y_return;
-	if (!XGetGeometry(dpy, ctx->icon_pixmap, &root_return, &x_return, &y_return, 
-	                 &width, &height, &border_width, &depth)) {
-		fprintf(stderr, "Invalid tray icon pixmap geometry\n");
-		if (ctx->icon_pixmap != None) {
-			XFreePixmap(dpy, ctx->icon_pixmap);
-		}
-		if (ctx->icon_mask != None) {
-			XFreePixmap(dpy, ctx->icon_mask);
-		}
+	ctx->icons = icons;
+	ctx->icon_count = icon_count;
+	ctx->icon_win_width = ctx->icon_win_height = TRAY_DEFAULT_ICON_SIZE;
+	if (load_icon(ctx) != 0) {
+		fprintf(stderr, "Failed to create tray icon pixmap\n");
 		free(ctx);
 		return NULL;
 	}
-	
-	//fprintf(stderr, "Tray icon pixmap created successfully: %ux%ux%u\n", width, height, depth);
-	
-	ctx->icon_width = (int)xpm_attrs.width;
-	ctx->icon_height = (int)xpm_attrs.height;
-	XpmFreeAttributes(&xpm_attrs);
 
 	// Create tray icon window
 	attrs.event_mask = ButtonPressMask | ButtonReleaseMask | ExposureMask | StructureNotifyMask;
 	attrs.override_redirect = True;
 
-	ctx->tray_icon = XCreateWindow(dpy, RootWindow(dpy, screen), -1, -1, (unsigned int)ctx->icon_width, (unsigned int)ctx->icon_height, 0, CopyFromParent, InputOutput, CopyFromParent, CWEventMask | CWOverrideRedirect, &attrs);
+	ctx->tray_icon = XCreateWindow(dpy, RootWindow(dpy, screen), -1, -1, (unsigned int)ctx->icon_win_width, (unsigned int)ctx->icon_win_height, 0, CopyFromParent, InputOutput, CopyFromParent, CWEventMask | CWOverrideRedirect, &attrs);
+	ctx->icon_gc = XCreateGC(dpy, ctx->tray_icon, 0, NULL);
+	apply_icon_shape(ctx);
 
 	// Set XEMBED info
 	set_xembed_info(ctx);
@@ -721,6 +891,9 @@ void tray_destroy(TrayContext *ctx) {
 	if (ctx->menu_font) {
 		XftFontClose(ctx->dpy, ctx->menu_font);
 	}
+	if (ctx->menu_gc) {
+		XFreeGC(ctx->dpy, ctx->menu_gc);
+	}
 	// Now safe to destroy windows after Xft resources are freed
 	if (ctx->menu_window) {
 		XDestroyWindow(ctx->dpy, ctx->menu_window);
@@ -731,6 +904,9 @@ void tray_destroy(TrayContext *ctx) {
 	if (ctx->icon_mask) {
 		XFreePixmap(ctx->dpy, ctx->icon_mask);
 	}
+	if (ctx->icon_gc) {
+		XFreeGC(ctx->dpy, ctx->icon_gc);
+	}
 	if (ctx->tray_icon) {
 		XDestroyWindow(ctx->dpy, ctx->tray_icon);
 	}
@@ -759,22 +935,8 @@ int tray_handle_event(TrayContext *ctx, XEvent *event) {
 					return 0;
 				}
 				if (event->xbutton.button == Button1) {
-					int clicked_item = 0;
-					int items_top = ctx->theme.border_width;
-					int y = event->xbutton.y - items_top;
 					// Determine which item was clicked
-					if (y >= 0 && y < ctx->menu_item_height) {
-						clicked_item = 1; // Pick Color
-					}
-					else if (y < ctx->menu_item_height * 2) {
-						clicked_item = 2; // Show Window
-					}
-					else if (y < ctx->menu_item_height * 3) {
-						clicked_item = 3; // Copy as Hex
-					}
-					else if (y >= ctx->menu_item_height * 3 + 5) {
-						clicked_item = 4; // Exit (after separator)
-					}
+					int clicked_item = menu_item_at(ctx, event->xbutton.y);
 					hide_context_menu(ctx);
 					if (clicked_item == 1) {
 						return 2; // Pick Color
@@ -785,7 +947,10 @@ int tray_handle_event(TrayContext *ctx, XEvent *event) {
 					if (clicked_item == 3) {
 						return 4; // Copy as Hex
 					}
-					if (clicked_item == 4) {
+					if (clicked_item > MENU_FIXED_ITEMS && clicked_item <= MENU_FIXED_ITEMS + ctx->recent_count) {
+						return TRAY_RESULT_RECENT + (clicked_item - MENU_FIXED_ITEMS - 1); // Recent colour
+					}
+					if (clicked_item == menu_item_count(ctx)) {
 						return 5; // Exit
 					}
 				}
@@ -795,36 +960,14 @@ int tray_handle_event(TrayContext *ctx, XEvent *event) {
 				}
 			break;
 
-			case MotionNotify: {
-				// Determine hover item
-				int items_top = ctx->theme.border_width;
-				int y = event->xmotion.y - items_top;
-				int old_hover = ctx->menu_hover;
-				if (y >= 0 && y < ctx->menu_item_height) {
-					ctx->menu_hover = 1; // Pick Color
-				}
-				else if (y < ctx->menu_item_height * 2) {
-					ctx->menu_hover = 2; // Show Window
-				}
-				else if (y < ctx->menu_item_height * 3) {
-					ctx->menu_hover = 3; // Copy as Hex
-				}
-				else if (y >= ctx->menu_item_height * 3 + 5) {
-					ctx->menu_hover = 4; // Exit
-				}
-				else {
-					ctx->menu_hover = 0; // Separator area
-				}
-				if (old_hover != ctx->menu_hover) {
-					draw_context_menu(ctx);
-				}
-				break;
-			}
+			case MotionNotify:
+				// Determine hover item (0 over the separator area)
+				set_menu_hover(ctx, menu_item_at(ctx, event->xmotion.y));
+			break;
 
 			case LeaveNotify:
 				// Remove hover effect
-				ctx->menu_hover = 0;
-				draw_context_menu(ctx);
+				set_menu_hover(ctx, 0);
 			break;
 
 			case UnmapNotify:
@@ -876,28 +1019,25 @@ int tray_handle_event(TrayContext *ctx, XEvent *event) {
 				Window child;
 				XTranslateCoordinates(ctx->dpy, ctx->tray_icon, RootWindow(ctx->dpy, ctx->screen), 0, 0, &icon_x, &icon_y, &child);
 				// Pass icon's top-right position so menu opens aligned to the right edge
-				show_context_menu(ctx, icon_x + ctx->icon_width, icon_y);
+				show_context_menu(ctx, icon_x + ctx->icon_win_width, icon_y);
 				return 0;
 			}
 		break;
 
 		case Expose:
-			// Redraw icon manually
-			if (ctx->icon_pixmap && ctx->tray_icon) {
-				// Validate pixmap before using it
-				unsigned int width, height, depth, border_width;
-				Window root_return;
-				int x_return, y_return;
-				if (XGetGeometry(ctx->dpy, ctx->icon_pixmap, &root_return, &x_return, &y_return, 
-				                 &width, &height, &border_width, &depth)) {
-					GC icon_gc = XCreateGC(ctx->dpy, ctx->tray_icon, 0, NULL);
-					// Copy pixmap to window
-					XCopyArea(ctx->dpy, ctx->icon_pixmap, ctx->tray_icon, icon_gc,
-					          0, 0, (unsigned int)ctx->icon_width, (unsigned int)ctx->icon_height,
-					          0, 0);
-					XFreeGC(ctx->dpy, icon_gc);
-				} else {
-					fprintf(stderr, "Warning: Tray icon pixmap became invalid, skipping redraw\n");
+			if (event->xexpose.count == 0) {
+				draw_icon(ctx);
+			}
+		break;
+
+		case ConfigureNotify:
+			// The tray decides the icon size; switch to the closest variant
+			if (event->xconfigure.width != ctx->icon_win_width || event->xconfigure.height != ctx->icon_win_height) {
+				ctx->icon_win_width = event->xconfigure.width;
+				ctx->icon_win_height = event->xconfigure.height;
+				if (load_icon(ctx) == 0) {
+					apply_icon_shape(ctx);
+					draw_icon(ctx);
 				}
 			}
 		break;
@@ -916,6 +1056,29 @@ int tray_handle_event(TrayContext *ctx, XEvent *event) {
 	return 0;
 }
 
+void tray_set_recent_colors(TrayContext *ctx, const RGB8 *colors, const char *const *labels, int count) {
+	if (!ctx) {
+		return;
+	}
+	if (count > TRAY_MAX_RECENT) {
+		count = TRAY_MAX_RECENT;
+	}
+	ctx->recent_count = count < 0 ? 0 : count;
+	for (int i = 0; i < ctx->recent_count; i++) {
+		ctx->recent_colors[i] = colors[i];
+		ctx->recent_pixels[i] = alloc_pixel(ctx, (unsigned short)(colors[i].r * 257), (unsigned short)(colors[i].g * 257), (unsigned short)(colors[i].b * 257));
+		strncpy(ctx->recent_labels[i], labels[i], sizeof(ctx->recent_labels[i]) - 1);
+		ctx->recent_labels[i][sizeof(ctx->recent_labels[i]) - 1] = '\0';
+	}
+	// Resize now so the next popup is positioned with the right size
+	update_menu_size(ctx);
+	XResizeWindow(ctx->dpy, ctx->menu_window, (unsigned int)ctx->menu_width, (unsigned int)ctx->menu_height);
+	if (ctx->menu_visible) {
+		apply_menu_shape(ctx);
+		draw_context_menu(ctx);
+	}
+}
+
 // cppcheck-suppress unusedFunction
 Window tray_get_window(TrayContext *ctx) {
 	return ctx ? ctx->tray_icon : None;
@@ -951,7 +1114,7 @@ void tray_set_theme(TrayContext *ctx, const MiniTheme *theme) {
 	ctx->menu_item_height = font_height + vertical_padding;
 	
 	// Recalculate menu dimensions
-	ctx->menu_height = (ctx->theme.border_width * 2) + (ctx->menu_item_height * 4) + 5;
+	update_menu_size(ctx);
 	
 	// Resize menu window
 	XResizeWindow(ctx->dpy, ctx->menu_window, (unsigned int)ctx->menu_width, (unsigned int)ctx->menu_height);
@@ -979,6 +1142,7 @@ void tray_set_theme(TrayContext *ctx, const MiniTheme *theme) {
 	xrc.blue = (unsigned short)(ctx->theme.hover_bg.b * 65535);
 	xrc.alpha = (unsigned short)(ctx->theme.hover_bg.a * 65535);
 	XftColorAllocValue(ctx->dpy, DefaultVisual(ctx->dpy, ctx->screen), colormap, &xrc, &ctx->menu_hover_bg);
+	ctx->menu_border_px = alloc_pixel(ctx, (unsigned short)(ctx->theme.border.r * 65535), (unsigned short)(ctx->theme.border.g * 65535), (unsigned short)(ctx->theme.border.b * 65535));
 	
 	// Reapply shape mask with new dimensions
 	apply_menu_shape(ctx);
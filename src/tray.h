@@ -4,6 +4,8 @@
 #include <X11/Xlib.h>
 #include <stdio.h>
 #include "config.h"
+#include "colormath.h"
+#include "icons.h"
 
 /**
  * @file tray.h
@@ -18,16 +20,16 @@
  * - XEMBED protocol support
  * - Click event handling
  * - Automatic tray detection
- * - Icon from XPM data
+ * - Icon picked from several pre-converted sizes to fit the tray
  * - Fully portable - no application-specific dependencies
  *
  * Dependencies:
- * - X11 (Xlib)
- * - XPM (icon format)
+ * - X11 (Xlib, XShape)
+ * - icons.h (IconImage pixels and masks)
  *
  * Usage:
  *   1. Check availability: tray_is_available(display, screen)
- *   2. Create tray: tray_create(display, screen, icon_xpm)
+ *   2. Create tray: tray_create(display, screen, icons, icon_count, theme, main_window)
  *   3. Handle events: tray_handle_event(tray, &event) in main loop
  *      - Returns 1 when tray icon is clicked
  *   4. Cleanup: tray_destroy(tray)
@@ -38,6 +40,12 @@
 
 #include <X11/Xlib.h>
 
+/* Maximum number of recent colours listed in the context menu */
+#define TRAY_MAX_RECENT 5
+
+/* tray_handle_event() result for recent colour i is TRAY_RESULT_RECENT + i */
+#define TRAY_RESULT_RECENT 100
+
 /* Opaque tray context */
 typedef struct TrayContext TrayContext;
 
@@ -47,16 +55,18 @@ typedef struct TrayContext TrayContext;
  * @brief Create system tray icon
  * @param dpy X11 display connection
  * @param screen Screen number
- * @param icon_xpm XPM icon data (e.g., from .xpm file)
+ * @param icons Icon sizes in ascending order (e.g. pixelprism_icons)
+ * @param icon_count Number of entries in icons
  * @param menu_theme Theme configuration for context menu (can be NULL for defaults)
  * @param main_window Main application window (for checking visibility state)
  *
  * Creates and embeds a system tray icon. Automatically locates the system
- * tray and embeds the icon using the XEMBED protocol.
+ * tray and embeds the icon using the XEMBED protocol. Whenever the tray
+ * resizes the icon window, the largest size that fits is shown.
  *
  * @return Tray context or NULL on failure (no tray available)
  */
-TrayContext *tray_create(Display *dpy, int screen, const char **icon_xpm, const void *menu_theme, Window main_window);
+TrayContext *tray_create(Display *dpy, int screen, const IconImage *icons, int icon_count, const void *menu_theme, Window main_window);
 
 /**
  * @brief Destroy tray icon and free resources
@@ -81,9 +91,22 @@ void tray_destroy(TrayContext *ctx);
  *   3 - Show/Hide Window menu item
  *   4 - Copy as Hex menu item
  *   5 - Exit menu item
+ *   TRAY_RESULT_RECENT + i - Recent colour i (see tray_set_recent_colors())
  */
 int tray_handle_event(TrayContext *ctx, XEvent *event);
 
+/**
+ * @brief Set the recently copied colours listed in the context menu
+ * @param ctx Tray context
+ * @param colors Colours, most recent first
+ * @param labels UTF-8 text shown next to each colour chip
+ * @param count Number of entries (at most TRAY_MAX_RECENT are shown)
+ *
+ * Entries appear between "Copy as Hex" and the separator. Clicking entry i
+ * makes tray_handle_event() return TRAY_RESULT_RECENT + i.
+ */
+void tray_set_recent_colors(TrayContext *ctx, const RGB8 *colors, const char *const *labels, int count);
+
 /* ========== VISIBILITY CONTROL ========== */
 
 /**
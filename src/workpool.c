@@ -0,0 +1,480 @@
+/* workpool.c - Worker Pool Implementation
+ *
+ * Runs jobs on worker threads and hands their completions back to the main
+ * loop through a lock-free queue and an eventfd.
+ *
+ * Internal design notes:
+ * - Every worker owns a deque behind its own mutex. The owner pops the
+ *   newest job and thieves take the oldest, so a burst of submissions
+ *   spreads over the workers while jobs a job submits itself stay on the
+ *   same (cache-warm) worker. The locks are per queue and only held for
+ *   a few pointer moves, so workers never contend on a shared queue.
+ * - Idle workers sleep on one condition variable. The queued counter is
+ *   raised before the signal, and workers re-check it under the same
+ *   mutex, so no wakeup is lost.
+ * - Finished jobs go onto an intrusive multi-producer single-consumer
+ *   queue (Vyukov): a push is one atomic exchange, and the consumer needs
+ *   no atomics beyond acquire loads. A pop can briefly miss a job whose
+ *   push is half done; that producer writes the eventfd after its push,
+ *   so the main loop wakes again and picks it up.
+ * - The eventfd is drained before the queue is, for the same reason.
+ * - workpool_parallel() splits one computation into items. It queues
+ *   helper jobs that claim items from a shared counter, and the caller
+ *   claims items too. The caller therefore never waits for a helper to
+ *   start, only for items already being run, so a job that calls it
+ *   cannot deadlock a busy pool. Helpers bypass the completion queue, and
+ *   the batch is reference counted because a helper may start after the
+ *   caller has returned.
+ */
+
+#include "workpool.h"
+#include <poll.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+/* ========== INTERNAL CONSTANTS ========== */
+
+#define DEQUE_INITIAL_SIZE 16
+
+/* ========== TYPE DEFINITIONS ========== */
+
+typedef struct Job {
+	WorkFunc work;
+	WorkDoneFunc done;
+	void *arg;
+	int detached;     // Freed by the worker, never reaches the completion queue
+	struct Job *next; // Completion queue link
+} Job;
+
+/* One workpool_parallel() call, shared by the caller and its helpers */
+typedef struct {
+	WorkFunc fn;
+	char *items;
+	size_t item_size;
+	int count;
+	int next;          // Next unclaimed item
+	int finished;      // Items run to completion
+	int refs;          // Caller plus queued helpers
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+} Batch;
+
+typedef struct {
+	pthread_mutex_t lock;
+	Job **ring;
+	unsigned int size;
+	unsigned int head;
+	unsigned int count;
+} Deque;
+
+typedef struct {
+	WorkPool *pool;
+	int index;
+	pthread_t thread;
+} Worker;
+
+struct WorkPool {
+	Worker workers[WORKPOOL_MAX_WORKERS];
+	Deque queues[WORKPOOL_MAX_WORKERS];
+	int worker_count;
+	unsigned int next_queue;  // Round-robin cursor for outside submissions
+	int queued;               // Jobs sitting in deques
+	int pending;              // Jobs whose completion has not run yet
+	int stopping;
+	pthread_mutex_t idle_lock;
+	pthread_cond_t idle_cond;
+	int event_fd;
+	Job *done_head;           // Producers push here
+	Job *done_tail;           // Consumer pops here
+	Job stub;
+};
+
+/* Worker running on this thread, so jobs submitted by jobs stay local */
+static __thread WorkPool *current_pool = NULL;
+static __thread int current_worker = -1;
+
+/* ========== DEQUE ========== */
+
+static int deque_init(Deque *d) {
+	d->ring = malloc(DEQUE_INITIAL_SIZE * sizeof(Job *));
+	if (!d->ring) {
+		return -1;
+	}
+	d->size = DEQUE_INITIAL_SIZE;
+	d->head = 0;
+	d->count = 0;
+	pthread_mutex_init(&d->lock, NULL);
+	return 0;
+}
+
+static void deque_free(Deque *d) {
+	if (d->ring) {
+		pthread_mutex_destroy(&d->lock);
+		free(d->ring);
+		d->ring = NULL;
+	}
+}
+
+static int deque_push(Deque *d, Job *job) {
+	pthread_mutex_lock(&d->lock);
+	if (d->count == d->size) {
+		Job **grown = malloc((size_t)d->size * 2 * sizeof(Job *));
+		if (!grown) {
+			pthread_mutex_unlock(&d->lock);
+			return -1;
+		}
+		for (unsigned int i = 0; i < d->count; i++) {
+			grown[i] = d->ring[(d->head + i) % d->size];
+		}
+		free(d->ring);
+		d->ring = grown;
+		d->size *= 2;
+		d->head = 0;
+	}
+	d->ring[(d->head + d->count) % d->size] = job;
+	d->count++;
+	pthread_mutex_unlock(&d->lock);
+	return 0;
+}
+
+/* Newest job, for the owner */
+static Job *deque_pop_newest(Deque *d) {
+	Job *job = NULL;
+	pthread_mutex_lock(&d->lock);
+	if (d->count) {
+		d->count--;
+		job = d->ring[(d->head + d->count) % d->size];
+	}
+	pthread_mutex_unlock(&d->lock);
+	return job;
+}
+
+/* Oldest job, for thieves */
+static Job *deque_pop_oldest(Deque *d) {
+	Job *job = NULL;
+	pthread_mutex_lock(&d->lock);
+	if (d->count) {
+		job = d->ring[d->head];
+		d->head = (d->head + 1) % d->size;
+		d->count--;
+	}
+	pthread_mutex_unlock(&d->lock);
+	return job;
+}
+
+/* ========== COMPLETION QUEUE ========== */
+
+static void done_push(WorkPool *pool, Job *job) {
+	__atomic_store_n(&job->next, NULL, __ATOMIC_RELAXED);
+	Job *prev = __atomic_exchange_n(&pool->done_head, job, __ATOMIC_ACQ_REL);
+	__atomic_store_n(&prev->next, job, __ATOMIC_RELEASE);
+}
+
+/* Pop one finished job; NULL when empty or a push is still in flight */
+static Job *done_pop(WorkPool *pool) {
+	Job *tail = pool->done_tail;
+	Job *next = __atomic_load_n(&tail->next, __ATOMIC_ACQUIRE);
+	if (tail == &pool->stub) {
+		if (!next) {
+			return NULL;
+		}
+		pool->done_tail = next;
+		tail = next;
+		next = __atomic_load_n(&tail->next, __ATOMIC_ACQUIRE);
+	}
+	if (next) {
+		pool->done_tail = next;
+		return tail;
+	}
+	if (tail != __atomic_load_n(&pool->done_head, __ATOMIC_ACQUIRE)) {
+		return NULL;
+	}
+	// tail is the last job: put the stub behind it so it can be unlinked
+	done_push(pool, &pool->stub);
+	next = __atomic_load_n(&tail->next, __ATOMIC_ACQUIRE);
+	if (next) {
+		pool->done_tail = next;
+		return tail;
+	}
+	return NULL;
+}
+
+/* ========== WORKERS ========== */
+
+static Job *take_job(WorkPool *pool, int index) {
+	int n = __atomic_load_n(&pool->worker_count, __ATOMIC_ACQUIRE);
+	Job *job = deque_pop_newest(&pool->queues[index]);
+	for (int i = 1; !job && i < n; i++) {
+		job = deque_pop_oldest(&pool->queues[(index + i) % n]);
+	}
+	if (job) {
+		__atomic_sub_fetch(&pool->queued, 1, __ATOMIC_ACQ_REL);
+	}
+	return job;
+}
+
+static void *worker_main(void *arg) {
+	Worker *worker = arg;
+	WorkPool *pool = worker->pool;
+	current_pool = pool;
+	current_worker = worker->index;
+	for (;;) {
+		Job *job = take_job(pool, worker->index);
+		if (job) {
+			job->work(job->arg);
+			if (job->detached) {
+				free(job);
+				continue;
+			}
+			done_push(pool, job);
+			uint64_t one = 1;
+			if (write(pool->event_fd, &one, sizeof(one)) < 0) {
+				// Counter saturated: the main loop is already due to wake
+			}
+			continue;
+		}
+		pthread_mutex_lock(&pool->idle_lock);
+		while (!__atomic_load_n(&pool->queued, __ATOMIC_ACQUIRE) && !pool->stopping) {
+			pthread_cond_wait(&pool->idle_cond, &pool->idle_lock);
+		}
+		int stop = pool->stopping && !__atomic_load_n(&pool->queued, __ATOMIC_ACQUIRE);
+		pthread_mutex_unlock(&pool->idle_lock);
+		if (stop) {
+			break;
+		}
+	}
+	return NULL;
+}
+
+/* ========== LIFECYCLE MANAGEMENT ========== */
+
+WorkPool *workpool_create(int threads) {
+	if (threads <= 0) {
+		long n = sysconf(_SC_NPROCESSORS_ONLN);
+		threads = n < 1 ? 1 : (int)(n > WORKPOOL_MAX_WORKERS ? WORKPOOL_MAX_WORKERS : n);
+	}
+	threads = threads > WORKPOOL_MAX_WORKERS ? WORKPOOL_MAX_WORKERS : threads;
+
+	WorkPool *pool = calloc(1, sizeof(WorkPool));
+	if (!pool) {
+		return NULL;
+	}
+	pool->event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (pool->event_fd < 0) {
+		perror("eventfd");
+		free(pool);
+		return NULL;
+	}
+	for (int i = 0; i < threads; i++) {
+		if (deque_init(&pool->queues[i]) != 0) {
+			for (int j = 0; j < i; j++) {
+				deque_free(&pool->queues[j]);
+			}
+			close(pool->event_fd);
+			free(pool);
+			return NULL;
+		}
+	}
+	pool->done_head = &pool->stub;
+	pool->done_tail = &pool->stub;
+	pthread_mutex_init(&pool->idle_lock, NULL);
+	pthread_cond_init(&pool->idle_cond, NULL);
+
+	// No job can exist yet, so shrinking worker_count after a failed start is safe
+	pool->worker_count = threads;
+	int started = 0;
+	for (int i = 0; i < threads; i++) {
+		pool->workers[i].pool = pool;
+		pool->workers[i].index = i;
+		if (pthread_create(&pool->workers[i].thread, NULL, worker_main, &pool->workers[i]) != 0) {
+			break;
+		}
+		started++;
+	}
+	__atomic_store_n(&pool->worker_count, started, __ATOMIC_RELEASE);
+	if (!started) {
+		fprintf(stderr, "Failed to start worker threads\n");
+		workpool_destroy(pool);
+		return NULL;
+	}
+	return pool;
+}
+
+void workpool_destroy(WorkPool *pool) {
+	if (!pool) {
+		return;
+	}
+	// Let every job finish; callbacks may submit follow-up jobs
+	while (__atomic_load_n(&pool->pending, __ATOMIC_ACQUIRE) > 0 && pool->worker_count > 0) {
+		struct pollfd pfd = {pool->event_fd, POLLIN, 0};
+		poll(&pfd, 1, -1);
+		workpool_dispatch(pool);
+	}
+
+	pthread_mutex_lock(&pool->idle_lock);
+	pool->stopping = 1;
+	pthread_cond_broadcast(&pool->idle_cond);
+	pthread_mutex_unlock(&pool->idle_lock);
+	for (int i = 0; i < pool->worker_count; i++) {
+		pthread_join(pool->workers[i].thread, NULL);
+	}
+	for (int i = 0; i < WORKPOOL_MAX_WORKERS; i++) {
+		deque_free(&pool->queues[i]);
+	}
+	pthread_cond_destroy(&pool->idle_cond);
+	pthread_mutex_destroy(&pool->idle_lock);
+	close(pool->event_fd);
+	free(pool);
+}
+
+/* ========== JOBS ========== */
+
+/* Queue a job; detached jobs are not counted as pending */
+static int queue_job(WorkPool *pool, WorkFunc work, WorkDoneFunc done, void *arg, int detached) {
+	if (!pool || !work || __atomic_load_n(&pool->stopping, __ATOMIC_ACQUIRE)) {
+		return -1;
+	}
+	Job *job = malloc(sizeof(Job));
+	if (!job) {
+		return -1;
+	}
+	job->work = work;
+	job->done = done;
+	job->arg = arg;
+	job->detached = detached;
+	job->next = NULL;
+
+	int n = __atomic_load_n(&pool->worker_count, __ATOMIC_ACQUIRE);
+	int q = (current_pool == pool && current_worker >= 0) ? current_worker : (int)(__atomic_fetch_add(&pool->next_queue, 1, __ATOMIC_RELAXED) % (unsigned int)n);
+	if (!detached) {
+		__atomic_add_fetch(&pool->pending, 1, __ATOMIC_ACQ_REL);
+	}
+	if (deque_push(&pool->queues[q], job) != 0) {
+		if (!detached) {
+			__atomic_sub_fetch(&pool->pending, 1, __ATOMIC_ACQ_REL);
+		}
+		free(job);
+		return -1;
+	}
+	__atomic_add_fetch(&pool->queued, 1, __ATOMIC_ACQ_REL);
+
+	pthread_mutex_lock(&pool->idle_lock);
+	pthread_cond_signal(&pool->idle_cond);
+	pthread_mutex_unlock(&pool->idle_lock);
+	return 0;
+}
+
+int workpool_submit(WorkPool *pool, WorkFunc work, WorkDoneFunc done, void *arg) {
+	return queue_job(pool, work, done, arg, 0);
+}
+
+/* ========== PARALLEL LOOPS ========== */
+
+static void batch_release(Batch *batch) {
+	if (__atomic_sub_fetch(&batch->refs, 1, __ATOMIC_ACQ_REL) == 0) {
+		pthread_cond_destroy(&batch->cond);
+		pthread_mutex_destroy(&batch->lock);
+		free(batch);
+	}
+}
+
+/* Claim and run items until none are left */
+static void batch_run(Batch *batch) {
+	for (;;) {
+		int i = __atomic_fetch_add(&batch->next, 1, __ATOMIC_ACQ_REL);
+		if (i >= batch->count) {
+			return;
+		}
+		batch->fn(batch->items + (size_t)i * batch->item_size);
+		if (__atomic_add_fetch(&batch->finished, 1, __ATOMIC_ACQ_REL) == batch->count) {
+			pthread_mutex_lock(&batch->lock);
+			pthread_cond_broadcast(&batch->cond);
+			pthread_mutex_unlock(&batch->lock);
+		}
+	}
+}
+
+static void batch_helper(void *arg) {
+	Batch *batch = arg;
+	batch_run(batch);
+	batch_release(batch);
+}
+
+void workpool_parallel(WorkPool *pool, WorkFunc fn, void *items, size_t item_size, int count) {
+	char *base = items;
+	Batch *batch = NULL;
+	if (pool && count > 1) {
+		batch = malloc(sizeof(Batch));
+	}
+	if (!batch) {
+		for (int i = 0; i < count; i++) {
+			fn(base + (size_t)i * item_size);
+		}
+		return;
+	}
+	batch->fn = fn;
+	batch->items = base;
+	batch->item_size = item_size;
+	batch->count = count;
+	batch->next = 0;
+	batch->finished = 0;
+	pthread_mutex_init(&batch->lock, NULL);
+	pthread_cond_init(&batch->cond, NULL);
+
+	int helpers = count - 1;
+	int workers = __atomic_load_n(&pool->worker_count, __ATOMIC_ACQUIRE);
+	helpers = helpers > workers ? workers : helpers;
+	batch->refs = helpers + 1;
+	for (int i = 0; i < helpers; i++) {
+		if (queue_job(pool, batch_helper, NULL, batch, 1) != 0) {
+			// Unqueued helpers hold no reference; the caller covers their items
+			__atomic_sub_fetch(&batch->refs, helpers - i, __ATOMIC_ACQ_REL);
+			break;
+		}
+	}
+
+	batch_run(batch);
+	pthread_mutex_lock(&batch->lock);
+	while (__atomic_load_n(&batch->finished, __ATOMIC_ACQUIRE) < count) {
+		pthread_cond_wait(&batch->cond, &batch->lock);
+	}
+	pthread_mutex_unlock(&batch->lock);
+	batch_release(batch);
+}
+
+int workpool_size(const WorkPool *pool) {
+	return pool ? __atomic_load_n(&pool->worker_count, __ATOMIC_ACQUIRE) : 1;
+}
+
+int workpool_dispatch(WorkPool *pool) {
+	if (!pool) {
+		return 0;
+	}
+	uint64_t count;
+	if (read(pool->event_fd, &count, sizeof(count)) < 0) {
+		// Nothing signalled; the queue may still hold jobs from a racing push
+	}
+	int ran = 0;
+	Job *job;
+	while ((job = done_pop(pool)) != NULL) {
+		if (job->done) {
+			job->done(job->arg);
+		}
+		free(job);
+		__atomic_sub_fetch(&pool->pending, 1, __ATOMIC_ACQ_REL);
+		ran++;
+	}
+	return ran;
+}
+
+int workpool_get_fd(const WorkPool *pool) {
+	return pool ? pool->event_fd : -1;
+}
+
+int workpool_pending(const WorkPool *pool) {
+	return pool ? __atomic_load_n(&pool->pending, __ATOMIC_ACQUIRE) : 0;
+}
@@ -0,0 +1,137 @@
+#ifndef WORKPOOL_H_
+#define WORKPOOL_H_
+
+/* ========== WORKER POOL INTERFACE ========== */
+
+/**
+ * @file workpool.h
+ * @brief Background worker threads whose results are applied on the main loop
+ *
+ * Jobs run on a small set of worker threads. Each worker has its own
+ * queue; submissions are spread round-robin over the queues and an idle
+ * worker steals from the others. When a job finishes it is pushed onto a
+ * lock-free completion queue and an eventfd is signalled, so the main loop
+ * can sleep in select() on that descriptor next to the X connection. The
+ * job's completion callback then runs on the main loop from
+ * workpool_dispatch(). That is the only place results should be applied to
+ * X resources or widgets.
+ *
+ * Dependencies:
+ * - POSIX threads
+ * - Linux eventfd
+ *
+ * Usage:
+ *   1. Create pool: workpool_create(0)
+ *   2. Add workpool_get_fd(pool) to the main loop's select() set
+ *   3. Submit: workpool_submit(pool, work, done, arg)
+ *      - work(arg) runs on a worker thread
+ *      - done(arg) runs later on the main loop and owns arg from then on
+ *   4. Each loop iteration: workpool_dispatch(pool)
+ *   5. Cleanup: workpool_destroy(pool)
+ *
+ * Data-parallel work that must finish before the caller continues uses
+ * workpool_parallel(pool, fn, items, sizeof(*items), count) instead.
+ *
+ * Thread safety: workpool_submit() and workpool_parallel() may be called
+ * from any thread, including from inside a job; dispatch and destroy
+ * belong to the main loop.
+ * Memory: Caller must call workpool_destroy() to free resources
+ */
+
+#include <stddef.h>
+
+/* Most workers a pool runs; workpool_size() never exceeds it, so callers
+ * may size per-worker arrays with it */
+#define WORKPOOL_MAX_WORKERS 8
+
+/* ========== TYPE DEFINITIONS ========== */
+
+/* Opaque pool handle */
+typedef struct WorkPool WorkPool;
+
+/* Job body, run on a worker thread */
+typedef void (*WorkFunc)(void *arg);
+
+/* Completion callback, run on the thread calling workpool_dispatch() */
+typedef void (*WorkDoneFunc)(void *arg);
+
+/* ========== LIFECYCLE MANAGEMENT ========== */
+
+/**
+ * @brief Start a worker pool
+ * @param threads Number of workers (0 = one per CPU, at most WORKPOOL_MAX_WORKERS)
+ *
+ * @return New pool, or NULL if no worker could be started
+ */
+WorkPool *workpool_create(int threads);
+
+/**
+ * @brief Stop the pool
+ * @param pool Pool (may be NULL)
+ *
+ * Waits for every submitted job to finish, runs the outstanding
+ * completion callbacks on the calling thread, then joins the workers.
+ * Callbacks may still touch X resources, so destroy the pool before
+ * closing the display.
+ */
+void workpool_destroy(WorkPool *pool);
+
+/* ========== JOBS ========== */
+
+/**
+ * @brief Queue a job
+ * @param pool Pool
+ * @param work Job body (required)
+ * @param done Completion callback (may be NULL)
+ * @param arg Argument for both
+ *
+ * @return 0 if queued, -1 if the pool is NULL, stopping or out of memory.
+ *         On failure nothing runs and the caller still owns arg; running
+ *         work(arg) and done(arg) inline keeps the caller working.
+ */
+int workpool_submit(WorkPool *pool, WorkFunc work, WorkDoneFunc done, void *arg);
+
+/**
+ * @brief Run fn over an array of items in parallel and wait for all of them
+ * @param pool Pool (NULL runs every item on the calling thread)
+ * @param fn Called once per item, with a pointer to the item
+ * @param items First item
+ * @param item_size Size of one item in bytes
+ * @param count Number of items
+ *
+ * The calling thread runs items too, and never waits for a worker to
+ * become free, so this is safe to call from inside a job even when every
+ * worker is busy. Items run in no particular order.
+ */
+void workpool_parallel(WorkPool *pool, WorkFunc fn, void *items, size_t item_size, int count);
+
+/**
+ * @brief Number of worker threads
+ * @param pool Pool
+ * @return Workers (at most WORKPOOL_MAX_WORKERS), or 1 if pool is NULL
+ */
+int workpool_size(const WorkPool *pool);
+
+/**
+ * @brief Run the completion callbacks of finished jobs
+ * @param pool Pool
+ *
+ * @return Number of callbacks run
+ */
+int workpool_dispatch(WorkPool *pool);
+
+/**
+ * @brief Descriptor that becomes readable when completions are waiting
+ * @param pool Pool
+ * @return eventfd descriptor, or -1 if pool is NULL
+ */
+int workpool_get_fd(const WorkPool *pool);
+
+/**
+ * @brief Number of jobs submitted whose completion has not run yet
+ * @param pool Pool
+ * @return Outstanding jobs
+ */
+int workpool_pending(const WorkPool *pool);
+
+#endif /* WORKPOOL_H_ */
@@ -11,11 +11,32 @@
  * - Image save/load functionality
  * - Keyboard shortcuts (Enter to pick, Escape to cancel)
  * - Mouse click to pick color
+ * - Drag to select a screen region (for dominant color extraction)
+ * - Shift+drag to track a region for live statistics
  *
  * Internal design notes:
  * - Grabs the pointer while selecting regions; releases once zoom window shows.
  * - Crosshair/cell colors are pulled from config and cached as Pixels.
  * - Zoom surface is a Pixmap updated via XGetImage for portability.
+ * - A Button1 press only anchors a drag; the release decides between a
+ *   pixel pick (pointer barely moved) and a region. The rubber band is
+ *   XOR-drawn on the root window and erased before every capture so it
+ *   never shows up in the magnifier or the region.
+ * - With Shift held the drag is a statistics drag: the rectangle is
+ *   published on every change and the release picks nothing. The band is
+ *   on screen meanwhile, so the application captures once when the drag
+ *   starts and reads sub-rectangles from that frame.
+ * - The optional capture thread owns a second X connection, so a slow
+ *   XGetImage no longer holds up input on the main connection and vice
+ *   versa. It grabs and upscales into one of three frames: the thread
+ *   fills "back", the newest finished frame waits in "ready", and "front"
+ *   (zoom_ximage[ZOOM_DST]) is what the window shows. Swaps are pointer
+ *   exchanges under the lock, so neither side waits on the other's round
+ *   trip, and requests coalesce to the latest pointer position.
+ * - Frames are numbered by request; the UI presents a frame only if it is
+ *   newer than the last one shown. Captures taken synchronously (during a
+ *   drag, when the XOR band must be erased first) bump the number so any
+ *   frame still in flight is dropped as stale.
  */
 
 #include "zoom.h"
@@ -23,6 +44,9 @@
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/eventfd.h>
 #include <X11/cursorfont.h>
 
 /* ========== INTERNAL CONSTANTS ========== */
@@ -30,6 +54,28 @@
 #define ZOOM_SRC 0
 #define ZOOM_DST 1
 #define DATA uint32_t
+#define DRAG_THRESHOLD 3 // Pixels the pointer must move before a click becomes a region
+
+/* Capture thread state; everything below the mutex is guarded by it */
+typedef struct {
+	Display *display;    // Second connection, used only by the thread
+	Window root;
+	pthread_t thread;
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	int event_fd;        // Readable when a new frame is ready
+	int running;
+	int quit;
+	int busy;            // Thread is capturing outside the lock
+	unsigned long request_seq;
+	unsigned long taken_seq;
+	unsigned long ready_seq;
+	unsigned long shown_seq;
+	int req_x, req_y;
+	int src_w, src_h, mag, dst_w; // Geometry snapshot for the thread
+	XImage *back;
+	XImage *ready;
+} ZoomCapture;
 
 struct ZoomContext {
 	Display *display;
@@ -57,6 +103,17 @@ struct ZoomContext {
 	int square_show_after_pick;    // Keep square visible after picking
 	Cursor cursor_cross;
 	Cursor cursor_normal;
+	GC band_gc;          // XOR rubber band on the root window
+	int is_dragging;
+	int drag_x, drag_y;  // Root position where Button1 went down
+	int band_drawn;
+	int band_x, band_y, band_w, band_h;
+	int is_region_picked;
+	int region_x, region_y, region_w, region_h;
+	int is_stats_drag;   // Shift was held when the drag started
+	int is_stats_changed;
+	int stats_x, stats_y, stats_w, stats_h;
+	ZoomCapture capture;
 	ZoomActivationCallback activation_callback;
 	void *activation_user_data;
 };
@@ -84,21 +141,54 @@ static void zoom_set_cursor_normal_internal(ZoomContext *ctx) {
 
 /* ========== IMAGE HANDLING ========== */
 
+static XImage *zoom_create_image(ZoomContext *ctx, int width, int height) {
+	XImage *image = XCreateImage(ctx->display, DefaultVisualOfScreen(ctx->screen), (unsigned int)DefaultDepthOfScreen(ctx->screen), ZPixmap, 0, NULL, (unsigned int)width, (unsigned int)height, 32, 0);
+	if (!image) {
+		fprintf(stderr, "XCreateImage failed\n");
+		return NULL;
+	}
+	size_t sz = (size_t)image->bytes_per_line * (size_t)image->height;
+	image->data = (char *)malloc(sz);
+	if (!image->data) {
+		fprintf(stderr, "malloc failed for XImage data (%zu bytes)\n", sz);
+		XDestroyImage(image);
+		return NULL;
+	}
+	return image;
+}
+
+static void zoom_free_image(XImage **image) {
+	if (*image) {
+		// Free data manually since we allocated it with malloc()
+		free((*image)->data);
+		(*image)->data = NULL; // Prevent XDestroyImage from double-freeing
+		XDestroyImage(*image);
+		*image = NULL;
+	}
+}
+
+/* Spare frames for the capture thread; on failure the thread stays idle
+ * and zoom_magnify() captures synchronously */
+static void zoom_allocate_spares(ZoomContext *ctx) {
+	ZoomCapture *cap = &ctx->capture;
+	cap->back = zoom_create_image(ctx, ctx->zoom_width[ZOOM_DST], ctx->zoom_height[ZOOM_DST]);
+	cap->ready = zoom_create_image(ctx, ctx->zoom_width[ZOOM_DST], ctx->zoom_height[ZOOM_DST]);
+	if (!cap->back || !cap->ready) {
+		zoom_free_image(&cap->back);
+		zoom_free_image(&cap->ready);
+	}
+}
+
 static void zoom_allocate_images(ZoomContext *ctx) {
 	for (int img = 0; img < 2; ++img) {
-		ctx->zoom_ximage[img] = XCreateImage(ctx->display, DefaultVisualOfScreen(ctx->screen), (unsigned int)DefaultDepthOfScreen(ctx->screen), ZPixmap, 0, NULL, (unsigned int)ctx->zoom_width[img], (unsigned int)ctx->zoom_height[img], 32, 0);
+		ctx->zoom_ximage[img] = zoom_create_image(ctx, ctx->zoom_width[img], ctx->zoom_height[img]);
 		if (!ctx->zoom_ximage[img]) {
-			fprintf(stderr, "XCreateImage failed\n");
-			exit(1);
-		}
-		size_t sz = (size_t)ctx->zoom_ximage[img]->bytes_per_line *
-		            (size_t)ctx->zoom_ximage[img]->height;
-		ctx->zoom_ximage[img]->data = (char *)malloc(sz);
-		if (!ctx->zoom_ximage[img]->data) {
-			fprintf(stderr, "malloc failed for XImage data (%zu bytes)\n", sz);
 			exit(1);
 		}
 	}
+	if (ctx->capture.running) {
+		zoom_allocate_spares(ctx);
+	}
 	ctx->created_images = 1;
 }
 
@@ -107,20 +197,22 @@ static void zoom_destroy_images(ZoomContext *ctx) {
 		return;
 	}
 	for (int img = 0; img < 2; ++img) {
-		if (ctx->zoom_ximage[img]) {
-			// Free data manually since we allocated it with malloc()
-			if (ctx->zoom_ximage[img]->data) {
-				free(ctx->zoom_ximage[img]->data);
-				ctx->zoom_ximage[img]->data = NULL; // Prevent XDestroyImage from double-freeing
-			}
-			XDestroyImage(ctx->zoom_ximage[img]);
-			ctx->zoom_ximage[img] = NULL;
-		}
+		zoom_free_image(&ctx->zoom_ximage[img]);
 	}
+	zoom_free_image(&ctx->capture.back);
+	zoom_free_image(&ctx->capture.ready);
 	ctx->created_images = 0;
 }
 
 static int zoom_resize(ZoomContext *ctx, int new_width, int new_height) {
+	ZoomCapture *cap = &ctx->capture;
+	if (cap->running) {
+		// The thread may be writing the back frame; wait for it
+		pthread_mutex_lock(&cap->lock);
+		while (cap->busy) {
+			pthread_cond_wait(&cap->cond, &cap->lock);
+		}
+	}
 	zoom_destroy_images(ctx);
 
 	// Source sampling size is ceil(dst/zoom_mag)
@@ -136,6 +228,17 @@ static int zoom_resize(ZoomContext *ctx, int new_width, int new_height) {
 	ctx->zoom_height[ZOOM_DST] = ctx->zoom_mag * ctx->zoom_height[ZOOM_SRC];
 
 	zoom_allocate_images(ctx);
+	if (cap->running) {
+		cap->src_w = ctx->zoom_width[ZOOM_SRC];
+		cap->src_h = ctx->zoom_height[ZOOM_SRC];
+		cap->mag = ctx->zoom_mag;
+		cap->dst_w = ctx->zoom_width[ZOOM_DST];
+		// Frames of the old size are gone; forget anything outstanding
+		cap->taken_seq = cap->request_seq;
+		cap->ready_seq = cap->request_seq;
+		cap->shown_seq = cap->request_seq;
+		pthread_mutex_unlock(&cap->lock);
+	}
 	return 0;
 }
 
@@ -235,50 +338,264 @@ static void overlays_rebuild(ZoomContext *ctx, int width, int height) {
 	}
 }
 
-/* ========== MAGNIFICATION CORE ========== */
+/* ========== REGION SELECTION ========== */
 
-static int zoom_magnify(ZoomContext *ctx) {
-	// Clamp grab region within root window bounds
+static void clamp_to_screen(const ZoomContext *ctx, int *x, int *y) {
 	int root_w = WidthOfScreen(ctx->screen);
 	int root_h = HeightOfScreen(ctx->screen);
-	if (ctx->grab_x < 0) {
-		ctx->grab_x = 0;
+	*x = *x < 0 ? 0 : (*x >= root_w ? root_w - 1 : *x);
+	*y = *y < 0 ? 0 : (*y >= root_h ? root_h - 1 : *y);
+}
+
+/* Normalized rectangle between the drag anchor and (x, y), inclusive */
+static void drag_rect(const ZoomContext *ctx, int x, int y, int *rx, int *ry, int *rw, int *rh) {
+	*rx = x < ctx->drag_x ? x : ctx->drag_x;
+	*ry = y < ctx->drag_y ? y : ctx->drag_y;
+	*rw = abs(x - ctx->drag_x) + 1;
+	*rh = abs(y - ctx->drag_y) + 1;
+}
+
+/* Remember the statistics rectangle for (x, y) if it grew past the
+ * threshold and differs from the last one */
+static void stats_track(ZoomContext *ctx, int x, int y) {
+	int rx, ry, rw, rh;
+	drag_rect(ctx, x, y, &rx, &ry, &rw, &rh);
+	if ((rw < DRAG_THRESHOLD && rh < DRAG_THRESHOLD) ||
+	    (rx == ctx->stats_x && ry == ctx->stats_y && rw == ctx->stats_w && rh == ctx->stats_h)) {
+		return;
 	}
-	if (ctx->grab_y < 0) {
-		ctx->grab_y = 0;
+	ctx->stats_x = rx;
+	ctx->stats_y = ry;
+	ctx->stats_w = rw;
+	ctx->stats_h = rh;
+	ctx->is_stats_changed = 1;
+}
+
+static void band_erase(ZoomContext *ctx) {
+	if (!ctx->band_drawn) {
+		return;
 	}
-	if (ctx->grab_x + ctx->zoom_width[ZOOM_SRC] > root_w) {
-		ctx->grab_x = root_w - ctx->zoom_width[ZOOM_SRC];
+	XDrawRectangle(ctx->display, RootWindowOfScreen(ctx->screen), ctx->band_gc, ctx->band_x, ctx->band_y, (unsigned int)(ctx->band_w - 1), (unsigned int)(ctx->band_h - 1));
+	ctx->band_drawn = 0;
+}
+
+static void band_draw(ZoomContext *ctx, int x, int y) {
+	drag_rect(ctx, x, y, &ctx->band_x, &ctx->band_y, &ctx->band_w, &ctx->band_h);
+	if (ctx->band_w < DRAG_THRESHOLD && ctx->band_h < DRAG_THRESHOLD) {
+		return;
 	}
-	if (ctx->grab_y + ctx->zoom_height[ZOOM_SRC] > root_h) {
-		ctx->grab_y = root_h - ctx->zoom_height[ZOOM_SRC];
+	XDrawRectangle(ctx->display, RootWindowOfScreen(ctx->screen), ctx->band_gc, ctx->band_x, ctx->band_y, (unsigned int)(ctx->band_w - 1), (unsigned int)(ctx->band_h - 1));
+	ctx->band_drawn = 1;
+}
+
+static void pick_pixel_at(ZoomContext *ctx, int x, int y) {
+	XImage *img = XGetImage(ctx->display, RootWindowOfScreen(ctx->screen), x, y, 1, 1, AllPlanes, ZPixmap);
+	if (img) {
+		ctx->last_pixel = XGetPixel(img, 0, 0);
+		XDestroyImage(img);
+		ctx->is_color_picked = 1;
 	}
-	// Grab source
-	XGetSubImage(ctx->display, RootWindowOfScreen(ctx->screen), ctx->grab_x, ctx->grab_y, (unsigned int)ctx->zoom_width[ZOOM_SRC], (unsigned int)ctx->zoom_height[ZOOM_SRC], AllPlanes, ZPixmap, ctx->zoom_ximage[ZOOM_SRC], 0, 0);
+}
+
+/* ========== MAGNIFICATION CORE ========== */
 
-	// Stride-aware nearest-neighbor upscale
-	const int dst_stride = ctx->zoom_ximage[ZOOM_DST]->bytes_per_line / 4;
-	for (int y = 0; y < ctx->zoom_height[ZOOM_SRC]; ++y) {
-		const DATA *src_row = (const DATA *)(ctx->zoom_ximage[ZOOM_SRC]->data + y * ctx->zoom_ximage[ZOOM_SRC]->bytes_per_line);
-		DATA *dst_row0 = (DATA *)(ctx->zoom_ximage[ZOOM_DST]->data + (y * ctx->zoom_mag) * ctx->zoom_ximage[ZOOM_DST]->bytes_per_line);
+/* Stride-aware nearest-neighbor upscale of src into dst */
+static void zoom_upscale(XImage *dst, const XImage *src, int src_w, int src_h, int mag, int dst_w) {
+	const int dst_stride = dst->bytes_per_line / 4;
+	for (int y = 0; y < src_h; ++y) {
+		const DATA *src_row = (const DATA *)(src->data + y * src->bytes_per_line);
+		DATA *dst_row0 = (DATA *)(dst->data + (y * mag) * dst->bytes_per_line);
 
 		DATA *d = dst_row0;
-		for (int x = 0; x < ctx->zoom_width[ZOOM_SRC]; ++x) {
+		for (int x = 0; x < src_w; ++x) {
 			DATA px = src_row[x];
-			for (int z = 0; z < ctx->zoom_mag; ++z) {
+			for (int z = 0; z < mag; ++z) {
 				*d++ = px;
 			}
 		}
-		for (int vr = 1; vr < ctx->zoom_mag; ++vr) {
+		for (int vr = 1; vr < mag; ++vr) {
 			DATA *dst_rowN = dst_row0 + vr * dst_stride;
-			memcpy(dst_rowN, dst_row0, (size_t)ctx->zoom_width[ZOOM_DST] * sizeof(DATA));
+			memcpy(dst_rowN, dst_row0, (size_t)dst_w * sizeof(DATA));
 		}
 	}
+}
+
+static void zoom_show_front(ZoomContext *ctx) {
 	XPutImage(ctx->display, ctx->zoom_window, ctx->zoom_gc, ctx->zoom_ximage[ZOOM_DST], 0, 0, 0, 0, (unsigned int)ctx->zoom_width[ZOOM_DST], (unsigned int)ctx->zoom_height[ZOOM_DST]);
 
 	// Keep overlays visible
 	XRaiseWindow(ctx->display, ctx->line);
 	XRaiseWindow(ctx->display, ctx->square);
+}
+
+/* ========== CAPTURE THREAD ========== */
+
+/* Mark every request so far as handled, so frames still in flight are
+ * never presented over what the UI thread drew itself */
+static void capture_drop_pending(ZoomContext *ctx) {
+	ZoomCapture *cap = &ctx->capture;
+	if (!cap->running) {
+		return;
+	}
+	pthread_mutex_lock(&cap->lock);
+	cap->request_seq++;
+	cap->taken_seq = cap->request_seq;
+	cap->shown_seq = cap->request_seq;
+	pthread_mutex_unlock(&cap->lock);
+}
+
+static void *capture_thread_main(void *arg) {
+	ZoomCapture *cap = (ZoomCapture *)arg;
+	pthread_mutex_lock(&cap->lock);
+	for (;;) {
+		while (!cap->quit && cap->taken_seq == cap->request_seq) {
+			pthread_cond_wait(&cap->cond, &cap->lock);
+		}
+		if (cap->quit) {
+			break;
+		}
+		// Only the newest request matters; older ones are skipped
+		unsigned long seq = cap->request_seq;
+		cap->taken_seq = seq;
+		if (!cap->back) {
+			continue;
+		}
+		const int x = cap->req_x, y = cap->req_y;
+		const int src_w = cap->src_w, src_h = cap->src_h;
+		const int mag = cap->mag, dst_w = cap->dst_w;
+		XImage *frame = cap->back;
+		cap->busy = 1;
+		pthread_mutex_unlock(&cap->lock);
+
+		int ok = 0;
+		XImage *src = XGetImage(cap->display, cap->root, x, y, (unsigned int)src_w, (unsigned int)src_h, AllPlanes, ZPixmap);
+		if (src) {
+			zoom_upscale(frame, src, src_w, src_h, mag, dst_w);
+			XDestroyImage(src);
+			ok = 1;
+		}
+
+		pthread_mutex_lock(&cap->lock);
+		cap->busy = 0;
+		if (ok && seq > cap->shown_seq) {
+			cap->back = cap->ready;
+			cap->ready = frame;
+			cap->ready_seq = seq;
+			uint64_t one = 1;
+			if (write(cap->event_fd, &one, sizeof(one)) < 0) {
+				// Counter saturated: the main loop is already due to wake
+			}
+		}
+		pthread_cond_broadcast(&cap->cond);
+	}
+	pthread_mutex_unlock(&cap->lock);
+	return NULL;
+}
+
+static int capture_start(ZoomContext *ctx) {
+	ZoomCapture *cap = &ctx->capture;
+	cap->display = XOpenDisplay(DisplayString(ctx->display));
+	if (!cap->display) {
+		fprintf(stderr, "Zoom capture: cannot open a second display connection\n");
+		return -1;
+	}
+	cap->root = RootWindow(cap->display, DefaultScreen(cap->display));
+	cap->event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (cap->event_fd < 0) {
+		perror("eventfd");
+		XCloseDisplay(cap->display);
+		cap->display = NULL;
+		return -1;
+	}
+	pthread_mutex_init(&cap->lock, NULL);
+	pthread_cond_init(&cap->cond, NULL);
+	cap->quit = 0;
+	cap->busy = 0;
+	cap->request_seq = cap->taken_seq = cap->ready_seq = cap->shown_seq = 0;
+	cap->src_w = ctx->zoom_width[ZOOM_SRC];
+	cap->src_h = ctx->zoom_height[ZOOM_SRC];
+	cap->mag = ctx->zoom_mag;
+	cap->dst_w = ctx->zoom_width[ZOOM_DST];
+	zoom_allocate_spares(ctx);
+	if (pthread_create(&cap->thread, NULL, capture_thread_main, cap) != 0) {
+		fprintf(stderr, "Zoom capture: cannot start thread\n");
+		zoom_free_image(&cap->back);
+		zoom_free_image(&cap->ready);
+		pthread_cond_destroy(&cap->cond);
+		pthread_mutex_destroy(&cap->lock);
+		close(cap->event_fd);
+		cap->event_fd = -1;
+		XCloseDisplay(cap->display);
+		cap->display = NULL;
+		return -1;
+	}
+	cap->running = 1;
+	return 0;
+}
+
+static void capture_stop(ZoomContext *ctx) {
+	ZoomCapture *cap = &ctx->capture;
+	if (!cap->running) {
+		return;
+	}
+	pthread_mutex_lock(&cap->lock);
+	cap->quit = 1;
+	pthread_cond_broadcast(&cap->cond);
+	pthread_mutex_unlock(&cap->lock);
+	pthread_join(cap->thread, NULL);
+	cap->running = 0;
+
+	zoom_free_image(&cap->back);
+	zoom_free_image(&cap->ready);
+	pthread_cond_destroy(&cap->cond);
+	pthread_mutex_destroy(&cap->lock);
+	close(cap->event_fd);
+	cap->event_fd = -1;
+	XCloseDisplay(cap->display);
+	cap->display = NULL;
+}
+
+/* ========== MAGNIFICATION CORE ========== */
+
+static int zoom_magnify(ZoomContext *ctx) {
+	// Clamp grab region within root window bounds
+	int root_w = WidthOfScreen(ctx->screen);
+	int root_h = HeightOfScreen(ctx->screen);
+	if (ctx->grab_x < 0) {
+		ctx->grab_x = 0;
+	}
+	if (ctx->grab_y < 0) {
+		ctx->grab_y = 0;
+	}
+	if (ctx->grab_x + ctx->zoom_width[ZOOM_SRC] > root_w) {
+		ctx->grab_x = root_w - ctx->zoom_width[ZOOM_SRC];
+	}
+	if (ctx->grab_y + ctx->zoom_height[ZOOM_SRC] > root_h) {
+		ctx->grab_y = root_h - ctx->zoom_height[ZOOM_SRC];
+	}
+
+	// Hand the capture to the thread, except while the rubber band is
+	// being redrawn around this call: the thread cannot see when it is
+	// erased and would magnify it.
+	ZoomCapture *cap = &ctx->capture;
+	if (cap->running && !ctx->is_dragging) {
+		pthread_mutex_lock(&cap->lock);
+		if (cap->back) {
+			cap->req_x = ctx->grab_x;
+			cap->req_y = ctx->grab_y;
+			cap->request_seq++;
+			pthread_cond_broadcast(&cap->cond);
+			pthread_mutex_unlock(&cap->lock);
+			return 0;
+		}
+		pthread_mutex_unlock(&cap->lock);
+	}
+	capture_drop_pending(ctx);
+
+	// Grab source
+	XGetSubImage(ctx->display, RootWindowOfScreen(ctx->screen), ctx->grab_x, ctx->grab_y, (unsigned int)ctx->zoom_width[ZOOM_SRC], (unsigned int)ctx->zoom_height[ZOOM_SRC], AllPlanes, ZPixmap, ctx->zoom_ximage[ZOOM_SRC], 0, 0);
+	zoom_upscale(ctx->zoom_ximage[ZOOM_DST], ctx->zoom_ximage[ZOOM_SRC], ctx->zoom_width[ZOOM_SRC], ctx->zoom_height[ZOOM_SRC], ctx->zoom_mag, ctx->zoom_width[ZOOM_DST]);
+	zoom_show_front(ctx);
 	return 0;
 }
 
@@ -329,6 +646,13 @@ ZoomContext *zoom_create(Display *dpy, Window parent, int x, int y, int width, i
 	ctx->cursor_cross = XCreateFontCursor(ctx->display, XC_tcross);
 	ctx->cursor_normal = XCreateFontCursor(ctx->display, XC_left_ptr);
 
+	XGCValues band_gcv;
+	band_gcv.function = GXxor;
+	band_gcv.foreground = WhitePixelOfScreen(ctx->screen) ^ BlackPixelOfScreen(ctx->screen);
+	band_gcv.subwindow_mode = IncludeInferiors;
+	ctx->band_gc = XCreateGC(ctx->display, RootWindowOfScreen(ctx->screen), GCFunction | GCForeground | GCSubwindowMode, &band_gcv);
+	ctx->capture.event_fd = -1;
+
 	zoom_resize(ctx, width, height);
 	create_overlays(ctx, ctx->zoom_width[ZOOM_DST], ctx->zoom_height[ZOOM_DST]);
 	return ctx;
@@ -371,6 +695,9 @@ void zoom_cancel_selection_ctx(ZoomContext *ctx) {
 	}
 	ctx->is_zoom_active = 0;
 	ctx->is_pressed = 0;
+	ctx->is_dragging = 0;
+	ctx->is_stats_drag = 0;
+	band_erase(ctx);
 
 	XUngrabPointer(ctx->display, CurrentTime);
 	XUngrabKeyboard(ctx->display, CurrentTime);
@@ -449,6 +776,38 @@ int zoom_color_picked_ctx(ZoomContext *ctx) {
 	return ctx ? ctx->is_color_picked : 0;
 }
 
+int zoom_region_picked_ctx(ZoomContext *ctx) {
+	return ctx ? ctx->is_region_picked : 0;
+}
+
+int zoom_get_region_ctx(ZoomContext *ctx, int *x, int *y, int *width, int *height) {
+	if (!ctx || !ctx->is_region_picked) {
+		return -1;
+	}
+	ctx->is_region_picked = 0;
+	*x = ctx->region_x;
+	*y = ctx->region_y;
+	*width = ctx->region_w;
+	*height = ctx->region_h;
+	return 0;
+}
+
+int zoom_stats_dragging_ctx(const ZoomContext *ctx) {
+	return ctx ? ctx->is_stats_drag : 0;
+}
+
+int zoom_get_stats_region_ctx(ZoomContext *ctx, int *x, int *y, int *width, int *height) {
+	if (!ctx || !ctx->is_stats_changed) {
+		return -1;
+	}
+	ctx->is_stats_changed = 0;
+	*x = ctx->stats_x;
+	*y = ctx->stats_y;
+	*width = ctx->stats_w;
+	*height = ctx->stats_h;
+	return 0;
+}
+
 int zoom_was_cancelled_ctx(ZoomContext *ctx) {
 	if (!ctx) {
 		return 0;
@@ -599,32 +958,13 @@ int zoom_handle_event(ZoomContext *ctx, XEvent *ev) {
 			}
 			if (ev->xbutton.button == Button1) {
 				if (ctx->is_pressed == 1) {
-					// Clamp pick to screen
-					int xr = ev->xbutton.x_root;
-					int yr = ev->xbutton.y_root;
-					int root_w = WidthOfScreen(ctx->screen);
-					int root_h = HeightOfScreen(ctx->screen);
-					if (xr < 0) {
-						xr = 0;
-					}
-					if (yr < 0) {
-						yr = 0;
-					}
-					if (xr >= root_w) {
-						xr = root_w - 1;
-					}
-					if (yr >= root_h) {
-						yr = root_h - 1;
-					}
-					XImage *img = XGetImage(ctx->display, RootWindowOfScreen(ctx->screen), xr, yr, 1, 1, AllPlanes, ZPixmap);
-					if (img) {
-						unsigned long pixel = XGetPixel(img, 0, 0);
-						XDestroyImage(img);
-
-						ctx->last_pixel = pixel;
-						ctx->is_color_picked = 1;
-					}
-					zoom_cancel_selection_ctx(ctx);
+					// Anchor a drag; the release decides between pixel and region
+					ctx->drag_x = ev->xbutton.x_root;
+					ctx->drag_y = ev->xbutton.y_root;
+					clamp_to_screen(ctx, &ctx->drag_x, &ctx->drag_y);
+					ctx->is_dragging = 1;
+					ctx->is_stats_drag = (ev->xbutton.state & ShiftMask) != 0;
+					ctx->stats_w = ctx->stats_h = 0;
 				}
 			}
 			else if (ev->xbutton.button == Button3) {
@@ -660,12 +1000,51 @@ int zoom_handle_event(ZoomContext *ctx, XEvent *ev) {
 			}
 			return 1;
 
+		case ButtonRelease: {
+			if (!ctx->is_zoom_active || !ctx->is_dragging || ev->xbutton.button != Button1) {
+				return ctx->is_zoom_active;
+			}
+			int xr = ev->xbutton.x_root, yr = ev->xbutton.y_root;
+			clamp_to_screen(ctx, &xr, &yr);
+			band_erase(ctx);
+			ctx->is_dragging = 0;
+			int rx, ry, rw, rh;
+			drag_rect(ctx, xr, yr, &rx, &ry, &rw, &rh);
+			if (ctx->is_stats_drag) {
+				// Statistics were shown while dragging; nothing is picked
+				stats_track(ctx, xr, yr);
+			}
+			else if (rw < DRAG_THRESHOLD && rh < DRAG_THRESHOLD) {
+				pick_pixel_at(ctx, ctx->drag_x, ctx->drag_y);
+			}
+			else {
+				ctx->region_x = rx;
+				ctx->region_y = ry;
+				ctx->region_w = rw;
+				ctx->region_h = rh;
+				ctx->is_region_picked = 1;
+			}
+			zoom_cancel_selection_ctx(ctx);
+			// Make sure the band is gone before anyone captures the region
+			XSync(ctx->display, False);
+			return 1;
+		}
+
 		case MotionNotify:
 			if (ctx->is_zoom_active && ctx->is_pressed) {
 				// Keep sample area centered under cursor
+				band_erase(ctx);
 				ctx->grab_x = ev->xmotion.x_root - ctx->zoom_width[ZOOM_SRC] / 2;
 				ctx->grab_y = ev->xmotion.y_root - ctx->zoom_height[ZOOM_SRC] / 2;
 				zoom_magnify(ctx);
+				if (ctx->is_dragging) {
+					int xr = ev->xmotion.x_root, yr = ev->xmotion.y_root;
+					clamp_to_screen(ctx, &xr, &yr);
+					band_draw(ctx, xr, yr);
+					if (ctx->is_stats_drag) {
+						stats_track(ctx, xr, yr);
+					}
+				}
 			}
 			return 1;
 
@@ -784,6 +1163,7 @@ int zoom_load_image(ZoomContext *ctx, const char *filepath) {
 		return -1;
 	}
 	// Read image data
+	capture_drop_pending(ctx);
 	size_t data_size = (size_t)saved_bytes_per_line * (size_t)saved_height;
 	if (fread(ctx->zoom_ximage[ZOOM_DST]->data, 1, data_size, f) != data_size) {
 		fclose(f);
@@ -803,6 +1183,7 @@ void zoom_clear_image(ZoomContext *ctx) {
 		return;
 	}
 	// Fill the image data with black (0)
+	capture_drop_pending(ctx);
 	size_t data_size = (size_t)ctx->zoom_ximage[ZOOM_DST]->bytes_per_line *
 	                   (size_t)ctx->zoom_height[ZOOM_DST];
 	memset(ctx->zoom_ximage[ZOOM_DST]->data, 0, data_size);
@@ -821,6 +1202,7 @@ void zoom_destroy(ZoomContext *ctx) {
 	if (!ctx) {
 		return;
 	}
+	capture_stop(ctx);
 	zoom_destroy_images(ctx);
 	if (ctx->square) {
 		XDestroyWindow(ctx->display, ctx->square);
@@ -831,6 +1213,9 @@ void zoom_destroy(ZoomContext *ctx) {
 	if (ctx->zoom_gc) {
 		XFreeGC(ctx->display, ctx->zoom_gc);
 	}
+	if (ctx->band_gc) {
+		XFreeGC(ctx->display, ctx->band_gc);
+	}
 	if (ctx->cursor_cross) {
 		XFreeCursor(ctx->display, ctx->cursor_cross);
 	}
@@ -843,6 +1228,48 @@ void zoom_destroy(ZoomContext *ctx) {
 	free(ctx);
 }
 
+int zoom_set_capture_thread(ZoomContext *ctx, int enabled) {
+	if (!ctx) {
+		return -1;
+	}
+	if (!enabled) {
+		capture_stop(ctx);
+		return 0;
+	}
+	if (ctx->capture.running) {
+		return 0;
+	}
+	return capture_start(ctx);
+}
+
+int zoom_get_capture_fd(const ZoomContext *ctx) {
+	return (ctx && ctx->capture.running) ? ctx->capture.event_fd : -1;
+}
+
+int zoom_present_frame(ZoomContext *ctx) {
+	if (!ctx || !ctx->capture.running) {
+		return 0;
+	}
+	ZoomCapture *cap = &ctx->capture;
+	uint64_t count;
+	if (read(cap->event_fd, &count, sizeof(count)) < 0) {
+		// Nothing signalled; a frame may still be waiting from before
+	}
+	pthread_mutex_lock(&cap->lock);
+	int fresh = cap->ready_seq > cap->shown_seq;
+	if (fresh) {
+		XImage *front = ctx->zoom_ximage[ZOOM_DST];
+		ctx->zoom_ximage[ZOOM_DST] = cap->ready;
+		cap->ready = front;
+		cap->shown_seq = cap->ready_seq;
+	}
+	pthread_mutex_unlock(&cap->lock);
+	if (fresh) {
+		zoom_show_front(ctx);
+	}
+	return fresh;
+}
+
 void zoom_set_activation_callback(ZoomContext *ctx, ZoomActivationCallback callback, void *user_data) {
 	if (!ctx) {
 		return;
@@ -12,6 +12,8 @@
  * - Screen magnification with configurable zoom level
  * - Crosshair overlay for precise pixel selection
  * - Color picking from screen
+ * - Drag-to-select screen regions
+ * - Shift+drag to inspect a region live (statistics mode)
  * - Keyboard activation (Ctrl+Alt+Z) and navigation (arrow keys)
  * - Image load/save support (X11 XImage format)
  * - Selection mode with visual feedback
@@ -27,9 +29,16 @@
  *   3. Update magnifier: zoom_magnify(zoom, mouse_x, mouse_y)
  *   4. Color picking: zoom_begin_selection_ctx(zoom)
  *   5. Get color: zoom_get_last_pixel_ctx(zoom, &r, &g, &b)
+ *      or, after a drag: zoom_get_region_ctx(zoom, &x, &y, &w, &h)
  *   6. Cleanup: zoom_destroy(zoom)
  *
- * Thread safety: Not thread-safe (uses X11 APIs)
+ * Optional capture thread:
+ *   zoom_set_capture_thread(zoom, 1) moves screen grabs onto a thread with
+ *   its own X connection. Add zoom_get_capture_fd(zoom) to the main loop's
+ *   select() set and call zoom_present_frame(zoom) once per iteration.
+ *
+ * Thread safety: Not thread-safe (uses X11 APIs); the capture thread only
+ * touches its own connection and the frames it hands over under a lock
  * Memory: Caller must call zoom_destroy() to free resources
  */
 
@@ -166,6 +175,60 @@ unsigned long zoom_get_last_pixel_ctx(ZoomContext *ctx);
  */
 int zoom_color_picked_ctx(ZoomContext *ctx);
 
+/**
+ * @brief Check if a screen region has been selected
+ * @param zoom_context Zoom context
+ *
+ * Dragging with Button1 during selection selects the rectangle between
+ * the press and release points instead of a single pixel.
+ *
+ * @return 1 if a region is waiting to be fetched, 0 otherwise
+ */
+int zoom_region_picked_ctx(ZoomContext *ctx);
+
+/**
+ * @brief Fetch the selected screen region and clear the flag
+ * @param zoom_context Zoom context
+ * @param x Receives the left edge (root window coordinates)
+ * @param y Receives the top edge
+ * @param width Receives the width in pixels
+ * @param height Receives the height in pixels
+ *
+ * The rubber band has been erased by the time the region is reported, so
+ * the area can be captured straight away.
+ *
+ * @return 0 on success, -1 if no region was selected
+ */
+int zoom_get_region_ctx(ZoomContext *ctx, int *x, int *y, int *width, int *height);
+
+/**
+ * @brief Check if a statistics drag is in progress
+ * @param zoom_context Zoom context
+ *
+ * Dragging with Shift+Button1 during selection tracks a rectangle for
+ * statistics instead of picking: the rectangle is reported on every
+ * change while the button is held, and releasing the button ends the
+ * selection without picking anything.
+ *
+ * @return 1 from the Shift+Button1 press until the selection ends, 0 otherwise
+ */
+int zoom_stats_dragging_ctx(const ZoomContext *ctx);
+
+/**
+ * @brief Fetch the statistics rectangle if it changed since the last call
+ * @param zoom_context Zoom context
+ * @param x Receives the left edge (root window coordinates)
+ * @param y Receives the top edge
+ * @param width Receives the width in pixels
+ * @param height Receives the height in pixels
+ *
+ * The rubber band is on screen while the drag is in progress, so callers
+ * should capture the screen when the drag starts rather than per update.
+ *
+ * @return 0 if a new rectangle was stored, -1 otherwise
+ */
+int zoom_get_stats_region_ctx(ZoomContext *ctx, int *x, int *y, int *width, int *height);
+
 /**
  * @brief Check if selection was cancelled
  * @param zoom_context Zoom context
@@ -237,6 +300,41 @@ int zoom_load_image(ZoomContext *ctx, const char *filepath);
  */
 void zoom_clear_image(ZoomContext *ctx);
 
+/* ========== CAPTURE THREAD ========== */
+
+/**
+ * @brief Start or stop the background capture thread
+ * @param ctx Zoom context
+ * @param enabled 1 to capture on a dedicated thread, 0 to capture inline
+ *
+ * The thread opens a second connection to the same display, so screen
+ * grabs no longer queue behind input on the main connection and input no
+ * longer waits for grabs. Captures made while a region is being dragged
+ * stay synchronous so the rubber band can be erased first.
+ *
+ * @return 0 on success, -1 if the thread or connection could not be
+ *         created (the widget keeps capturing inline)
+ */
+int zoom_set_capture_thread(ZoomContext *ctx, int enabled);
+
+/**
+ * @brief Descriptor that becomes readable when a captured frame is ready
+ * @param ctx Zoom context
+ * @return eventfd descriptor, or -1 when the capture thread is off
+ */
+int zoom_get_capture_fd(const ZoomContext *ctx);
+
+/**
+ * @brief Show the newest captured frame if it has not been shown yet
+ * @param ctx Zoom context
+ *
+ * Frames older than the last one shown, including any overtaken by an
+ * inline capture, are dropped.
+ *
+ * @return 1 if a frame was drawn, 0 otherwise
+ */
+int zoom_present_frame(ZoomContext *ctx);
+
 /* ========== CALLBACK MANAGEMENT ========== */
 
 /**
@@ -0,0 +1,369 @@
+/* xpm2argb.c - Build-time XPM to ARGB Converter
+ *
+ * Reads XPM icon files and writes a C source file with the pixels as
+ * premultiplied ARGB32 arrays and 1-bit masks, so the program can create its
+ * icons without parsing XPM (or linking libXpm) at runtime.
+ *
+ * Usage:
+ *   xpm2argb [-s SIZE[,SIZE...]] FILE.xpm... > icons_data.c
+ *
+ * Every input is emitted at its native size. Each -s size that no input has
+ * natively is produced by box-filtering the smallest input that is at least
+ * that large (or the largest input when none is).
+ *
+ * Internal design notes:
+ * - Only the "c" (color) key is used, with #RGB, #RRGGBB, #RRRRGGGGBBBB or
+ *   None values. XPM has binary transparency, so alpha is 0 or 255 in the
+ *   native images; downscaled images get partial alpha along edges.
+ * - Masks use XBM layout (LSB first, rows padded to whole bytes), which is
+ *   what XCreateBitmapFromData() expects. A pixel is set when alpha >= 128.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#define MAX_IMAGES 16
+
+typedef struct {
+	int width;
+	int height;
+	uint32_t *argb; // premultiplied
+} Image;
+
+/* ========== XPM PARSING ========== */
+
+/* Read the whole file into a NUL-terminated buffer */
+static char *read_file(const char *path) {
+	FILE *fp = fopen(path, "rb");
+	if (!fp) {
+		perror(path);
+		return NULL;
+	}
+	size_t cap = 65536, len = 0;
+	char *buf = malloc(cap);
+	while (buf) {
+		len += fread(buf + len, 1, cap - len - 1, fp);
+		if (len < cap - 1) {
+			break;
+		}
+		cap *= 2;
+		char *grown = realloc(buf, cap);
+		if (!grown) {
+			free(buf);
+			buf = NULL;
+			break;
+		}
+		buf = grown;
+	}
+	fclose(fp);
+	if (buf) {
+		buf[len] = '\0';
+	}
+	return buf;
+}
+
+/* Split the C string literals out of the file, skipping comments. The
+ * literals are unescaped in place; returns the number found. */
+static int collect_strings(char *text, char ***out) {
+	int count = 0, cap = 256;
+	char **strs = malloc((size_t)cap * sizeof(char *));
+	char *p = text;
+	while (strs && *p) {
+		if (p[0] == '/' && p[1] == '*') {
+			char *end = strstr(p + 2, "*/");
+			p = end ? end + 2 : p + strlen(p);
+			continue;
+		}
+		if (*p != '"') {
+			p++;
+			continue;
+		}
+		char *start = ++p, *dst = p;
+		while (*p && *p != '"') {
+			if (*p == '\\' && p[1]) {
+				p++;
+			}
+			*dst++ = *p++;
+		}
+		if (*p) {
+			p++;
+		}
+		*dst = '\0';
+		if (count == cap) {
+			cap *= 2;
+			char **grown = realloc(strs, (size_t)cap * sizeof(char *));
+			if (!grown) {
+				free(strs);
+				return -1;
+			}
+			strs = grown;
+		}
+		strs[count++] = start;
+	}
+	*out = strs;
+	return strs ? count : -1;
+}
+
+static int hex_value(const char *s, int digits) {
+	int v = 0;
+	for (int i = 0; i < digits; i++) {
+		char c = s[i];
+		int d = c >= '0' && c <= '9' ? c - '0' : c >= 'a' && c <= 'f' ? c - 'a' + 10 : c >= 'A' && c <= 'F' ? c - 'A' + 10 : -1;
+		if (d < 0) {
+			return -1;
+		}
+		v = v * 16 + d;
+	}
+	return v;
+}
+
+/* Parse a color value into ARGB; returns 0 on failure */
+static int parse_color(const char *value, uint32_t *argb) {
+	if (strcasecmp(value, "None") == 0) {
+		*argb = 0;
+		return 1;
+	}
+	size_t len = strlen(value);
+	if (value[0] != '#' || (len != 4 && len != 7 && len != 13)) {
+		return 0;
+	}
+	int digits = (int)(len - 1) / 3;
+	int c[3];
+	for (int i = 0; i < 3; i++) {
+		c[i] = hex_value(value + 1 + i * digits, digits);
+		if (c[i] < 0) {
+			return 0;
+		}
+		if (digits == 1) {
+			c[i] *= 17;
+		}
+		else if (digits == 4) {
+			c[i] >>= 8;
+		}
+	}
+	*argb = 0xFF000000u | (uint32_t)c[0] << 16 | (uint32_t)c[1] << 8 | (uint32_t)c[2];
+	return 1;
+}
+
+/* Find the "c" value in a color line (after the cpp key characters) */
+static int color_value(char *line, char **value) {
+	char *save = NULL;
+	for (char *tok = strtok_r(line, " \t", &save); tok; tok = strtok_r(NULL, " \t", &save)) {
+		if (strcmp(tok, "c") == 0) {
+			*value = strtok_r(NULL, " \t", &save);
+			return *value != NULL;
+		}
+	}
+	return 0;
+}
+
+static int load_xpm(const char *path, Image *img) {
+	char *text = read_file(path);
+	char **strs = NULL;
+	int rc = -1;
+	if (!text) {
+		return -1;
+	}
+	int n = collect_strings(text, &strs);
+	int w, h, ncolors, cpp;
+	if (n < 1 || sscanf(strs[0], "%d %d %d %d", &w, &h, &ncolors, &cpp) != 4 || w <= 0 || h <= 0 || ncolors <= 0 || cpp <= 0 || cpp > 4 ||
+	    n < 1 + ncolors + h) {
+		fprintf(stderr, "%s: not a valid XPM\n", path);
+		goto out;
+	}
+	char (*keys)[5] = calloc((size_t)ncolors, sizeof(*keys));
+	uint32_t *colors = calloc((size_t)ncolors, sizeof(uint32_t));
+	img->argb = calloc((size_t)w * (size_t)h, sizeof(uint32_t));
+	if (!keys || !colors || !img->argb) {
+		goto colors_out;
+	}
+	for (int i = 0; i < ncolors; i++) {
+		char *line = strs[1 + i];
+		char *value;
+		if (strlen(line) < (size_t)cpp) {
+			fprintf(stderr, "%s: short color line %d\n", path, i + 1);
+			goto colors_out;
+		}
+		memcpy(keys[i], line, (size_t)cpp);
+		if (!color_value(line + cpp, &value) || !parse_color(value, &colors[i])) {
+			fprintf(stderr, "%s: unsupported color on line %d (use #RRGGBB or None)\n", path, i + 1);
+			goto colors_out;
+		}
+	}
+	for (int y = 0; y < h; y++) {
+		const char *row = strs[1 + ncolors + y];
+		if (strlen(row) < (size_t)(w * cpp)) {
+			fprintf(stderr, "%s: short pixel row %d\n", path, y + 1);
+			goto colors_out;
+		}
+		for (int x = 0; x < w; x++) {
+			const char *key = row + x * cpp;
+			int found = -1;
+			for (int i = 0; i < ncolors && found < 0; i++) {
+				if (memcmp(keys[i], key, (size_t)cpp) == 0) {
+					found = i;
+				}
+			}
+			if (found < 0) {
+				fprintf(stderr, "%s: unknown color key at %d,%d\n", path, x, y);
+				goto colors_out;
+			}
+			img->argb[y * w + x] = colors[found];
+		}
+	}
+	img->width = w;
+	img->height = h;
+	rc = 0;
+colors_out:
+	if (rc != 0) {
+		free(img->argb);
+		img->argb = NULL;
+	}
+	free(keys);
+	free(colors);
+out:
+	free(strs);
+	free(text);
+	return rc;
+}
+
+/* ========== SCALING ========== */
+
+/* Box filter: every destination pixel is the area-weighted mean of the
+ * source pixels it covers, in premultiplied space */
+static int downscale(const Image *src, int w, int h, Image *dst) {
+	dst->argb = calloc((size_t)w * (size_t)h, sizeof(uint32_t));
+	if (!dst->argb) {
+		return -1;
+	}
+	dst->width = w;
+	dst->height = h;
+	double sx = (double)src->width / w, sy = (double)src->height / h;
+	for (int y = 0; y < h; y++) {
+		double y0 = y * sy, y1 = y0 + sy;
+		for (int x = 0; x < w; x++) {
+			double x0 = x * sx, x1 = x0 + sx;
+			double sum[4] = {0, 0, 0, 0}, area = 0;
+			for (int py = (int)y0; py < src->height && py < y1; py++) {
+				double cy = (py + 1 < y1 ? py + 1 : y1) - (py > y0 ? py : y0);
+				for (int px = (int)x0; px < src->width && px < x1; px++) {
+					double cx = (px + 1 < x1 ? px + 1 : x1) - (px > x0 ? px : x0);
+					uint32_t p = src->argb[py * src->width + px];
+					double wgt = cx * cy;
+					for (int c = 0; c < 4; c++) {
+						sum[c] += wgt * (double)((p >> (24 - c * 8)) & 0xFF);
+					}
+					area += wgt;
+				}
+			}
+			uint32_t out = 0;
+			for (int c = 0; c < 4; c++) {
+				out = out << 8 | (uint32_t)(sum[c] / area + 0.5);
+			}
+			dst->argb[y * w + x] = out;
+		}
+	}
+	return 0;
+}
+
+/* ========== OUTPUT ========== */
+
+static void write_image(const Image *img, int index) {
+	int n = img->width * img->height;
+	printf("static const uint32_t icon%d_argb[%d] = {", index, n);
+	for (int i = 0; i < n; i++) {
+		printf("%s0x%08X,", i % 8 == 0 ? "\n\t" : " ", img->argb[i]);
+	}
+	printf("\n};\n\n");
+
+	int stride = (img->width + 7) / 8;
+	printf("static const unsigned char icon%d_mask[%d] = {", index, stride * img->height);
+	for (int y = 0; y < img->height; y++) {
+		for (int b = 0; b < stride; b++) {
+			unsigned int bits = 0;
+			for (int i = 0; i < 8 && b * 8 + i < img->width; i++) {
+				if ((img->argb[y * img->width + b * 8 + i] >> 24) >= 128) {
+					bits |= 1u << i;
+				}
+			}
+			int k = y * stride + b;
+			printf("%s0x%02X,", k % 12 == 0 ? "\n\t" : " ", bits);
+		}
+	}
+	printf("\n};\n\n");
+}
+
+static int compare_size(const void *a, const void *b) {
+	const Image *ia = a, *ib = b;
+	return ia->width - ib->width;
+}
+
+int main(int argc, char **argv) {
+	Image images[MAX_IMAGES];
+	int native = 0, count = 0;
+	int sizes[MAX_IMAGES], nsizes = 0;
+	int argi = 1;
+
+	if (argi + 1 < argc && strcmp(argv[argi], "-s") == 0) {
+		for (char *s = strtok(argv[argi + 1], ","); s && nsizes < MAX_IMAGES; s = strtok(NULL, ",")) {
+			sizes[nsizes] = atoi(s);
+			if (sizes[nsizes] > 0) {
+				nsizes++;
+			}
+		}
+		argi += 2;
+	}
+	if (argi >= argc) {
+		fprintf(stderr, "Usage: %s [-s SIZE[,SIZE...]] FILE.xpm... > icons_data.c\n", argv[0]);
+		return 1;
+	}
+	for (; argi < argc && count < MAX_IMAGES; argi++) {
+		if (load_xpm(argv[argi], &images[count]) != 0) {
+			return 1;
+		}
+		count++;
+	}
+	native = count;
+	qsort(images, (size_t)native, sizeof(Image), compare_size);
+
+	for (int i = 0; i < nsizes && count < MAX_IMAGES; i++) {
+		int s = sizes[i], have = 0;
+		for (int j = 0; j < count; j++) {
+			have |= images[j].width == s && images[j].height == s;
+		}
+		if (have) {
+			continue;
+		}
+		// Smallest native image that is at least as large, else the largest
+		const Image *src = &images[native - 1];
+		for (int j = native - 1; j >= 0; j--) {
+			if (images[j].width >= s && images[j].height >= s) {
+				src = &images[j];
+			}
+		}
+		if (downscale(src, s, s, &images[count]) != 0) {
+			fprintf(stderr, "Out of memory\n");
+			return 1;
+		}
+		count++;
+	}
+	qsort(images, (size_t)count, sizeof(Image), compare_size);
+
+	printf("/* icons_data.c - Generated by tools/xpm2argb from the XPM files in icons/; do not edit */\n\n");
+	printf("#include \"icons.h\"\n\n");
+	for (int i = 0; i < count; i++) {
+		write_image(&images[i], i);
+	}
+	printf("const IconImage pixelprism_icons[] = {\n");
+	for (int i = 0; i < count; i++) {
+		printf("\t{%d, %d, icon%d_argb, icon%d_mask},\n", images[i].width, images[i].height, i, i);
+	}
+	printf("};\n\nconst int pixelprism_icon_count = %d;\n", count);
+	for (int i = 0; i < count; i++) {
+		free(images[i].argb);
+	}
+	return ferror(stdout) ? 1 : 0;
+}